@@ -0,0 +1,96 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/argon2_pool.h>
+
+#include <Util/include/args.h>
+#include <Util/include/mutex.h>
+
+#include <cstdlib>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace LLC
+{
+
+    /* Mutex for the released buffers. */
+    std::mutex ARGON2_MUTEX;
+
+
+    /* Released buffers with their sizes, most recent last. */
+    std::vector< std::pair<size_t, uint8_t*> > vArgon2Pool;
+
+
+    /* Argon2 memory allocator that reuses released memory of the same size. */
+    int Argon2Allocate(uint8_t** pMemory, size_t nBytes)
+    {
+        {
+            LOCK(ARGON2_MUTEX);
+
+            /* Take the most recent buffer of this size, which is most likely still paged in. */
+            for(auto it = vArgon2Pool.rbegin(); it != vArgon2Pool.rend(); ++it)
+            {
+                if(it->first != nBytes)
+                    continue;
+
+                *pMemory = it->second;
+                vArgon2Pool.erase(std::next(it).base());
+
+                return 0;
+            }
+        }
+
+        *pMemory = static_cast<uint8_t*>(std::malloc(nBytes));
+        return 0;
+    }
+
+
+    /* Argon2 memory deallocator that keeps released buffers for reuse. */
+    void Argon2Free(uint8_t* pMemory, size_t nBytes)
+    {
+        /* Two buffers cover a login and a transaction hashing at once. */
+        static const uint32_t nMax = static_cast<uint32_t>(config::GetArg("-argon2pool", 2));
+
+        if(nMax == 0)
+        {
+            std::free(pMemory);
+            return;
+        }
+
+        /* Keep the buffer, releasing the oldest one when full. */
+        uint8_t* pRelease = nullptr;
+        {
+            LOCK(ARGON2_MUTEX);
+
+            if(vArgon2Pool.size() >= nMax)
+            {
+                pRelease = vArgon2Pool.front().second;
+                vArgon2Pool.erase(vArgon2Pool.begin());
+            }
+
+            vArgon2Pool.push_back(std::make_pair(nBytes, pMemory));
+        }
+
+        std::free(pRelease);
+    }
+
+
+    /* Get the number of released buffers kept for reuse. */
+    uint32_t Argon2PoolSize()
+    {
+        LOCK(ARGON2_MUTEX);
+        return static_cast<uint32_t>(vArgon2Pool.size());
+    }
+
+}
@@ -11,9 +11,15 @@
 
 ____________________________________________________________________________________________*/
 #include <LLC/types/base_uint.h>
+#include <cstring>
 #include <limits>
 #include <stdexcept>
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <x86intrin.h>
+#define BASE_UINT_CARRY64 1
+#endif
+
 namespace
 {
     uint8_t phexdigit[256] =
@@ -26,6 +32,144 @@ namespace
         0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
         0,0xa,0xb,0xc,0xd,0xe,0xf,0,0,0,0,0,0,0,0,0
     };
+
+
+    /* Gets a 64-bit limb from the 32-bit words, low word first. An odd last word is zero extended. */
+    template<uint32_t WIDTH>
+    inline uint64_t GetLimb(const uint32_t* pn, const uint32_t n)
+    {
+        if(2 * n + 1 == WIDTH)
+            return pn[2 * n];
+
+    #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint64_t nLimb;
+        std::memcpy(&nLimb, pn + 2 * n, sizeof(nLimb));
+
+        return nLimb;
+    #else
+        return pn[2 * n] | (static_cast<uint64_t>(pn[2 * n + 1]) << 32);
+    #endif
+    }
+
+
+    /* Sets a 64-bit limb into the 32-bit words, dropping the high half past an odd last word. */
+    template<uint32_t WIDTH>
+    inline void SetLimb(uint32_t* pn, const uint32_t n, const uint64_t nLimb)
+    {
+        if(2 * n + 1 == WIDTH)
+        {
+            pn[2 * n] = static_cast<uint32_t>(nLimb);
+            return;
+        }
+
+    #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        std::memcpy(pn + 2 * n, &nLimb, sizeof(nLimb));
+    #else
+        pn[2 * n]     = static_cast<uint32_t>(nLimb);
+        pn[2 * n + 1] = static_cast<uint32_t>(nLimb >> 32);
+    #endif
+    }
+
+
+    /* Gets all the 64-bit limbs of a number, so they can be worked on without aliasing the words. */
+    template<uint32_t WIDTH>
+    inline void GetLimbs(const uint32_t* pn, uint64_t* pLimbs)
+    {
+        for(uint32_t i = 0; i < (WIDTH + 1) / 2; ++i)
+            pLimbs[i] = GetLimb<WIDTH>(pn, i);
+    }
+
+
+    /* Sets all the 64-bit limbs of a number. */
+    template<uint32_t WIDTH>
+    inline void SetLimbs(uint32_t* pn, const uint64_t* pLimbs)
+    {
+        for(uint32_t i = 0; i < (WIDTH + 1) / 2; ++i)
+            SetLimb<WIDTH>(pn, i, pLimbs[i]);
+    }
+
+
+    /* Adds two limbs and a carry, setting the carry out. */
+    inline uint64_t AddCarry(const uint64_t a, const uint64_t b, uint8_t& nCarry)
+    {
+    #ifdef BASE_UINT_CARRY64
+        unsigned long long nSum;
+        nCarry = _addcarry_u64(nCarry, a, b, &nSum);
+
+        return nSum;
+    #else
+        const uint64_t nSum = a + b + nCarry;
+        nCarry = (nSum < a || (nCarry && nSum == a));
+
+        return nSum;
+    #endif
+    }
+
+
+    /* Subtracts a limb and a borrow from a limb, setting the borrow out. */
+    inline uint64_t SubBorrow(const uint64_t a, const uint64_t b, uint8_t& nBorrow)
+    {
+    #ifdef BASE_UINT_CARRY64
+        unsigned long long nDiff;
+        nBorrow = _subborrow_u64(nBorrow, a, b, &nDiff);
+
+        return nDiff;
+    #else
+        const uint64_t nDiff = a - b - nBorrow;
+        nBorrow = (a < b || (nBorrow && a == b));
+
+        return nDiff;
+    #endif
+    }
+
+
+    /* Computes a * b + c + d, which always fits in 128 bits, returning the low limb and setting the high limb. */
+    inline uint64_t MulAdd(const uint64_t a, const uint64_t b, const uint64_t c, const uint64_t d, uint64_t& nHigh)
+    {
+    #ifdef __SIZEOF_INT128__
+        __extension__ typedef unsigned __int128 uint128_native;
+
+        const uint128_native n = static_cast<uint128_native>(a) * b + c + d;
+        nHigh = static_cast<uint64_t>(n >> 64);
+
+        return static_cast<uint64_t>(n);
+    #else
+        /* Multiply the 32-bit halves. */
+        const uint64_t nLL = (a & 0xffffffff) * (b & 0xffffffff);
+        const uint64_t nLH = (a & 0xffffffff) * (b >> 32);
+        const uint64_t nHL = (a >> 32) * (b & 0xffffffff);
+        const uint64_t nHH = (a >> 32) * (b >> 32);
+
+        const uint64_t nMid = (nLL >> 32) + (nLH & 0xffffffff) + (nHL & 0xffffffff);
+        uint64_t nLow = (nMid << 32) | (nLL & 0xffffffff);
+        nHigh = nHH + (nLH >> 32) + (nHL >> 32) + (nMid >> 32);
+
+        /* Add the two limbs. */
+        nLow += c;
+        nHigh += (nLow < c);
+
+        nLow += d;
+        nHigh += (nLow < d);
+
+        return nLow;
+    #endif
+    }
+
+
+    /* Compares two numbers limb by limb from the most significant, returning -1, 0 or 1. */
+    template<uint32_t WIDTH>
+    inline int32_t Compare(const uint32_t* a, const uint32_t* b)
+    {
+        for(int32_t i = (WIDTH + 1) / 2 - 1; i >= 0; --i)
+        {
+            const uint64_t nA = GetLimb<WIDTH>(a, i);
+            const uint64_t nB = GetLimb<WIDTH>(b, i);
+            if(nA != nB)
+                return (nA < nB) ? -1 : 1;
+        }
+
+        return 0;
+    }
 }
 
 
@@ -134,9 +278,9 @@ base_uint<BITS>::base_uint(uint64_t b)
 template<uint32_t BITS>
 bool base_uint<BITS>::operator!() const
 {
-    for(uint8_t i = 0; i < WIDTH; ++i)
+    for(uint32_t i = 0; i < LIMBS; ++i)
     {
-        if(pn[i] != 0)
+        if(GetLimb<WIDTH>(pn, i) != 0)
             return false;
     }
 
@@ -231,18 +375,21 @@ base_uint<BITS>& base_uint<BITS>::operator&=(const base_uint<BITS>& b)
 template<uint32_t BITS>
 base_uint<BITS>& base_uint<BITS>::operator<<=(uint32_t shift)
 {
-    base_uint<BITS> a(*this);
-    for(int32_t i = 0; i < WIDTH; ++i)
-        pn[i] = 0;
+    /* Shift whole limbs, then the bits within them, from the most significant so limbs are read before written. */
+    const uint32_t k = shift / 64;
+    shift = shift % 64;
 
-    int32_t k = shift / 32;
-    shift = shift % 32;
-    for(int32_t i = 0; i < WIDTH; ++i)
+    for(int32_t i = LIMBS - 1; i >= 0; --i)
     {
-        if(i+k+1 < WIDTH && shift != 0)
-            pn[i+k+1] |= (a.pn[i] >> (32-shift));
-        if(i+k < WIDTH)
-            pn[i+k] |= (a.pn[i] << shift);
+        uint64_t nLimb = 0;
+        if(i >= int32_t(k))
+        {
+            nLimb = GetLimb<WIDTH>(pn, i - k) << shift;
+            if(shift != 0 && i > int32_t(k))
+                nLimb |= GetLimb<WIDTH>(pn, i - k - 1) >> (64 - shift);
+        }
+
+        SetLimb<WIDTH>(pn, i, nLimb);
     }
 
     return *this;
@@ -254,19 +401,21 @@ base_uint<BITS>& base_uint<BITS>::operator<<=(uint32_t shift)
 template<uint32_t BITS>
 base_uint<BITS>& base_uint<BITS>::operator>>=(uint32_t shift)
 {
-    base_uint<BITS> a(*this);
-
-    for(int32_t i = 0; i < WIDTH; ++i)
-        pn[i] = 0;
+    /* Shift whole limbs, then the bits within them, from the least significant so limbs are read before written. */
+    const uint32_t k = shift / 64;
+    shift = shift % 64;
 
-    int32_t k = shift / 32;
-    shift = shift % 32;
-    for(int32_t i = 0; i < WIDTH; ++i)
+    for(uint32_t i = 0; i < LIMBS; ++i)
     {
-        if(i-k-1 >= 0 && shift != 0)
-            pn[i-k-1] |= (a.pn[i] << (32-shift));
-        if(i-k >= 0)
-            pn[i-k] |= (a.pn[i] >> shift);
+        uint64_t nLimb = 0;
+        if(k < LIMBS - i)
+        {
+            nLimb = GetLimb<WIDTH>(pn, i + k) >> shift;
+            if(shift != 0 && k + 1 < LIMBS - i)
+                nLimb |= GetLimb<WIDTH>(pn, i + k + 1) << (64 - shift);
+        }
+
+        SetLimb<WIDTH>(pn, i, nLimb);
     }
 
     return *this;
@@ -277,13 +426,12 @@ base_uint<BITS>& base_uint<BITS>::operator>>=(uint32_t shift)
 template<uint32_t BITS>
 base_uint<BITS>& base_uint<BITS>::operator+=(const base_uint<BITS>& b)
 {
-    uint64_t carry = 0;
-    for(uint8_t i = 0; i < WIDTH; ++i)
-    {
-        uint64_t n = carry + pn[i] + b.pn[i];
-        pn[i] = n & 0xffffffff;
-        carry = n >> 32;
-    }
+    uint64_t c[LIMBS];
+    GetLimbs<WIDTH>(b.pn, c);
+
+    uint8_t nCarry = 0;
+    for(uint32_t i = 0; i < LIMBS; ++i)
+        SetLimb<WIDTH>(pn, i, AddCarry(GetLimb<WIDTH>(pn, i), c[i], nCarry));
 
     return *this;
 }
@@ -293,9 +441,12 @@ base_uint<BITS>& base_uint<BITS>::operator+=(const base_uint<BITS>& b)
 template<uint32_t BITS>
 base_uint<BITS>& base_uint<BITS>::operator+=(uint64_t b64)
 {
-    base_uint<BITS> b;
-    b = b64;
-    *this += b;
+    uint8_t nCarry = 0;
+    SetLimb<WIDTH>(pn, 0, AddCarry(GetLimb<WIDTH>(pn, 0), b64, nCarry));
+
+    /* Carry into the higher limbs. */
+    for(uint32_t i = 1; i < LIMBS && nCarry; ++i)
+        SetLimb<WIDTH>(pn, i, AddCarry(GetLimb<WIDTH>(pn, i), 0, nCarry));
 
     return *this;
 }
@@ -305,7 +456,12 @@ base_uint<BITS>& base_uint<BITS>::operator+=(uint64_t b64)
 template<uint32_t BITS>
 base_uint<BITS>& base_uint<BITS>::operator-=(const base_uint<BITS>& b)
 {
-    *this += -b;
+    uint64_t c[LIMBS];
+    GetLimbs<WIDTH>(b.pn, c);
+
+    uint8_t nBorrow = 0;
+    for(uint32_t i = 0; i < LIMBS; ++i)
+        SetLimb<WIDTH>(pn, i, SubBorrow(GetLimb<WIDTH>(pn, i), c[i], nBorrow));
 
     return *this;
 }
@@ -315,9 +471,12 @@ base_uint<BITS>& base_uint<BITS>::operator-=(const base_uint<BITS>& b)
 template<uint32_t BITS>
 base_uint<BITS>& base_uint<BITS>::operator-=(uint64_t b64)
 {
-    base_uint<BITS> b;
-    b = b64;
-    *this += -b;
+    uint8_t nBorrow = 0;
+    SetLimb<WIDTH>(pn, 0, SubBorrow(GetLimb<WIDTH>(pn, 0), b64, nBorrow));
+
+    /* Borrow from the higher limbs. */
+    for(uint32_t i = 1; i < LIMBS && nBorrow; ++i)
+        SetLimb<WIDTH>(pn, i, SubBorrow(GetLimb<WIDTH>(pn, i), 0, nBorrow));
 
     return *this;
 }
@@ -327,20 +486,22 @@ base_uint<BITS>& base_uint<BITS>::operator-=(uint64_t b64)
 template<uint32_t BITS>
 base_uint<BITS>& base_uint<BITS>::operator*=(const base_uint<BITS>& b)
 {
-    base_uint<BITS> a;
-    a = 0u;
+    uint64_t a[LIMBS];
+    uint64_t c[LIMBS];
+    GetLimbs<WIDTH>(pn, a);
+    GetLimbs<WIDTH>(b.pn, c);
+
+    uint64_t r[LIMBS] = { };
 
-    for(int j = 0; j < WIDTH; j++)
+    /* Schoolbook multiply, keeping only the limbs that fit. */
+    for(uint32_t j = 0; j < LIMBS; ++j)
     {
-        uint64_t carry = 0;
-        for(int i = 0; i + j < WIDTH; i++)
-        {
-            uint64_t n = carry + a.pn[i + j] + (uint64_t)pn[j] * b.pn[i];
-            a.pn[i + j] = n & 0xffffffff;
-            carry = n >> 32;
-        }
+        uint64_t nCarry = 0;
+        for(uint32_t i = 0; i + j < LIMBS; ++i)
+            r[i + j] = MulAdd(a[j], c[i], r[i + j], nCarry, nCarry);
     }
-    *this = a;
+
+    SetLimbs<WIDTH>(pn, r);
 
     return *this;
 }
@@ -350,23 +511,14 @@ base_uint<BITS>& base_uint<BITS>::operator*=(const base_uint<BITS>& b)
 template<uint32_t BITS>
 base_uint<BITS>& base_uint<BITS>::operator*=(uint64_t n)
 {
-    base_uint<BITS> a;
-    a = 0u;
+    uint64_t a[LIMBS];
+    GetLimbs<WIDTH>(pn, a);
 
-    base_uint<BITS> b;
-    b = n;
+    uint64_t nCarry = 0;
+    for(uint32_t i = 0; i < LIMBS; ++i)
+        a[i] = MulAdd(a[i], n, nCarry, 0, nCarry);
 
-    for(int j = 0; j < WIDTH; j++)
-    {
-        uint64_t carry = 0;
-        for(int i = 0; i + j < WIDTH; i++)
-        {
-            uint64_t n = carry + a.pn[i + j] + (uint64_t)pn[j] * b.pn[i];
-            a.pn[i + j] = n & 0xffffffff;
-            carry = n >> 32;
-        }
-    }
-    *this = a;
+    SetLimbs<WIDTH>(pn, a);
 
     return *this;
 }
@@ -476,15 +628,7 @@ const base_uint<BITS> base_uint<BITS>::operator--(int)
 template<uint32_t BITS>
 bool base_uint<BITS>::operator<(const base_uint<BITS>& n) const
 {
-    for(int8_t i = WIDTH-1; i >= 0; --i)
-    {
-        if(this->pn[i] < n.pn[i])
-            return true;
-        else if(this->pn[i] > n.pn[i])
-            return false;
-    }
-
-    return false;
+    return Compare<WIDTH>(pn, n.pn) < 0;
 }
 
 
@@ -492,15 +636,7 @@ bool base_uint<BITS>::operator<(const base_uint<BITS>& n) const
 template<uint32_t BITS>
 bool base_uint<BITS>::operator<=(const base_uint<BITS>& n) const
 {
-    for(int8_t i = WIDTH-1; i >= 0; --i)
-    {
-        if(this->pn[i] < n.pn[i])
-            return true;
-        else if(this->pn[i] > n.pn[i])
-            return false;
-    }
-
-    return true;
+    return Compare<WIDTH>(pn, n.pn) <= 0;
 }
 
 
@@ -508,15 +644,7 @@ bool base_uint<BITS>::operator<=(const base_uint<BITS>& n) const
 template<uint32_t BITS>
 bool base_uint<BITS>::operator>(const base_uint<BITS>& n) const
 {
-    for(int8_t i = WIDTH-1; i >= 0; --i)
-    {
-        if(this->pn[i] > n.pn[i])
-            return true;
-        else if(this->pn[i] < n.pn[i])
-            return false;
-    }
-
-    return false;
+    return Compare<WIDTH>(pn, n.pn) > 0;
 }
 
 
@@ -524,15 +652,7 @@ bool base_uint<BITS>::operator>(const base_uint<BITS>& n) const
 template<uint32_t BITS>
 bool base_uint<BITS>::operator>=(const base_uint<BITS>& n) const
 {
-    for(int8_t i = WIDTH-1; i >= 0; --i)
-    {
-        if(this->pn[i] > n.pn[i])
-            return true;
-        else if(this->pn[i] < n.pn[i])
-            return false;
-    }
-
-    return true;
+    return Compare<WIDTH>(pn, n.pn) >= 0;
 }
 
 
@@ -540,8 +660,8 @@ bool base_uint<BITS>::operator>=(const base_uint<BITS>& n) const
 template<uint32_t BITS>
 bool base_uint<BITS>::operator==(const base_uint<BITS>& n) const
 {
-    for(uint8_t i = 0; i < WIDTH; ++i)
-        if(this->pn[i] != n.pn[i])
+    for(uint32_t i = 0; i < LIMBS; ++i)
+        if(GetLimb<WIDTH>(pn, i) != GetLimb<WIDTH>(n.pn, i))
             return false;
 
     return true;
@@ -552,13 +672,11 @@ bool base_uint<BITS>::operator==(const base_uint<BITS>& n) const
 template<uint32_t BITS>
 bool base_uint<BITS>::operator==(uint64_t n) const
 {
-    if(this->pn[0] != (uint32_t)n)
-        return false;
-    if(this->pn[1] != (uint32_t)(n >> 32))
+    if(GetLimb<WIDTH>(pn, 0) != n)
         return false;
 
-    for(uint8_t i = 2; i < WIDTH; ++i)
-        if(this->pn[i] != 0)
+    for(uint32_t i = 1; i < LIMBS; ++i)
+        if(GetLimb<WIDTH>(pn, i) != 0)
             return false;
 
     return true;
@@ -796,16 +914,21 @@ uint32_t base_uint<BITS>::high_bits(uint32_t mask)
 template <uint32_t BITS>
 uint32_t base_uint<BITS>::bits() const
 {
-    for(int32_t pos = WIDTH - 1; pos >= 0; --pos)
+    for(int32_t pos = LIMBS - 1; pos >= 0; --pos)
     {
-        if(pn[pos])
+        const uint64_t nLimb = GetLimb<WIDTH>(pn, pos);
+        if(nLimb)
         {
-            for(int32_t nbits = 31; nbits > 0; --nbits)
+        #ifdef __GNUC__
+            return 64 * pos + 64 - __builtin_clzll(nLimb);
+        #else
+            for(int32_t nbits = 63; nbits > 0; --nbits)
             {
-                if(pn[pos] & 1U << nbits)
-                    return 32 * pos + nbits + 1;
+                if(nLimb & (uint64_t(1) << nbits))
+                    return 64 * pos + nbits + 1;
             }
-            return 32 * pos + 1;
+            return 64 * pos + 1;
+        #endif
         }
     }
 
@@ -657,37 +657,15 @@ falcon_verify_start(shake256_context *hash_data,
 	return 0;
 }
 
-/* see falcon.h */
-int
-falcon_verify_finish(const void *sig, size_t sig_len,
-	const void *pubkey, size_t pubkey_len,
-	shake256_context *hash_data,
-	void *tmp, size_t tmp_len)
+/*
+ * Get the format of a signature of degree logn: 1 for the constant-time
+ * format, 0 for the compressed format, or a negative error code.
+ */
+static int
+verify_sig_format(const uint8_t *es, unsigned logn)
 {
-	unsigned logn;
-	uint8_t *atmp;
-	const uint8_t *pk, *es;
 	int ct;
-	size_t u, v, n;
-	uint16_t *h, *hm;
-	int16_t *sv;
 
-	/*
-	 * Get Falcon degree from public key; verify consistency with
-	 * signature value, and check parameters.
-	 */
-	if (sig_len < 41 || pubkey_len == 0) {
-		return FALCON_ERR_FORMAT;
-	}
-	es = sig;
-	pk = pubkey;
-	if ((pk[0] & 0xF0) != 0x00) {
-		return FALCON_ERR_FORMAT;
-	}
-	logn = pk[0] & 0x0F;
-	if (logn < 1 || logn > 10) {
-		return FALCON_ERR_FORMAT;
-	}
 	switch (es[0] & 0xF0) {
 	case 0x30:
 		ct = 0;
@@ -701,28 +679,30 @@ falcon_verify_finish(const void *sig, size_t sig_len,
 	if ((es[0] & 0x0F) != logn) {
 		return FALCON_ERR_BADSIG;
 	}
-	if (pubkey_len != FALCON_PUBKEY_SIZE(logn)) {
-		return FALCON_ERR_FORMAT;
-	}
-	if (tmp_len < FALCON_TMPSIZE_VERIFY(logn)) {
-		return FALCON_ERR_SIZE;
-	}
+	return ct;
+}
+
+/*
+ * Finish a signature verification with the decoded public key h[] (in
+ * NTT and Montgomery representation). The signature header has been
+ * checked, and *hash_data has received the nonce and the message. The
+ * message is hashed to a point in variable time if vartime is non-zero,
+ * otherwise with the method of the signature format. The hm[] buffer
+ * must have room for 3*n values.
+ */
+static int
+verify_decoded_finish(const uint8_t *es, size_t sig_len, int ct,
+	const uint16_t *h, unsigned logn, shake256_context *hash_data,
+	int vartime, uint16_t *hm)
+{
+	uint8_t *atmp;
+	size_t u, v, n;
+	int16_t *sv;
 
 	n = (size_t)1 << logn;
-	h = (uint16_t *)align_u16(tmp);
-	hm = h + n;
 	sv = (int16_t *)(hm + n);
 	atmp = (uint8_t *)(sv + n);
 
-	/*
-	 * Decode public key.
-	 */
-	if (Zf(modq_decode)(h, logn, pk + 1, pubkey_len - 1)
-		!= pubkey_len - 1)
-	{
-		return FALCON_ERR_FORMAT;
-	}
-
 	/*
 	 * Decode signature value.
 	 */
@@ -741,7 +721,7 @@ falcon_verify_finish(const void *sig, size_t sig_len,
 	 * Hash message to point.
 	 */
 	shake256_flip(hash_data);
-	if (ct) {
+	if (ct && !vartime) {
 		Zf(hash_to_point_ct)(
 			(inner_shake256_context *)hash_data, hm, logn, atmp);
 	} else {
@@ -752,13 +732,69 @@ falcon_verify_finish(const void *sig, size_t sig_len,
 	/*
 	 * Verify signature.
 	 */
-	Zf(to_ntt_monty)(h, logn);
 	if (!Zf(verify_raw)(hm, sv, h, logn, atmp)) {
 		return FALCON_ERR_BADSIG;
 	}
 	return 0;
 }
 
+/* see falcon.h */
+int
+falcon_verify_finish(const void *sig, size_t sig_len,
+	const void *pubkey, size_t pubkey_len,
+	shake256_context *hash_data,
+	void *tmp, size_t tmp_len)
+{
+	unsigned logn;
+	const uint8_t *pk, *es;
+	int ct;
+	size_t n;
+	uint16_t *h;
+
+	/*
+	 * Get Falcon degree from public key; verify consistency with
+	 * signature value, and check parameters.
+	 */
+	if (sig_len < 41 || pubkey_len == 0) {
+		return FALCON_ERR_FORMAT;
+	}
+	es = sig;
+	pk = pubkey;
+	if ((pk[0] & 0xF0) != 0x00) {
+		return FALCON_ERR_FORMAT;
+	}
+	logn = pk[0] & 0x0F;
+	if (logn < 1 || logn > 10) {
+		return FALCON_ERR_FORMAT;
+	}
+	ct = verify_sig_format(es, logn);
+	if (ct < 0) {
+		return ct;
+	}
+	if (pubkey_len != FALCON_PUBKEY_SIZE(logn)) {
+		return FALCON_ERR_FORMAT;
+	}
+	if (tmp_len < FALCON_TMPSIZE_VERIFY(logn)) {
+		return FALCON_ERR_SIZE;
+	}
+
+	n = (size_t)1 << logn;
+	h = (uint16_t *)align_u16(tmp);
+
+	/*
+	 * Decode public key.
+	 */
+	if (Zf(modq_decode)(h, logn, pk + 1, pubkey_len - 1)
+		!= pubkey_len - 1)
+	{
+		return FALCON_ERR_FORMAT;
+	}
+	Zf(to_ntt_monty)(h, logn);
+
+	return verify_decoded_finish(es, sig_len, ct,
+		h, logn, hash_data, 0, h + n);
+}
+
 /* see falcon.h */
 int
 falcon_verify(const void *sig, size_t sig_len,
@@ -777,3 +813,102 @@ falcon_verify(const void *sig, size_t sig_len,
 	return falcon_verify_finish(sig, sig_len,
 		pubkey, pubkey_len, &hd, tmp, tmp_len);
 }
+
+/* see falcon.h */
+int
+falcon_decode_pubkey(void *decoded, size_t decoded_len,
+	const void *pubkey, size_t pubkey_len)
+{
+	unsigned logn;
+	const uint8_t *pk;
+	uint8_t *dk;
+	uint16_t *h;
+
+	if (pubkey_len == 0) {
+		return FALCON_ERR_FORMAT;
+	}
+	pk = pubkey;
+	if ((pk[0] & 0xF0) != 0x00) {
+		return FALCON_ERR_FORMAT;
+	}
+	logn = pk[0] & 0x0F;
+	if (logn < 1 || logn > 10) {
+		return FALCON_ERR_FORMAT;
+	}
+	if (pubkey_len != FALCON_PUBKEY_SIZE(logn)) {
+		return FALCON_ERR_FORMAT;
+	}
+	if (decoded_len < FALCON_DECODED_PUBKEY_SIZE(logn)) {
+		return FALCON_ERR_SIZE;
+	}
+	if (((uintptr_t)decoded & 1u) != 0) {
+		return FALCON_ERR_BADARG;
+	}
+
+	/*
+	 * The degree comes first, then the key in NTT and Montgomery
+	 * representation.
+	 */
+	dk = decoded;
+	dk[0] = (uint8_t)logn;
+	dk[1] = 0;
+	h = (uint16_t *)(dk + 2);
+	if (Zf(modq_decode)(h, logn, pk + 1, pubkey_len - 1)
+		!= pubkey_len - 1)
+	{
+		return FALCON_ERR_FORMAT;
+	}
+	Zf(to_ntt_monty)(h, logn);
+	return 0;
+}
+
+/* see falcon.h */
+int
+falcon_verify_decoded(const void *sig, size_t sig_len,
+	const void *decoded, size_t decoded_len,
+	const void *data, size_t data_len,
+	void *tmp, size_t tmp_len)
+{
+	shake256_context hd;
+	unsigned logn;
+	const uint8_t *dk;
+	int ct, r;
+
+	if (sig_len < 41 || decoded_len < 2) {
+		return FALCON_ERR_FORMAT;
+	}
+	dk = decoded;
+	logn = dk[0];
+	if (logn < 1 || logn > 10 || dk[1] != 0) {
+		return FALCON_ERR_FORMAT;
+	}
+	if (decoded_len < FALCON_DECODED_PUBKEY_SIZE(logn)) {
+		return FALCON_ERR_FORMAT;
+	}
+	if (((uintptr_t)decoded & 1u) != 0) {
+		return FALCON_ERR_BADARG;
+	}
+	ct = verify_sig_format(sig, logn);
+	if (ct < 0) {
+		return ct;
+	}
+	if (tmp_len < FALCON_TMPSIZE_VERIFY(logn)) {
+		return FALCON_ERR_SIZE;
+	}
+
+	r = falcon_verify_start(&hd, sig, sig_len);
+	if (r < 0) {
+		return r;
+	}
+	shake256_inject(&hd, data, data_len);
+	return verify_decoded_finish(sig, sig_len, ct,
+		(const uint16_t *)(dk + 2), logn, &hd, 1,
+		(uint16_t *)align_u16(tmp));
+}
+
+/* see falcon.h */
+int
+falcon_verify_avx2(int enable)
+{
+	return Zf(vrfy_avx2)(enable);
+}
@@ -335,6 +335,12 @@ extern "C" {
 #define FALCON_TMPSIZE_VERIFY(logn) \
 	((8u << (logn)) + 1)
 
+/*
+ * Size of a decoded public key (see falcon_decode_pubkey()).
+ */
+#define FALCON_DECODED_PUBKEY_SIZE(logn) \
+	((2u << (logn)) + 2)
+
 /* ==================================================================== */
 /*
  * SHAKE256.
@@ -725,6 +731,54 @@ int falcon_verify_finish(const void *sig, size_t sig_len,
 	shake256_context *hash_data,
 	void *tmp, size_t tmp_len);
 
+/*
+ * Decode the public key pubkey[] (of length pubkey_len bytes) into
+ * decoded[] (of length decoded_len bytes), in the form used by the
+ * verification itself. A decoded key can verify any number of
+ * signatures with falcon_verify_decoded(), without decoding the public
+ * key again for each of them.
+ *
+ * The decoded[] buffer MUST be suitably aligned for 16-bit access, and
+ * its size MUST be at least FALCON_DECODED_PUBKEY_SIZE(logn) bytes. It
+ * contains no pointers and can be copied to another such buffer.
+ *
+ * Returned value: 0 on success, or a negative error code.
+ */
+int falcon_decode_pubkey(void *decoded, size_t decoded_len,
+	const void *pubkey, size_t pubkey_len);
+
+/*
+ * Verify the signature sig[] (of length sig_len bytes) with regards to
+ * the public key decoded by falcon_decode_pubkey() into decoded[] (of
+ * length decoded_len bytes) and the message data[] (of length data_len
+ * bytes).
+ *
+ * The message is hashed to a point with the variable-time method for
+ * both signature formats, which is faster and gives the same point; it
+ * only leaks timing information about the message, which is public when
+ * verifying. Use falcon_verify() for secret messages.
+ *
+ * The tmp[] buffer is used to hold temporary values. Its size tmp_len
+ * MUST be at least FALCON_TMPSIZE_VERIFY(logn) bytes.
+ *
+ * Returned value: 0 on success, or a negative error code.
+ */
+int falcon_verify_decoded(const void *sig, size_t sig_len,
+	const void *decoded, size_t decoded_len,
+	const void *data, size_t data_len,
+	void *tmp, size_t tmp_len);
+
+/*
+ * Allow (enable != 0, the default) or forbid (enable == 0) the use of
+ * AVX2 opcodes in signature verification. They are used only if the
+ * CPU supports them, which is checked at runtime; the results are the
+ * same either way. This setting is global and is not meant to change
+ * while signatures are verified.
+ *
+ * Returned value: 1 if verification now uses AVX2 opcodes, 0 otherwise.
+ */
+int falcon_verify_avx2(int enable);
+
 /* ==================================================================== */
 
 #ifdef __cplusplus
@@ -578,6 +578,12 @@ int Zf(is_short_half)(uint32_t sqn, const int16_t *s2, unsigned logn);
  */
 void Zf(to_ntt_monty)(uint16_t *h, unsigned logn);
 
+/*
+ * Allow or forbid the use of AVX2 opcodes in the NTT of verification,
+ * when the CPU supports them. Returned value is 1 if they are now used.
+ */
+int Zf(vrfy_avx2)(int enable);
+
 /*
  * Internal signature verification code:
  *   c0[]      contains the hashed nonce+message
@@ -498,6 +498,399 @@ mq_div_12289(uint32_t x, uint32_t y)
 	return mq_montymul(y18, x);
 }
 
+/* ===================================================================== */
+/*
+ * AVX2 implementation of the NTT and of the pointwise operations. It is
+ * compiled with GCC-compatible compilers on x86, and used only when the
+ * CPU supports AVX2, which is checked at runtime. Each 256-bit register
+ * holds 16 values modulo q; results are identical to the portable code.
+ */
+
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+#define FALCON_VRFY_AVX2   1
+#else
+#define FALCON_VRFY_AVX2   0
+#endif
+
+/*
+ * Set to 0 to use the portable code even when the CPU supports AVX2.
+ */
+static int mq_avx2_enabled = 1;
+
+#if FALCON_VRFY_AVX2
+
+#include <immintrin.h>
+
+#define TARGET_VRFY_AVX2   __attribute__((target("avx2")))
+
+/*
+ * Check whether the AVX2 code can be used.
+ */
+static inline int
+mq_avx2(void)
+{
+	return mq_avx2_enabled && __builtin_cpu_supports("avx2");
+}
+
+/*
+ * Montgomery multiplication of 16 values modulo q (see mq_montymul()).
+ * The high half of x*y + k*q is computed with 16-bit multiplications;
+ * its low half is zero, which carries into the high half exactly when
+ * the low half of x*y is not zero.
+ */
+TARGET_VRFY_AVX2
+static inline __m256i
+mq_montymul_x16(__m256i x, __m256i y)
+{
+	__m256i lo, hi, k, z;
+
+	lo = _mm256_mullo_epi16(x, y);
+	hi = _mm256_mulhi_epu16(x, y);
+	k = _mm256_mullo_epi16(lo, _mm256_set1_epi16(Q0I));
+	z = _mm256_add_epi16(hi,
+		_mm256_mulhi_epu16(k, _mm256_set1_epi16(Q)));
+	z = _mm256_add_epi16(z,
+		_mm256_min_epu16(lo, _mm256_set1_epi16(1)));
+
+	/*
+	 * The value is lower than 2q; if it is lower than q, then the
+	 * subtraction wraps around and the minimum keeps the value.
+	 */
+	return _mm256_min_epu16(z, _mm256_sub_epi16(z, _mm256_set1_epi16(Q)));
+}
+
+/*
+ * Addition of 16 values modulo q (see mq_add()).
+ */
+TARGET_VRFY_AVX2
+static inline __m256i
+mq_add_x16(__m256i x, __m256i y)
+{
+	__m256i d;
+
+	d = _mm256_add_epi16(x, y);
+	return _mm256_min_epu16(d, _mm256_sub_epi16(d, _mm256_set1_epi16(Q)));
+}
+
+/*
+ * Subtraction of 16 values modulo q (see mq_sub()).
+ */
+TARGET_VRFY_AVX2
+static inline __m256i
+mq_sub_x16(__m256i x, __m256i y)
+{
+	__m256i d;
+
+	d = _mm256_sub_epi16(x, y);
+	return _mm256_min_epu16(d, _mm256_add_epi16(d, _mm256_set1_epi16(Q)));
+}
+
+/*
+ * Butterflies closer than 16 values apart are computed 16 at a time on
+ * 32 consecutive values x:y, split into the first halves u and second
+ * halves v of the butterflies. For a half-distance of 8, u and v are
+ * the 128-bit lanes; below that, they are 64-bit words of the lanes,
+ * after the values of each lane are sorted by a shuffle (for half-
+ * distances 2 and 1). The lanes of u hold the butterflies in the order:
+ *
+ *   ht = 8:  lane 0 = b0        lane 1 = b1
+ *   ht = 4:  lane 0 = b0 b2     lane 1 = b1 b3
+ *   ht = 2:  lane 0 = b0 b1 b4 b5     lane 1 = b2 b3 b6 b7
+ *   ht = 1:  lane 0 = b0..b3 b8..b11  lane 1 = b4..b7 b12..b15
+ *
+ * Word indices for the shuffles, per lane: sorting of the values for
+ * ht = 2 (its own inverse) and ht = 1 (and its inverse), and expansion
+ * of the twiddle factors of the butterflies, by log2(ht).
+ */
+static const uint8_t mq_sort2_x16[] = {
+	0, 1, 4, 5, 2, 3, 6, 7,   0, 1, 4, 5, 2, 3, 6, 7
+};
+
+static const uint8_t mq_sort1_x16[] = {
+	0, 2, 4, 6, 1, 3, 5, 7,   0, 2, 4, 6, 1, 3, 5, 7
+};
+
+static const uint8_t mq_unsort1_x16[] = {
+	0, 4, 1, 5, 2, 6, 3, 7,   0, 4, 1, 5, 2, 6, 3, 7
+};
+
+static const uint8_t mq_twiddle_x16[4][16] = {
+	/* ht = 1 loads the factors in order, see mq_twiddles_x16() */
+	{ 0, 0, 0, 0, 0, 0, 0, 0,   0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 0, 1, 1, 4, 4, 5, 5,   2, 2, 3, 3, 6, 6, 7, 7 },
+	{ 0, 0, 0, 0, 2, 2, 2, 2,   1, 1, 1, 1, 3, 3, 3, 3 },
+	{ 0, 0, 0, 0, 0, 0, 0, 0,   1, 1, 1, 1, 1, 1, 1, 1 }
+};
+
+/*
+ * Convert 16 word indices (per 128-bit lane) into a byte shuffle mask.
+ */
+TARGET_VRFY_AVX2
+static inline __m256i
+mq_wordmask_x16(const uint8_t *w)
+{
+	__m256i x;
+
+	x = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)w));
+	x = _mm256_mullo_epi16(x, _mm256_set1_epi16(0x0202));
+	return _mm256_add_epi16(x, _mm256_set1_epi16(0x0100));
+}
+
+/*
+ * Shuffle masks for a stage with butterflies ht values apart (ht < 16).
+ */
+typedef struct {
+	__m256i sort, unsort, twiddle;
+} mq_masks_x16;
+
+TARGET_VRFY_AVX2
+static inline void
+mq_masks_init_x16(mq_masks_x16 *mm, size_t ht)
+{
+	unsigned lht;
+
+	lht = (ht >= 8) ? 3 : (ht >= 4) ? 2 : (ht >= 2) ? 1 : 0;
+	mm->sort = mq_wordmask_x16(ht == 1 ? mq_sort1_x16 : mq_sort2_x16);
+	mm->unsort = mq_wordmask_x16(ht == 1 ? mq_unsort1_x16 : mq_sort2_x16);
+	mm->twiddle = mq_wordmask_x16(mq_twiddle_x16[lht]);
+}
+
+/*
+ * Split 32 values x:y into the halves u:v of their butterflies.
+ */
+TARGET_VRFY_AVX2
+static inline void
+mq_split_x16(__m256i *x, __m256i *y, size_t ht, const mq_masks_x16 *mm)
+{
+	__m256i u, v;
+
+	if (ht == 8) {
+		u = _mm256_permute2x128_si256(*x, *y, 0x20);
+		v = _mm256_permute2x128_si256(*x, *y, 0x31);
+	} else {
+		if (ht < 4) {
+			*x = _mm256_shuffle_epi8(*x, mm->sort);
+			*y = _mm256_shuffle_epi8(*y, mm->sort);
+		}
+		u = _mm256_unpacklo_epi64(*x, *y);
+		v = _mm256_unpackhi_epi64(*x, *y);
+	}
+	*x = u;
+	*y = v;
+}
+
+/*
+ * Merge the halves u:v of butterflies back into 32 values x:y.
+ */
+TARGET_VRFY_AVX2
+static inline void
+mq_merge_x16(__m256i *u, __m256i *v, size_t ht, const mq_masks_x16 *mm)
+{
+	__m256i x, y;
+
+	if (ht == 8) {
+		x = _mm256_permute2x128_si256(*u, *v, 0x20);
+		y = _mm256_permute2x128_si256(*u, *v, 0x31);
+	} else {
+		x = _mm256_unpacklo_epi64(*u, *v);
+		y = _mm256_unpackhi_epi64(*u, *v);
+		if (ht < 4) {
+			x = _mm256_shuffle_epi8(x, mm->unsort);
+			y = _mm256_shuffle_epi8(y, mm->unsort);
+		}
+	}
+	*u = x;
+	*v = y;
+}
+
+/*
+ * Get the twiddle factors of the 16 / ht butterflies of 32 values, in
+ * the order of mq_split_x16(). The table is read 8 values at a time,
+ * which stays within it for all stages with ht < 16.
+ */
+TARGET_VRFY_AVX2
+static inline __m256i
+mq_twiddles_x16(const uint16_t *s, size_t ht, const mq_masks_x16 *mm)
+{
+	if (ht == 1) {
+		return _mm256_permute4x64_epi64(
+			_mm256_loadu_si256((const __m256i *)s), 0xD8);
+	}
+	return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(
+		_mm_loadu_si128((const __m128i *)s)), mm->twiddle);
+}
+
+/*
+ * NTT on a ring element (see mq_NTT()); logn must be at least 5.
+ */
+TARGET_VRFY_AVX2
+static void
+mq_NTT_avx2(uint16_t *a, unsigned logn)
+{
+	size_t n, t, m;
+
+	n = (size_t)1 << logn;
+	t = n;
+	for (m = 1; m < n; m <<= 1) {
+		size_t ht, i, j, j1;
+
+		ht = t >> 1;
+		if (ht >= 16) {
+			for (i = 0, j1 = 0; i < m; i ++, j1 += t) {
+				__m256i s;
+
+				s = _mm256_set1_epi16((short)GMb[m + i]);
+				for (j = j1; j < j1 + ht; j += 16) {
+					__m256i u, v;
+
+					u = _mm256_loadu_si256((__m256i *)(a + j));
+					v = _mm256_loadu_si256((__m256i *)(a + j + ht));
+					v = mq_montymul_x16(v, s);
+					_mm256_storeu_si256((__m256i *)(a + j),
+						mq_add_x16(u, v));
+					_mm256_storeu_si256((__m256i *)(a + j + ht),
+						mq_sub_x16(u, v));
+				}
+			}
+		} else {
+			mq_masks_x16 mm;
+
+			mq_masks_init_x16(&mm, ht);
+			for (i = 0, j = 0; j < n; i += 16 / ht, j += 32) {
+				__m256i u, v, w;
+
+				u = _mm256_loadu_si256((__m256i *)(a + j));
+				v = _mm256_loadu_si256((__m256i *)(a + j + 16));
+				mq_split_x16(&u, &v, ht, &mm);
+				v = mq_montymul_x16(v,
+					mq_twiddles_x16(&GMb[m + i], ht, &mm));
+				w = mq_sub_x16(u, v);
+				u = mq_add_x16(u, v);
+				mq_merge_x16(&u, &w, ht, &mm);
+				_mm256_storeu_si256((__m256i *)(a + j), u);
+				_mm256_storeu_si256((__m256i *)(a + j + 16), w);
+			}
+		}
+		t = ht;
+	}
+}
+
+/*
+ * Inverse NTT on a ring element (see mq_iNTT()), without the final
+ * division by n; logn must be at least 5.
+ */
+TARGET_VRFY_AVX2
+static void
+mq_iNTT_avx2(uint16_t *a, unsigned logn)
+{
+	size_t n, t, m;
+
+	n = (size_t)1 << logn;
+	t = 1;
+	m = n;
+	while (m > 1) {
+		size_t hm, dt, i, j, j1;
+
+		hm = m >> 1;
+		dt = t << 1;
+		if (t >= 16) {
+			for (i = 0, j1 = 0; i < hm; i ++, j1 += dt) {
+				__m256i s;
+
+				s = _mm256_set1_epi16((short)iGMb[hm + i]);
+				for (j = j1; j < j1 + t; j += 16) {
+					__m256i u, v;
+
+					u = _mm256_loadu_si256((__m256i *)(a + j));
+					v = _mm256_loadu_si256((__m256i *)(a + j + t));
+					_mm256_storeu_si256((__m256i *)(a + j),
+						mq_add_x16(u, v));
+					_mm256_storeu_si256((__m256i *)(a + j + t),
+						mq_montymul_x16(mq_sub_x16(u, v), s));
+				}
+			}
+		} else {
+			mq_masks_x16 mm;
+
+			mq_masks_init_x16(&mm, t);
+			for (i = 0, j = 0; j < n; i += 16 / t, j += 32) {
+				__m256i u, v, w;
+
+				u = _mm256_loadu_si256((__m256i *)(a + j));
+				v = _mm256_loadu_si256((__m256i *)(a + j + 16));
+				mq_split_x16(&u, &v, t, &mm);
+				w = mq_montymul_x16(mq_sub_x16(u, v),
+					mq_twiddles_x16(&iGMb[hm + i], t, &mm));
+				u = mq_add_x16(u, v);
+				mq_merge_x16(&u, &w, t, &mm);
+				_mm256_storeu_si256((__m256i *)(a + j), u);
+				_mm256_storeu_si256((__m256i *)(a + j + 16), w);
+			}
+		}
+		t = dt;
+		m = hm;
+	}
+}
+
+/*
+ * Montgomery multiplication of two polynomials, value by value (see
+ * mq_poly_montymul_ntt()); logn must be at least 4.
+ */
+TARGET_VRFY_AVX2
+static void
+mq_poly_montymul_ntt_avx2(uint16_t *f, const uint16_t *g, unsigned logn)
+{
+	size_t u, n;
+
+	n = (size_t)1 << logn;
+	for (u = 0; u < n; u += 16) {
+		__m256i x, y;
+
+		x = _mm256_loadu_si256((__m256i *)(f + u));
+		y = _mm256_loadu_si256((const __m256i *)(g + u));
+		_mm256_storeu_si256((__m256i *)(f + u), mq_montymul_x16(x, y));
+	}
+}
+
+/*
+ * Montgomery multiplication of a polynomial by a constant c (lower
+ * than q); logn must be at least 4.
+ */
+TARGET_VRFY_AVX2
+static void
+mq_poly_montymul_const_avx2(uint16_t *f, uint32_t c, unsigned logn)
+{
+	size_t u, n;
+	__m256i y;
+
+	n = (size_t)1 << logn;
+	y = _mm256_set1_epi16((short)c);
+	for (u = 0; u < n; u += 16) {
+		__m256i x;
+
+		x = _mm256_loadu_si256((__m256i *)(f + u));
+		_mm256_storeu_si256((__m256i *)(f + u), mq_montymul_x16(x, y));
+	}
+}
+
+#else
+
+static inline int
+mq_avx2(void)
+{
+	return 0;
+}
+
+#endif
+
+/* see inner.h */
+int
+Zf(vrfy_avx2)(int enable)
+{
+	mq_avx2_enabled = (enable != 0);
+	return mq_avx2();
+}
+
 /*
  * Compute NTT on a ring element.
  */
@@ -506,6 +899,12 @@ mq_NTT(uint16_t *a, unsigned logn)
 {
 	size_t n, t, m;
 
+#if FALCON_VRFY_AVX2
+	if (logn >= 5 && mq_avx2()) {
+		mq_NTT_avx2(a, logn);
+		return;
+	}
+#endif
 	n = (size_t)1 << logn;
 	t = n;
 	for (m = 1; m < n; m <<= 1) {
@@ -541,6 +940,17 @@ mq_iNTT(uint16_t *a, unsigned logn)
 	uint32_t ni;
 
 	n = (size_t)1 << logn;
+#if FALCON_VRFY_AVX2
+	if (logn >= 5 && mq_avx2()) {
+		mq_iNTT_avx2(a, logn);
+		ni = R;
+		for (m = n; m > 1; m >>= 1) {
+			ni = mq_rshift1(ni);
+		}
+		mq_poly_montymul_const_avx2(a, ni, logn);
+		return;
+	}
+#endif
 	t = 1;
 	m = n;
 	while (m > 1) {
@@ -595,6 +1005,12 @@ mq_poly_tomonty(uint16_t *f, unsigned logn)
 {
 	size_t u, n;
 
+#if FALCON_VRFY_AVX2
+	if (logn >= 4 && mq_avx2()) {
+		mq_poly_montymul_const_avx2(f, R2, logn);
+		return;
+	}
+#endif
 	n = (size_t)1 << logn;
 	for (u = 0; u < n; u ++) {
 		f[u] = (uint16_t)mq_montymul(f[u], R2);
@@ -610,6 +1026,12 @@ mq_poly_montymul_ntt(uint16_t *f, const uint16_t *g, unsigned logn)
 {
 	size_t u, n;
 
+#if FALCON_VRFY_AVX2
+	if (logn >= 4 && mq_avx2()) {
+		mq_poly_montymul_ntt_avx2(f, g, logn);
+		return;
+	}
+#endif
 	n = (size_t)1 << logn;
 	for (u = 0; u < n; u ++) {
 		f[u] = (uint16_t)mq_montymul(f[u], g[u]);
@@ -0,0 +1,91 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/flcache.h>
+#include <LLC/hash/SK.h>
+
+#include <LLC/falcon/falcon.h>
+
+#include <Util/include/args.h>
+
+namespace LLC
+{
+    FLKeyCache flcache;
+
+
+    /* Default Constructor. */
+    FLKeyCache::FLKeyCache()
+    : cacheKeys ( )
+    , nHits     (0)
+    , nMisses   (0)
+    {
+    }
+
+
+    /* Get a decoded public key, decoding and adding it if it isn't cached. */
+    bool FLKeyCache::Get(const std::vector<uint8_t>& vchPubKey, std::vector<uint8_t>& vchDecoded)
+    {
+        /* The bound over all shards, read on first use. */
+        static const uint32_t nMax = static_cast<uint32_t>(config::GetArg("-flkeycache", 1024));
+
+        if(vchPubKey.empty())
+            return false;
+
+        /* Only use an entry for the same encoded key, a colliding fingerprint decodes its own. */
+        const uint128_t hashKey = SKFingerprint(&vchPubKey[0], vchPubKey.size());
+
+        std::shared_ptr<const Entry> pentry;
+        if(cacheKeys.get(hashKey, pentry) && pentry->vchPubKey == vchPubKey)
+        {
+            vchDecoded.assign(pentry->vchDecoded.begin(), pentry->vchDecoded.end());
+            ++nHits;
+
+            return true;
+        }
+        ++nMisses;
+
+        /* Only FALCON-512 keys verify, so keys of a higher degree are rejected before decoding. */
+        if((vchPubKey[0] & 0x0F) > 9)
+            return false;
+
+        /* Decode outside the lock, invalid keys are not cached. */
+        vchDecoded.resize(FALCON_DECODED_PUBKEY_SIZE(9));
+        if(falcon_decode_pubkey(&vchDecoded[0], vchDecoded.size(), &vchPubKey[0], vchPubKey.size()) != 0)
+            return false;
+
+        vchDecoded.resize(FALCON_DECODED_PUBKEY_SIZE(vchDecoded[0]));
+
+        /* Another thread may have decoded the same key, or a colliding one that stays cached. */
+        std::shared_ptr<Entry> pnew = std::make_shared<Entry>();
+        pnew->vchPubKey  = vchPubKey;
+        pnew->vchDecoded = vchDecoded;
+
+        cacheKeys.put(hashKey, pnew, nMax);
+
+        return true;
+    }
+
+
+    /* Get the number of lookups that found a decoded key. */
+    uint64_t FLKeyCache::Hits() const
+    {
+        return nHits.load();
+    }
+
+
+    /* Get the number of lookups that decoded the key. */
+    uint64_t FLKeyCache::Misses() const
+    {
+        return nMisses.load();
+    }
+}
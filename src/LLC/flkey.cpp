@@ -18,9 +18,56 @@ ________________________________________________________________________________
 #include <LLC/types/typedef.h>
 
 #include <LLC/include/flkey.h>
+#include <LLC/include/flcache.h>
 
 namespace LLC
 {
+    /** VerifyScratch
+     *
+     *  Memory for verifying signatures, kept by each thread so verifying doesn't allocate.
+     *
+     **/
+    struct VerifyScratch
+    {
+        /** The decoded public key. **/
+        std::vector<uint8_t> vchDecoded;
+
+
+        /** Temp memory for FALCON-512, the only degree that verifies. **/
+        std::vector<uint8_t> vchTemp;
+
+
+        /** Default Constructor. **/
+        VerifyScratch()
+        : vchDecoded (FALCON_DECODED_PUBKEY_SIZE(9), 0)
+        , vchTemp    (FALCON_TMPSIZE_VERIFY(9), 0)
+        {
+        }
+    };
+
+
+    /* Get the verification memory of this thread. */
+    VerifyScratch& GetVerifyScratch()
+    {
+        static thread_local VerifyScratch scratch;
+        return scratch;
+    }
+
+
+    /* Verify a signature with a decoded public key. */
+    bool VerifyDecoded(const std::vector<uint8_t>& vchData, const std::vector<uint8_t>& vchSig, VerifyScratch& scratch)
+    {
+        if(vchSig.empty())
+            return false;
+
+        /* Keys of a higher degree never verified with FALCON_TMPSIZE_VERIFY(9), so keep rejecting them. */
+        if(scratch.vchDecoded.empty() || scratch.vchDecoded[0] > 9)
+            return false;
+
+        return falcon_verify_decoded(&vchSig[0], vchSig.size(), &scratch.vchDecoded[0], scratch.vchDecoded.size(),
+            vchData.data(), vchData.size(), &scratch.vchTemp[0], scratch.vchTemp.size()) == 0;
+    }
+
     /* The default constructor. */
     FLKey::FLKey()
     : vchPubKey   ( )
@@ -226,13 +273,37 @@ namespace LLC
         if(!fSet || vchPubKey.empty())
             return false;
 
-        /* Create temp memory. */
-        std::vector<uint8_t> vchTemp(FALCON_TMPSIZE_VERIFY(9), 0);
-
-        /* Verify the signed message. */
-        if(falcon_verify(&vchSig[0], vchSig.size(), &vchPubKey[0], vchPubKey.size(), &vchData[0], vchData.size(), &vchTemp[0], vchTemp.size()))
+        /* Get the decoded public key, decoding it only the first time it is seen. */
+        VerifyScratch& scratch = GetVerifyScratch();
+        if(!flcache.Get(vchPubKey, scratch.vchDecoded))
             return false;
 
+        return VerifyDecoded(vchData, vchSig, scratch);
+    }
+
+
+    /* Verify a batch of signatures. */
+    bool FLKey::VerifyMany(const std::vector<FLSignature>& vSignatures)
+    {
+        VerifyScratch& scratch = GetVerifyScratch();
+
+        /* The signature whose public key is decoded in the scratch memory. */
+        const FLSignature* pDecoded = nullptr;
+        for(const auto& signature : vSignatures)
+        {
+            /* Decode the public key when it changes. */
+            if(!pDecoded || (&pDecoded->vchPubKey != &signature.vchPubKey && pDecoded->vchPubKey != signature.vchPubKey))
+            {
+                if(!flcache.Get(signature.vchPubKey, scratch.vchDecoded))
+                    return false;
+
+                pDecoded = &signature;
+            }
+
+            if(!VerifyDecoded(signature.vchData, signature.vchSig, scratch))
+                return false;
+        }
+
         return true;
     }
 
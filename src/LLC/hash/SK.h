@@ -19,19 +19,162 @@ ________________________________________________________________________________
 #include <LLC/hash/SK/skein.h>
 #include <LLC/hash/SK/KeccakHash.h>
 
-#include <LLD/cache/template_lru.h>
-
 /** Namespace LLC (Lower Level Crypto) **/
 namespace LLC
 {
 
 	static uint8_t pblank[1];
 
-	/* LRU cache of hashed values  */
-	extern LLD::TemplateLRU<std::vector<uint8_t>, uint64_t> cache64;
-	extern LLD::TemplateLRU<std::vector<uint8_t>, uint256_t> cache256;
-	extern LLD::TemplateLRU<std::vector<uint8_t>, uint512_t> cache512;
-	extern LLD::TemplateLRU<std::vector<uint8_t>, uint1024_t> cache1024;
+	/** The largest input in bytes kept in the memo, larger inputs are cheaper to hash again. **/
+	const uint64_t SK_MEMO_MAX = 1024;
+
+
+	/** SKFingerprint
+	 *
+	 *  Get the key of an input in the memo. This is a 128-bit XXH3 with a seed
+	 *  chosen at random on startup, so inputs can't be crafted to collide.
+	 *
+	 *  @param[in] pdata The input to fingerprint.
+	 *  @param[in] nSize The size of the input in bytes.
+	 *
+	 *  @return The fingerprint of the input.
+	 *
+	 **/
+	uint128_t SKFingerprint(const uint8_t* pdata, const uint64_t nSize);
+
+
+	/** SKMemo
+	 *
+	 *  Set associative memo of recent hashes, keyed by fingerprint and size. Each
+	 *  thread has its own, so lookups take no locks and copy no input.
+	 *
+	 **/
+	template<typename HashType>
+	class SKMemo
+	{
+		/** The number of sets. **/
+		static const uint32_t SETS = 16;
+
+
+		/** The number of slots in each set. **/
+		static const uint32_t WAYS = 4;
+
+
+		/** Slot
+		 *
+		 *  A memoized hash with the key of its input.
+		 *
+		 **/
+		struct Slot
+		{
+			/** The fingerprint of the input. **/
+			uint128_t hashFingerprint;
+
+
+			/** The size of the input in bytes. **/
+			uint64_t nSize;
+
+
+			/** The hash of the input. **/
+			HashType hash;
+
+
+			/** Flag for a slot that was written. **/
+			bool fValid;
+
+
+			/** Default Constructor. **/
+			Slot()
+			: hashFingerprint (0)
+			, nSize           (0)
+			, hash            (0)
+			, fValid          (false)
+			{
+			}
+		};
+
+
+		/** The slots of the memo by set. **/
+		Slot vSlots[SETS][WAYS];
+
+
+		/** The next slot to replace in each set. **/
+		uint8_t vNext[SETS];
+
+
+	public:
+
+		/** Default Constructor. **/
+		SKMemo()
+		: vSlots ( )
+		, vNext  ( )
+		{
+		}
+
+
+		/** Get
+		 *
+		 *  Get the memoized hash of an input.
+		 *
+		 *  @param[in] hashFingerprint The fingerprint of the input.
+		 *  @param[in] nSize The size of the input in bytes.
+		 *  @param[out] hash The memoized hash.
+		 *
+		 *  @return true if the input was found.
+		 *
+		 **/
+		bool Get(const uint128_t& hashFingerprint, const uint64_t nSize, HashType& hash) const
+		{
+			const Slot* pset = vSlots[hashFingerprint.Get64() % SETS];
+			for(uint32_t n = 0; n < WAYS; ++n)
+			{
+				const Slot& slot = pset[n];
+				if(slot.fValid && slot.nSize == nSize && slot.hashFingerprint == hashFingerprint)
+				{
+					hash = slot.hash;
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+
+		/** Put
+		 *
+		 *  Memoize the hash of an input, replacing the oldest input in its set.
+		 *
+		 *  @param[in] hashFingerprint The fingerprint of the input.
+		 *  @param[in] nSize The size of the input in bytes.
+		 *  @param[in] hash The hash of the input.
+		 *
+		 **/
+		void Put(const uint128_t& hashFingerprint, const uint64_t nSize, const HashType& hash)
+		{
+			const uint32_t nSet = hashFingerprint.Get64() % SETS;
+
+			Slot& slot = vSlots[nSet][vNext[nSet]];
+			vNext[nSet] = (vNext[nSet] + 1) % WAYS;
+
+			slot.hashFingerprint = hashFingerprint;
+			slot.nSize           = nSize;
+			slot.hash            = hash;
+			slot.fValid          = true;
+		}
+	};
+
+
+	/** SKMemoLocal
+	 *
+	 *  Get the memo of the calling thread for a hash type.
+	 *
+	 **/
+	template<typename HashType>
+	inline SKMemo<HashType>& SKMemoLocal()
+	{
+		static thread_local SKMemo<HashType> memo;
+		return memo;
+	}
 
 
     /** SK32
@@ -87,29 +230,33 @@ namespace LLC
      *
      **/
 	template<typename T1>
-	inline uint64_t SK64(const T1 pbegin, const T1 pend)
+	inline uint64_t SK64(const T1 pbegin, const T1 pend, const bool fMemo = false)
 	{
-		/* Copy the data into a vector of bytes so we can cache the hashed value */
-		std::vector<uint8_t> vData(pbegin, pend);
+		const uint8_t* pdata = (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]);
+		const uint64_t nSize = (pend - pbegin) * sizeof(pbegin[0]);
+
+		/* Check the memo when the call site opts in. */
+		const bool fCache = (fMemo && nSize <= SK_MEMO_MAX);
+		const uint128_t hashFingerprint = (fCache ? SKFingerprint(pdata, nSize) : uint128_t(0));
 
-		/* Check the cache for this data */
 		uint64_t hashKeccak = 0;
-		if(!cache64.Get(vData, hashKeccak))
-		{
-			uint64_t hashSkein = 0;
-			Skein_256_Ctxt_t ctxSkein;
-			Skein_256_Init  (&ctxSkein, 64);
-			Skein_256_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
-			Skein_256_Final (&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize(&ctxKeccak, 1344, 256, 64, 0x06);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 64);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
-
-			/* Cache the hashed value */
-			cache64.Put(vData, hashKeccak);
-		}
+		if(fCache && SKMemoLocal<uint64_t>().Get(hashFingerprint, nSize, hashKeccak))
+			return hashKeccak;
+
+		uint64_t hashSkein = 0;
+		Skein_256_Ctxt_t ctxSkein;
+		Skein_256_Init  (&ctxSkein, 64);
+		Skein_256_Update(&ctxSkein, pdata, nSize);
+		Skein_256_Final (&ctxSkein, (uint8_t *)&hashSkein);
+
+		Keccak_HashInstance ctxKeccak;
+		Keccak_HashInitialize(&ctxKeccak, 1344, 256, 64, 0x06);
+		Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 64);
+		Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
+
+		/* Memoize the hashed value */
+		if(fCache)
+			SKMemoLocal<uint64_t>().Put(hashFingerprint, nSize, hashKeccak);
 
 		return hashKeccak;
 	}
@@ -120,56 +267,45 @@ namespace LLC
      *  64-bit hashing template for Address Generation.
      *
      **/
-	inline uint64_t SK64(const std::vector<uint8_t>& vch)
+	inline uint64_t SK64(const std::vector<uint8_t>& vch, const bool fMemo = false)
 	{
-		/* Check the cache for this data */
-		uint64_t hashKeccak = 0;
-		if(!cache64.Get(vch, hashKeccak))
-		{
-			uint64_t hashSkein = 0;
-			Skein_256_Ctxt_t ctxSkein;
-			Skein_256_Init(&ctxSkein, 64);
-			Skein_256_Update(&ctxSkein, (uint8_t *)&vch[0], vch.size());
-			Skein_256_Final(&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize(&ctxKeccak, 1344, 256, 64, 0x06);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 64);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
-
-			/* Cache the hashed value */
-			cache64.Put(vch, hashKeccak);
-		}
-
-		return hashKeccak;
+		return SK64(vch.begin(), vch.end(), fMemo);
 	}
 
 
 	/** SK256
      *
-     *  256-bit hashing template for Address Generation .
+     *  256-bit hashing template for Address Generation.
      *
      **/
-	inline uint256_t SK256(const std::vector<uint8_t>& vch)
+	template<typename T1>
+	inline uint256_t SK256(const T1 pbegin, const T1 pend, const bool fMemo = false)
 	{
-		/* Check the cache for this data */
+		const uint8_t* pdata = (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]);
+		const uint64_t nSize = (pend - pbegin) * sizeof(pbegin[0]);
+
+		/* Check the memo when the call site opts in. */
+		const bool fCache = (fMemo && nSize <= SK_MEMO_MAX);
+		const uint128_t hashFingerprint = (fCache ? SKFingerprint(pdata, nSize) : uint128_t(0));
+
 		uint256_t hashKeccak;
-		if(!cache256.Get(vch, hashKeccak))
-		{
-			uint256_t hashSkein = 0;
-			Skein_256_Ctxt_t ctxSkein;
-			Skein_256_Init(&ctxSkein, 256);
-			Skein_256_Update(&ctxSkein, (uint8_t *)&vch[0], vch.size());
-			Skein_256_Final(&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize_SHA3_256(&ctxKeccak);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 256);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
-
-			/* Cache the hashed value */
-			cache256.Put(vch, hashKeccak);
-		}
+		if(fCache && SKMemoLocal<uint256_t>().Get(hashFingerprint, nSize, hashKeccak))
+			return hashKeccak;
+
+		uint256_t hashSkein;
+		Skein_256_Ctxt_t ctxSkein;
+		Skein_256_Init  (&ctxSkein, 256);
+		Skein_256_Update(&ctxSkein, pdata, nSize);
+		Skein_256_Final (&ctxSkein, (uint8_t *)&hashSkein);
+
+		Keccak_HashInstance ctxKeccak;
+		Keccak_HashInitialize_SHA3_256(&ctxKeccak);
+		Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 256);
+		Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
+
+		/* Memoize the hashed value */
+		if(fCache)
+			SKMemoLocal<uint256_t>().Put(hashFingerprint, nSize, hashKeccak);
 
 		return hashKeccak;
 	}
@@ -177,35 +313,12 @@ namespace LLC
 
 	/** SK256
      *
-     *  256-bit hashing template for Address Generation.
+     *  256-bit hashing template for Address Generation .
      *
      **/
-	template<typename T1>
-	inline uint256_t SK256(const T1 pbegin, const T1 pend)
+	inline uint256_t SK256(const std::vector<uint8_t>& vch, const bool fMemo = false)
 	{
-		/* Copy the data into a vector of bytes so we can cache the hashed value */
-		std::vector<uint8_t> vData(pbegin, pend);
-
-		/* Check the cache for this data */
-		uint256_t hashKeccak;
-		if(!cache256.Get(vData, hashKeccak))
-		{
-			uint256_t hashSkein;
-			Skein_256_Ctxt_t ctxSkein;
-			Skein_256_Init  (&ctxSkein, 256);
-			Skein_256_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
-			Skein_256_Final (&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize_SHA3_256(&ctxKeccak);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 256);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
-
-			/* Cache the hashed value */
-			cache256.Put(vData, hashKeccak);
-		}
-
-		return hashKeccak;
+		return SK256(vch.begin(), vch.end(), fMemo);
 	}
 
 
@@ -214,44 +327,15 @@ namespace LLC
 	 *  256-bit hashing template for strings.
 	 *
 	 *  @param[in] str The string to hash
+	 *  @param[in] fMemo Flag to check and fill this thread's memo.
 	 *
 	 *  @return uint256_t hashSkein/hashKeccak hash of the string
 	 *
 	 **/
 
-	inline uint256_t SK256(const std::string& str)
+	inline uint256_t SK256(const std::string& str, const bool fMemo = false)
 	{
-		return SK256(str.begin(), str.end());
-	}
-
-
-    /** SK512
-     *
-     *  512-bit hashing template for Next Hash.
-     *
-     **/
-    inline uint512_t SK512(const std::vector<uint8_t>& vch)
-	{
-		/* Check the cache for this data */
-		uint512_t hashKeccak;
-		if(!cache512.Get(vch, hashKeccak))
-		{
-			uint512_t hashSkein;
-			Skein_512_Ctxt_t ctxSkein;
-			Skein_512_Init(&ctxSkein, 512);
-			Skein_512_Update(&ctxSkein, (uint8_t *)&vch[0], vch.size());
-			Skein_512_Final(&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize_SHA3_512(&ctxKeccak);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 512);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
-
-			/* Cache the hashed value */
-			cache512.Put(vch, hashKeccak);
-		}
-
-		return hashKeccak;
+		return SK256(str.begin(), str.end(), fMemo);
 	}
 
 
@@ -286,34 +370,49 @@ namespace LLC
      *
      **/
 	template<typename T1>
-	inline uint512_t SK512(const T1 pbegin, const T1 pend)
+	inline uint512_t SK512(const T1 pbegin, const T1 pend, const bool fMemo = false)
 	{
-		/* Copy the data into a vector of bytes so we can cache the hashed value */
-		std::vector<uint8_t> vData(pbegin, pend);
+		const uint8_t* pdata = (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]);
+		const uint64_t nSize = (pend - pbegin) * sizeof(pbegin[0]);
+
+		/* Check the memo when the call site opts in. */
+		const bool fCache = (fMemo && nSize <= SK_MEMO_MAX);
+		const uint128_t hashFingerprint = (fCache ? SKFingerprint(pdata, nSize) : uint128_t(0));
 
-		/* Check the cache for this data */
 		uint512_t hashKeccak;
-		if(!cache512.Get(vData, hashKeccak))
-		{
-			uint512_t hashSkein;
-			Skein_512_Ctxt_t ctxSkein;
-			Skein_512_Init  (&ctxSkein, 512);
-			Skein_512_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
-			Skein_512_Final (&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize_SHA3_512(&ctxKeccak);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 512);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
-
-			/* Cache the hashed value */
-			cache512.Put(vData, hashKeccak);
-		}
+		if(fCache && SKMemoLocal<uint512_t>().Get(hashFingerprint, nSize, hashKeccak))
+			return hashKeccak;
+
+		uint512_t hashSkein;
+		Skein_512_Ctxt_t ctxSkein;
+		Skein_512_Init  (&ctxSkein, 512);
+		Skein_512_Update(&ctxSkein, pdata, nSize);
+		Skein_512_Final (&ctxSkein, (uint8_t *)&hashSkein);
+
+		Keccak_HashInstance ctxKeccak;
+		Keccak_HashInitialize_SHA3_512(&ctxKeccak);
+		Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 512);
+		Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
+
+		/* Memoize the hashed value */
+		if(fCache)
+			SKMemoLocal<uint512_t>().Put(hashFingerprint, nSize, hashKeccak);
 
 		return hashKeccak;
 	}
 
 
+    /** SK512
+     *
+     *  512-bit hashing template for Next Hash.
+     *
+     **/
+    inline uint512_t SK512(const std::vector<uint8_t>& vch, const bool fMemo = false)
+	{
+		return SK512(vch.begin(), vch.end(), fMemo);
+	}
+
+
 	/** SK512
      *
      * 512-bit hashing template for TX hash.
@@ -368,6 +467,20 @@ namespace LLC
 	}
 
 
+	/** SK512Batch
+     *
+     *  512-bit hashing of many messages at once, for transaction hashes and merkle
+     *  trees. Runs four messages per pass with AVX2 where the CPU supports it, or
+     *  one at a time otherwise. Hashes match SK512.
+     *
+     *  @param[in] vMessages The begin and end of each message.
+     *
+     *  @return The hash of each message, in order.
+     *
+     **/
+	std::vector<uint512_t> SK512Batch(const std::vector< std::pair<const uint8_t*, const uint8_t*> >& vMessages);
+
+
 	/** SK576
      *
      * 576-bit hashing template used for Private Keys.
@@ -398,29 +511,33 @@ namespace LLC
      *
      **/
 	template<typename T1>
-	inline uint1024_t SK1024(const T1 pbegin, const T1 pend)
+	inline uint1024_t SK1024(const T1 pbegin, const T1 pend, const bool fMemo = false)
 	{
-		/* Copy the data into a vector of bytes so we can cache the hashed value */
-		std::vector<uint8_t> vData(pbegin, pend);
+		const uint8_t* pdata = (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]);
+		const uint64_t nSize = (pend - pbegin) * sizeof(pbegin[0]);
+
+		/* Check the memo when the call site opts in. */
+		const bool fCache = (fMemo && nSize <= SK_MEMO_MAX);
+		const uint128_t hashFingerprint = (fCache ? SKFingerprint(pdata, nSize) : uint128_t(0));
 
-		/* Check the cache for this data */
 		uint1024_t hashKeccak;
-		if(!cache1024.Get(vData, hashKeccak))
-		{
-			uint1024_t hashSkein;
-			Skein1024_Ctxt_t ctxSkein;
-			Skein1024_Init(&ctxSkein, 1024);
-			Skein1024_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
-			Skein1024_Final(&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize(&ctxKeccak, 576, 1024, 1024, 0x05);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 1024);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
-
-			/* Cache the hashed value */
-			cache1024.Put(vData, hashKeccak);
-		}
+		if(fCache && SKMemoLocal<uint1024_t>().Get(hashFingerprint, nSize, hashKeccak))
+			return hashKeccak;
+
+		uint1024_t hashSkein;
+		Skein1024_Ctxt_t ctxSkein;
+		Skein1024_Init(&ctxSkein, 1024);
+		Skein1024_Update(&ctxSkein, pdata, nSize);
+		Skein1024_Final(&ctxSkein, (uint8_t *)&hashSkein);
+
+		Keccak_HashInstance ctxKeccak;
+		Keccak_HashInitialize(&ctxKeccak, 576, 1024, 1024, 0x05);
+		Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 1024);
+		Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
+
+		/* Memoize the hashed value */
+		if(fCache)
+			SKMemoLocal<uint1024_t>().Put(hashFingerprint, nSize, hashKeccak);
 
 		return hashKeccak;
 	}
@@ -12,12 +12,24 @@
 ____________________________________________________________________________________________*/
 
 #include <LLC/hash/SK.h>
+#include <LLC/include/random.h>
+
+#include <LLD/hash/xxh3.h>
 
 namespace LLC
 {
-    /* Implementation of SK function caches */
-    LLD::TemplateLRU<std::vector<uint8_t>, uint64_t>   cache64   (32);
-    LLD::TemplateLRU<std::vector<uint8_t>, uint256_t>  cache256  (32);
-    LLD::TemplateLRU<std::vector<uint8_t>, uint512_t>  cache512  (32);
-    LLD::TemplateLRU<std::vector<uint8_t>, uint1024_t> cache1024 (32);
+    /* Get the key of an input in the memo. */
+    uint128_t SKFingerprint(const uint8_t* pdata, const uint64_t nSize)
+    {
+        /* Chosen on first use so fingerprints differ between nodes. */
+        static const uint64_t nSeed = LLC::GetRand();
+
+        const XXH128_hash_t hash = XXH3_128bits_withSeed(pdata, nSize, nSeed);
+
+        uint128_t hashFingerprint = hash.high64;
+        hashFingerprint <<= 64;
+        hashFingerprint  |= hash.low64;
+
+        return hashFingerprint;
+    }
 }
@@ -0,0 +1,372 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/hash/SK.h>
+#include <LLC/hash/SK/skein_iv.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define SK_BATCH_AVX2 1
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace LLC
+{
+
+    /* Hash one message with Skein-512 and SHA3-512, the same as SK512 without the cache. */
+    uint512_t SK512Single(const uint8_t* pbegin, const uint8_t* pend)
+    {
+        uint512_t hashSkein;
+        Skein_512_Ctxt_t ctxSkein;
+        Skein_512_Init  (&ctxSkein, 512);
+        Skein_512_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)pbegin), pend - pbegin);
+        Skein_512_Final (&ctxSkein, (uint8_t *)&hashSkein);
+
+        uint512_t hashKeccak;
+        Keccak_HashInstance ctxKeccak;
+        Keccak_HashInitialize_SHA3_512(&ctxKeccak);
+        Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 512);
+        Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
+
+        return hashKeccak;
+    }
+
+
+#ifdef SK_BATCH_AVX2
+
+    /* The number of messages hashed together. */
+    const uint32_t LANES = 4;
+
+
+    /* Keccak-f[1600] round constants. */
+    const uint64_t KECCAK_RC[24] =
+    {
+        0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+        0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+        0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+        0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+        0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+        0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+    };
+
+
+    /* Keccak-f[1600] rotation offsets, by lane x + 5y. */
+    const uint32_t KECCAK_RHO[25] =
+    {
+         0,  1, 62, 28, 27,
+        36, 44,  6, 55, 20,
+         3, 10, 43, 25, 39,
+        41, 45, 15, 21,  8,
+        18,  2, 61, 56, 14
+    };
+
+
+    /* Rotate four 64-bit words left by a constant. */
+    #define ROTL64X4(x, n) _mm256_or_si256(_mm256_slli_epi64((x), (n)), _mm256_srli_epi64((x), 64 - (n)))
+
+
+    /* Run Keccak-f[1600] on four states, one state per 64-bit lane. */
+    TARGET_AVX2 void KeccakF1600x4(__m256i A[25])
+    {
+        for(uint32_t nRound = 0; nRound < 24; ++nRound)
+        {
+            /* Theta. */
+            __m256i C[5];
+            for(uint32_t x = 0; x < 5; ++x)
+                C[x] = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A[x], A[x + 5]),
+                       _mm256_xor_si256(A[x + 10], A[x + 15])), A[x + 20]);
+
+            for(uint32_t x = 0; x < 5; ++x)
+            {
+                const __m256i D = _mm256_xor_si256(C[(x + 4) % 5], ROTL64X4(C[(x + 1) % 5], 1));
+                for(uint32_t y = 0; y < 25; y += 5)
+                    A[x + y] = _mm256_xor_si256(A[x + y], D);
+            }
+
+            /* Rho and pi. */
+            __m256i B[25];
+            for(uint32_t i = 0; i < 25; ++i)
+            {
+                const uint32_t x = i % 5;
+                const uint32_t y = i / 5;
+
+                const __m256i nLeft  = _mm256_set1_epi64x(KECCAK_RHO[i]);
+                const __m256i nRight = _mm256_set1_epi64x(64 - KECCAK_RHO[i]);
+
+                B[y + 5 * ((2 * x + 3 * y) % 5)] =
+                    _mm256_or_si256(_mm256_sllv_epi64(A[i], nLeft), _mm256_srlv_epi64(A[i], nRight));
+            }
+
+            /* Chi. */
+            for(uint32_t y = 0; y < 25; y += 5)
+                for(uint32_t x = 0; x < 5; ++x)
+                    A[x + y] = _mm256_xor_si256(B[x + y], _mm256_andnot_si256(B[(x + 1) % 5 + y], B[(x + 2) % 5 + y]));
+
+            /* Iota. */
+            A[0] = _mm256_xor_si256(A[0], _mm256_set1_epi64x(KECCAK_RC[nRound]));
+        }
+    }
+
+
+    /* Run one UBI block on four Skein-512 states: X = Threefish(X, T, W) ^ W. */
+    TARGET_AVX2 void Skein512x4(uint64_t X[LANES][8], const uint64_t T[LANES][2], const uint64_t W[LANES][8])
+    {
+        /* Transpose into one vector per word. */
+        __m256i ks[9];
+        __m256i ts[3];
+        __m256i w[8];
+        __m256i x[8];
+
+        ks[8] = _mm256_set1_epi64x(SKEIN_KS_PARITY);
+        for(uint32_t i = 0; i < 8; ++i)
+        {
+            ks[i] = _mm256_set_epi64x(X[3][i], X[2][i], X[1][i], X[0][i]);
+            w[i]  = _mm256_set_epi64x(W[3][i], W[2][i], W[1][i], W[0][i]);
+
+            ks[8] = _mm256_xor_si256(ks[8], ks[i]);
+        }
+
+        ts[0] = _mm256_set_epi64x(T[3][0], T[2][0], T[1][0], T[0][0]);
+        ts[1] = _mm256_set_epi64x(T[3][1], T[2][1], T[1][1], T[0][1]);
+        ts[2] = _mm256_xor_si256(ts[0], ts[1]);
+
+        /* First key injection. */
+        for(uint32_t i = 0; i < 8; ++i)
+            x[i] = _mm256_add_epi64(w[i], ks[i]);
+
+        x[5] = _mm256_add_epi64(x[5], ts[0]);
+        x[6] = _mm256_add_epi64(x[6], ts[1]);
+
+        #define MIX512X4(p0, p1, ROT)                                   \
+            x[p0] = _mm256_add_epi64(x[p0], x[p1]);                     \
+            x[p1] = _mm256_xor_si256(ROTL64X4(x[p1], ROT), x[p0]);
+
+        #define ROUND512X4(p0, p1, p2, p3, p4, p5, p6, p7, ROT)         \
+            MIX512X4(p0, p1, ROT##_0)                                   \
+            MIX512X4(p2, p3, ROT##_1)                                   \
+            MIX512X4(p4, p5, ROT##_2)                                   \
+            MIX512X4(p6, p7, ROT##_3)
+
+        #define INJECT512X4(R)                                                              \
+            for(uint32_t i = 0; i < 8; ++i)                                                 \
+                x[i] = _mm256_add_epi64(x[i], ks[((R) + 1 + i) % 9]);                       \
+            x[5] = _mm256_add_epi64(x[5], ts[((R) + 1) % 3]);                               \
+            x[6] = _mm256_add_epi64(x[6], ts[((R) + 2) % 3]);                               \
+            x[7] = _mm256_add_epi64(x[7], _mm256_set1_epi64x((R) + 1));
+
+        /* Eight rounds with two key injections, nine times for 72 rounds. */
+        for(uint32_t r = 0; r < SKEIN_512_ROUNDS_TOTAL / 8; ++r)
+        {
+            ROUND512X4(0, 1, 2, 3, 4, 5, 6, 7, R_512_0);
+            ROUND512X4(2, 1, 4, 7, 6, 5, 0, 3, R_512_1);
+            ROUND512X4(4, 1, 6, 3, 0, 5, 2, 7, R_512_2);
+            ROUND512X4(6, 1, 0, 7, 2, 5, 4, 3, R_512_3);
+            INJECT512X4(2 * r);
+
+            ROUND512X4(0, 1, 2, 3, 4, 5, 6, 7, R_512_4);
+            ROUND512X4(2, 1, 4, 7, 6, 5, 0, 3, R_512_5);
+            ROUND512X4(4, 1, 6, 3, 0, 5, 2, 7, R_512_6);
+            ROUND512X4(6, 1, 0, 7, 2, 5, 4, 3, R_512_7);
+            INJECT512X4(2 * r + 1);
+        }
+
+        #undef INJECT512X4
+        #undef ROUND512X4
+        #undef MIX512X4
+
+        /* Feed forward and transpose back. */
+        for(uint32_t i = 0; i < 8; ++i)
+        {
+            alignas(32) uint64_t nWords[LANES];
+            _mm256_store_si256((__m256i*)nWords, _mm256_xor_si256(x[i], w[i]));
+
+            for(uint32_t n = 0; n < LANES; ++n)
+                X[n][i] = nWords[n];
+        }
+    }
+
+
+    /* Hash messages four at a time, refilling each lane as its message finishes. */
+    TARGET_AVX2 void SK512x4(const std::vector< std::pair<const uint8_t*, const uint8_t*> >& vMessages,
+                             std::vector<uint512_t>& vHashes)
+    {
+        const uint32_t nMessages = static_cast<uint32_t>(vMessages.size());
+
+        /* The Skein-512 output of each message. */
+        std::vector< std::array<uint64_t, 8> > vSkein(nMessages);
+
+        /* Per lane chaining value, tweak, and block. */
+        uint64_t X[LANES][8];
+        uint64_t T[LANES][2];
+        uint64_t W[LANES][8];
+
+        /* Per lane message, bytes consumed, and whether the message blocks are done. */
+        uint32_t nLane[LANES];
+        uint64_t nOffset[LANES];
+        bool     fOutput[LANES];
+
+        uint32_t nNext   = 0;
+        uint32_t nActive = 0;
+
+        auto fnStart = [&](const uint32_t n)
+        {
+            if(nNext == nMessages)
+            {
+                nLane[n] = nMessages;
+                return;
+            }
+
+            nLane[n]   = nNext++;
+            nOffset[n] = 0;
+            fOutput[n] = false;
+
+            std::copy(SKEIN_512_IV_512, SKEIN_512_IV_512 + 8, X[n]);
+            T[n][0] = 0;
+            T[n][1] = SKEIN_T1_FLAG_FIRST | SKEIN_T1_BLK_TYPE_MSG;
+
+            ++nActive;
+        };
+
+        for(uint32_t n = 0; n < LANES; ++n)
+            fnStart(n);
+
+        while(nActive > 0)
+        {
+            /* Load the next block of each lane, idle lanes hash zeros. */
+            for(uint32_t n = 0; n < LANES; ++n)
+            {
+                std::fill(W[n], W[n] + 8, 0);
+
+                if(nLane[n] == nMessages)
+                {
+                    std::fill(X[n], X[n] + 8, 0);
+                    T[n][0] = T[n][1] = 0;
+
+                    continue;
+                }
+
+                /* The output block is a zero counter. */
+                if(fOutput[n])
+                {
+                    T[n][0] = sizeof(uint64_t);
+                    T[n][1] = SKEIN_T1_FLAG_FIRST | SKEIN_T1_BLK_TYPE_OUT_FINAL;
+
+                    continue;
+                }
+
+                /* The last block, even if full or empty, is the final block. */
+                const std::pair<const uint8_t*, const uint8_t*>& message = vMessages[nLane[n]];
+                const uint64_t nRemaining = (message.second - message.first) - nOffset[n];
+                const uint64_t nBytes     = std::min(nRemaining, uint64_t(SKEIN_512_BLOCK_BYTES));
+
+                if(nBytes > 0)
+                    std::memcpy(W[n], message.first + nOffset[n], nBytes);
+
+                nOffset[n] += nBytes;
+                T[n][0]    += nBytes;
+
+                if(nRemaining <= SKEIN_512_BLOCK_BYTES)
+                    T[n][1] |= SKEIN_T1_FLAG_FINAL;
+            }
+
+            Skein512x4(X, T, W);
+
+            /* Advance each lane to its next block, output stage, or message. */
+            for(uint32_t n = 0; n < LANES; ++n)
+            {
+                if(nLane[n] == nMessages)
+                    continue;
+
+                if(fOutput[n])
+                {
+                    std::copy(X[n], X[n] + 8, vSkein[nLane[n]].begin());
+
+                    --nActive;
+                    fnStart(n);
+
+                    continue;
+                }
+
+                if(T[n][1] & SKEIN_T1_FLAG_FINAL)
+                    fOutput[n] = true;
+
+                T[n][1] &= ~SKEIN_T1_FLAG_FIRST;
+            }
+        }
+
+        /* SHA3-512 of the 64 byte Skein output is a single padded block. */
+        for(uint32_t nBegin = 0; nBegin < nMessages; nBegin += LANES)
+        {
+            const uint32_t nCount = std::min(LANES, nMessages - nBegin);
+
+            uint64_t nWords[LANES][8] = { };
+            for(uint32_t n = 0; n < nCount; ++n)
+                std::copy(vSkein[nBegin + n].begin(), vSkein[nBegin + n].end(), nWords[n]);
+
+            __m256i A[25];
+            for(uint32_t i = 0; i < 25; ++i)
+                A[i] = _mm256_setzero_si256();
+
+            for(uint32_t i = 0; i < 8; ++i)
+                A[i] = _mm256_set_epi64x(nWords[3][i], nWords[2][i], nWords[1][i], nWords[0][i]);
+
+            /* Domain suffix 0x06 after the message, and the last bit of the 72 byte rate. */
+            A[8] = _mm256_set1_epi64x(0x8000000000000006ULL);
+
+            KeccakF1600x4(A);
+
+            for(uint32_t i = 0; i < 8; ++i)
+            {
+                alignas(32) uint64_t nLanes[LANES];
+                _mm256_store_si256((__m256i*)nLanes, A[i]);
+
+                for(uint32_t n = 0; n < nCount; ++n)
+                    nWords[n][i] = nLanes[n];
+            }
+
+            for(uint32_t n = 0; n < nCount; ++n)
+                std::memcpy((uint8_t*)&vHashes[nBegin + n], nWords[n], 64);
+        }
+    }
+
+#endif
+
+
+    /* 512-bit hashing of many messages at once. */
+    std::vector<uint512_t> SK512Batch(const std::vector< std::pair<const uint8_t*, const uint8_t*> >& vMessages)
+    {
+        std::vector<uint512_t> vHashes(vMessages.size());
+
+    #ifdef SK_BATCH_AVX2
+
+        /* Check the CPU once, and only batch when there is more than one message. */
+        static const bool fAVX2 = __builtin_cpu_supports("avx2");
+        if(fAVX2 && vMessages.size() > 1)
+        {
+            SK512x4(vMessages, vHashes);
+            return vHashes;
+        }
+
+    #endif
+
+        /* Scalar fallback, one message at a time. */
+        for(uint32_t n = 0; n < vMessages.size(); ++n)
+            vHashes[n] = SK512Single(vMessages[n].first, vMessages[n].second);
+
+        return vHashes;
+    }
+}
@@ -231,6 +231,16 @@ typedef enum Argon2_version {
     ARGON2_VERSION_NUMBER = ARGON2_VERSION_13
 } argon2_version;
 
+/* Block compression kernel used to fill memory */
+typedef enum Argon2_kernel {
+    ARGON2_KERNEL_AUTO = 0,
+    ARGON2_KERNEL_REF = 1,
+    ARGON2_KERNEL_SSE2 = 2,
+    ARGON2_KERNEL_SSSE3 = 3,
+    ARGON2_KERNEL_AVX2 = 4,
+    ARGON2_KERNEL_AVX512F = 5
+} argon2_kernel;
+
 /*
  * Function that gives the string representation of an argon2_type.
  * @param type The argon2_type that we want the string for
@@ -410,6 +420,28 @@ ARGON2_PUBLIC int argon2id_verify_ctx(argon2_context *context,
 ARGON2_PUBLIC int argon2_verify_ctx(argon2_context *context, const char *hash,
                                     argon2_type type);
 
+/**
+ * Selects the block compression kernel. The default, ARGON2_KERNEL_AUTO, picks
+ * the fastest one the CPU supports each time memory is filled.
+ * @param kernel The kernel to use
+ * @return ARGON2_OK, or ARGON2_INCORRECT_PARAMETER if the kernel is not
+ * built in or the CPU does not support it
+ */
+ARGON2_PUBLIC int argon2_select_kernel(argon2_kernel kernel);
+
+/**
+ * Get the block compression kernel used to fill memory
+ * @return The selected kernel, or the one picked by ARGON2_KERNEL_AUTO
+ */
+ARGON2_PUBLIC argon2_kernel argon2_current_kernel(void);
+
+/**
+ * Function that gives the string representation of an argon2_kernel.
+ * @param kernel The argon2_kernel that we want the string for
+ * @return NULL if invalid kernel, otherwise the string representation.
+ */
+ARGON2_PUBLIC const char *argon2_kernel2string(argon2_kernel kernel);
+
 /**
  * Get the associated error message for given error code
  * @return  The error message associated with the given error code
@@ -217,6 +217,33 @@ void finalize(const argon2_context *context, argon2_instance_t *instance);
 void fill_segment(const argon2_instance_t *instance,
                   argon2_position_t position);
 
+/* SIMD kernels are built with target pragmas, which need GCC on x86 */
+#if defined(__GNUC__) && !defined(__clang__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define ARGON2_KERNEL_X86 1
+#endif
+
+/*
+ * Block compression kernels that fill_segment dispatches to at runtime. Each
+ * fills the segment like fill_segment, with the same result.
+ */
+void fill_segment_ref(const argon2_instance_t *instance,
+                      argon2_position_t position);
+
+#if defined(ARGON2_KERNEL_X86)
+void fill_segment_sse2(const argon2_instance_t *instance,
+                       argon2_position_t position);
+
+void fill_segment_ssse3(const argon2_instance_t *instance,
+                        argon2_position_t position);
+
+void fill_segment_avx2(const argon2_instance_t *instance,
+                       argon2_position_t position);
+
+void fill_segment_avx512f(const argon2_instance_t *instance,
+                          argon2_position_t position);
+#endif
+
 /*
  * Function that fills the entire memory t_cost times based on the first two
  * blocks in each lane
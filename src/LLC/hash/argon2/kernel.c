@@ -0,0 +1,119 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : http://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+#include <LLC/hash/argon2.h>
+#include "core.h"
+
+/* The kernel set by argon2_select_kernel */
+static argon2_kernel selected_kernel = ARGON2_KERNEL_AUTO;
+
+/* Check if a kernel is built in and supported by this CPU */
+static int kernel_supported(argon2_kernel kernel) {
+    switch(kernel) {
+    case ARGON2_KERNEL_REF:
+        return 1;
+#if defined(ARGON2_KERNEL_X86)
+    case ARGON2_KERNEL_SSE2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+    case ARGON2_KERNEL_SSSE3:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3");
+    case ARGON2_KERNEL_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    case ARGON2_KERNEL_AVX512F:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return 0;
+    }
+}
+
+int argon2_select_kernel(argon2_kernel kernel) {
+    if(kernel != ARGON2_KERNEL_AUTO && !kernel_supported(kernel)) {
+        return ARGON2_INCORRECT_PARAMETER;
+    }
+
+    selected_kernel = kernel;
+    return ARGON2_OK;
+}
+
+argon2_kernel argon2_current_kernel(void) {
+    if(selected_kernel != ARGON2_KERNEL_AUTO) {
+        return selected_kernel;
+    }
+
+    /* The fastest kernel the CPU supports */
+    if(kernel_supported(ARGON2_KERNEL_AVX512F)) {
+        return ARGON2_KERNEL_AVX512F;
+    }
+    if(kernel_supported(ARGON2_KERNEL_AVX2)) {
+        return ARGON2_KERNEL_AVX2;
+    }
+    if(kernel_supported(ARGON2_KERNEL_SSSE3)) {
+        return ARGON2_KERNEL_SSSE3;
+    }
+    if(kernel_supported(ARGON2_KERNEL_SSE2)) {
+        return ARGON2_KERNEL_SSE2;
+    }
+
+    return ARGON2_KERNEL_REF;
+}
+
+const char *argon2_kernel2string(argon2_kernel kernel) {
+    switch(kernel) {
+    case ARGON2_KERNEL_AUTO:
+        return "auto";
+    case ARGON2_KERNEL_REF:
+        return "ref";
+    case ARGON2_KERNEL_SSE2:
+        return "sse2";
+    case ARGON2_KERNEL_SSSE3:
+        return "ssse3";
+    case ARGON2_KERNEL_AVX2:
+        return "avx2";
+    case ARGON2_KERNEL_AVX512F:
+        return "avx512f";
+    }
+
+    return NULL;
+}
+
+void fill_segment(const argon2_instance_t *instance,
+                  argon2_position_t position) {
+    switch(argon2_current_kernel()) {
+#if defined(ARGON2_KERNEL_X86)
+    case ARGON2_KERNEL_AVX512F:
+        fill_segment_avx512f(instance, position);
+        break;
+    case ARGON2_KERNEL_AVX2:
+        fill_segment_avx2(instance, position);
+        break;
+    case ARGON2_KERNEL_SSSE3:
+        fill_segment_ssse3(instance, position);
+        break;
+    case ARGON2_KERNEL_SSE2:
+        fill_segment_sse2(instance, position);
+        break;
+#endif
+    default:
+        fill_segment_ref(instance, position);
+        break;
+    }
+}
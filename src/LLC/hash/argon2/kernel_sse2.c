@@ -0,0 +1,30 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : http://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+/*
+ * The optimized block compression of opt.c built for SSE2, so it can be picked
+ * at runtime by fill_segment in kernel.c. The target has to be set before the
+ * intrinsics headers are included.
+ */
+#include "core.h"
+
+#if defined(ARGON2_KERNEL_X86)
+#pragma GCC target("sse2")
+
+#define fill_segment fill_segment_sse2
+#include "opt.c"
+#endif
@@ -0,0 +1,60 @@
+/*__________________________________________________________________________________________
+
+			(c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+			(c) Copyright The Nexus Developers 2014 - 2019
+
+			Distributed under the MIT software license, see the accompanying
+			file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+			"ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLC_INCLUDE_ARGON2_POOL_H
+#define NEXUS_LLC_INCLUDE_ARGON2_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace LLC
+{
+
+    /** Argon2Allocate
+     *
+     *  Argon2 memory allocator that reuses released memory of the same size, so
+     *  repeated hashes don't map and unmap their memory each time. Pass it as the
+     *  allocate_cbk of an argon2_context, with Argon2Free as the free_cbk.
+     *
+     *  @param[out] pMemory The allocated memory, or nullptr on failure.
+     *  @param[in] nBytes The number of bytes to allocate.
+     *
+     *  @return 0 always, argon2 checks the memory for failures.
+     *
+     **/
+    int Argon2Allocate(uint8_t** pMemory, size_t nBytes);
+
+
+    /** Argon2Free
+     *
+     *  Argon2 memory deallocator that keeps the last -argon2pool released buffers
+     *  for reuse. Argon2 wipes the memory before releasing it.
+     *
+     *  @param[in] pMemory The memory to release.
+     *  @param[in] nBytes The size of the memory in bytes.
+     *
+     **/
+    void Argon2Free(uint8_t* pMemory, size_t nBytes);
+
+
+    /** Argon2PoolSize
+     *
+     *  Get the number of released buffers kept for reuse.
+     *
+     **/
+    uint32_t Argon2PoolSize();
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLC_INCLUDE_FLCACHE_H
+#define NEXUS_LLC_INCLUDE_FLCACHE_H
+
+#include <LLC/types/uint1024.h>
+
+#include <Util/templates/sharded_cache.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace LLC
+{
+
+    /** FLKeyCache
+     *
+     *  Bounded cache of decoded FALCON public keys, keyed by a fingerprint of the
+     *  encoded key, so repeated verifications for the same sigchain skip decoding
+     *  the key. Entries keep the encoded key and are only used if it matches, so
+     *  a fingerprint collision can't verify against the wrong key.
+     *
+     *  Entries are split over independently locked shards by fingerprint.
+     *
+     **/
+    class FLKeyCache
+    {
+        /** Entry
+         *
+         *  An encoded public key with its decoded form.
+         *
+         **/
+        struct Entry
+        {
+            /** The encoded public key. **/
+            std::vector<uint8_t> vchPubKey;
+
+
+            /** The decoded public key. **/
+            std::vector<uint8_t> vchDecoded;
+        };
+
+
+        /** ShardHash
+         *
+         *  Picks the shard of an entry by its fingerprint.
+         *
+         **/
+        struct ShardHash
+        {
+            uint64_t operator()(const uint128_t& hashKey) const
+            {
+                return hashKey.Get64();
+            }
+        };
+
+
+        /** The decoded keys by fingerprint, shared so lookups copy them outside the shard lock. **/
+        sharded_cache<uint128_t, std::shared_ptr<const Entry>, ShardHash> cacheKeys;
+
+
+        /** The number of lookups that found a decoded key. **/
+        std::atomic<uint64_t> nHits;
+
+
+        /** The number of lookups that decoded the key. **/
+        std::atomic<uint64_t> nMisses;
+
+
+    public:
+
+        /** Default Constructor. **/
+        FLKeyCache();
+
+
+        /** Get
+         *
+         *  Get a decoded public key, decoding and adding it if it isn't cached, and
+         *  evicting the oldest keys over -flkeycache.
+         *
+         *  @param[in] vchPubKey The encoded public key.
+         *  @param[out] vchDecoded The decoded public key.
+         *
+         *  @return true if the public key is valid.
+         *
+         **/
+        bool Get(const std::vector<uint8_t>& vchPubKey, std::vector<uint8_t>& vchDecoded);
+
+
+        /** Hits
+         *
+         *  Get the number of lookups that found a decoded key.
+         *
+         **/
+        uint64_t Hits() const;
+
+
+        /** Misses
+         *
+         *  Get the number of lookups that decoded the key.
+         *
+         **/
+        uint64_t Misses() const;
+    };
+
+    extern FLKeyCache flcache;
+}
+
+#endif
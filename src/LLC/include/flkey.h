@@ -26,6 +26,36 @@ ________________________________________________________________________________
 namespace LLC
 {
 
+    /** FLSignature
+     *
+     *  A signature to verify in a batch, referring to the caller's public key,
+     *  signed data and signature, which must outlive the batch.
+     *
+     **/
+    struct FLSignature
+    {
+        /** The public key to verify with. **/
+        const std::vector<uint8_t>& vchPubKey;
+
+
+        /** The signed data. **/
+        const std::vector<uint8_t>& vchData;
+
+
+        /** The signature to check. **/
+        const std::vector<uint8_t>& vchSig;
+
+
+        /** Constructor. **/
+        FLSignature(const std::vector<uint8_t>& vchPubKeyIn, const std::vector<uint8_t>& vchDataIn,
+                    const std::vector<uint8_t>& vchSigIn)
+        : vchPubKey (vchPubKeyIn)
+        , vchData   (vchDataIn)
+        , vchSig    (vchSigIn)
+        {
+        }
+    };
+
 
     /** FLKey
      *
@@ -212,6 +242,19 @@ namespace LLC
         bool Verify(const std::vector<uint8_t>& vchData, const std::vector<uint8_t>& vchSig) const;
 
 
+        /** VerifyMany
+         *
+         *  Verify a batch of signatures, such as those of a block, decoding the
+         *  public key once for consecutive signatures with the same key.
+         *
+         *  @param[in] vSignatures The signatures to verify.
+         *
+         *  @return True if every signature was verified as valid.
+         *
+         **/
+        static bool VerifyMany(const std::vector<FLSignature>& vSignatures);
+
+
         /** IsValid
          *
          *  Check if a Key is valid based on a few parameters.
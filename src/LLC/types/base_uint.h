@@ -47,6 +47,9 @@ protected:
     /* Determine the width in number of words. */
     enum { WIDTH=BITS/32 };
 
+    /* Determine the width in number of 64-bit limbs that arithmetic runs on. */
+    enum { LIMBS=(WIDTH+1)/2 };
+
     /* The 32-bit integer bignum array. */
     uint32_t pn[WIDTH];
 
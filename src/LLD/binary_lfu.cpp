@@ -293,7 +293,7 @@ namespace LLD
 
 
     /*  Add data in the Pool. */
-    void BinaryLFU::Put(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, bool fReserve)
+    void BinaryLFU::Put(const SectorKey& key, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, bool fReserve)
     {
         LOCK(MUTEX);
 
@@ -455,4 +455,15 @@ namespace LLD
 
         return true;
     }
+
+
+    /*  Log the current size of the cache. */
+    void BinaryLFU::Meters(const std::string& strName)
+    {
+        LOCK(MUTEX);
+
+        debug::log(0,
+            ANSI_COLOR_FUNCTION, strName, " LLD : ", ANSI_COLOR_RESET,
+            "LFU Cache ", nCurrentSize, " of ", MAX_CACHE_SIZE, " bytes");
+    }
 }
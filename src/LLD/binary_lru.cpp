@@ -10,6 +10,7 @@
             "ad vocem populi" - To the Voice of the People
 ____________________________________________________________________________________________*/
 
+
 #include <LLD/cache/binary_lru.h>
 #include <LLD/templates/key.h>
 #include <LLD/hash/xxh3.h>
@@ -18,6 +19,11 @@ ________________________________________________________________________________
 #include <Util/include/debug.h>
 #include <Util/include/hex.h>
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
 namespace LLD
 {
     /*  Node to hold the binary data of the double linked list. */
@@ -35,44 +41,277 @@ namespace LLD
         /** The data in the binary node. **/
         std::vector<uint8_t> vData;
 
+        /** Flag for if node is in the protected segment. **/
+        bool fProtected;
+
+        /** Flag for if node is reserved from eviction. **/
+        bool fReserved;
+
         /** Default constructor **/
-        BinaryNode(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vDataIn)
-        : pprev   (nullptr)
-        , pnext   (nullptr)
-        , hashKey (XXH64(&vKey[0], vKey.size(), 0))
-        , vData   (vDataIn)
+        BinaryNode(const uint64_t hashKeyIn, const std::vector<uint8_t>& vDataIn, const bool fReservedIn)
+        : pprev      (nullptr)
+        , pnext      (nullptr)
+        , hashKey    (hashKeyIn)
+        , vData      (vDataIn)
+        , fProtected (false)
+        , fReserved  (fReservedIn)
         {
         }
 
-        /** bucket Node is Assigned to. **/
-        uint32_t Bucket(const uint64_t nBuckets)
+        /** The memory the node accounts for in the cache. **/
+        uint32_t Size() const
         {
-            return static_cast<uint32_t>(hashKey % static_cast<uint64_t>(nBuckets));
+            return static_cast<uint32_t>(vData.size() + sizeof(BinaryNode) + 32);
         }
+    };
 
 
-        /** Erase the data. **/
-        void Erase()
+    /*  Double linked list of binary nodes, most recent at the front. */
+    struct BinaryList
+    {
+        /** Keep track of the first and last object in linked list. **/
+        BinaryNode* pfirst;
+        BinaryNode* plast;
+
+        /** The total memory of the nodes in the list. **/
+        uint32_t nSize;
+
+        BinaryList()
+        : pfirst (nullptr)
+        , plast  (nullptr)
+        , nSize  (0)
         {
-            std::vector<uint8_t>().swap(vData);
         }
 
+        /** Remove a node from the list. **/
+        void Remove(BinaryNode* pthis)
+        {
+            if(pthis->pprev)
+                pthis->pprev->pnext = pthis->pnext;
+            else
+                pfirst = pthis->pnext;
+
+            if(pthis->pnext)
+                pthis->pnext->pprev = pthis->pprev;
+            else
+                plast = pthis->pprev;
+
+            pthis->pprev = nullptr;
+            pthis->pnext = nullptr;
+
+            nSize -= pthis->Size();
+        }
+
+        /** Add a node to the front of the list. **/
+        void PushFront(BinaryNode* pthis)
+        {
+            pthis->pprev = nullptr;
+            pthis->pnext = pfirst;
+
+            if(pfirst)
+                pfirst->pprev = pthis;
+            else
+                plast = pthis;
+
+            pfirst = pthis;
+
+            nSize += pthis->Size();
+        }
+
+        /** Find the least recent node that can be evicted. **/
+        BinaryNode* Victim() const
+        {
+            for(BinaryNode* pnode = plast; pnode; pnode = pnode->pprev)
+                if(!pnode->fReserved)
+                    return pnode;
+
+            return nullptr;
+        }
+    };
+
+
+    /*  Count-min sketch of 4-bit counters to estimate how often keys are accessed. */
+    struct FrequencySketch
+    {
+        /** The counters, two per byte. **/
+        std::vector<uint8_t> vTable;
+
+        /** The mask for the counter index. **/
+        uint64_t nMask;
+
+        /** Increments since the last reset. **/
+        uint64_t nAdditions;
+
+        /** The increments to allow before halving every counter. **/
+        uint64_t nSampleSize;
+
+        FrequencySketch(const uint32_t nEntries)
+        : vTable      ()
+        , nMask       (0)
+        , nAdditions  (0)
+        , nSampleSize (0)
+        {
+            /* Round the width up to a power of two. */
+            uint64_t nWidth = 1024;
+            while(nWidth < nEntries)
+                nWidth <<= 1;
+
+            vTable.resize(nWidth / 2, 0);
+            nMask       = nWidth - 1;
+            nSampleSize = nWidth * 10;
+        }
+
+        /** Get the counter for a given row. **/
+        uint8_t Counter(const uint64_t nIndex) const
+        {
+            return (vTable[nIndex >> 1] >> ((nIndex & 1) << 2)) & 0x0f;
+        }
 
-        /** Check if node is in null state. **/
-        bool IsNull() const
+        /** Get the counter index for a given row. **/
+        uint64_t Index(const uint64_t hashKey, const uint32_t nRow) const
         {
-            return hashKey == 0;
+            return ((hashKey >> (nRow * 16)) ^ (hashKey * (nRow + 1))) & nMask;
         }
 
+        /** Estimate the frequency of a key. **/
+        uint8_t Frequency(const uint64_t hashKey) const
+        {
+            uint8_t nMin = 15;
+            for(uint32_t nRow = 0; nRow < 4; ++nRow)
+                nMin = std::min(nMin, Counter(Index(hashKey, nRow)));
+
+            return nMin;
+        }
 
-        /** Set node into null state. **/
-        void SetNull()
+        /** Record an access to a key. **/
+        void Increment(const uint64_t hashKey)
         {
-            pprev   = nullptr;
-            pnext   = nullptr;
-            hashKey = 0;
+            for(uint32_t nRow = 0; nRow < 4; ++nRow)
+            {
+                const uint64_t nIndex = Index(hashKey, nRow);
+                if(Counter(nIndex) < 15)
+                    vTable[nIndex >> 1] += static_cast<uint8_t>(1 << ((nIndex & 1) << 2));
+            }
 
-            Erase();
+            /* Age the counters so old popularity fades. */
+            if(++nAdditions >= nSampleSize)
+            {
+                for(auto& nByte : vTable)
+                    nByte = (nByte >> 1) & 0x77;
+
+                nAdditions /= 2;
+            }
+        }
+    };
+
+
+    /*  One independently locked partition of the cache. */
+    struct BinaryShard
+    {
+        /** Mutex for thread concurrency. **/
+        std::mutex MUTEX;
+
+        /** The Maximum Size of the shard. **/
+        uint32_t MAX_SHARD_SIZE;
+
+        /** Map of the current holding data. **/
+        std::unordered_map<uint64_t, BinaryNode*> mapNodes;
+
+        /** The probation and protected segments. **/
+        BinaryList listProbation;
+        BinaryList listProtected;
+
+        /** The admission filter. **/
+        FrequencySketch sketch;
+
+        /** Counters for the meters. **/
+        std::atomic<uint64_t> nHits;
+        std::atomic<uint64_t> nMisses;
+        std::atomic<uint64_t> nEvictions;
+        std::atomic<uint64_t> nRejections;
+
+        BinaryShard(const uint32_t nShardSize)
+        : MUTEX          ( )
+        , MAX_SHARD_SIZE (nShardSize)
+        , mapNodes       ( )
+        , listProbation  ( )
+        , listProtected  ( )
+        , sketch         (nShardSize / 128)
+        , nHits          (0)
+        , nMisses        (0)
+        , nEvictions     (0)
+        , nRejections    (0)
+        {
+        }
+
+        ~BinaryShard()
+        {
+            for(auto& item : mapNodes)
+                delete item.second;
+        }
+
+        /** The current size of the shard. **/
+        uint32_t Size() const
+        {
+            return listProbation.nSize + listProtected.nSize;
+        }
+
+        /** The list a node currently belongs to. **/
+        BinaryList& List(const BinaryNode* pthis)
+        {
+            return pthis->fProtected ? listProtected : listProbation;
+        }
+
+        /** Find the next node to evict, probation first. **/
+        BinaryNode* Victim() const
+        {
+            BinaryNode* pnode = listProbation.Victim();
+            if(!pnode)
+                pnode = listProtected.Victim();
+
+            return pnode;
+        }
+
+        /** Record a hit on a node, promoting it to the protected segment. **/
+        void Touch(BinaryNode* pthis)
+        {
+            List(pthis).Remove(pthis);
+
+            pthis->fProtected = true;
+            listProtected.PushFront(pthis);
+
+            /* Keep the protected segment at 80% of the shard, demoting its tail back to probation. */
+            while(listProtected.nSize > (MAX_SHARD_SIZE / 5) * 4 && listProtected.plast && listProtected.plast != pthis)
+            {
+                BinaryNode* pdemote = listProtected.plast;
+                listProtected.Remove(pdemote);
+
+                pdemote->fProtected = false;
+                listProbation.PushFront(pdemote);
+            }
+        }
+
+        /** Remove and delete a node. **/
+        void Erase(BinaryNode* pthis)
+        {
+            List(pthis).Remove(pthis);
+            mapNodes.erase(pthis->hashKey);
+
+            delete pthis;
+        }
+
+        /** Evict nodes until the shard is within its size. **/
+        void Evict()
+        {
+            while(Size() > MAX_SHARD_SIZE)
+            {
+                BinaryNode* pnode = Victim();
+                if(!pnode)
+                    break;
+
+                Erase(pnode);
+                ++nEvictions;
+            }
         }
     };
 
@@ -80,97 +319,64 @@ namespace LLD
     /** Cache Size Constructor **/
     BinaryLRU::BinaryLRU(const uint32_t nCacheSizeIn)
     : MAX_CACHE_SIZE    (nCacheSizeIn)
-    , MAX_CACHE_BUCKETS (nCacheSizeIn / 128)
-    , nCurrentSize      (MAX_CACHE_BUCKETS * 16)
-    , MUTEX             ( )
-    , hashmap           (MAX_CACHE_BUCKETS, nullptr)
-    , indexes           (MAX_CACHE_BUCKETS, 0)
-    , pfirst            (nullptr)
-    , plast             (nullptr)
+    , vShards           ( )
     {
+        /* One shard per 256 kb of cache, up to 64 shards, rounded down to a power of two. */
+        uint32_t nShards = 1;
+        while(nShards < 64 && (nShards << 1) * 256 * 1024 <= MAX_CACHE_SIZE)
+            nShards <<= 1;
+
+        for(uint32_t n = 0; n < nShards; ++n)
+            vShards.push_back(new BinaryShard(MAX_CACHE_SIZE / nShards));
     }
 
 
     /** Class Destructor. **/
     BinaryLRU::~BinaryLRU()
     {
-        LOCK(MUTEX);
-
-        /* Loop through the linked list. */
-        for(auto& item : hashmap)
-            if(item != nullptr)
-                delete item;
+        for(auto& pshard : vShards)
+            delete pshard;
     }
 
 
     /*  Check if data exists. */
     bool BinaryLRU::Has(const std::vector<uint8_t>& vKey) const
     {
-        LOCK(MUTEX);
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
 
-        /* Get the data. */
-        const uint64_t& nIndex  = indexes[bucket(vKey)];
-        if(nIndex == 0)
-            return false;
+        BinaryShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
 
-        /* Check if the Record Exists. */
-        const BinaryNode* pthis = hashmap[slot(nIndex)];
-        if(pthis == nullptr)
-            return false;
-
-        /* Check for null state. */
-        if(pthis->IsNull())
-            return false;
-
-        /* Check the data is expected. */
-        return (pthis->hashKey == XXH64(&vKey[0], vKey.size(), 0));
-    }
-
-
-    /*  Find a bucket for cache key management. */
-    uint32_t BinaryLRU::bucket(const std::vector<uint8_t>& vKey) const
-    {
-        /* Get an xxHash. */
-        uint64_t nBucket = XXH64(&vKey[0], vKey.size(), 0);
-
-        return static_cast<uint32_t>(nBucket % static_cast<uint64_t>(MAX_CACHE_BUCKETS));
+        return pshard->mapNodes.count(hashKey) > 0;
     }
 
 
     /*  Get the data by index */
     bool BinaryLRU::Get(const std::vector<uint8_t>& vKey, std::vector<uint8_t>& vData)
     {
-        LOCK(MUTEX);
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
 
-        /* Check for data. */
-        uint64_t& nIndex  = indexes[bucket(vKey)];
-        if(nIndex == 0)
-            return false;
+        BinaryShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
 
-        /* Get the binary node. */
-        BinaryNode* pthis = hashmap[slot(nIndex)];
-        if(pthis == nullptr)
-        {
-            nIndex = 0; //reset by reference
-            return false;
-        }
+        /* Record the access for admission, hit or miss. */
+        pshard->sketch.Increment(hashKey);
 
-        /* Check for null state. */
-        if(pthis->IsNull())
+        /* Check for data. */
+        auto it = pshard->mapNodes.find(hashKey);
+        if(it == pshard->mapNodes.end())
         {
-            nIndex = 0; //reset by reference
+            ++pshard->nMisses;
             return false;
         }
 
-        /* Check the keys are correct. */
-        if(pthis->hashKey != XXH64(&vKey[0], vKey.size(), 0))
-            return false;
-
         /* Get the data. */
+        BinaryNode* pthis = it->second;
         vData = pthis->vData;
 
-        /* Move to front of double linked list. */
-        move_to_front(pthis);
+        /* Move to front of the protected segment. */
+        pshard->Touch(pthis);
+        ++pshard->nHits;
 
         return true;
     }
@@ -179,199 +385,127 @@ namespace LLD
     /*  Add data in the Pool. */
     void BinaryLRU::Put(const SectorKey& key, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, bool fReserve)
     {
-        LOCK(MUTEX);
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
+
+        BinaryShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
 
-        /* Get the binary node. */
-        uint64_t& nIndex = indexes[bucket(vKey)];
-        if(nIndex != 0)
+        /* Replace the data in place if the key is already cached, so it never goes stale. */
+        auto it = pshard->mapNodes.find(hashKey);
+        if(it != pshard->mapNodes.end())
         {
-            /* Get the node from checksum. */
-            uint32_t nSlot    = slot(nIndex);
-            BinaryNode* pthis = hashmap[nSlot];
+            BinaryNode* pthis = it->second;
+            BinaryList& list  = pshard->List(pthis);
 
-            /* Check for dereferencing nullptr. */
-            if(pthis != nullptr && !pthis->IsNull())
-            {
-                /* Reduce the current size. */
-                nCurrentSize -= static_cast<uint32_t>(pthis->vData.size());
+            list.nSize     -= pthis->Size();
+            pthis->vData    = vData;
+            pthis->fReserved = pthis->fReserved || fReserve;
+            list.nSize     += pthis->Size();
 
-                /* Free the memory. */
-                remove_node(pthis);
-                pthis->SetNull();
-            }
+            pshard->Evict();
+            return;
         }
 
-        /* Update index hashmap through reference: NOTE nSectorFile and nSectorStart are 0-based so we add 1 to it to ensure we always have an index */
-        nIndex = ((key.nSectorFile + 1) * (key.nSectorStart + 1));
+        /* Writes count towards frequency, reads were counted on their miss. */
+        if(fReserve)
+            pshard->sketch.Increment(hashKey);
 
-        /* Cleanup if colliding with another bucket. */
-        uint32_t nSlot = slot(nIndex);
-        if(hashmap[nSlot] != nullptr)
+        /* Check the admission filter if this would push out another node. */
+        BinaryNode* pthis = new BinaryNode(hashKey, vData, fReserve);
+        if(!fReserve && pshard->Size() + pthis->Size() > pshard->MAX_SHARD_SIZE)
         {
-            /* Claiming an empty hashmap slot. */
-            if(!hashmap[nSlot]->IsNull())
+            /* Only admit keys accessed more often than the node they would replace. */
+            BinaryNode* pvictim = pshard->Victim();
+            if(pvictim && pshard->sketch.Frequency(hashKey) <= pshard->sketch.Frequency(pvictim->hashKey))
             {
-                /* Erase data on collision. */
-                nCurrentSize -= static_cast<uint32_t>(hashmap[nSlot]->vData.size());
-                hashmap[nSlot]->Erase();
-            }
-
-            /* Set new values. */
-            hashmap[nSlot]->hashKey = XXH64(&vKey[0], vKey.size(), 0);
-            hashmap[nSlot]->vData   = vData;
+                delete pthis;
+                ++pshard->nRejections;
 
-            /* Move to front of list. */
-            move_to_front(hashmap[nSlot]);
-        }
-        else
-        {
-            /* Add cache node to objects map. */
-            hashmap[nSlot] = new BinaryNode(vKey, vData);;
-            move_to_front(hashmap[nSlot]);
-
-            /* Account for the node's memory size. */
-            nCurrentSize += sizeof(*hashmap[nSlot]);
+                return;
+            }
         }
 
-        /* Remove the last node if cache too large. */
-        while(nCurrentSize > MAX_CACHE_SIZE)
-        {
-            /* Get last pointer. */
-            BinaryNode* pnode = plast;
-            if(!pnode || pnode->IsNull())
-                break;
-
-            /* Set the new links. */
-            plast = plast->pprev;
-            if (plast)
-                plast->pnext = nullptr;
-
-            /* Reset the memory linking. */
-            pnode->pprev = nullptr;
-            pnode->pnext = nullptr;
-
-            /* Reduce memory size. */
-            nCurrentSize -= static_cast<uint32_t>(pnode->vData.size());
-
-            /* Calculate the buckets for the node being deleted */
-            uint32_t  nBucket = pnode->Bucket(MAX_CACHE_BUCKETS);
-            uint64_t& nRemove = indexes[nBucket];
-
-            /* Reset the slot. */
-            hashmap[slot(nRemove)]->SetNull();
-            nRemove                = 0;
-        }
+        /* Add cache node to the probation segment. */
+        pshard->mapNodes[hashKey] = pthis;
+        pshard->listProbation.PushFront(pthis);
 
-        nCurrentSize += static_cast<uint32_t>(vData.size());
+        /* Remove the last nodes if cache too large. */
+        pshard->Evict();
     }
 
 
     /*  Reserve this item in the cache permanently if true, unreserve if false. */
     void BinaryLRU::Reserve(const std::vector<uint8_t>& vKey, bool fReserve)
     {
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
+
+        BinaryShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
+
+        /* Set the reserved flag. */
+        auto it = pshard->mapNodes.find(hashKey);
+        if(it == pshard->mapNodes.end())
+            return;
+
+        it->second->fReserved = fReserve;
+
+        /* Evict anything that was held over the size by reserved nodes. */
+        if(!fReserve)
+            pshard->Evict();
     }
 
 
     /*  Force Remove Object by Index. */
     bool BinaryLRU::Remove(const std::vector<uint8_t>& vKey)
     {
-        LOCK(MUTEX);
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
 
-        /* Get the data. */
-        uint64_t& nIndex = indexes[bucket(vKey)];
-        if(nIndex == 0)
-            return false;
+        BinaryShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
 
-        /* Get the binary node. */
-        uint32_t nSlot = slot(nIndex);
-        if(hashmap[nSlot] == nullptr)
-        {
-            nIndex = 0; //reset by reference
+        /* Get the data. */
+        auto it = pshard->mapNodes.find(hashKey);
+        if(it == pshard->mapNodes.end())
             return false;
-        }
-
-        /* Remove from the linked list. */
-        BinaryNode* pthis = hashmap[nSlot];
-        remove_node(pthis);
-
-        /* Set to null state. */
-        hashmap[nSlot]->SetNull();
 
         /* Free the memory. */
-        nCurrentSize  -= static_cast<uint32_t>(pthis->vData.size() + 48);
-        nIndex         = 0; //reset by reference
+        pshard->Erase(it->second);
 
         return true;
     }
 
 
-    /*  Find a bucket for checksum key management. */
-    uint32_t BinaryLRU::slot(const uint64_t nIndex) const
-    {
-        return static_cast<uint32_t>(nIndex % static_cast<uint64_t>(MAX_CACHE_BUCKETS));
-    }
-
-
-    /*  Remove a node from the double linked list. */
-    void BinaryLRU::remove_node(BinaryNode* pthis)
+    /*  Log and reset the hit, miss, eviction, and rejection counters. */
+    void BinaryLRU::Meters(const std::string& strName)
     {
-        /* Relink last pointer. */
-        if(pthis == plast)
+        for(uint32_t n = 0; n < vShards.size(); ++n)
         {
-            plast = plast->pprev;
-            if(plast)
-                plast->pnext = nullptr;
+            BinaryShard* pshard = vShards[n];
+
+            /* Get and reset the counters. */
+            const uint64_t nHits       = pshard->nHits.exchange(0);
+            const uint64_t nMisses     = pshard->nMisses.exchange(0);
+            const uint64_t nEvictions  = pshard->nEvictions.exchange(0);
+            const uint64_t nRejections = pshard->nRejections.exchange(0);
+
+            /* Skip idle shards. */
+            if(nHits + nMisses + nEvictions + nRejections == 0)
+                continue;
+
+            debug::log(0,
+                ANSI_COLOR_FUNCTION, strName, " LRU shard ", n, " : ", ANSI_COLOR_RESET,
+                "Hits ", nHits, " | ",
+                "Misses ", nMisses, " | ",
+                "Evictions ", nEvictions, " | ",
+                "Rejections ", nRejections);
         }
-
-        /* Relink first pointer. */
-        if(pthis == pfirst)
-        {
-            pfirst = pfirst->pnext;
-            if(pfirst)
-                pfirst->pprev = nullptr;
-        }
-
-        /* Link the next pointer if not null */
-        if (pthis->pnext)
-            pthis->pnext->pprev = pthis->pprev;
-
-        /* Link the previous pointer if not null. */
-        if (pthis->pprev)
-            pthis->pprev->pnext = pthis->pnext;
-
-        /* Unlink next and prev. */
-        pthis->pnext = nullptr;
-        pthis->pprev = nullptr;
     }
 
 
-    /*  Move the node in double linked list to front. */
-    void BinaryLRU::move_to_front(BinaryNode* pthis)
+    /*  Find the shard that holds a key. */
+    BinaryShard* BinaryLRU::shard(const uint64_t hashKey) const
     {
-        /* Don't move to front if already in the front. */
-        if(pthis == pfirst)
-            return;
-
-        /* Move last pointer if moving from back. */
-        remove_node(pthis);
-
-        /* Link to front. */
-        pthis->pprev = nullptr;
-        pthis->pnext = pfirst;
-
-        /* Update the first reference prev */
-        if(pfirst)
-        {
-            /* Set last for second iteration. */
-            pfirst->pprev = pthis;
-            if(!plast)
-            {
-                plast = pfirst;
-                plast->pnext = nullptr;
-            }
-        }
-
-        /* Update the first reference. */
-        pfirst        = pthis;
+        /* Use the high bits so shards are independent of the map buckets. */
+        return vShards[(hashKey >> 48) & (vShards.size() - 1)];
     }
 }
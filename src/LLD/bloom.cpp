@@ -0,0 +1,192 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/bloom.h>
+#include <LLD/templates/randomfile.h>
+#include <LLD/hash/xxh3.h>
+
+#include <Util/include/filesystem.h>
+#include <Util/include/mutex.h>
+#include <Util/include/debug.h>
+
+#include <algorithm>
+
+namespace LLD
+{
+
+    /* Capacity Constructor. */
+    BloomFilter::BloomFilter(const uint64_t nKeys)
+    : FILE_MUTEX ( )
+    , vWords     (std::max(uint64_t(1), (nKeys * BITS_PER_KEY) / 64))
+    , pstream    (nullptr)
+    , strPath    ( )
+    {
+        for(auto& nWord : vWords)
+            nWord.store(0);
+    }
+
+
+    /* Default Destructor. */
+    BloomFilter::~BloomFilter()
+    {
+        if(pstream)
+            delete pstream;
+    }
+
+
+    /* Load the filter from disk and keep the file open for writes. */
+    bool BloomFilter::Load(const std::string& strFile)
+    {
+        /* Check the filter exists. */
+        if(!filesystem::exists(strFile))
+            return false;
+
+        /* Open the filter file. */
+        std::fstream* pfile = new std::fstream(strFile, std::ios::in | std::ios::out | std::ios::binary);
+        if(!pfile->is_open())
+        {
+            delete pfile;
+            return false;
+        }
+
+        /* Read the filter words. */
+        std::vector<uint64_t> vRead(vWords.size(), 0);
+        if(!pfile->read((char*)&vRead[0], vRead.size() * 8) || pfile->peek() != EOF)
+        {
+            delete pfile;
+            return debug::error(FUNCTION, "filter ", strFile, " has incorrect size");
+        }
+        pfile->clear();
+
+        /* Set the words in memory. */
+        for(uint64_t n = 0; n < vRead.size(); ++n)
+            vWords[n].store(vRead[n]);
+
+        /* Swap in the new file stream. */
+        LOCK(FILE_MUTEX);
+        if(pstream)
+            delete pstream;
+
+        pstream = pfile;
+        strPath = strFile;
+
+        return true;
+    }
+
+
+    /* Write the current filter to a new file and keep it open for writes. */
+    bool BloomFilter::Create(const std::string& strFile)
+    {
+        /* Copy out the current words. */
+        std::vector<uint64_t> vWrite(vWords.size(), 0);
+        for(uint64_t n = 0; n < vWrite.size(); ++n)
+            vWrite[n] = vWords[n].load();
+
+        /* Write the new filter file. */
+        {
+            std::ofstream stream(strFile, std::ios::out | std::ios::binary | std::ios::trunc);
+            if(!stream.write((char*)&vWrite[0], vWrite.size() * 8))
+                return debug::error(FUNCTION, "failed to write filter ", strFile);
+        }
+
+        /* Open the filter for writing. */
+        std::fstream* pfile = new std::fstream(strFile, std::ios::in | std::ios::out | std::ios::binary);
+        if(!pfile->is_open())
+        {
+            delete pfile;
+            return debug::error(FUNCTION, "failed to open filter ", strFile);
+        }
+
+        /* Swap in the new file stream. */
+        LOCK(FILE_MUTEX);
+        if(pstream)
+            delete pstream;
+
+        pstream = pfile;
+        strPath = strFile;
+
+        return true;
+    }
+
+
+    /* Add a key to the filter, writing the changed word through to disk. */
+    void BloomFilter::Insert(const uint8_t* pKey, const uint64_t nSize)
+    {
+        /* Get the slot and bits for this key. */
+        uint64_t nMask  = 0;
+        uint64_t nIndex = slot(pKey, nSize, nMask);
+
+        /* Set the bits under the file lock so a set bit is always a persisted bit. */
+        LOCK(FILE_MUTEX);
+
+        /* Skip the disk write if the bits were already set. */
+        const uint64_t nPrev = vWords[nIndex].fetch_or(nMask);
+        if(!pstream || (nPrev & nMask) == nMask)
+            return;
+
+        /* Get the new value of the word. */
+        const uint64_t nWord = nPrev | nMask;
+
+        /* Write the word through to disk. */
+        pstream->seekp(nIndex * 8, std::ios::beg);
+        pstream->write((char*)&nWord, 8);
+        pstream->flush();
+    }
+
+
+    /* Sync the filter file to disk. */
+    bool BloomFilter::Sync()
+    {
+        LOCK(FILE_MUTEX);
+
+        /* Filters that were never persisted have nothing to sync. */
+        if(!pstream)
+            return true;
+
+        /* Flush the stream and sync the file. */
+        pstream->flush();
+
+        RandomAccessFile file(strPath);
+        if(file.IsNull() || !file.Sync())
+            return debug::error(FUNCTION, "failed to sync filter ", strPath);
+
+        return true;
+    }
+
+
+    /* Check if a key may be in the filter. */
+    bool BloomFilter::Has(const uint8_t* pKey, const uint64_t nSize) const
+    {
+        /* Get the slot and bits for this key. */
+        uint64_t nMask  = 0;
+        uint64_t nIndex = slot(pKey, nSize, nMask);
+
+        return (vWords[nIndex].load(std::memory_order_relaxed) & nMask) == nMask;
+    }
+
+
+    /* Calculate the word and bit mask for a key. */
+    uint64_t BloomFilter::slot(const uint8_t* pKey, const uint64_t nSize, uint64_t& nMask) const
+    {
+        /* Use a different seed than the hashmap buckets to keep the filter independent. */
+        uint64_t nHash = XXH3_64bits_withSeed(pKey, nSize, 0x626c6f6f6d);
+
+        /* Four bits inside the word, selected by the low 24 bits of the hash. */
+        nMask = (uint64_t(1) << (nHash & 63))
+              | (uint64_t(1) << ((nHash >> 6)  & 63))
+              | (uint64_t(1) << ((nHash >> 12) & 63))
+              | (uint64_t(1) << ((nHash >> 18) & 63));
+
+        return (nHash >> 32) % vWords.size();
+    }
+}
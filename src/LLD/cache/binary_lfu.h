@@ -16,6 +16,7 @@ ________________________________________________________________________________
 
 #include <mutex>
 #include <cstdint>
+#include <string>
 #include <vector>
 
 
@@ -23,6 +24,10 @@ ________________________________________________________________________________
 namespace LLD
 {
 
+    /** Forward declarations. **/
+    class SectorKey;
+
+
     /** BinaryNode
      *
      *  Node to hold the binary data of the double linked list.
@@ -188,12 +193,13 @@ namespace LLD
          *
          *  Add data in the Pool
          *
+         *  @param[in] key The sector key of the record, unused by this cache.
          *  @param[in] vKey The key in binary form.
          *  @param[in] vData The input data in binary form.
          *  @param[in] fReserve Flag for if item should be saved from cache eviction.
          *
          **/
-        void Put(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, bool fReserve = false);
+        void Put(const SectorKey& key, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, bool fReserve = false);
 
 
         /** Reserve
@@ -217,6 +223,16 @@ namespace LLD
          *
          **/
         bool Remove(const std::vector<uint8_t>& vKey);
+
+
+        /** Meters
+         *
+         *  Log the current size of the cache.
+         *
+         *  @param[in] strName The name of the database for output.
+         *
+         **/
+        void Meters(const std::string& strName);
     };
 }
 
@@ -14,8 +14,8 @@ ________________________________________________________________________________
 #ifndef NEXUS_LLD_CACHE_BINARY_LRU_H
 #define NEXUS_LLD_CACHE_BINARY_LRU_H
 
-#include <mutex>
 #include <cstdint>
+#include <string>
 #include <vector>
 
 
@@ -33,12 +33,27 @@ namespace LLD
     struct BinaryNode;
 
 
+    /** BinaryShard
+     *
+     *  One independently locked partition of the cache.
+     *
+     **/
+    struct BinaryShard;
+
+
     /** BinaryLRU
     *
     *   LRU - Least Recently Used.
     *   This class is responsible for holding data that is partially processed.
     *   This class has no types, all objects are in binary forms.
     *
+    *   The cache is split into shards by key hash, each with its own lock, so
+    *   readers of different keys don't contend. Each shard is a segmented LRU:
+    *   new keys enter a probation list and move to a protected list on their
+    *   second hit. A TinyLFU style frequency sketch decides whether a new key
+    *   is worth evicting the probation tail for, so one-off scans don't flush
+    *   hot records.
+    *
     **/
     class BinaryLRU
     {
@@ -46,32 +61,8 @@ namespace LLD
         uint32_t MAX_CACHE_SIZE;
 
 
-        /* The total buckets available. */
-        uint32_t MAX_CACHE_BUCKETS;
-
-
-        /* The current size of the pool. */
-        uint32_t nCurrentSize;
-
-
-        /* Mutex for thread concurrency. */
-        mutable std::mutex MUTEX;
-
-
-        /* Map of the current holding data. */
-        std::vector<BinaryNode*> hashmap;
-
-
-        /* Map of the current data indexes. */
-        std::vector<uint64_t> indexes;
-
-
-        /* Keep track of the first object in linked list. */
-        BinaryNode* pfirst;
-
-
-        /* Keep track of the last object in linked list. */
-        BinaryNode* plast;
+        /* The shards of the cache. */
+        std::vector<BinaryShard*> vShards;
 
 
     public:
@@ -169,46 +160,26 @@ namespace LLD
         bool Remove(const std::vector<uint8_t>& vKey);
 
 
-    private:
-
-        /** RemoveNode
-         *
-         *  Remove a node from the double linked list.
-         *
-         *  @param[in] pthis The node to remove from list.
-         *
-         **/
-        void remove_node(BinaryNode* pthis);
-
-
-        /** MoveToFront
+        /** Meters
          *
-         *  Move the node in double linked list to front.
+         *  Log and reset the hit, miss, eviction, and rejection counters.
          *
-         *  @param[in] pthis The node to move to front.
+         *  @param[in] strName The name of the database for output.
          *
          **/
-        void move_to_front(BinaryNode* pthis);
+        void Meters(const std::string& strName);
 
 
-        /** Bucket
-         *
-         *  Find a bucket for cache key management.
-         *
-         *  @param[in] vKey The key to get bucket for.
-         *
-         **/
-        uint32_t bucket(const std::vector<uint8_t>& vKey) const;
-
+    private:
 
-        /** Bucket
+        /** Shard
          *
-         *  Find a bucket for checksum key management.
+         *  Find the shard that holds a key.
          *
-         *  @param[in] nIndex The checksum to get bucket for.
+         *  @param[in] hashKey The 64-bit hash of the key.
          *
          **/
-        uint32_t slot(const uint64_t nIndex) const;
+        BinaryShard* shard(const uint64_t hashKey) const;
     };
 }
 
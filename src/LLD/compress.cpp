@@ -0,0 +1,91 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/compress.h>
+#include <LLD/include/version.h>
+#include <LLD/compress/lz4.h>
+
+#include <Util/templates/datastream.h>
+#include <Util/include/debug.h>
+
+namespace LLD
+{
+
+    /* LZ4 compress a record into its stored form. */
+    bool Compress(const std::vector<uint8_t>& vData, std::vector<uint8_t>& vStored, const uint32_t nMinSize)
+    {
+        /* Small records don't compress well enough to pay for the header, and the raw size must deserialize. */
+        if(vData.size() < nMinSize || vData.size() > MAX_SIZE)
+            return false;
+
+        /* Write the marker and the raw size. */
+        DataStream ssHeader(SER_LLD, DATABASE_VERSION);
+        ssHeader << RECORD_COMPRESSED;
+        WriteCompactSize(ssHeader, vData.size());
+
+        /* Compress after the header. */
+        const uint32_t nHeader = static_cast<uint32_t>(ssHeader.size());
+        const int32_t  nBound  = LZ4_compressBound(static_cast<int32_t>(vData.size()));
+
+        vStored.resize(nHeader + nBound);
+        std::copy(ssHeader.Bytes().begin(), ssHeader.Bytes().end(), vStored.begin());
+
+        const int32_t nCompressed = LZ4_compress_default((const char*)&vData[0], (char*)&vStored[nHeader],
+                                                         static_cast<int32_t>(vData.size()), nBound);
+
+        /* Keep the raw record if it didn't get smaller. */
+        if(nCompressed <= 0 || nHeader + nCompressed >= vData.size())
+            return false;
+
+        vStored.resize(nHeader + nCompressed);
+
+        return true;
+    }
+
+
+    /* Decompress a stored record in place. */
+    bool Decompress(std::vector<uint8_t>& vData)
+    {
+        /* Raw records are returned as they are. */
+        if(vData.empty() || vData[0] != RECORD_COMPRESSED)
+            return true;
+
+        /* Read the raw size after the marker. */
+        uint64_t nSize = 0;
+        uint32_t nHeader = 0;
+        try
+        {
+            const DataStream ssHeader(vData, SER_LLD, DATABASE_VERSION);
+            ssHeader.SetPos(1);
+
+            nSize   = ReadCompactSize(ssHeader);
+            nHeader = static_cast<uint32_t>(ssHeader.GetPos());
+        }
+        catch(const std::exception& e)
+        {
+            return debug::error(FUNCTION, "malformed compressed record: ", e.what());
+        }
+
+        /* Decompress into the raw record. */
+        std::vector<uint8_t> vRaw(nSize);
+        const int32_t nRaw = LZ4_decompress_safe((const char*)&vData[nHeader], (char*)&vRaw[0],
+                                                 static_cast<int32_t>(vData.size() - nHeader), static_cast<int32_t>(vRaw.size()));
+
+        if(nRaw < 0 || static_cast<uint64_t>(nRaw) != nSize)
+            return debug::error(FUNCTION, "corrupted compressed record of ", nSize, " bytes");
+
+        vData.swap(vRaw);
+
+        return true;
+    }
+}
@@ -12,9 +12,21 @@
 ____________________________________________________________________________________________*/
 
 #include <LLD/include/global.h>
+#include <LLD/include/snapshot.h>
+
+#include <LLD/templates/wal.h>
+#include <LLD/include/version.h>
 
 #include <TAO/Ledger/include/enum.h> //for internal flags
 
+#include <Util/include/filesystem.h>
+#include <Util/include/thread_pool.h>
+
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <tuple>
+
 namespace LLD
 {
     /* The LLD global instance pointers. */
@@ -29,11 +41,214 @@ namespace LLD
     LegacyDB*     Legacy;
 
 
+    /* Mutex for opening the transaction coordinator objects. */
+    std::mutex COORDINATOR_MUTEX;
+
+
+    /* The shared journal for global transactions. */
+    WriteAheadLog* pJournal = nullptr;
+
+
+    /* Flag for a failed commit that left the shared journal for recovery. */
+    bool fRecover = false;
+
+
+    /* The worker pool for committing databases in parallel. */
+    thread_pool* pCommitPool = nullptr;
+
+
+    /* Get the shared journal, opening it on first use. */
+    WriteAheadLog* GetJournal()
+    {
+        LOCK(COORDINATOR_MUTEX);
+
+        if(!pJournal)
+            pJournal = new WriteAheadLog(debug::safe_printstr(config::GetDataDir(), "journal.wal"));
+
+        return pJournal;
+    }
+
+
+    /* Get the commit pool, starting it on first use. */
+    thread_pool* GetCommitPool()
+    {
+        LOCK(COORDINATOR_MUTEX);
+
+        if(!pCommitPool)
+            pCommitPool = new thread_pool(static_cast<uint32_t>(config::GetArg("-lldcommitthreads", 4)));
+
+        return pCommitPool;
+    }
+
+
+    /* Get the databases that take part in global transactions, in commit order. */
+    std::vector< SectorDatabase<Keychain, BinaryLRU>* > GetParticipants()
+    {
+        std::vector< SectorDatabase<Keychain, BinaryLRU>* > vDatabases;
+
+        if(Contract)
+            vDatabases.push_back(Contract);
+
+        if(Register)
+            vDatabases.push_back(Register);
+
+        if(Ledger)
+            vDatabases.push_back(Ledger);
+
+        if(Local)
+            vDatabases.push_back(Local);
+
+        if(Client)
+            vDatabases.push_back(Client);
+
+        if(Trust)
+            vDatabases.push_back(Trust);
+
+        if(Legacy)
+            vDatabases.push_back(Legacy);
+
+        return vDatabases;
+    }
+
+
+    /* A record of a journal, as its opcode, key and data. */
+    typedef std::tuple<uint8_t, std::vector<uint8_t>, std::vector<uint8_t>> JournalRecord;
+
+
+    /* Read the string tagged records of a per database journal, false if it never reached its commit. */
+    bool ReadLegacyJournal(const std::vector<uint8_t>& vBuffer, std::vector<JournalRecord>& vRecords)
+    {
+        try
+        {
+            const DataStream ssJournal(vBuffer, SER_LLD, DATABASE_VERSION);
+            while(!ssJournal.End())
+            {
+                /* Read the data entry type. */
+                std::string strType;
+                ssJournal >> strType;
+
+                std::vector<uint8_t> vKey, vData;
+                if(strType == "erase")
+                {
+                    ssJournal >> vKey;
+                    vRecords.push_back(JournalRecord(JOURNAL::ERASE, vKey, vData));
+                }
+                else if(strType == "key")
+                {
+                    ssJournal >> vKey;
+                    vRecords.push_back(JournalRecord(JOURNAL::KEY, vKey, vData));
+                }
+                else if(strType == "write")
+                {
+                    ssJournal >> vKey >> vData;
+                    vRecords.push_back(JournalRecord(JOURNAL::WRITE, vKey, vData));
+                }
+                else if(strType == "index")
+                {
+                    ssJournal >> vKey >> vData;
+                    vRecords.push_back(JournalRecord(JOURNAL::INDEX, vKey, vData));
+                }
+                else if(strType == "commit")
+                    return true;
+                else
+                    return debug::error(FUNCTION, "unknown journal entry ", strType);
+            }
+        }
+        catch(const std::exception& e)
+        {
+            return debug::error(FUNCTION, "torn journal: ", e.what());
+        }
+
+        return false;
+    }
+
+
+    /* Replay the per database journals left by releases before the shared journal. */
+    void TxnRecoveryLegacy()
+    {
+        /* Read the journals that are left, the old recovery only committed if every database reached its commit. */
+        bool fComplete = true;
+        uint64_t nBytes = 0;
+        std::vector<std::string> vFiles;
+        std::vector< std::pair<SectorDatabase<Keychain, BinaryLRU>*, std::vector<JournalRecord>> > vRecover;
+        for(auto& pdb : GetParticipants())
+        {
+            const std::string strFile = debug::safe_printstr(config::GetDataDir(), pdb->GetName(), "/journal.dat");
+            if(!filesystem::exists(strFile))
+            {
+                fComplete = false;
+                continue;
+            }
+
+            vFiles.push_back(strFile);
+
+            /* Read the whole journal. */
+            std::ifstream stream(strFile, std::ios::in | std::ios::binary);
+            const std::vector<uint8_t> vBuffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            stream.close();
+
+            nBytes += vBuffer.size();
+
+            std::vector<JournalRecord> vRecords;
+            if(vBuffer.empty() || !ReadLegacyJournal(vBuffer, vRecords))
+                fComplete = false;
+
+            vRecover.push_back(std::make_pair(pdb, vRecords));
+        }
+
+        /* Check for journals left by an older release. */
+        if(vFiles.empty())
+            return;
+
+        /* Commit the transactions in the legacy journals if they all reached their commit. */
+        if(nBytes > 0)
+        {
+            debug::log(0, FUNCTION, "legacy transaction journals detected of ", nBytes, " bytes");
+
+            if(fComplete)
+            {
+                for(auto& recover : vRecover)
+                {
+                    recover.first->TxnBegin();
+                    for(const auto& record : recover.second)
+                        recover.first->TxnRecord(std::get<0>(record), std::get<1>(record), std::get<2>(record));
+
+                    const bool fCommitted = recover.first->TxnCommit() && recover.first->Sync();
+                    recover.first->TxnRelease();
+
+                    /* Keep the journals so the next start can retry the recovery. */
+                    if(!fCommitted)
+                    {
+                        debug::error(FUNCTION, recover.first->GetName(), " failed to recover legacy transaction... keeping legacy journals");
+                        return;
+                    }
+                }
+
+                debug::log(0, FUNCTION, "legacy transaction recovered");
+            }
+            else
+                debug::error(FUNCTION, "legacy transaction journals never reached commit on every database... dropping them");
+        }
+
+        /* Remove the legacy journals, the shared journal replaces them. */
+        for(const auto& strFile : vFiles)
+            filesystem::remove(strFile);
+
+        debug::log(0, FUNCTION, "removed ", vFiles.size(), " legacy transaction journals");
+    }
+
+
     /*  Initialize the global LLD instances. */
     void Initialize()
     {
         debug::log(0, FUNCTION, "Initializing LLD");
 
+        /* Enable memory mapped reads for the large read-heavy databases. */
+        uint8_t nMapFlags = config::GetBoolArg("-lldmmap", false) ? FLAGS::MMAP : 0;
+
+        /* Enable record compression for the large databases, whose records are mostly serialized objects. */
+        uint8_t nCompressFlags = config::GetBoolArg("-lldcompress", false) ? FLAGS::COMPRESS : 0;
+
         /* Create the contract database instance. */
         Contract = new ContractDB(
                         FLAGS::CREATE | FLAGS::FORCE);
@@ -41,14 +256,14 @@ namespace LLD
         /* Create the contract database instance. */
         uint32_t nRegisterCacheSize = config::GetArg("-registercache", 2);
         Register = new RegisterDB(
-                        FLAGS::CREATE | FLAGS::FORCE,
+                        FLAGS::CREATE | FLAGS::FORCE | nMapFlags | nCompressFlags,
                         77773,
                         nRegisterCacheSize * 1024 * 1024);
 
         /* Create the ledger database instance. */
         uint32_t nLedgerCacheSize = config::GetArg("-ledgercache", 2);
         Ledger    = new LedgerDB(
-                        FLAGS::CREATE | FLAGS::FORCE,
+                        FLAGS::CREATE | FLAGS::FORCE | nMapFlags | nCompressFlags,
                         config::fClient.load() ? 77773 : (256 * 256 * 64),
                         nLedgerCacheSize * 1024 * 1024);
 
@@ -56,7 +271,7 @@ namespace LLD
         /* Create the legacy database instance. */
         uint32_t nLegacyCacheSize = config::GetArg("-legacycache", 1);
         Legacy = new LegacyDB(
-                        FLAGS::CREATE | FLAGS::FORCE,
+                        FLAGS::CREATE | FLAGS::FORCE | nMapFlags | nCompressFlags,
                         config::fClient.load() ? 77773 : 256 * 256 * 64,
                         nLegacyCacheSize * 1024 * 1024);
 
@@ -142,79 +357,119 @@ namespace LLD
             debug::log(2, FUNCTION, "Shutting down TrustDB");
             delete Trust;
         }
+
+
+        /* Cleanup the transaction coordinator. */
+        LOCK(COORDINATOR_MUTEX);
+        if(pCommitPool)
+        {
+            delete pCommitPool;
+            pCommitPool = nullptr;
+        }
+
+        if(pJournal)
+        {
+            delete pJournal;
+            pJournal = nullptr;
+        }
     }
 
 
     /* Check the transactions for recovery. */
     void TxnRecovery()
     {
-        /* Flag to determine if there are any failures. */
-        bool fRecovery = true;
-
-        /* Check the contract DB journal. */
-        if(Contract && !Contract->TxnRecovery())
-            fRecovery = false;
-
-        /* Check the register DB journal. */
-        if(Register && !Register->TxnRecovery())
-            fRecovery = false;
-
-        /* Check the ledger DB journal. */
-        if(Ledger && !Ledger->TxnRecovery())
-            fRecovery = false;
-
-        /* Check the local DB journal. */
-        if(Local && !Local->TxnRecovery())
-            fRecovery = false;
+        /* Journals left by an older release come before anything in the shared journal. */
+        TxnRecoveryLegacy();
 
-        /* Check the client DB journal. */
-        if(Client && !Client->TxnRecovery())
-            fRecovery = false;
+        /* Check the shared journal size for 0. */
+        WriteAheadLog* pjournal = GetJournal();
+        const uint64_t nSize = pjournal->Size();
+        if(nSize == 0)
+            return;
 
-        /* Check the ledger DB journal. */
-        if(Trust && !Trust->TxnRecovery())
-            fRecovery = false;
+        debug::log(0, FUNCTION, "transaction journal detected of ", nSize, " bytes");
 
-        /* Check the ledger DB journal. */
-        if(Legacy && !Legacy->TxnRecovery())
-            fRecovery = false;
+        /* Find the databases by name. */
+        std::map<std::string, SectorDatabase<Keychain, BinaryLRU>*> mapDatabases;
+        for(auto& pdb : GetParticipants())
+            mapDatabases[pdb->GetName()] = pdb;
 
-        /* Commit the transactions if journals are recovered. */
-        if(fRecovery)
+        /* Replay every complete transaction in order, a journal kept by a failed commit is followed by the later ones. */
+        bool fFailed = false;
+        uint32_t nRecovered = 0;
+        SectorDatabase<Keychain, BinaryLRU>* pdb = nullptr;
+        std::vector< SectorDatabase<Keychain, BinaryLRU>* > vRecover;
+        pjournal->Replay([&](const uint8_t nOpcode, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData)
         {
-            debug::log(0, FUNCTION, "all transactions are complete, recovering...");
-
-            /* Commit contract DB transaction. */
-            if(Contract)
-                Contract->TxnCommit();
-
-            /* Commit register DB transaction. */
-            if(Register)
-                Register->TxnCommit();
-
-            /* Commit ledger DB transaction. */
-            if(Ledger)
-                Ledger->TxnCommit();
-
-            /* Commit the local DB transaction. */
-            if(Local)
-                Local->TxnCommit();
-
-            /* Commit the client DB transaction. */
-            if(Client)
-                Client->TxnCommit();
-
-            /* Commit the trust DB transaction. */
-            if(Trust)
-                Trust->TxnCommit();
+            /* Commit the transaction once its commit record is reached. */
+            if(nOpcode == JOURNAL::COMMIT)
+            {
+                for(auto& pdatabase : vRecover)
+                {
+                    if(!pdatabase->TxnCommit() || !pdatabase->Sync())
+                    {
+                        debug::error(FUNCTION, pdatabase->GetName(), " failed to recover transaction");
+                        fFailed = true;
+                    }
+
+                    pdatabase->TxnRelease();
+                }
+
+                vRecover.clear();
+                pdb = nullptr;
+
+                /* Later transactions build on this one, so stop at the first failure. */
+                ++nRecovered;
+                return !fFailed;
+            }
+
+            /* Switch to the database the next records belong to. */
+            if(nOpcode == JOURNAL::DATABASE)
+            {
+                const std::string strName(vKey.begin(), vKey.end());
+                if(!mapDatabases.count(strName))
+                {
+                    debug::error(FUNCTION, "journal for unknown database ", strName);
+                    pdb = nullptr;
+
+                    return true;
+                }
+
+                pdb = mapDatabases[strName];
+                pdb->TxnBegin();
+                vRecover.push_back(pdb);
+
+                return true;
+            }
+
+            /* Apply the record to the current database. */
+            if(pdb)
+                pdb->TxnRecord(nOpcode, vKey, vData);
+
+            return true;
+        });
+
+        /* Drop the records of a transaction that never reached its commit. */
+        if(!vRecover.empty())
+            debug::error(FUNCTION, "transaction journal never reached commit");
+
+        for(auto& pdatabase : vRecover)
+            pdatabase->TxnRelease();
+
+        /* Keep the journal so the next start can retry the recovery. */
+        if(fFailed)
+        {
+            fRecover = true;
+            debug::error(FUNCTION, "keeping transaction journal for recovery");
 
-            /* Commit the legacy DB transaction. */
-            if(Legacy)
-                Legacy->TxnCommit();
+            return;
         }
 
-        /* Abort all the transactions. */
-        TxnAbort();
+        debug::log(0, FUNCTION, nRecovered, " transactions recovered");
+
+        /* Clear the shared journal. */
+        pjournal->Truncate();
+        fRecover = false;
     }
 
 
@@ -335,90 +590,78 @@ namespace LLD
         if(nFlags == TAO::Ledger::FLAGS::MEMPOOL)
             return;
 
-        /* Set a checkpoint for contract DB. */
-        if(Contract)
-            Contract->TxnCheckpoint();
-
-        /* Set a checkpoint for register DB. */
-        if(Register)
-            Register->TxnCheckpoint();
-
-        /* Set a checkpoint for ledger DB. */
-        if(Ledger)
-            Ledger->TxnCheckpoint();
-
-        /* Set a checkpoint for local DB. */
-        if(Local)
-            Local->TxnCheckpoint();
-
-        /* Set a checkpoint for client DB. */
-        if(Client)
-            Client->TxnCheckpoint();
-
-        /* Set a checkpoint for trust DB. */
-        if(Trust)
-            Trust->TxnCheckpoint();
-
-        /* Set a checkpoint for legacy DB. */
-        if(Legacy)
-            Legacy->TxnCheckpoint();
+        /* Encode every participating transaction into the shared journal. */
+        DataStream ssJournal(SER_LLD, DATABASE_VERSION);
+        std::vector< SectorDatabase<Keychain, BinaryLRU>* > vCommit;
+        for(auto& pdb : GetParticipants())
+            if(pdb->TxnCheckpoint(ssJournal))
+                vCommit.push_back(pdb);
 
+        /* Write the shared journal with a single durability barrier. */
+        if(!vCommit.empty())
+        {
+            WriteAheadLog::Encode(ssJournal, JOURNAL::COMMIT, std::vector<uint8_t>(), std::vector<uint8_t>());
 
-        /* Commit contract DB transaction. */
-        if(Contract)
-            Contract->TxnCommit();
-
-        /* Commit register DB transaction. */
-        if(Register)
-            Register->TxnCommit();
-
-        /* Commit legacy DB transaction. */
-        if(Ledger)
-            Ledger->TxnCommit();
-
-        /* Commit the local DB transaction. */
-        if(Local)
-            Local->TxnCommit();
-
-        /* Commit the client DB transaction. */
-        if(Client)
-            Client->TxnCommit();
-
-        /* Commit the trust DB transaction. */
-        if(Trust)
-            Trust->TxnCommit();
-
-        /* Commit the legacy DB transaction. */
-        if(Legacy)
-            Legacy->TxnCommit();
+            /* Nothing can be recovered without the journal, so it is synced and any failure aborts before a database commits. */
+            if(!GetJournal()->Append(ssJournal.Bytes(), true))
+            {
+                debug::error(FUNCTION, "failed to write transaction journal... aborting");
 
+                for(auto& pdb : GetParticipants())
+                    pdb->TxnRelease();
 
-        /* Abort the contract DB transaction. */
-        if(Contract)
-            Contract->TxnRelease();
+                return;
+            }
+        }
 
-        /* Abort the register DB transaction. */
-        if(Register)
-            Register->TxnRelease();
+        /* Publish every transaction at one epoch, then make it current so new snapshots see all databases change at once. */
+        const uint64_t nEpoch = Snapshot::Reserve();
+        for(auto& pdb : vCommit)
+            pdb->TxnPublish(nEpoch);
 
-        /* Abort the ledger DB transaction. */
-        if(Ledger)
-            Ledger->TxnRelease();
+        const bool fPriors = Snapshot::Publish(nEpoch);
 
-        /* Abort the local DB transaction. */
-        if(Local)
-            Local->TxnRelease();
+        /* Commit the databases in parallel, they share no files. Older snapshots get the replaced values first. */
+        std::atomic<bool> fFailed(false);
+        thread_pool* ppool = GetCommitPool();
+        for(auto& pdb : vCommit)
+        {
+            ppool->add([pdb, fPriors, &fFailed]
+            {
+                if(fPriors)
+                    pdb->TxnPriors();
+
+                if(!pdb->TxnCommit())
+                {
+                    debug::error(FUNCTION, pdb->GetName(), " failed to commit transaction");
+                    fFailed.store(true);
+
+                    return;
+                }
+
+                /* The records have to be on disk before the shared journal is cleared. */
+                if(!pdb->Sync())
+                {
+                    debug::error(FUNCTION, pdb->GetName(), " failed to sync transaction");
+                    fFailed.store(true);
+                }
+            });
+        }
+        ppool->wait();
 
-        /* Abort the client DB transaction. */
-        if(Client)
-            Client->TxnRelease();
+        /* Release the transactions. */
+        for(auto& pdb : GetParticipants())
+            pdb->TxnRelease();
 
-        /* Abort the trust DB transaction. */
-        if(Trust)
-            Trust->TxnRelease();
+        /* Keep the journal of a failed commit, so recovery can replay it and every commit after it. */
+        if(fFailed.load())
+        {
+            fRecover = true;
+            debug::error(FUNCTION, "keeping transaction journal for recovery");
+        }
 
-        /* Abort the legacy DB transaction. */
-        if(Legacy)
-            Legacy->TxnRelease();
+        /* Clear the shared journal. */
+        if(!fRecover)
+            GetJournal()->Truncate();
     }
 }
@@ -17,10 +17,12 @@ ________________________________________________________________________________
 #include <LLD/hash/xxh3.h>
 
 #include <Util/templates/datastream.h>
+#include <Util/include/args.h>
 #include <Util/include/filesystem.h>
 #include <Util/include/debug.h>
 #include <Util/include/hex.h>
 
+#include <algorithm>
 #include <iomanip>
 
 namespace LLD
@@ -30,7 +32,7 @@ namespace LLD
     BinaryHashMap::BinaryHashMap(const std::string& strBaseLocationIn, const uint8_t nFlagsIn, const uint64_t nBucketsIn)
     : KEY_MUTEX              ( )
     , strBaseLocation        (strBaseLocationIn)
-    , fileCache              (new TemplateLRU<uint16_t, std::fstream*>(8))
+    , vFiles                 (std::numeric_limits<uint16_t>::max() + 1)
     , pindex                 (nullptr)
     , hashmap                (nBucketsIn)
     , HASHMAP_TOTAL_BUCKETS  (nBucketsIn)
@@ -38,7 +40,25 @@ namespace LLD
     , HASHMAP_KEY_ALLOCATION (static_cast<uint16_t>(HASHMAP_MAX_KEY_SIZE + 13))
     , nFlags                 (nFlagsIn)
     , RECORD_MUTEX           (1024)
+    , vFilters               (std::numeric_limits<uint16_t>::max() + 1)
+    , fMeters                (config::GetBoolArg("-lldmeters", false))
+    , nLookups               (0)
+    , nFileReads             (0)
+    , nFilterSkips           (0)
+    , strRootLocation        (strBaseLocationIn)
+    , nHashVersion           (0)
+    , nGeneration            (0)
+    , pRehash                (nullptr)
+    , nRehashBucket          (0)
+    , RehashThread           ( )
+    , fRehashStop            (false)
     {
+        for(auto& pfile : vFiles)
+            pfile.store(nullptr);
+
+        for(auto& pfilter : vFilters)
+            pfilter.store(nullptr);
+
         Initialize();
     }
 
@@ -47,15 +67,33 @@ namespace LLD
     BinaryHashMap::BinaryHashMap(const BinaryHashMap& map)
     : KEY_MUTEX              ( )
     , strBaseLocation        (map.strBaseLocation)
-    , fileCache              (map.fileCache)
-    , pindex                 (map.pindex)
+    , vFiles                 (std::numeric_limits<uint16_t>::max() + 1)
+    , pindex                 (nullptr)
     , hashmap                (map.hashmap)
     , HASHMAP_TOTAL_BUCKETS  (map.HASHMAP_TOTAL_BUCKETS)
     , HASHMAP_MAX_KEY_SIZE   (map.HASHMAP_MAX_KEY_SIZE)
     , HASHMAP_KEY_ALLOCATION (map.HASHMAP_KEY_ALLOCATION)
     , nFlags                 (map.nFlags)
     , RECORD_MUTEX           (map.RECORD_MUTEX.size())
+    , vFilters               (std::numeric_limits<uint16_t>::max() + 1)
+    , fMeters                (map.fMeters)
+    , nLookups               (0)
+    , nFileReads             (0)
+    , nFilterSkips           (0)
+    , strRootLocation        (map.strRootLocation)
+    , nHashVersion           (0)
+    , nGeneration            (0)
+    , pRehash                (nullptr)
+    , nRehashBucket          (0)
+    , RehashThread           ( )
+    , fRehashStop            (false)
     {
+        for(auto& pfile : vFiles)
+            pfile.store(nullptr);
+
+        for(auto& pfilter : vFilters)
+            pfilter.store(nullptr);
+
         Initialize();
     }
 
@@ -64,15 +102,33 @@ namespace LLD
     BinaryHashMap::BinaryHashMap(BinaryHashMap&& map)
     : KEY_MUTEX              ( )
     , strBaseLocation        (std::move(map.strBaseLocation))
-    , fileCache              (std::move(map.fileCache))
-    , pindex                 (std::move(map.pindex))
+    , vFiles                 (std::numeric_limits<uint16_t>::max() + 1)
+    , pindex                 (nullptr)
     , hashmap                (std::move(map.hashmap))
     , HASHMAP_TOTAL_BUCKETS  (std::move(map.HASHMAP_TOTAL_BUCKETS))
     , HASHMAP_MAX_KEY_SIZE   (std::move(map.HASHMAP_MAX_KEY_SIZE))
     , HASHMAP_KEY_ALLOCATION (std::move(map.HASHMAP_KEY_ALLOCATION))
     , nFlags                 (std::move(map.nFlags))
     , RECORD_MUTEX           (map.RECORD_MUTEX.size())
+    , vFilters               (std::numeric_limits<uint16_t>::max() + 1)
+    , fMeters                (map.fMeters)
+    , nLookups               (0)
+    , nFileReads             (0)
+    , nFilterSkips           (0)
+    , strRootLocation        (map.strRootLocation)
+    , nHashVersion           (0)
+    , nGeneration            (0)
+    , pRehash                (nullptr)
+    , nRehashBucket          (0)
+    , RehashThread           ( )
+    , fRehashStop            (false)
     {
+        for(auto& pfile : vFiles)
+            pfile.store(nullptr);
+
+        for(auto& pfilter : vFilters)
+            pfilter.store(nullptr);
+
         Initialize();
     }
 
@@ -81,8 +137,7 @@ namespace LLD
     BinaryHashMap& BinaryHashMap::operator=(const BinaryHashMap& map)
     {
         strBaseLocation        = map.strBaseLocation;
-        fileCache              = map.fileCache;
-        pindex                 = map.pindex;
+        strRootLocation        = map.strRootLocation;
         hashmap                = map.hashmap;
         HASHMAP_TOTAL_BUCKETS  = map.HASHMAP_TOTAL_BUCKETS;
         HASHMAP_MAX_KEY_SIZE   = map.HASHMAP_MAX_KEY_SIZE;
@@ -99,8 +154,7 @@ namespace LLD
     BinaryHashMap& BinaryHashMap::operator=(BinaryHashMap&& map)
     {
         strBaseLocation        = std::move(map.strBaseLocation);
-        fileCache              = std::move(map.fileCache);
-        pindex                 = std::move(map.pindex);
+        strRootLocation        = std::move(map.strRootLocation);
         hashmap                = std::move(map.hashmap);
         HASHMAP_TOTAL_BUCKETS  = std::move(map.HASHMAP_TOTAL_BUCKETS);
         HASHMAP_MAX_KEY_SIZE   = std::move(map.HASHMAP_MAX_KEY_SIZE);
@@ -116,11 +170,24 @@ namespace LLD
     /* Default Destructor */
     BinaryHashMap::~BinaryHashMap()
     {
-        if(fileCache)
-            delete fileCache;
+        /* Stop the rehash, which checkpoints its progress for the next start. */
+        fRehashStop = true;
+        if(RehashThread.joinable())
+            RehashThread.join();
+
+        if(pRehash)
+            delete pRehash;
+
+        for(auto& pfile : vFiles)
+            if(pfile.load())
+                delete pfile.load();
 
         if(pindex)
             delete pindex;
+
+        for(auto& pfilter : vFilters)
+            if(pfilter.load())
+                delete pfilter.load();
     }
 
 
@@ -148,6 +215,15 @@ namespace LLD
     /* Calculates a bucket to be used for the hashmap allocation. */
     uint32_t BinaryHashMap::GetBucket(const std::vector<uint8_t>& vKey)
     {
+        /* Rehashed tables hash the compressed key, since that is all a rehash can read back from disk. */
+        if(nHashVersion > 0 && vKey.size() > HASHMAP_MAX_KEY_SIZE)
+        {
+            std::vector<uint8_t> vKeyCompressed = vKey;
+            CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
+
+            return static_cast<uint32_t>((XXH64(&vKeyCompressed[0], vKeyCompressed.size(), 0) / 7) % HASHMAP_TOTAL_BUCKETS);
+        }
+
         /* Get an xxHash. */
         uint64_t nBucket = XXH64(&vKey[0], vKey.size(), 0) / 7;
 
@@ -158,6 +234,18 @@ namespace LLD
     /* Read a key index from the disk hashmaps. */
     void BinaryHashMap::Initialize()
     {
+        /* Load the table metadata, which overrides the bucket count once a table has been rehashed. */
+        uint32_t nRehashBuckets = 0, nRehashCursor = 0;
+        if(read_meta(nRehashBuckets, nRehashCursor) && hashmap.size() != HASHMAP_TOTAL_BUCKETS)
+            hashmap.assign(HASHMAP_TOTAL_BUCKETS, 0);
+
+        /* Remove the previous table if a crash stopped the rehash from cleaning it up. */
+        if(nGeneration > 0 && filesystem::exists(table_location(nGeneration - 1) + "_hashmap.index"))
+            remove_table(table_location(nGeneration - 1));
+
+        /* Set the location of the current table. */
+        strBaseLocation = table_location(nGeneration);
+
         /* Create directories if they don't exist yet. */
         if(!filesystem::exists(strBaseLocation) && filesystem::create_directories(strBaseLocation))
             debug::log(0, FUNCTION, "Generated Path ", strBaseLocation);
@@ -167,7 +255,7 @@ namespace LLD
         if(!filesystem::exists(index))
         {
             /* Generate empty space for new file. */
-            const static std::vector<uint8_t> vSpace(HASHMAP_TOTAL_BUCKETS * 4, 0);
+            const std::vector<uint8_t> vSpace(HASHMAP_TOTAL_BUCKETS * 4, 0);
 
             /* Write the new disk index .*/
             std::fstream stream(index, std::ios::out | std::ios::binary | std::ios::trunc);
@@ -218,21 +306,44 @@ namespace LLD
             debug::log(0, FUNCTION, "Generated Disk Hash Map 0 of ", vSpace.size(), " bytes");
         }
 
-        /* Create the stream index object. */
-        pindex = new std::fstream(index, std::ios::in | std::ios::out | std::ios::binary);
+        /* Create the index file object. */
+        if(pindex)
+            delete pindex;
+
+        pindex = new RandomAccessFile(index);
+
+        /* Load the bloom filters for all existing hashmap files. */
+        for(uint16_t nFile = 0; filesystem::exists(debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), nFile)); ++nFile)
+        {
+            /* Skip filters that are already loaded. */
+            if(vFilters[nFile].load())
+                continue;
 
-        /* Load the stream object into the stream LRU cache. */
-        fileCache->Put(0, new std::fstream(file, std::ios::in | std::ios::out | std::ios::binary));
+            vFilters[nFile].store(load_filter(nFile));
+        }
+
+        /* Resume a rehash that was running at shutdown. */
+        if(nRehashBuckets > 0 && !pRehash)
+            start_rehash(nRehashBuckets, nRehashCursor);
     }
 
 
     /* Read a key index from the disk hashmaps. */
     bool BinaryHashMap::Get(const std::vector<uint8_t>& vKey, SectorKey &cKey)
     {
-        LOCK(KEY_MUTEX);
+        /* Get the assigned bucket and lock its stripe. */
+        uint32_t nBucket = 0;
+        std::unique_lock<std::mutex> lk = lock_bucket(vKey, nBucket);
+
+        /* Check the rehash table first, since it holds all new writes and every migrated bucket. */
+        if(pRehash)
+        {
+            if(pRehash->Get(vKey, cKey))
+                return true;
 
-        /* Get the assigned bucket for the hashmap. */
-        uint32_t nBucket = GetBucket(vKey);
+            if(nBucket < nRehashBucket.load())
+                return false;
+        }
 
         /* Get the file binary position. */
         uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
@@ -244,33 +355,26 @@ namespace LLD
         std::vector<uint8_t> vKeyCompressed = vKey;
         CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
 
+        /* Iterate the lookup meter. */
+        if(fMeters)
+            ++nLookups;
+
         /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
         for(int16_t i = hashmap[nBucket] - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream *pstream;
-            if(!fileCache->Get(i, pstream))
-            {
-                /* Set the new stream pointer. */
-                std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i);
-
-                pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
-                    continue;
-                }
+            /* Skip files that the bloom filter shows don't have this key. */
+            if(!check_filter(i, vKeyCompressed))
+                continue;
 
-                /* If file not found add to LRU cache. */
-                fileCache->Put(i, pstream);
-            }
-
-            /* Seek to the hashmap index in file. */
-            pstream->seekg(nFilePos, std::ios::beg);
+            /* Get the file object for this hashmap file. */
+            RandomAccessFile* pfile = get_file(i);
+            if(!pfile)
+                continue;
 
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+            /* Read the bucket binary data from the file. */
+            if(!pfile->Read(nFilePos, vBucket))
+                continue;
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -306,10 +410,13 @@ namespace LLD
     /* Write a key to the disk hashmaps. */
     bool BinaryHashMap::Put(const SectorKey& cKey)
     {
-        LOCK(KEY_MUTEX);
+        /* Get the assigned bucket and lock its stripe. */
+        uint32_t nBucket = 0;
+        std::unique_lock<std::mutex> lk = lock_bucket(cKey.vKey, nBucket);
 
-        /* Get the assigned bucket for the hashmap. */
-        uint32_t nBucket = GetBucket(cKey.vKey);
+        /* Write to the rehash table while a rehash is running. */
+        if(pRehash)
+            return pRehash->Put(cKey);
 
         /* Get the file binary position. */
         uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
@@ -325,30 +432,14 @@ namespace LLD
             std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
             for(int16_t i = hashmap[nBucket] - 1; i >= 0; --i)
             {
-                /* Find the file stream for LRU cache. */
-                std::fstream* pstream;
-                if(!fileCache->Get(i, pstream))
-                {
-                    std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i);
-
-                    /* Set the new stream pointer. */
-                    pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                    if(!pstream->is_open())
-                    {
-                        delete pstream;
-                        return debug::error(FUNCTION, "couldn't create hashmap object at: ",
-                            filename, " (", strerror(errno), ")");
-                    }
-
-                    /* If file not found add to LRU cache. */
-                    fileCache->Put(i, pstream);
-                }
+                /* Get the file object for this hashmap file. */
+                RandomAccessFile* pfile = get_file(i);
+                if(!pfile)
+                    return debug::error(FUNCTION, "couldn't create hashmap object at file ", i);
 
-                /* Seek to the hashmap index in file. */
-                pstream->seekg (nFilePos, std::ios::beg);
-
-                /* Read the bucket binary data from file stream */
-                pstream->read((char*) &vBucket[0], vBucket.size());
+                /* Read the bucket binary data from the file. */
+                if(!pfile->Read(nFilePos, vBucket))
+                    return debug::error(FUNCTION, "couldn't read hashmap bucket ", nBucket, " at file ", i);
 
                 /* Check if this bucket has the key or is in an empty state. */
                 if(vBucket[0] == STATE::EMPTY || std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -360,30 +451,12 @@ namespace LLD
                     /* Serialize the key into the end of the vector. */
                     ssKey.write((char*)&vKeyCompressed[0], vKeyCompressed.size());
 
-                    /* Find the file stream for LRU cache. */
-                    std::fstream* pstream;
-                    if(!fileCache->Get(i, pstream))
-                    {
-                        std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i);
-
-                        /* Set the new stream pointer. */
-                        pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                        if(!pstream->is_open())
-                        {
-                            delete pstream;
-                            return debug::error(FUNCTION, "couldn't create hashmap object at: ",
-                                filename, " (", strerror(errno), ")");
-                        }
-
-                        /* If file not found add to LRU cache. */
-                        fileCache->Put(i, pstream);
-                    }
-
+                    /* Add to the filter before the key hits disk so the filter never misses a key. */
+                    insert_filter(i, vKeyCompressed);
 
                     /* Handle the disk writing operations. */
-                    pstream->seekp (nFilePos, std::ios::beg);
-                    pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
-                    pstream->flush();
+                    if(!pfile->Write(nFilePos, ssKey.Bytes()))
+                        return debug::error(FUNCTION, "failed to write hashmap bucket ", nBucket, " at file ", i);
 
 
                     /* Debug Output of Sector Key Information. */
@@ -404,22 +477,27 @@ namespace LLD
         }
 
         /* Create a new disk hashmap object in linked list if it doesn't exist. */
-        std::string file = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), hashmap[nBucket]);
-        if(!filesystem::exists(file))
         {
-            /* Blank vector to write empty space in new disk file. */
-            std::vector<uint8_t> vSpace(HASHMAP_KEY_ALLOCATION, 0);
+            /* Lock the file creation so that two stripes don't generate the same file. */
+            LOCK2(KEY_MUTEX);
 
-            /* Write the blank data to the new file handle. */
-            std::ofstream stream(file, std::ios::out | std::ios::binary | std::ios::app);
-            if(!stream)
-                return debug::error(FUNCTION, strerror(errno));
+            std::string file = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), hashmap[nBucket]);
+            if(!filesystem::exists(file))
+            {
+                /* Blank vector to write empty space in new disk file. */
+                std::vector<uint8_t> vSpace(HASHMAP_KEY_ALLOCATION, 0);
 
-            for(uint32_t i = 0; i < HASHMAP_TOTAL_BUCKETS; ++i)
-                stream.write((char*)&vSpace[0], vSpace.size());
+                /* Write the blank data to the new file handle. */
+                std::ofstream stream(file, std::ios::out | std::ios::binary | std::ios::app);
+                if(!stream)
+                    return debug::error(FUNCTION, strerror(errno));
 
-            //stream.flush();
-            stream.close();
+                for(uint32_t i = 0; i < HASHMAP_TOTAL_BUCKETS; ++i)
+                    stream.write((char*)&vSpace[0], vSpace.size());
+
+                //stream.flush();
+                stream.close();
+            }
         }
 
         /* Read the State and Size of Sector Header. */
@@ -429,39 +507,24 @@ namespace LLD
         /* Serialize the key into the end of the vector. */
         ssKey.write((char*)&vKeyCompressed[0], vKeyCompressed.size());
 
-        /* Find the file stream for LRU cache. */
-        std::fstream* pstream;
-        if(!fileCache->Get(hashmap[nBucket], pstream))
-        {
-            /* Set the new stream pointer. */
-            pstream = new std::fstream(file, std::ios::in | std::ios::out | std::ios::binary);
-            if(!pstream->is_open())
-            {
-                delete pstream;
-                return debug::error(FUNCTION, "Failed to generate file object");
-            }
+        /* Get the file object for this hashmap file. */
+        RandomAccessFile* pfile = get_file(hashmap[nBucket]);
+        if(!pfile)
+            return debug::error(FUNCTION, "Failed to generate file object");
 
-            /* If not in cache, add to the LRU. */
-            fileCache->Put(hashmap[nBucket], pstream);
-        }
+        /* Add to the filter before the key hits disk so the filter never misses a key. */
+        insert_filter(hashmap[nBucket], vKeyCompressed);
 
         /* Flush the key file to disk. */
-        pstream->seekp (nFilePos, std::ios::beg);
-        pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
-        pstream->flush();
-
-        /* Seek to the index position. */
-        pindex->seekp((nBucket * 2), std::ios::beg);
+        if(!pfile->Write(nFilePos, ssKey.Bytes()))
+            return debug::error(FUNCTION, "failed to write hashmap bucket ", nBucket, " at file ", hashmap[nBucket]);
 
         /* Write the index to disk. */
         uint16_t nIndex = ++hashmap[nBucket];
 
-        /* Get the bucket data. */
-        std::vector<uint8_t> vBucket((uint8_t*)&nIndex, (uint8_t*)&nIndex + 2);
-
         /* Write the index into hashmap. */
-        pindex->write((char*)&vBucket[0], vBucket.size());
-        pindex->flush();
+        if(!pindex->Write(nBucket * 2, (uint8_t*)&nIndex, 2))
+            return debug::error(FUNCTION, "failed to write hashmap index for bucket ", nBucket);
 
         /* Debug Output of Sector Key Information. */
         if(config::nVerbose >= 4)
@@ -480,22 +543,83 @@ namespace LLD
     }
 
 
+    /* Read a batch of keys from the disk hashmaps, ordered by bucket. */
+    bool BinaryHashMap::Get(const std::vector< std::vector<uint8_t> >& vKeys, std::vector<SectorKey>& vSectorKeys)
+    {
+        /* Calculate the buckets for the batch. */
+        std::vector< std::pair<uint32_t, uint32_t> > vOrder;
+        vOrder.reserve(vKeys.size());
+        for(uint32_t n = 0; n < vKeys.size(); ++n)
+            vOrder.push_back(std::make_pair(GetBucket(vKeys[n]), n));
+
+        /* Sort so that keys sharing a bucket are read together. */
+        std::sort(vOrder.begin(), vOrder.end());
+
+        /* Read the keys in bucket order. */
+        bool fFound = true;
+        for(const auto& order : vOrder)
+        {
+            SectorKey cKey;
+            if(!Get(vKeys[order.second], cKey))
+            {
+                fFound = false;
+                continue;
+            }
+
+            vSectorKeys.push_back(cKey);
+        }
+
+        return fFound;
+    }
+
+
+    /* Write a batch of keys to the disk hashmaps, ordered by bucket. */
+    bool BinaryHashMap::Put(const std::vector<SectorKey>& vKeys)
+    {
+        /* Calculate the buckets for the batch. */
+        std::vector< std::pair<uint32_t, uint32_t> > vOrder;
+        vOrder.reserve(vKeys.size());
+        for(uint32_t n = 0; n < vKeys.size(); ++n)
+            vOrder.push_back(std::make_pair(GetBucket(vKeys[n].vKey), n));
+
+        /* Stable sort so that duplicate keys keep their order and the last write wins. */
+        std::stable_sort(vOrder.begin(), vOrder.end(),
+            [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b)
+            {
+                return a.first < b.first;
+            });
+
+        /* Write the keys in bucket order. */
+        for(const auto& order : vOrder)
+            if(!Put(vKeys[order.second]))
+                return false;
+
+        return true;
+    }
+
+
     /* Flush all buffers to disk if using ACID transaction. */
     void BinaryHashMap::Flush()
     {
-        /* Flush the index files. */
-        pindex->flush();
+        /* Hold the file lock so that a finishing rehash can't swap the files out from under us. */
+        LOCK(KEY_MUTEX);
 
-        /* Iterate the linked list until end. */
-        TemplateNode<uint16_t, std::fstream*>* pnode = fileCache->pfirst;
-        while(pnode && pnode->pnext)
-        {
-            /* Flush to disk. */
-            pnode->Data->flush();
+        /* Sync the rehash table, which holds every write since the rehash started. */
+        if(pRehash)
+            pRehash->Flush();
 
-            /* Set to next. */
-            pnode = pnode->pnext;
-        }
+        /* Sync the bloom filters first, a filter older than its hashmap file would hide keys after a crash. */
+        for(auto& pfilter : vFilters)
+            if(pfilter.load())
+                pfilter.load()->Sync();
+
+        /* Sync the index file. */
+        pindex->Sync();
+
+        /* Sync all of the open hashmap files. */
+        for(auto& pfile : vFiles)
+            if(pfile.load())
+                pfile.load()->Sync();
     }
 
 
@@ -503,10 +627,18 @@ namespace LLD
      *  TODO: This should be optimized further. */
     bool BinaryHashMap::Erase(const std::vector<uint8_t> &vKey)
     {
-        LOCK(KEY_MUTEX);
+        /* Get the assigned bucket and lock its stripe. */
+        uint32_t nBucket = 0;
+        std::unique_lock<std::mutex> lk = lock_bucket(vKey, nBucket);
 
-        /* Get the assigned bucket for the hashmap. */
-        uint32_t nBucket = GetBucket(vKey);
+        /* Erase from the rehash table, and from this table unless the bucket was already migrated. */
+        bool fErased = false;
+        if(pRehash)
+        {
+            fErased = pRehash->Erase(vKey);
+            if(nBucket < nRehashBucket.load())
+                return fErased;
+        }
 
         /* Get the file binary position. */
         uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
@@ -519,24 +651,18 @@ namespace LLD
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
         for(int16_t i = hashmap[nBucket] - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream* pstream;
-            if(!fileCache->Get(i, pstream))
-            {
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(
-                  debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i),
-                  std::ios::in | std::ios::out | std::ios::binary);
+            /* Skip files that the bloom filter shows don't have this key. */
+            if(!check_filter(i, vKeyCompressed))
+                continue;
 
-                /* If file not found add to LRU cache. */
-                fileCache->Put(i, pstream);
-            }
+            /* Get the file object for this hashmap file. */
+            RandomAccessFile* pfile = get_file(i);
+            if(!pfile)
+                continue;
 
-            /* Seek to the hashmap index in file. */
-            pstream->seekg (nFilePos, std::ios::beg);
-
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+            /* Read the bucket binary data from the file. */
+            if(!pfile->Read(nFilePos, vBucket))
+                continue;
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -546,13 +672,10 @@ namespace LLD
                 SectorKey cKey;
                 ssKey >> cKey;
 
-                /* Seek to the hashmap index in file. */
-                pstream->seekp (nFilePos, std::ios::beg);
-
-                /* Read the bucket binary data from file stream */
+                /* Write the empty bucket over the key. */
                 std::vector<uint8_t> vEmpty(HASHMAP_KEY_ALLOCATION, 0);
-                pstream->write((char*) &vEmpty[0], vEmpty.size());
-                pstream->flush();
+                if(!pfile->Write(nFilePos, vEmpty))
+                    return false;
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
@@ -570,17 +693,26 @@ namespace LLD
             }
         }
 
-        return false;
+        return fErased;
     }
 
 
     /* Restore an index in the hashmap if it is found. */
     bool BinaryHashMap::Restore(const std::vector<uint8_t> &vKey)
     {
-        LOCK(KEY_MUTEX);
+        /* Get the assigned bucket and lock its stripe. */
+        uint32_t nBucket = 0;
+        std::unique_lock<std::mutex> lk = lock_bucket(vKey, nBucket);
+
+        /* Restore from the rehash table, falling back to this table for buckets not yet migrated. */
+        if(pRehash)
+        {
+            if(pRehash->Restore(vKey))
+                return true;
 
-        /* Get the assigned bucket for the hashmap. */
-        uint32_t nBucket = GetBucket(vKey);
+            if(nBucket < nRehashBucket.load())
+                return false;
+        }
 
         /* Get the file binary position. */
         uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
@@ -593,24 +725,18 @@ namespace LLD
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
         for(int16_t i = hashmap[nBucket] - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream* pstream;
-            if(!fileCache->Get(i, pstream))
-            {
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(
-                  debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i),
-                  std::ios::in | std::ios::out | std::ios::binary);
-
-                /* If file not found add to LRU cache. */
-                fileCache->Put(i, pstream);
-            }
+            /* Skip files that the bloom filter shows don't have this key. */
+            if(!check_filter(i, vKeyCompressed))
+                continue;
 
-            /* Seek to the hashmap index in file. */
-            pstream->seekg (nFilePos, std::ios::beg);
+            /* Get the file object for this hashmap file. */
+            RandomAccessFile* pfile = get_file(i);
+            if(!pfile)
+                continue;
 
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+            /* Read the bucket binary data from the file. */
+            if(!pfile->Read(nFilePos, vBucket))
+                continue;
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -624,13 +750,10 @@ namespace LLD
                 if(cKey.Ready())
                     return true;
 
-                /* Seek to the hashmap index in file. */
-                pstream->seekp (nFilePos, std::ios::beg);
-
-                /* Read the bucket binary data from file stream */
-                std::vector<uint8_t> vReady(STATE::READY);
-                pstream->write((char*) &vReady[0], vReady.size());
-                pstream->flush();
+                /* Write the ready state over the key state. */
+                std::vector<uint8_t> vReady(1, STATE::READY);
+                if(!pfile->Write(nFilePos, vReady))
+                    return false;
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
@@ -650,4 +773,463 @@ namespace LLD
 
         return false;
     }
+
+
+    /* Log and reset the keychain lookup meters. */
+    void BinaryHashMap::Meters(const std::string& strName)
+    {
+        /* Get the current meters. */
+        const uint64_t nTotalLookups = nLookups.exchange(0);
+        const uint64_t nTotalReads   = nFileReads.exchange(0);
+        const uint64_t nTotalSkips   = nFilterSkips.exchange(0);
+
+        /* Check for zero values. */
+        if(nTotalLookups == 0)
+            return;
+
+        /* Debug output. */
+        debug::log(0,
+            ANSI_COLOR_FUNCTION, strName, " LLD : ", ANSI_COLOR_RESET,
+            "Keychain ", nTotalLookups, " lookups | ",
+            "Reads ", double(nTotalReads) / nTotalLookups, " per lookup | ",
+            "Filter Skips ", (nTotalSkips * 100.0) / std::max(uint64_t(1), nTotalReads + nTotalSkips), " %");
+    }
+
+
+    /* Get the number of hashmap file reads since the meters were last logged. */
+    uint64_t BinaryHashMap::FileReads() const
+    {
+        return nFileReads.load();
+    }
+
+
+    /* Get the file object for a hashmap file, opening it if needed. */
+    RandomAccessFile* BinaryHashMap::get_file(const uint16_t nFile)
+    {
+        /* Check for an already opened file. */
+        RandomAccessFile* pfile = vFiles[nFile].load(std::memory_order_acquire);
+        if(pfile)
+            return pfile;
+
+        LOCK(KEY_MUTEX);
+
+        /* Check again in case another stripe opened this file while we waited. */
+        pfile = vFiles[nFile].load(std::memory_order_acquire);
+        if(pfile)
+            return pfile;
+
+        /* Open the new file object. */
+        pfile = new RandomAccessFile(debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), nFile));
+        if(pfile->IsNull())
+        {
+            delete pfile;
+            return nullptr;
+        }
+
+        /* Publish the file for all stripes. */
+        vFiles[nFile].store(pfile, std::memory_order_release);
+
+        return pfile;
+    }
+
+
+    /* Load the bloom filter for a hashmap file, rebuilding it if it is missing. */
+    BloomFilter* BinaryHashMap::load_filter(const uint16_t nFile)
+    {
+        /* Try to load the filter from disk. */
+        BloomFilter* pfilter = new BloomFilter(HASHMAP_TOTAL_BUCKETS);
+
+        std::string strFilter = debug::safe_printstr(strBaseLocation, "_bloom.", std::setfill('0'), std::setw(5), nFile);
+        if(pfilter->Load(strFilter))
+            return pfilter;
+
+        /* Open the hashmap file to rebuild the filter. */
+        std::string strFile = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), nFile);
+        std::ifstream stream(strFile, std::ios::in | std::ios::binary);
+        if(!stream)
+        {
+            delete pfilter;
+            return nullptr;
+        }
+
+        /* Read the hashmap file in chunks of buckets. */
+        uint32_t nKeys = 0;
+        std::vector<uint8_t> vBuffer(HASHMAP_KEY_ALLOCATION * 4096, 0);
+        while(stream)
+        {
+            stream.read((char*)&vBuffer[0], vBuffer.size());
+
+            /* Add all the keys that are in a non-empty state. */
+            uint64_t nRead = static_cast<uint64_t>(stream.gcount());
+            for(uint64_t nPos = 0; nPos + HASHMAP_KEY_ALLOCATION <= nRead; nPos += HASHMAP_KEY_ALLOCATION)
+            {
+                if(vBuffer[nPos] == STATE::EMPTY)
+                    continue;
+
+                /* Get the compressed key size from the key length. */
+                uint16_t nLength = static_cast<uint16_t>(vBuffer[nPos + 1] | (vBuffer[nPos + 2] << 8));
+                pfilter->Insert(&vBuffer[nPos + 13], std::min(nLength, HASHMAP_MAX_KEY_SIZE));
+
+                ++nKeys;
+            }
+        }
+
+        /* Write the rebuilt filter to disk. */
+        if(!pfilter->Create(strFilter))
+        {
+            delete pfilter;
+            return nullptr;
+        }
+
+        debug::log(0, FUNCTION, "Rebuilt Bloom Filter ", nFile, " with ", nKeys, " keys");
+
+        return pfilter;
+    }
+
+
+    /* Check if a hashmap file may contain the given key. */
+    bool BinaryHashMap::check_filter(const uint16_t nFile, const std::vector<uint8_t>& vKeyCompressed)
+    {
+        /* Check the filter if we have one for this file. */
+        BloomFilter* pfilter = vFilters[nFile].load();
+        if(pfilter && !pfilter->Has(&vKeyCompressed[0], vKeyCompressed.size()))
+        {
+            if(fMeters)
+                ++nFilterSkips;
+
+            return false;
+        }
+
+        /* Iterate the disk read meter. */
+        if(fMeters)
+            ++nFileReads;
+
+        return true;
+    }
+
+
+    /* Add a key to the filter of a hashmap file, creating the filter if needed. */
+    void BinaryHashMap::insert_filter(const uint16_t nFile, const std::vector<uint8_t>& vKeyCompressed)
+    {
+        /* Load or build the filter for newly generated hashmap files. */
+        BloomFilter* pfilter = vFilters[nFile].load();
+        if(!pfilter)
+        {
+            pfilter = load_filter(nFile);
+            if(!pfilter)
+                return;
+
+            /* Use the other filter if another thread loaded it first. */
+            BloomFilter* pexpected = nullptr;
+            if(!vFilters[nFile].compare_exchange_strong(pexpected, pfilter))
+            {
+                delete pfilter;
+                pfilter = pexpected;
+            }
+        }
+
+        pfilter->Insert(&vKeyCompressed[0], vKeyCompressed.size());
+    }
+
+
+    /* Start migrating the keys into a new table with the given number of buckets. */
+    bool BinaryHashMap::Rehash(const uint32_t nBucketsNew)
+    {
+        /* Check for a rehash that is already running. */
+        if(pRehash)
+        {
+            if(pRehash->HASHMAP_TOTAL_BUCKETS == nBucketsNew)
+                return true;
+
+            return debug::error(FUNCTION, "rehash to ", pRehash->HASHMAP_TOTAL_BUCKETS, " buckets is already running");
+        }
+
+        /* Check that there is something to do. */
+        if(nBucketsNew == 0 || nBucketsNew == HASHMAP_TOTAL_BUCKETS)
+            return true;
+
+        /* Clear out any table left behind by a rehash that never committed its metadata. */
+        remove_table(table_location(nGeneration + 1));
+
+        return start_rehash(nBucketsNew, 0);
+    }
+
+
+    /* Get the bucket for a key and lock its stripe. */
+    std::unique_lock<std::mutex> BinaryHashMap::lock_bucket(const std::vector<uint8_t>& vKey, uint32_t& nBucket)
+    {
+        while(true)
+        {
+            /* Get the bucket for the current table. */
+            const uint32_t nGen = nGeneration.load();
+            nBucket = GetBucket(vKey);
+
+            /* Lock the stripe, and retry if a new table was swapped in while waiting. */
+            std::unique_lock<std::mutex> lk(RECORD_MUTEX[nBucket % RECORD_MUTEX.size()]);
+            if(nGen == nGeneration.load())
+                return lk;
+        }
+    }
+
+
+    /* Get the directory of the table for a given generation. */
+    std::string BinaryHashMap::table_location(const uint32_t nGen) const
+    {
+        /* The first table lives in the keychain directory so existing databases keep working. */
+        if(nGen == 0)
+            return strRootLocation;
+
+        return debug::safe_printstr(strRootLocation, "_table.", std::setfill('0'), std::setw(3), nGen, "/");
+    }
+
+
+    /* Read the table metadata. */
+    bool BinaryHashMap::read_meta(uint32_t& nRehashBuckets, uint32_t& nRehashCursor)
+    {
+        /* Tables without metadata have never been rehashed. */
+        std::string strMeta = debug::safe_printstr(strRootLocation, "_hashmap.meta");
+        if(!filesystem::exists(strMeta))
+            return false;
+
+        /* Read the metadata bytes. */
+        std::ifstream stream(strMeta, std::ios::in | std::ios::binary);
+        std::vector<uint8_t> vMeta((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        /* Deserialize the metadata, which is replaced atomically so it should never be partial. */
+        try
+        {
+            uint32_t nGen = 0;
+
+            const DataStream ssMeta(vMeta, SER_LLD, DATABASE_VERSION);
+            ssMeta >> nHashVersion >> nGen >> HASHMAP_TOTAL_BUCKETS >> nRehashBuckets >> nRehashCursor;
+
+            nGeneration.store(nGen);
+        }
+        catch(const std::exception& e)
+        {
+            throw debug::exception(FUNCTION, "malformed keychain metadata ", strMeta, ": ", e.what());
+        }
+
+        return true;
+    }
+
+
+    /* Write the table metadata. */
+    bool BinaryHashMap::write_meta(const uint32_t nRehashBuckets, const uint32_t nRehashCursor)
+    {
+        /* Serialize the metadata. */
+        DataStream ssMeta(SER_LLD, DATABASE_VERSION);
+        ssMeta << nHashVersion << nGeneration.load() << HASHMAP_TOTAL_BUCKETS << nRehashBuckets << nRehashCursor;
+
+        /* Write and sync a temporary file. */
+        std::string strMeta = debug::safe_printstr(strRootLocation, "_hashmap.meta");
+        {
+            RandomAccessFile file(strMeta + ".tmp", true);
+            if(file.IsNull() || !file.Truncate(0) || !file.Write(0, ssMeta.Bytes()) || !file.Sync())
+                return debug::error(FUNCTION, "failed to write keychain metadata ", strMeta);
+        }
+
+        /* Replace the old metadata in one step. */
+        if(!filesystem::rename(strMeta + ".tmp", strMeta))
+            return debug::error(FUNCTION, "failed to replace keychain metadata ", strMeta);
+
+        return true;
+    }
+
+
+    /* Open the rehash table and start the rehash thread. */
+    bool BinaryHashMap::start_rehash(const uint32_t nBucketsNew, const uint32_t nCursor)
+    {
+        /* Record the rehash before the new table takes any writes, so a restart knows to read from it. */
+        if(!write_meta(nBucketsNew, nCursor))
+            return false;
+
+        /* Open the new table, which hashes the compressed keys. */
+        BinaryHashMap* pTable = new BinaryHashMap(table_location(nGeneration + 1), nFlags, nBucketsNew);
+        pTable->nHashVersion = 1;
+
+        /* Publish the new table while holding every stripe. */
+        for(auto& mutex : RECORD_MUTEX)
+            mutex.lock();
+
+        pRehash = pTable;
+        nRehashBucket.store(nCursor);
+
+        for(auto& mutex : RECORD_MUTEX)
+            mutex.unlock();
+
+        /* Start the migration in the background. */
+        if(RehashThread.joinable())
+            RehashThread.join();
+
+        fRehashStop = false;
+        RehashThread = std::thread(&BinaryHashMap::rehash_thread, this);
+
+        debug::log(0, FUNCTION, "Rehashing ", HASHMAP_TOTAL_BUCKETS, " buckets into ", nBucketsNew, " from bucket ", nCursor);
+
+        return true;
+    }
+
+
+    /* Migrate the buckets of this table and swap in the new table when done. */
+    void BinaryHashMap::rehash_thread()
+    {
+        while(!fRehashStop.load())
+        {
+            /* Swap in the new table once every bucket is migrated. */
+            const uint32_t nBucket = nRehashBucket.load();
+            if(nBucket >= HASHMAP_TOTAL_BUCKETS)
+            {
+                finish_rehash();
+                return;
+            }
+
+            /* Migrate the bucket while holding its stripe. */
+            {
+                LOCK(RECORD_MUTEX[nBucket % RECORD_MUTEX.size()]);
+                if(!migrate_bucket(nBucket))
+                {
+                    debug::error(FUNCTION, "rehash stopped at bucket ", nBucket);
+                    break;
+                }
+
+                nRehashBucket.store(nBucket + 1);
+            }
+
+            /* Checkpoint the progress, syncing the new table first so the checkpoint never runs ahead of it. */
+            if((nBucket + 1) % REHASH_CHECKPOINT == 0)
+            {
+                pRehash->Flush();
+                write_meta(pRehash->HASHMAP_TOTAL_BUCKETS, nBucket + 1);
+
+                debug::log(2, FUNCTION, "Rehashed ", nBucket + 1, " of ", HASHMAP_TOTAL_BUCKETS, " buckets");
+            }
+        }
+
+        /* Checkpoint where we stopped so the next start resumes from here. */
+        pRehash->Flush();
+        write_meta(pRehash->HASHMAP_TOTAL_BUCKETS, nRehashBucket.load());
+    }
+
+
+    /* Copy the keys of a bucket into the rehash table. */
+    bool BinaryHashMap::migrate_bucket(const uint32_t nBucket)
+    {
+        /* Get the file binary position. */
+        uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
+
+        /* Iterate the newest files first so that the newest version of a key is the one migrated. */
+        std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
+        for(int16_t i = hashmap[nBucket] - 1; i >= 0; --i)
+        {
+            /* Get the file object for this hashmap file. */
+            RandomAccessFile* pfile = get_file(i);
+            if(!pfile)
+                return debug::error(FUNCTION, "couldn't open hashmap file ", i);
+
+            /* Read the bucket binary data from the file. */
+            if(!pfile->Read(nFilePos, vBucket))
+                return debug::error(FUNCTION, "couldn't read hashmap bucket ", nBucket, " at file ", i);
+
+            /* Skip empty and erased buckets. */
+            if(vBucket[0] == STATE::EMPTY)
+                continue;
+
+            /* Deserialize the key, which only has the compressed key bytes on disk. */
+            DataStream ssKey(vBucket, SER_LLD, DATABASE_VERSION);
+            SectorKey cKey;
+            ssKey >> cKey;
+
+            cKey.vKey.assign(vBucket.begin() + 13, vBucket.begin() + 13 + std::min(cKey.nLength, HASHMAP_MAX_KEY_SIZE));
+
+            /* Skip keys that have been written to the new table since the rehash started. */
+            SectorKey cExisting;
+            if(pRehash->Get(cKey.vKey, cExisting))
+                continue;
+
+            if(!pRehash->Put(cKey))
+                return debug::error(FUNCTION, "couldn't write key from bucket ", nBucket, " to rehash table");
+        }
+
+        return true;
+    }
+
+
+    /* Swap the rehash table in as this table and remove the old table. */
+    bool BinaryHashMap::finish_rehash()
+    {
+        /* Make sure the new table is on disk before it replaces this one. */
+        pRehash->Flush();
+
+        /* Take every stripe and the file lock so no operation sees a half swapped table. */
+        for(auto& mutex : RECORD_MUTEX)
+            mutex.lock();
+
+        BinaryHashMap* pOld = pRehash;
+        {
+            LOCK(KEY_MUTEX);
+
+            /* Swap the tables, leaving the old table in the rehash object to be deleted. */
+            std::swap(strBaseLocation, pOld->strBaseLocation);
+            std::swap(HASHMAP_TOTAL_BUCKETS, pOld->HASHMAP_TOTAL_BUCKETS);
+            std::swap(nHashVersion, pOld->nHashVersion);
+            std::swap(pindex, pOld->pindex);
+            hashmap.swap(pOld->hashmap);
+
+            for(uint32_t n = 0; n < vFiles.size(); ++n)
+            {
+                vFiles[n].store(pOld->vFiles[n].exchange(vFiles[n].load()));
+                vFilters[n].store(pOld->vFilters[n].exchange(vFilters[n].load()));
+            }
+
+            pRehash = nullptr;
+            nRehashBucket.store(0);
+
+            /* Waiting operations see the new generation and recompute their buckets. */
+            ++nGeneration;
+        }
+
+        for(auto& mutex : RECORD_MUTEX)
+            mutex.unlock();
+
+        /* Commit the new table, a crash before this resumes the rehash and finishes it again. */
+        if(!write_meta(0, 0))
+            return debug::error(FUNCTION, "failed to commit rehashed table");
+
+        /* Remove the old table. */
+        const std::string strOld = pOld->strBaseLocation;
+        delete pOld;
+
+        remove_table(strOld);
+
+        debug::log(0, FUNCTION, "Rehash complete with ", HASHMAP_TOTAL_BUCKETS, " buckets in ", strBaseLocation);
+
+        return true;
+    }
+
+
+    /* Remove the files of a table that was replaced by a rehash. */
+    void BinaryHashMap::remove_table(const std::string& strLocation)
+    {
+        /* Rehashed tables have their own directory. */
+        if(strLocation != strRootLocation)
+        {
+            if(filesystem::exists(strLocation))
+                filesystem::remove_directories(strLocation);
+
+            return;
+        }
+
+        /* The first table shares the keychain directory with the metadata, so remove its files by name. */
+        filesystem::remove(debug::safe_printstr(strLocation, "_hashmap.index"));
+        for(uint32_t nFile = 0; nFile <= std::numeric_limits<uint16_t>::max(); ++nFile)
+        {
+            std::string strFile = debug::safe_printstr(strLocation, "_hashmap.", std::setfill('0'), std::setw(5), nFile);
+            if(!filesystem::exists(strFile))
+                break;
+
+            filesystem::remove(strFile);
+            filesystem::remove(debug::safe_printstr(strLocation, "_bloom.", std::setfill('0'), std::setw(5), nFile));
+        }
+    }
 }
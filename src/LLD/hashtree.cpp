@@ -15,12 +15,17 @@ ________________________________________________________________________________
 #include <LLD/include/enum.h>
 #include <LLD/include/version.h>
 #include <LLD/hash/xxh3.h>
+#include <LLD/templates/randomfile.h>
 
 #include <Util/templates/datastream.h>
+#include <Util/include/args.h>
 #include <Util/include/filesystem.h>
 #include <Util/include/debug.h>
 #include <Util/include/hex.h>
 
+#include <algorithm>
+#include <iomanip>
+
 namespace LLD
 {
 
@@ -36,39 +41,31 @@ namespace LLD
     , HASHMAP_MAX_KEY_SIZE(32)
     , HASHMAP_KEY_ALLOCATION(static_cast<uint16_t>(HASHMAP_MAX_KEY_SIZE + 13))
     , nFlags(FLAGS::APPEND)
+    , fMeters(false)
+    , nLookups(0)
+    , nFileReads(0)
+    , setDirty()
     {
     }
 
 
     /** The Database Constructor. To determine file location and the Bytes per Record. **/
-    BinaryHashTree::BinaryHashTree(const std::string& strBaseLocationIn, uint8_t nFlagsIn)
+    BinaryHashTree::BinaryHashTree(const std::string& strBaseLocationIn, const uint8_t nFlagsIn,
+        const uint64_t nBucketsIn, const uint32_t nMaxCacheSize)
     : KEY_MUTEX()
     , strBaseLocation(strBaseLocationIn)
     , fileCache(new TemplateLRU<uint32_t, std::fstream*>(8))
     , pindex(nullptr)
-    , hashmap(256 * 256 * 24)
-    , HASHMAP_TOTAL_BUCKETS(256 * 256 * 24)
-    , HASHMAP_MAX_CACHE_SIZE(10 * 1024)
-    , HASHMAP_MAX_KEY_SIZE(32)
-    , HASHMAP_KEY_ALLOCATION(static_cast<uint16_t>(HASHMAP_MAX_KEY_SIZE + 13))
-    , nFlags(nFlagsIn)
-    {
-        Initialize();
-    }
-
-
-    /** Default Constructor **/
-    BinaryHashTree::BinaryHashTree(const std::string& strBaseLocationIn, const uint32_t nTotalBuckets, const uint32_t nMaxCacheSize,  const uint8_t nFlagsIn)
-    : KEY_MUTEX()
-    , strBaseLocation(strBaseLocationIn)
-    , fileCache(new TemplateLRU<uint32_t, std::fstream*>(8))
-    , pindex(nullptr)
-    , hashmap(nTotalBuckets)
-    , HASHMAP_TOTAL_BUCKETS(nTotalBuckets)
+    , hashmap(nBucketsIn)
+    , HASHMAP_TOTAL_BUCKETS(static_cast<uint32_t>(nBucketsIn))
     , HASHMAP_MAX_CACHE_SIZE(nMaxCacheSize)
     , HASHMAP_MAX_KEY_SIZE(32)
     , HASHMAP_KEY_ALLOCATION(static_cast<uint16_t>(HASHMAP_MAX_KEY_SIZE + 13))
     , nFlags(nFlagsIn)
+    , fMeters(config::GetBoolArg("-lldmeters", false))
+    , nLookups(0)
+    , nFileReads(0)
+    , setDirty()
     {
         Initialize();
     }
@@ -77,8 +74,22 @@ namespace LLD
     /** Copy Assignment Operator **/
     BinaryHashTree& BinaryHashTree::operator=(const BinaryHashTree& map)
     {
-        strBaseLocation       = map.strBaseLocation;
-        fileCache             = map.fileCache;
+        /* Each copy owns its own file handles, so replace rather than share them. */
+        delete fileCache;
+        delete pindex;
+
+        strBaseLocation        = map.strBaseLocation;
+        fileCache              = new TemplateLRU<uint32_t, std::fstream*>(8);
+        pindex                 = nullptr;
+        hashmap                = map.hashmap;
+        HASHMAP_TOTAL_BUCKETS  = map.HASHMAP_TOTAL_BUCKETS;
+        HASHMAP_MAX_CACHE_SIZE = map.HASHMAP_MAX_CACHE_SIZE;
+        HASHMAP_MAX_KEY_SIZE   = map.HASHMAP_MAX_KEY_SIZE;
+        HASHMAP_KEY_ALLOCATION = map.HASHMAP_KEY_ALLOCATION;
+        nFlags                 = map.nFlags;
+        fMeters                = map.fMeters;
+
+        Initialize();
 
         return *this;
     }
@@ -86,9 +97,22 @@ namespace LLD
 
     /** Copy Constructor **/
     BinaryHashTree::BinaryHashTree(const BinaryHashTree& map)
+    : KEY_MUTEX()
+    , strBaseLocation(map.strBaseLocation)
+    , fileCache(new TemplateLRU<uint32_t, std::fstream*>(8))
+    , pindex(nullptr)
+    , hashmap(map.hashmap)
+    , HASHMAP_TOTAL_BUCKETS(map.HASHMAP_TOTAL_BUCKETS)
+    , HASHMAP_MAX_CACHE_SIZE(map.HASHMAP_MAX_CACHE_SIZE)
+    , HASHMAP_MAX_KEY_SIZE(map.HASHMAP_MAX_KEY_SIZE)
+    , HASHMAP_KEY_ALLOCATION(map.HASHMAP_KEY_ALLOCATION)
+    , nFlags(map.nFlags)
+    , fMeters(map.fMeters)
+    , nLookups(0)
+    , nFileReads(0)
+    , setDirty()
     {
-        strBaseLocation    = map.strBaseLocation;
-        fileCache          = map.fileCache;
+        Initialize();
     }
 
 
@@ -204,7 +228,7 @@ namespace LLD
         pindex = new std::fstream(index, std::ios::in | std::ios::out | std::ios::binary);
 
         /* Load the stream object into the stream LRU cache. */
-        fileCache->Put(0, new std::fstream(file, std::ios::in | std::ios::out | std::ios::binary));
+        fileCache->Put(1, new std::fstream(file, std::ios::in | std::ios::out | std::ios::binary));
     }
 
 
@@ -250,20 +274,24 @@ namespace LLD
         /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
 
+        /* Update the lookup meter. */
+        if(fMeters)
+            ++nLookups;
+
         uint32_t i = 1;
         while(true)
         {
-            /* Set the new stream pointer. */
-            std::string filename = debug::safe_printstr(strBaseLocation, "_hashtree.", std::setfill('0'), std::setw(5), i);
-
-            /* Check for file. */
-            if(!filesystem::exists(filename))
-                return false;
-
             /* Find the file stream for LRU cache. */
             std::fstream *pstream;
             if(!fileCache->Get(i, pstream))
             {
+                /* Set the new stream pointer. */
+                std::string filename = debug::safe_printstr(strBaseLocation, "_hashtree.", std::setfill('0'), std::setw(5), i);
+
+                /* Check for file, a missing level ends the search. */
+                if(!filesystem::exists(filename))
+                    return false;
+
                 pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
                 if(!pstream->is_open())
                 {
@@ -280,6 +308,8 @@ namespace LLD
 
             /* Read the bucket binary data from file stream */
             pstream->read((char*) &vBucket[0], vBucket.size());
+            if(fMeters)
+                ++nFileReads;
 
             /* Check if this bucket has the key */
             //if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -358,7 +388,7 @@ namespace LLD
                 if(!filesystem::exists(filename))
                 {
                     /* Blank vector to write empty space in new disk file. */
-                    static const std::vector<uint8_t> vSpace(HASHMAP_TOTAL_BUCKETS * HASHMAP_KEY_ALLOCATION, 0xff);
+                    const std::vector<uint8_t> vSpace(HASHMAP_TOTAL_BUCKETS * HASHMAP_KEY_ALLOCATION, 0xff);
 
                     /* Write the blank data to the new file handle. */
                     std::fstream stream(filename, std::ios::out | std::ios::binary | std::ios::trunc);
@@ -407,6 +437,7 @@ namespace LLD
                 pstream->seekp (nFilePos, std::ios::beg);
                 pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
                 pstream->flush();
+                setDirty.insert(i);
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
@@ -461,17 +492,17 @@ namespace LLD
         uint32_t i = 1;
         while(true)
         {
-            /* Set the new stream pointer. */
-            std::string filename = debug::safe_printstr(strBaseLocation, "_hashtree.", std::setfill('0'), std::setw(5), i);
-
-            /* Check for file. */
-            if(!filesystem::exists(filename))
-                return debug::error(filename, " not found");
-
             /* Find the file stream for LRU cache. */
             std::fstream *pstream;
             if(!fileCache->Get(i, pstream))
             {
+                /* Set the new stream pointer. */
+                std::string filename = debug::safe_printstr(strBaseLocation, "_hashtree.", std::setfill('0'), std::setw(5), i);
+
+                /* Check for file, a missing level ends the search. */
+                if(!filesystem::exists(filename))
+                    return false;
+
                 pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
                 if(!pstream->is_open())
                 {
@@ -503,6 +534,7 @@ namespace LLD
                 pstream->seekp (nFilePos, std::ios::beg);
                 pstream->write((char*)&vBucket[0], vBucket.size());
                 pstream->flush();
+                setDirty.insert(i);
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
@@ -517,21 +549,95 @@ namespace LLD
             else if(compare(vBucket.begin(), vBucket.end(), vBlank.begin(), vBlank.end()) == 0)
                 return false;
 
-            //++i;
-            //i += 2;
+            /* Walk down the same branch that Put used. */
             i <<= 1;
-            i  |= (nCompare < 0);
+            if(nCompare > 0)
+                i |= 1;
         }
 
         return false;
     }
 
 
+    /*  Read a batch of keys from the disk hashtree, ordered by bucket. */
+    bool BinaryHashTree::Get(const std::vector< std::vector<uint8_t> >& vKeys, std::vector<SectorKey>& vSectorKeys)
+    {
+        /* Calculate the buckets for the batch. */
+        std::vector< std::pair<uint32_t, uint32_t> > vOrder;
+        vOrder.reserve(vKeys.size());
+        for(uint32_t n = 0; n < vKeys.size(); ++n)
+            vOrder.push_back(std::make_pair(GetBucket(vKeys[n]), n));
+
+        /* Sort so that keys sharing a bucket are read together. */
+        std::sort(vOrder.begin(), vOrder.end());
+
+        /* Read the keys in bucket order. */
+        bool fFound = true;
+        for(const auto& order : vOrder)
+        {
+            SectorKey cKey;
+            if(!Get(vKeys[order.second], cKey))
+            {
+                fFound = false;
+                continue;
+            }
+
+            vSectorKeys.push_back(cKey);
+        }
+
+        return fFound;
+    }
+
+
+    /*  Write a batch of keys to the disk hashtree, ordered by bucket. */
+    bool BinaryHashTree::Put(const std::vector<SectorKey>& vKeys)
+    {
+        /* Calculate the buckets for the batch. */
+        std::vector< std::pair<uint32_t, uint32_t> > vOrder;
+        vOrder.reserve(vKeys.size());
+        for(uint32_t n = 0; n < vKeys.size(); ++n)
+            vOrder.push_back(std::make_pair(GetBucket(vKeys[n].vKey), n));
+
+        /* Stable sort so that duplicate keys keep their order and the last write wins. */
+        std::stable_sort(vOrder.begin(), vOrder.end(),
+            [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b)
+            {
+                return a.first < b.first;
+            });
+
+        /* Write the keys in bucket order. */
+        for(const auto& order : vOrder)
+            if(!Put(vKeys[order.second]))
+                return false;
+
+        return true;
+    }
+
+
+    /*  Flush all buffers to disk if using ACID transaction. */
+    void BinaryHashTree::Flush()
+    {
+        LOCK(KEY_MUTEX);
+
+        /* Every write flushes its stream, so sync the files written since the last flush. */
+        for(const uint32_t nFile : setDirty)
+        {
+            RandomAccessFile file(debug::safe_printstr(strBaseLocation, "_hashtree.", std::setfill('0'), std::setw(5), nFile));
+            if(!file.Sync())
+                debug::error(FUNCTION, "failed to sync hashtree file ", nFile);
+        }
+
+        setDirty.clear();
+    }
+
+
     /*  Restore an index in the hashmap if it is found. */
     bool BinaryHashTree::Restore(const std::vector<uint8_t> &vKey)
     {
         LOCK(KEY_MUTEX);
 
+        static const std::vector<uint8_t> vBlank(HASHMAP_KEY_ALLOCATION, 0xff);
+
         /* Get the assigned bucket for the hashmap. */
         uint32_t nBucket = GetBucket(vKey);
 
@@ -542,18 +648,29 @@ namespace LLD
         std::vector<uint8_t> vKeyCompressed = vKey;
         CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
 
-        /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
+        /* Walk the tree levels from the root to find the key. */
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
-        for(int i = hashmap[nBucket] - 1; i >= 0; --i)
+
+        uint32_t i = 1;
+        while(true)
         {
             /* Find the file stream for LRU cache. */
             std::fstream* pstream;
             if(!fileCache->Get(i, pstream))
             {
                 /* Set the new stream pointer. */
-                pstream = new std::fstream(
-                  debug::safe_printstr(strBaseLocation, "_hashtree.", std::setfill('0'), std::setw(5), i),
-                  std::ios::in | std::ios::out | std::ios::binary);
+                std::string filename = debug::safe_printstr(strBaseLocation, "_hashtree.", std::setfill('0'), std::setw(5), i);
+
+                /* Check for file, a missing level ends the search. */
+                if(!filesystem::exists(filename))
+                    return false;
+
+                pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
+                if(!pstream->is_open())
+                {
+                    delete pstream;
+                    return false;
+                }
 
                 /* If file not found add to LRU cache. */
                 fileCache->Put(i, pstream);
@@ -566,24 +683,26 @@ namespace LLD
             pstream->read((char*) &vBucket[0], vBucket.size());
 
             /* Check if this bucket has the key */
-            if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
+            int32_t nCompare = compare(vBucket.begin() + 13, vBucket.end(), vKeyCompressed.begin(), vKeyCompressed.end());
+            if(nCompare == 0)
             {
                 /* Deserialize key and return if found. */
                 DataStream ssKey(vBucket, SER_LLD, DATABASE_VERSION);
                 SectorKey cKey;
                 ssKey >> cKey;
 
-                /* Skip over keys that are already erased. */
+                /* Skip over keys that are already restored. */
                 if(cKey.Ready())
                     return true;
 
                 /* Seek to the hashmap index in file. */
                 pstream->seekp (nFilePos, std::ios::beg);
 
-                /* Read the bucket binary data from file stream */
-                std::vector<uint8_t> vReady(STATE::READY);
+                /* Write the ready state over the key state. */
+                std::vector<uint8_t> vReady(1, STATE::READY);
                 pstream->write((char*) &vReady[0], vReady.size());
                 pstream->flush();
+                setDirty.insert(i);
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
@@ -591,7 +710,7 @@ namespace LLD
                         " | Length: ", cKey.nLength,
                         " | Bucket ", nBucket,
                         " | Location: ", nFilePos,
-                        " | File: ", hashmap[nBucket] - 1,
+                        " | File: ", i,
                         " | Sector File: ", cKey.nSectorFile,
                         " | Sector Size: ", cKey.nSectorSize,
                         " | Sector Start: ", cKey.nSectorStart,
@@ -599,10 +718,34 @@ namespace LLD
 
                 return true;
             }
+            else if(compare(vBucket.begin(), vBucket.end(), vBlank.begin(), vBlank.end()) == 0)
+                return false;
+
+            /* Walk down the same branch that Put used. */
+            i <<= 1;
+            if(nCompare > 0)
+                i |= 1;
         }
 
         return false;
     }
 
 
+    /* Log and reset the keychain lookup meters. */
+    void BinaryHashTree::Meters(const std::string& strName)
+    {
+        /* Get the current meters. */
+        const uint64_t nTotalLookups = nLookups.exchange(0);
+        const uint64_t nTotalReads   = nFileReads.exchange(0);
+
+        /* Check for zero values. */
+        if(nTotalLookups == 0)
+            return;
+
+        /* Debug output. */
+        debug::log(0,
+            ANSI_COLOR_FUNCTION, strName, " LLD : ", ANSI_COLOR_RESET,
+            "Tree Keychain ", nTotalLookups, " lookups | ",
+            "Reads ", double(nTotalReads) / nTotalLookups, " per lookup");
+    }
 }
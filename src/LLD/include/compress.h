@@ -0,0 +1,58 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_INCLUDE_COMPRESS_H
+#define NEXUS_LLD_INCLUDE_COMPRESS_H
+
+#include <cstdint>
+#include <vector>
+
+namespace LLD
+{
+
+    /** The first byte of a compressed record. Raw records begin with the compact size
+     *  of their type string, which would need a string over 4 GB to reach this value.
+     **/
+    const uint8_t RECORD_COMPRESSED = 0xff;
+
+
+    /** Compress
+     *
+     *  LZ4 compress a record into its stored form, a marker byte and the raw
+     *  size followed by the compressed bytes.
+     *
+     *  @param[in] vData The raw record.
+     *  @param[out] vStored The stored record.
+     *  @param[in] nMinSize The smallest record worth compressing.
+     *
+     *  @return True if the record was compressed and is smaller, false to store it raw.
+     *
+     **/
+    bool Compress(const std::vector<uint8_t>& vData, std::vector<uint8_t>& vStored, const uint32_t nMinSize);
+
+
+    /** Decompress
+     *
+     *  Decompress a stored record in place, leaving raw records as they are.
+     *
+     *  @param[in,out] vData The stored record, replaced with the raw record.
+     *
+     *  @return False if a compressed record is corrupted.
+     *
+     **/
+    bool Decompress(std::vector<uint8_t>& vData);
+
+}
+
+#endif
@@ -29,7 +29,9 @@ namespace LLD
         READONLY      = (1 << 2),
         CREATE        = (1 << 3),
         WRITE         = (1 << 4),
-        FORCE         = (1 << 5)
+        FORCE         = (1 << 5),
+        MMAP          = (1 << 6),
+        COMPRESS      = (1 << 7)
     };
 
 
@@ -45,6 +47,41 @@ namespace LLD
         TRANSACTION     = 2
     };
 
+
+    /** JOURNAL
+     *
+     *  Opcodes for records in the write ahead log.
+     *
+     **/
+    namespace JOURNAL
+    {
+        enum
+        {
+            ERASE         = 0x01,
+            KEY           = 0x02,
+            WRITE         = 0x03,
+            INDEX         = 0x04,
+            COMMIT        = 0x05,
+            DATABASE      = 0x06
+        };
+    }
+
+
+    /** SYNC
+     *
+     *  Policies for syncing the write ahead log to disk.
+     *
+     **/
+    namespace SYNC
+    {
+        enum
+        {
+            NONE          = 0,
+            INTERVAL      = 1,
+            ALWAYS        = 2
+        };
+    }
+
 }
 
 #endif
@@ -55,7 +55,8 @@ namespace LLD
 
     /** TxnRecover
      *
-     *  Check the transactions for recovery.
+     *  Check the transactions for recovery, replaying the per database
+     *  journals of older releases once before the shared journal.
      *
      **/
     void TxnRecovery();
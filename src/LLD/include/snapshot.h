@@ -0,0 +1,99 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_INCLUDE_SNAPSHOT_H
+#define NEXUS_LLD_INCLUDE_SNAPSHOT_H
+
+#include <cstdint>
+
+namespace LLD
+{
+
+    /** Snapshot
+     *
+     *  Pins the current commit epoch for the reads of this thread while in scope.
+     *  Reads under a snapshot skip the transaction lock and see every database as
+     *  it was at the pinned epoch, even while a block is being committed.
+     *
+     *  A thread with a pending transaction should not pin a snapshot, since it
+     *  would not see its own writes. Nested snapshots keep the outer epoch.
+     *
+     **/
+    class Snapshot
+    {
+        /** The pinned epoch, zero if an outer snapshot already holds one. **/
+        uint64_t nEpoch;
+
+    public:
+
+        /** Default Constructor. Pins the current epoch. **/
+        Snapshot();
+
+
+        /** Copy Constructor. **/
+        Snapshot(const Snapshot&)            = delete;
+
+
+        /** Copy Assignment. **/
+        Snapshot& operator=(const Snapshot&) = delete;
+
+
+        /** Default Destructor. Releases the pinned epoch. **/
+        ~Snapshot();
+
+
+        /** Pinned
+         *
+         *  Get the epoch pinned by this thread.
+         *
+         *  @return The pinned epoch, or zero if the thread has no snapshot.
+         *
+         **/
+        static uint64_t Pinned();
+
+
+        /** Oldest
+         *
+         *  Get the oldest epoch that a snapshot could still read.
+         *
+         *  @return The oldest pinned epoch, or the current epoch if none are pinned.
+         *
+         **/
+        static uint64_t Oldest();
+
+
+        /** Reserve
+         *
+         *  Reserve the epoch of the next commit, which snapshots do not see until it is published.
+         *
+         *  @return The reserved epoch.
+         *
+         **/
+        static uint64_t Reserve();
+
+
+        /** Publish
+         *
+         *  Make a reserved epoch current, so new snapshots see the commit.
+         *
+         *  @param[in] nEpochIn The reserved epoch to publish.
+         *
+         *  @return True if snapshots are pinned at older epochs and need the values the commit replaces.
+         *
+         **/
+        static bool Publish(const uint64_t nEpochIn);
+    };
+}
+
+#endif
@@ -0,0 +1,157 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/keychain/keychain.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/keychain/shard_hashmap.h>
+#include <LLD/keychain/hashtree.h>
+#include <LLD/include/enum.h>
+#include <LLD/include/version.h>
+#include <LLD/templates/randomfile.h>
+
+#include <Util/templates/datastream.h>
+#include <Util/include/args.h>
+#include <Util/include/debug.h>
+#include <Util/include/filesystem.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+
+namespace LLD
+{
+
+    /* Read the keychain backend recorded in the keychain directory. */
+    std::string ReadKeychainType(const std::string& strBaseLocation)
+    {
+        /* Keychains that recorded their backend. */
+        const std::string strMeta = strBaseLocation + "_keychain.type";
+        if(filesystem::exists(strMeta))
+        {
+            std::ifstream stream(strMeta, std::ios::in | std::ios::binary);
+            std::vector<uint8_t> vMeta((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+            try
+            {
+                std::string strType;
+
+                const DataStream ssMeta(vMeta, SER_LLD, DATABASE_VERSION);
+                ssMeta >> strType;
+
+                return strType;
+            }
+            catch(const std::exception& e)
+            {
+                throw debug::exception(FUNCTION, "malformed keychain type ", strMeta, ": ", e.what());
+            }
+        }
+
+        /* Keychains written before the backend was recorded are known by their files. */
+        if(filesystem::exists(strBaseLocation + "_hashmap.index"))
+            return "hashmap";
+
+        if(filesystem::exists(strBaseLocation + "_index.000"))
+            return "shard";
+
+        if(filesystem::exists(strBaseLocation + "_hashtree.index"))
+            return "hashtree";
+
+        return "";
+    }
+
+
+    /* Record the keychain backend in the keychain directory. */
+    bool WriteKeychainType(const std::string& strBaseLocation, const std::string& strType)
+    {
+        /* Make sure the directory exists before the backend creates its files. */
+        if(!filesystem::exists(strBaseLocation))
+            filesystem::create_directories(strBaseLocation);
+
+        /* Serialize the backend type. */
+        DataStream ssMeta(SER_LLD, DATABASE_VERSION);
+        ssMeta << strType;
+
+        /* Write and sync a temporary file. */
+        const std::string strMeta = strBaseLocation + "_keychain.type";
+        {
+            RandomAccessFile file(strMeta + ".tmp", true);
+            if(file.IsNull() || !file.Truncate(0) || !file.Write(0, ssMeta.Bytes()) || !file.Sync())
+                return debug::error(FUNCTION, "failed to write keychain type ", strMeta);
+        }
+
+        /* Replace any old record in one step. */
+        if(!filesystem::rename(strMeta + ".tmp", strMeta))
+            return debug::error(FUNCTION, "failed to replace keychain type ", strMeta);
+
+        return true;
+    }
+
+
+    /* Create the keychain backend selected by -<name>keychain. */
+    Keychain* Keychain::Create(const std::string& strName, const std::string& strBaseLocation,
+                               const uint8_t nFlags, const uint64_t nBuckets)
+    {
+        /* Build the argument name from the database name, so _LEDGER reads -ledgerkeychain. */
+        std::string strArg = strName.substr(std::min(strName.find_first_not_of('_'), strName.size()));
+        std::transform(strArg.begin(), strArg.end(), strArg.begin(), ::tolower);
+
+        /* Get the requested backend, falling back to the binary hashmap for unknown types. */
+        const std::string strRequest = config::GetArg("-" + strArg + "keychain", "");
+
+        std::string strType = strRequest.empty() ? "hashmap" : strRequest;
+        if(strType != "hashmap" && strType != "shard" && strType != "hashtree")
+        {
+            debug::error(FUNCTION, "unknown keychain type ", strType, " for ", strName, ", using hashmap");
+            strType = "hashmap";
+        }
+
+        /* Each backend only reads its own files, so an existing keychain keeps the backend it was created with. */
+        const std::string strStored = ReadKeychainType(strBaseLocation);
+        if(!strStored.empty())
+        {
+            if(!strRequest.empty() && strType != strStored)
+                throw debug::exception(FUNCTION, strName, " keychain was created as ", strStored, " and can't be opened as ", strType,
+                                       ", remove the database and resync to change it");
+
+            strType = strStored;
+        }
+
+        /* Record the backend of new keychains and of keychains from before it was recorded. */
+        if(!filesystem::exists(strBaseLocation + "_keychain.type") && !(nFlags & FLAGS::READONLY)
+        && (nFlags & (FLAGS::CREATE | FLAGS::WRITE | FLAGS::APPEND | FLAGS::FORCE)))
+            WriteKeychainType(strBaseLocation, strType);
+
+        /* Create the selected backend. */
+        if(strType == "shard")
+        {
+            debug::log(0, FUNCTION, strName, " using shard hashmap keychain");
+            return new ShardHashMap(strBaseLocation, nFlags, nBuckets);
+        }
+
+        if(strType == "hashtree")
+        {
+            debug::log(0, FUNCTION, strName, " using binary hashtree keychain");
+            return new BinaryHashTree(strBaseLocation, nFlags, nBuckets);
+        }
+
+        BinaryHashMap* pmap = new BinaryHashMap(strBaseLocation, nFlags, nBuckets);
+
+        /* Start an online rehash if -<name>rehash asks for a new bucket count. */
+        const uint32_t nRehash = static_cast<uint32_t>(config::GetArg("-" + strArg + "rehash", 0));
+        if(nRehash > 0)
+            pmap->Rehash(nRehash);
+
+        return pmap;
+    }
+}
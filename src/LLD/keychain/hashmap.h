@@ -16,14 +16,17 @@ ________________________________________________________________________________
 #define NEXUS_LLD_KEYCHAIN_HASHMAP_H
 
 #include <LLD/keychain/keychain.h>
-#include <LLD/cache/template_lru.h>
+#include <LLD/templates/bloom.h>
+#include <LLD/templates/randomfile.h>
 #include <LLD/include/enum.h>
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <fstream>
 #include <vector>
 #include <mutex>
+#include <thread>
 
 namespace LLD
 {
@@ -41,7 +44,7 @@ namespace LLD
     {
     protected:
 
-        /** Mutex for Thread Synchronization. **/
+        /** Mutex for opening and creating hashmap files. **/
         mutable std::mutex KEY_MUTEX;
 
 
@@ -49,12 +52,12 @@ namespace LLD
         std::string strBaseLocation;
 
 
-        /** Keychain stream object. **/
-        TemplateLRU<uint16_t, std::fstream*> *fileCache;
+        /** Keychain file objects, indexed by file number. **/
+        std::vector< std::atomic<RandomAccessFile*> > vFiles;
 
 
-        /** Keychain index stream. **/
-        std::fstream* pindex;
+        /** Keychain index file. **/
+        RandomAccessFile* pindex;
 
 
         /** Total elements in hashmap for quick inserts. **/
@@ -77,12 +80,57 @@ namespace LLD
         uint8_t nFlags;
 
 
-        /* The key level locking hashmap. */
+        /** Striped bucket locks, a bucket is guarded by RECORD_MUTEX[nBucket % size]. **/
         mutable std::vector<std::mutex> RECORD_MUTEX;
 
 
+        /** Bloom filters for each hashmap file, indexed by file number. **/
+        std::vector< std::atomic<BloomFilter*> > vFilters;
+
+
+        /** Flag to determine if meters are enabled. **/
+        bool fMeters;
+
+
+        /** Meters for lookups, hashmap file reads, and files skipped by filters. **/
+        std::atomic<uint64_t> nLookups;
+        std::atomic<uint64_t> nFileReads;
+        std::atomic<uint64_t> nFilterSkips;
+
+
+        /** The keychain directory, which holds the table metadata and rehashed tables. **/
+        std::string strRootLocation;
+
+
+        /** The bucket hash version, tables past version zero hash the compressed key. **/
+        uint8_t nHashVersion;
+
+
+        /** The table generation, incremented each time a rehash completes. **/
+        std::atomic<uint32_t> nGeneration;
+
+
+        /** The larger table that keys are being migrated into, if a rehash is running. **/
+        BinaryHashMap* pRehash;
+
+
+        /** The next bucket of this table to migrate into the rehash table. **/
+        std::atomic<uint32_t> nRehashBucket;
+
+
+        /** Thread that migrates buckets into the rehash table. **/
+        std::thread RehashThread;
+
+
+        /** Flag to stop the rehash thread. **/
+        std::atomic<bool> fRehashStop;
+
+
     public:
 
+        /** The number of buckets migrated between rehash checkpoints. **/
+        static const uint32_t REHASH_CHECKPOINT = 4096;
+
 
         /** Default Constructor. **/
         BinaryHashMap() = delete;
@@ -157,6 +205,19 @@ namespace LLD
         bool Get(const std::vector<uint8_t>& vKey, SectorKey &cKey);
 
 
+        /** Get
+         *
+         *  Read a batch of keys from the disk hashmaps, ordered by bucket.
+         *
+         *  @param[in] vKeys The binary data of the keys.
+         *  @param[out] vSectorKeys The key objects found, in the order they were read.
+         *
+         *  @return True if all keys were found, false otherwise.
+         *
+         **/
+        bool Get(const std::vector< std::vector<uint8_t> >& vKeys, std::vector<SectorKey>& vSectorKeys);
+
+
         /** Put
          *
          *  Write a key to the disk hashmaps.
@@ -169,6 +230,19 @@ namespace LLD
         bool Put(const SectorKey& cKey);
 
 
+        /** Put
+         *
+         *  Write a batch of keys to the disk hashmaps, ordered by bucket so
+         *  that writes walk each hashmap file in ascending offsets.
+         *
+         *  @param[in] vKeys The key objects to write.
+         *
+         *  @return True if all the keys were written, false otherwise.
+         *
+         **/
+        bool Put(const std::vector<SectorKey>& vKeys);
+
+
         /** Flush
          *
          *  Flush all buffers to disk if using ACID transaction.
@@ -200,6 +274,197 @@ namespace LLD
          *
          **/
         bool Erase(const std::vector<uint8_t> &vKey);
+
+
+        /** Meters
+         *
+         *  Log and reset the keychain lookup meters.
+         *
+         *  @param[in] strName The name of the database for output.
+         *
+         **/
+        void Meters(const std::string& strName);
+
+
+        /** FileReads
+         *
+         *  Get the number of hashmap file reads since the meters were last logged.
+         *
+         **/
+        uint64_t FileReads() const;
+
+
+        /** Rehash
+         *
+         *  Start migrating the keys into a new table with the given number of
+         *  buckets. Reads and writes are served from both tables while the
+         *  rehash runs in the background, and progress is checkpointed in the
+         *  table metadata so that a restart resumes where it left off.
+         *
+         *  @param[in] nBucketsNew The number of buckets in the new table.
+         *
+         *  @return True if the rehash was started or is already running.
+         *
+         **/
+        bool Rehash(const uint32_t nBucketsNew);
+
+
+    private:
+
+        /** LockBucket
+         *
+         *  Get the bucket for a key and lock its stripe, retrying if a rehash
+         *  swaps in a new table while waiting on the lock.
+         *
+         *  @param[in] vKey The binary data of the key.
+         *  @param[out] nBucket The bucket assigned to the key.
+         *
+         *  @return The lock on the bucket stripe.
+         *
+         **/
+        std::unique_lock<std::mutex> lock_bucket(const std::vector<uint8_t>& vKey, uint32_t& nBucket);
+
+
+        /** TableLocation
+         *
+         *  Get the directory of the table for a given generation.
+         *
+         *  @param[in] nGen The table generation.
+         *
+         **/
+        std::string table_location(const uint32_t nGen) const;
+
+
+        /** ReadMeta
+         *
+         *  Read the table metadata, setting the hash version, generation, and
+         *  bucket count of this table.
+         *
+         *  @param[out] nRehashBuckets The buckets of a running rehash, or zero.
+         *  @param[out] nRehashCursor The checkpointed rehash bucket.
+         *
+         *  @return False if there is no metadata.
+         *
+         **/
+        bool read_meta(uint32_t& nRehashBuckets, uint32_t& nRehashCursor);
+
+
+        /** WriteMeta
+         *
+         *  Write the table metadata, replacing the old metadata atomically.
+         *
+         *  @param[in] nRehashBuckets The buckets of a running rehash, or zero.
+         *  @param[in] nRehashCursor The rehash bucket to checkpoint.
+         *
+         *  @return True if the metadata was written.
+         *
+         **/
+        bool write_meta(const uint32_t nRehashBuckets, const uint32_t nRehashCursor);
+
+
+        /** StartRehash
+         *
+         *  Open the rehash table and start the rehash thread.
+         *
+         *  @param[in] nBucketsNew The number of buckets in the new table.
+         *  @param[in] nCursor The bucket to start migrating from.
+         *
+         *  @return True if the rehash was started.
+         *
+         **/
+        bool start_rehash(const uint32_t nBucketsNew, const uint32_t nCursor);
+
+
+        /** RehashThread
+         *
+         *  Migrate the buckets of this table one at a time, checkpointing the
+         *  progress, and swap in the new table when done.
+         *
+         **/
+        void rehash_thread();
+
+
+        /** MigrateBucket
+         *
+         *  Copy the keys of a bucket into the rehash table, skipping keys that
+         *  were written to the new table after the rehash started.
+         *
+         *  @param[in] nBucket The bucket to migrate.
+         *
+         *  @return True if the bucket was migrated.
+         *
+         **/
+        bool migrate_bucket(const uint32_t nBucket);
+
+
+        /** FinishRehash
+         *
+         *  Swap the rehash table in as this table and remove the old table.
+         *
+         *  @return True if the new table was committed.
+         *
+         **/
+        bool finish_rehash();
+
+
+        /** RemoveTable
+         *
+         *  Remove the files of a table that was replaced by a rehash.
+         *
+         *  @param[in] strLocation The directory of the table.
+         *
+         **/
+        void remove_table(const std::string& strLocation);
+
+
+        /** GetFile
+         *
+         *  Get the file object for a hashmap file, opening it if needed.
+         *
+         *  @param[in] nFile The hashmap file to get.
+         *
+         *  @return The file object, or nullptr if it couldn't be opened.
+         *
+         **/
+        RandomAccessFile* get_file(const uint16_t nFile);
+
+
+        /** LoadFilter
+         *
+         *  Load the bloom filter for a hashmap file, rebuilding it from the
+         *  hashmap file if it is missing.
+         *
+         *  @param[in] nFile The hashmap file to load the filter for.
+         *
+         *  @return The filter object, or nullptr on failure.
+         *
+         **/
+        BloomFilter* load_filter(const uint16_t nFile);
+
+
+        /** CheckFilter
+         *
+         *  Check if a hashmap file may contain the given key.
+         *
+         *  @param[in] nFile The hashmap file to check.
+         *  @param[in] vKeyCompressed The compressed key to check for.
+         *
+         *  @return False if the file is known not to have the key.
+         *
+         **/
+        bool check_filter(const uint16_t nFile, const std::vector<uint8_t>& vKeyCompressed);
+
+
+        /** InsertFilter
+         *
+         *  Add a key to the filter of a hashmap file, creating the filter
+         *  if it doesn't exist yet.
+         *
+         *  @param[in] nFile The hashmap file the key is written to.
+         *  @param[in] vKeyCompressed The compressed key to add.
+         *
+         **/
+        void insert_filter(const uint16_t nFile, const std::vector<uint8_t>& vKeyCompressed);
     };
 }
 
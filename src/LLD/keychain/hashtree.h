@@ -15,17 +15,18 @@ ________________________________________________________________________________
 #ifndef NEXUS_LLD_TEMPLATES_HASHTREE_H
 #define NEXUS_LLD_TEMPLATES_HASHTREE_H
 
-#include <LLD/templates/key.h>
+#include <LLD/keychain/keychain.h>
 #include <LLD/cache/template_lru.h>
 #include <LLD/include/enum.h>
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <fstream>
 #include <vector>
 #include <mutex>
+#include <set>
 
-//TODO: Abstract base class for all keychains
 namespace LLD
 {
 
@@ -38,7 +39,7 @@ namespace LLD
      *  when there is a collision that is found.
      *
      **/
-    class BinaryHashTree
+    class BinaryHashTree : public Keychain
     {
     protected:
 
@@ -82,6 +83,19 @@ namespace LLD
         uint8_t nFlags;
 
 
+        /** Flag to determine if meters are enabled. **/
+        bool fMeters;
+
+
+        /** Meters for lookups and hashtree file reads. **/
+        std::atomic<uint64_t> nLookups;
+        std::atomic<uint64_t> nFileReads;
+
+
+        /** The hashtree files written since the last flush. **/
+        std::set<uint32_t> setDirty;
+
+
     public:
 
         /** Default Constructor **/
@@ -89,11 +103,8 @@ namespace LLD
 
 
         /** The Database Constructor. To determine file location and the Bytes per Record. **/
-        BinaryHashTree(const std::string& strBaseLocationIn, const uint8_t nFlagsIn = FLAGS::APPEND);
-
-
-        /** Default Constructor **/
-        BinaryHashTree(const std::string& strBaseLocationIn, const uint32_t nTotalBuckets, const uint32_t nMaxCacheSize, const uint8_t nFlagsIn = FLAGS::APPEND);
+        BinaryHashTree(const std::string& strBaseLocationIn, const uint8_t nFlagsIn = FLAGS::APPEND,
+            const uint64_t nBucketsIn = 256 * 256 * 24, const uint32_t nMaxCacheSize = 10 * 1024);
 
 
         /** Copy Assignment Operator **/
@@ -161,6 +172,19 @@ namespace LLD
         bool Get(const std::vector<uint8_t>& vKey, SectorKey &cKey);
 
 
+        /** Get
+         *
+         *  Read a batch of keys from the disk hashtree, ordered by bucket.
+         *
+         *  @param[in] vKeys The binary data of the keys.
+         *  @param[out] vSectorKeys The key objects found, in the order they were read.
+         *
+         *  @return True if all keys were found, false otherwise.
+         *
+         **/
+        bool Get(const std::vector< std::vector<uint8_t> >& vKeys, std::vector<SectorKey>& vSectorKeys);
+
+
         /** Put
          *
          *  Write a key to the disk hashmaps.
@@ -173,6 +197,27 @@ namespace LLD
         bool Put(const SectorKey& cKey);
 
 
+        /** Put
+         *
+         *  Write a batch of keys to the disk hashtree, ordered by bucket so
+         *  that each level is written in ascending offsets.
+         *
+         *  @param[in] vKeys The key objects to write.
+         *
+         *  @return True if all the keys were written, false otherwise.
+         *
+         **/
+        bool Put(const std::vector<SectorKey>& vKeys);
+
+
+        /** Flush
+         *
+         *  Flush all buffers to disk if using ACID transaction.
+         *
+         **/
+        void Flush();
+
+
         /** Restore
          *
          *  Restore an erased key from keychain.
@@ -196,6 +241,16 @@ namespace LLD
          *
          **/
         bool Erase(const std::vector<uint8_t> &vKey);
+
+
+        /** Meters
+         *
+         *  Log and reset the keychain lookup meters.
+         *
+         *  @param[in] strName The name of the database for output.
+         *
+         **/
+        void Meters(const std::string& strName);
     };
 }
 
@@ -17,6 +17,9 @@ ________________________________________________________________________________
 
 #include <LLD/templates/key.h>
 
+#include <string>
+#include <vector>
+
 namespace LLD
 {
 
@@ -47,6 +50,19 @@ namespace LLD
         virtual bool Get(const std::vector<uint8_t>& vKey, SectorKey &cKey) = 0;
 
 
+        /** Get
+         *
+         *  Read a batch of keys from the keychain.
+         *
+         *  @param[in] vKeys The binary data of the keys.
+         *  @param[out] vSectorKeys The key objects found, in the order they were read.
+         *
+         *  @return True if all keys were found, false otherwise.
+         *
+         **/
+        virtual bool Get(const std::vector< std::vector<uint8_t> >& vKeys, std::vector<SectorKey>& vSectorKeys) = 0;
+
+
         /** Put
          *
          *  Write a key to the keychain.
@@ -59,6 +75,18 @@ namespace LLD
         virtual bool Put(const SectorKey& cKey) = 0;
 
 
+        /** Put
+         *
+         *  Write a batch of keys to the keychain.
+         *
+         *  @param[in] vKeys The key objects to write.
+         *
+         *  @return True if all keys were written, false otherwise.
+         *
+         **/
+        virtual bool Put(const std::vector<SectorKey>& vKeys) = 0;
+
+
         /** Flush
          *
          *  Flush all buffers to disk if using ACID transaction.
@@ -89,7 +117,66 @@ namespace LLD
          *
          **/
         virtual bool Erase(const std::vector<uint8_t>& vKey) = 0;
+
+
+        /** Meters
+         *
+         *  Log the keychain meters and reset them.
+         *
+         *  @param[in] strName The name of the database for the log.
+         *
+         **/
+        virtual void Meters(const std::string& strName) = 0;
+
+
+        /** Create
+         *
+         *  Create the keychain backend selected by -<name>keychain, where name
+         *  is the database name in lowercase without leading underscores.
+         *  Supported backends are hashmap (default), shard, and hashtree.
+         *
+         *  The backend is recorded in the keychain directory when it is first
+         *  created, and an existing keychain always opens with it. Asking for a
+         *  different backend throws, since it would open an empty keychain over
+         *  the existing sector files.
+         *
+         *  @param[in] strName The name of the database.
+         *  @param[in] strBaseLocation The directory of the keychain files.
+         *  @param[in] nFlags The keychain flags.
+         *  @param[in] nBuckets The total buckets per hashmap file.
+         *
+         *  @return The new keychain object.
+         *
+         **/
+        static Keychain* Create(const std::string& strName, const std::string& strBaseLocation,
+                                const uint8_t nFlags, const uint64_t nBuckets);
     };
+
+
+    /** ReadKeychainType
+     *
+     *  Read the keychain backend recorded in a keychain directory, detecting
+     *  it from the files of keychains written before it was recorded.
+     *
+     *  @param[in] strBaseLocation The directory of the keychain files.
+     *
+     *  @return The backend type, or an empty string for a new keychain.
+     *
+     **/
+    std::string ReadKeychainType(const std::string& strBaseLocation);
+
+
+    /** WriteKeychainType
+     *
+     *  Record the keychain backend in a keychain directory.
+     *
+     *  @param[in] strBaseLocation The directory of the keychain files.
+     *  @param[in] strType The backend type.
+     *
+     *  @return True if the type was written.
+     *
+     **/
+    bool WriteKeychainType(const std::string& strBaseLocation, const std::string& strType);
 }
 
 #endif
@@ -15,17 +15,18 @@ ________________________________________________________________________________
 #ifndef NEXUS_LLD_TEMPLATES_SHARD_HASHMAP_H
 #define NEXUS_LLD_TEMPLATES_SHARD_HASHMAP_H
 
-#include <LLD/templates/key.h>
+#include <LLD/keychain/keychain.h>
 #include <LLD/cache/template_lru.h>
 #include <LLD/include/enum.h>
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <fstream>
 #include <vector>
 #include <mutex>
+#include <set>
 
-//TODO: Abstract base class for all keychains
 namespace LLD
 {
 
@@ -38,7 +39,7 @@ namespace LLD
      *  when there is a collision that is found.
      *
      **/
-    class ShardHashMap
+    class ShardHashMap : public Keychain
     {
     protected:
 
@@ -86,6 +87,23 @@ namespace LLD
         mutable std::vector<std::mutex> RECORD_MUTEX;
 
 
+        /** Flag to determine if meters are enabled. **/
+        bool fMeters;
+
+
+        /** Meters for lookups and hashmap file reads. **/
+        std::atomic<uint64_t> nLookups;
+        std::atomic<uint64_t> nFileReads;
+
+
+        /** The shard and number of the hashmap files written since the last flush. **/
+        std::set< std::pair<uint16_t, uint16_t> > setDirty;
+
+
+        /** The shards with index files written since the last flush. **/
+        std::set<uint16_t> setDirtyIndex;
+
+
     public:
 
 
@@ -162,6 +180,19 @@ namespace LLD
         bool Get(const std::vector<uint8_t>& vKey, SectorKey &cKey);
 
 
+        /** Get
+         *
+         *  Read a batch of keys from the disk hashmaps, ordered by shard and bucket.
+         *
+         *  @param[in] vKeys The binary data of the keys.
+         *  @param[out] vSectorKeys The key objects found, in the order they were read.
+         *
+         *  @return True if all keys were found, false otherwise.
+         *
+         **/
+        bool Get(const std::vector< std::vector<uint8_t> >& vKeys, std::vector<SectorKey>& vSectorKeys);
+
+
         /** Get
          *
          *  Read a key index from the disk hashmaps.
@@ -188,6 +219,27 @@ namespace LLD
         bool Put(const SectorKey& cKey);
 
 
+        /** Put
+         *
+         *  Write a batch of keys to the disk hashmaps, ordered by shard and
+         *  bucket so that each shard's files are written in ascending offsets.
+         *
+         *  @param[in] vKeys The key objects to write.
+         *
+         *  @return True if all the keys were written, false otherwise.
+         *
+         **/
+        bool Put(const std::vector<SectorKey>& vKeys);
+
+
+        /** Flush
+         *
+         *  Flush all buffers to disk if using ACID transaction.
+         *
+         **/
+        void Flush();
+
+
         /** Restore
          *
          *  Restore an erased key from keychain.
@@ -211,6 +263,16 @@ namespace LLD
          *
          **/
         bool Erase(const std::vector<uint8_t> &vKey);
+
+
+        /** Meters
+         *
+         *  Log and reset the keychain lookup meters.
+         *
+         *  @param[in] strName The name of the database for output.
+         *
+         **/
+        void Meters(const std::string& strName);
     };
 }
 
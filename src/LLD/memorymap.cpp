@@ -0,0 +1,138 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/memorymap.h>
+
+#include <Util/include/debug.h>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+namespace LLD
+{
+
+    /* File Constructor. */
+    MemoryMap::MemoryMap(const std::string& strFile, const uint64_t nReserveIn)
+    : nFile     (-1)
+    , pBegin    (nullptr)
+    , nReserved (nReserveIn)
+    , nFileSize (0)
+    {
+    #ifndef WIN32
+        /* Open the file descriptor for reading. */
+        nFile = ::open(strFile.c_str(), O_RDONLY);
+        if(nFile < 0)
+        {
+            debug::error(FUNCTION, "failed to open ", strFile, " (", strerror(errno), ")");
+            return;
+        }
+
+        /* Get the current size of the file. */
+        struct stat stat;
+        if(::fstat(nFile, &stat) == 0)
+            nFileSize.store(static_cast<uint64_t>(stat.st_size));
+
+        /* Reserve the full window so that file growth doesn't require a remap. */
+        void* pMap = ::mmap(nullptr, nReserved, PROT_READ, MAP_SHARED, nFile, 0);
+        if(pMap == MAP_FAILED)
+        {
+            debug::error(FUNCTION, "failed to map ", strFile, " (", strerror(errno), ")");
+
+            ::close(nFile);
+            nFile = -1;
+
+            return;
+        }
+
+        /* Sector reads are random access, so don't waste IO on readahead. */
+        ::madvise(pMap, nReserved, MADV_RANDOM);
+
+        pBegin = static_cast<uint8_t*>(pMap);
+    #endif
+    }
+
+
+    /* Default Destructor. */
+    MemoryMap::~MemoryMap()
+    {
+    #ifndef WIN32
+        if(pBegin)
+            ::munmap(pBegin, nReserved);
+
+        if(nFile >= 0)
+            ::close(nFile);
+    #endif
+    }
+
+
+    /* Determines if the mapping failed to be created. */
+    bool MemoryMap::IsNull() const
+    {
+        return pBegin == nullptr;
+    }
+
+
+    /* Copy a range of bytes out of the mapped file. */
+    bool MemoryMap::Read(const uint64_t nStart, std::vector<uint8_t>& vData) const
+    {
+        /* Check that we have a valid mapping. */
+        if(!pBegin)
+            return false;
+
+        /* Check that the range is within our reserved window. */
+        const uint64_t nEnd = nStart + vData.size();
+        if(nEnd > nReserved)
+            return false;
+
+    #ifndef WIN32
+        /* Refresh the file size if reading past our last known end of file. */
+        if(nEnd > nFileSize.load())
+        {
+            struct stat stat;
+            if(::fstat(nFile, &stat) != 0)
+                return false;
+
+            nFileSize.store(static_cast<uint64_t>(stat.st_size));
+
+            /* Pages past end of file would raise SIGBUS, so fail here instead. */
+            if(nEnd > nFileSize.load())
+                return false;
+        }
+    #endif
+
+        /* Copy the data out of the mapping. */
+        std::copy(pBegin + nStart, pBegin + nEnd, vData.begin());
+
+        return true;
+    }
+
+
+    /* Determines if memory mapped reads are available on this platform. */
+    bool MemoryMap::Supported()
+    {
+    #ifdef WIN32
+        return false;
+    #else
+        /* Reserving a window per sector file needs a 64-bit address space. */
+        return sizeof(void*) >= 8;
+    #endif
+    }
+}
@@ -0,0 +1,194 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/randomfile.h>
+
+#include <Util/include/mutex.h>
+#include <Util/include/debug.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <cerrno>
+
+namespace LLD
+{
+
+    /* File Constructor. */
+    RandomAccessFile::RandomAccessFile(const std::string& strFile, const bool fCreate)
+    : nFile      (-1)
+    , SEEK_MUTEX ( )
+    {
+    #ifdef WIN32
+        nFile = ::_open(strFile.c_str(), _O_RDWR | _O_BINARY | (fCreate ? _O_CREAT : 0), _S_IREAD | _S_IWRITE);
+    #else
+        nFile = ::open(strFile.c_str(), O_RDWR | (fCreate ? O_CREAT : 0), 0644);
+    #endif
+
+        if(nFile < 0)
+            debug::error(FUNCTION, "failed to open ", strFile, " (", strerror(errno), ")");
+    }
+
+
+    /* Default Destructor. */
+    RandomAccessFile::~RandomAccessFile()
+    {
+        if(nFile < 0)
+            return;
+
+    #ifdef WIN32
+        ::_close(nFile);
+    #else
+        ::close(nFile);
+    #endif
+    }
+
+
+    /* Determines if the file failed to open. */
+    bool RandomAccessFile::IsNull() const
+    {
+        return nFile < 0;
+    }
+
+
+    /* Read bytes from a given position in the file. */
+    bool RandomAccessFile::Read(const uint64_t nPos, std::vector<uint8_t>& vData) const
+    {
+        if(nFile < 0)
+            return false;
+
+        /* Loop until all bytes are read, in case the kernel returns short reads. */
+        uint64_t nRead = 0;
+        while(nRead < vData.size())
+        {
+        #ifdef WIN32
+            LOCK(SEEK_MUTEX);
+
+            ::_lseeki64(nFile, nPos + nRead, SEEK_SET);
+            int64_t nBytes = ::_read(nFile, &vData[nRead], static_cast<uint32_t>(vData.size() - nRead));
+        #else
+            int64_t nBytes = ::pread(nFile, &vData[nRead], vData.size() - nRead, nPos + nRead);
+        #endif
+
+            /* Retry on signal interrupts. */
+            if(nBytes < 0 && errno == EINTR)
+                continue;
+
+            /* Fail on errors or end of file. */
+            if(nBytes <= 0)
+                return false;
+
+            nRead += nBytes;
+        }
+
+        return true;
+    }
+
+
+    /* Write bytes to a given position in the file. */
+    bool RandomAccessFile::Write(const uint64_t nPos, const uint8_t* pData, const uint64_t nSize)
+    {
+        if(nFile < 0)
+            return false;
+
+        /* Loop until all bytes are written, in case the kernel returns short writes. */
+        uint64_t nWrote = 0;
+        while(nWrote < nSize)
+        {
+        #ifdef WIN32
+            LOCK(SEEK_MUTEX);
+
+            ::_lseeki64(nFile, nPos + nWrote, SEEK_SET);
+            int64_t nBytes = ::_write(nFile, pData + nWrote, static_cast<uint32_t>(nSize - nWrote));
+        #else
+            int64_t nBytes = ::pwrite(nFile, pData + nWrote, nSize - nWrote, nPos + nWrote);
+        #endif
+
+            /* Retry on signal interrupts. */
+            if(nBytes < 0 && errno == EINTR)
+                continue;
+
+            /* Fail on errors. */
+            if(nBytes <= 0)
+                return debug::error(FUNCTION, "only ", nWrote, "/", nSize, " bytes written (", strerror(errno), ")");
+
+            nWrote += nBytes;
+        }
+
+        return true;
+    }
+
+
+    /* Write bytes to a given position in the file. */
+    bool RandomAccessFile::Write(const uint64_t nPos, const std::vector<uint8_t>& vData)
+    {
+        return Write(nPos, vData.data(), vData.size());
+    }
+
+
+    /* Flush the file contents from the operating system to disk. */
+    bool RandomAccessFile::Sync()
+    {
+        if(nFile < 0)
+            return false;
+
+    #ifdef WIN32
+        return ::_commit(nFile) == 0;
+    #elif defined(MAC_OSX)
+        return ::fsync(nFile) == 0;
+    #else
+        return ::fdatasync(nFile) == 0;
+    #endif
+    }
+
+
+    /* Truncate or extend the file to a given size. */
+    bool RandomAccessFile::Truncate(const uint64_t nSize)
+    {
+        if(nFile < 0)
+            return false;
+
+    #ifdef WIN32
+        return ::_chsize_s(nFile, nSize) == 0;
+    #else
+        return ::ftruncate(nFile, nSize) == 0;
+    #endif
+    }
+
+
+    /* Get the current size of the file. */
+    uint64_t RandomAccessFile::Size() const
+    {
+        if(nFile < 0)
+            return 0;
+
+    #ifdef WIN32
+        struct _stati64 stat;
+        if(::_fstati64(nFile, &stat) != 0)
+            return 0;
+    #else
+        struct stat stat;
+        if(::fstat(nFile, &stat) != 0)
+            return 0;
+    #endif
+
+        return static_cast<uint64_t>(stat.st_size);
+    }
+}
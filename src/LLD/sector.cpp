@@ -24,11 +24,31 @@ ________________________________________________________________________________
 #include <Util/include/filesystem.h>
 #include <Util/include/hex.h>
 
+#include <algorithm>
 #include <functional>
+#include <set>
 
 namespace LLD
 {
 
+    /* Create the keychain for a database, constructing concrete keychain types directly. */
+    template<class KeychainType>
+    KeychainType* CreateKeychain(const std::string& strName, const std::string& strLocation,
+                                 const uint8_t nFlags, const uint64_t nBuckets)
+    {
+        return new KeychainType(strLocation, nFlags, nBuckets);
+    }
+
+
+    /* Create the keychain for a database, selecting the backend from config. */
+    template<>
+    Keychain* CreateKeychain<Keychain>(const std::string& strName, const std::string& strLocation,
+                                       const uint8_t nFlags, const uint64_t nBuckets)
+    {
+        return Keychain::Create(strName, strLocation, nFlags, nBuckets);
+    }
+
+
     /* The Database Constructor. To determine file location and the Bytes per Record. */
     template<class KeychainType, class CacheType>
     SectorDatabase<KeychainType, CacheType>::SectorDatabase(const std::string& strNameIn,
@@ -39,17 +59,28 @@ namespace LLD
     , SECTOR_MUTEX()
     , BUFFER_MUTEX()
     , TRANSACTION_MUTEX()
+    , MAP_MUTEX()
+    , COMPACT_MUTEX()
+    , POSTING_MUTEX()
+    , SYNC_MUTEX()
     , strBaseLocation(config::GetDataDir() + strNameIn + "/datachain/")
     , strName(strNameIn)
     , runtime()
     , pTransaction(nullptr)
-    , pSectorKeys(new KeychainType((config::GetDataDir() + strName + "/keychain/"), nFlagsIn, nBucketsIn))
+    , VERSION_MUTEX()
+    , pVersions()
+    , pCommit()
+    , pSectorKeys(CreateKeychain<KeychainType>(strNameIn, (config::GetDataDir() + strNameIn + "/keychain/"), nFlagsIn, nBucketsIn))
     , cachePool(new CacheType(nCacheIn))
     , fileCache(new TemplateLRU<uint32_t, std::fstream*>(8))
+    , vMemoryMaps((nFlagsIn & FLAGS::MMAP) ? std::numeric_limits<uint16_t>::max() + 1 : 0)
     , nCurrentFile(0)
     , nCurrentFileSize(0)
+    , setDirty()
     , CacheWriterThread()
     , MeterThread()
+    , CompactorThread()
+    , PostingThread()
     , vDiskBuffer()
     , nBufferBytes(0)
     , nBytesRead(0)
@@ -57,12 +88,52 @@ namespace LLD
     , nRecordsFlushed(0)
     , fDestruct(false)
     , fInitialized(false)
+    , fCompact(false)
+    , mapDeadBytes()
+    , vRetired()
+    , vRetiredMaps()
+    , setRetiring()
+    , nMapEpoch(0)
+    , nMapReaders()
+    , nMapWrites(0)
+    , streamKeys()
+    , nKeysFile(0)
+    , nCompactedBytes(0)
+    , nReclaimedBytes(0)
+    , nCompressMin(static_cast<uint32_t>(config::GetArg("-lldcompressmin", 128)))
+    , nReadAhead(static_cast<uint32_t>(std::max(int64_t(64), config::GetArg("-lldreadahead", 1024)) * 1024))
+    , fTypeIndex(false)
+    , fPostings(false)
+    , mapPostings()
+    , streamPostings()
     , nFlags(nFlagsIn)
     {
         /* Set readonly flag if write or append are not specified. */
         if(!(nFlags & FLAGS::FORCE) && !(nFlags & FLAGS::WRITE) && !(nFlags & FLAGS::APPEND))
             nFlags |= FLAGS::READONLY;
 
+        /* Compact sector files of writable databases if enabled. */
+        fCompact = !(nFlags & FLAGS::READONLY) && config::GetBoolArg("-lldcompact", false);
+
+        /* Keep posting lists of record types for writable databases if enabled. */
+        fTypeIndex = !(nFlags & FLAGS::READONLY) && config::GetBoolArg("-lldtypeindex", false);
+
+        /* Check that memory mapped reads are supported on this platform. */
+        if(nFlags & FLAGS::MMAP && !MemoryMap::Supported())
+        {
+            debug::log(0, FUNCTION, strName, " memory mapped reads not supported... disabling");
+
+            nFlags &= ~FLAGS::MMAP;
+            std::vector< std::atomic<MemoryMap*> >().swap(vMemoryMaps);
+        }
+
+        /* Clear the memory map slots. */
+        for(auto& pmap : vMemoryMaps)
+            pmap.store(nullptr);
+
+        nMapReaders[0].store(0);
+        nMapReaders[1].store(0);
+
         /* Initialize the Database. */
         Initialize();
 
@@ -74,6 +145,7 @@ namespace LLD
 
         CacheWriterThread = std::thread(std::bind(&SectorDatabase::CacheWriter, this));
         MeterThread = std::thread(std::bind(&SectorDatabase::Meter, this));
+        CompactorThread = std::thread(std::bind(&SectorDatabase::Compactor, this));
     }
 
 
@@ -90,6 +162,12 @@ namespace LLD
         if(MeterThread.joinable())
             MeterThread.join();
 
+        if(CompactorThread.joinable())
+            CompactorThread.join();
+
+        if(PostingThread.joinable())
+            PostingThread.join();
+
         if(pTransaction)
             delete pTransaction;
 
@@ -99,6 +177,13 @@ namespace LLD
         if(fileCache)
             delete fileCache;
 
+        for(auto& pmap : vMemoryMaps)
+            if(pmap.load())
+                delete pmap.load();
+
+        for(auto& pmap : vRetiredMaps)
+            delete pmap;
+
         if(pSectorKeys)
             delete pSectorKeys;
     }
@@ -144,6 +229,14 @@ namespace LLD
             ++nCurrentFile;
         }
 
+        /* Load the dead byte counts for the compactor. */
+        if(fCompact)
+            ReadLiveness();
+
+        /* Load the posting lists for typed scans. */
+        if(fTypeIndex)
+            ReadPostings();
+
         pTransaction = nullptr;
         fInitialized = true;
     }
@@ -156,14 +249,16 @@ namespace LLD
         /* Iterate if meters are enabled. */
         nBytesRead += static_cast<uint32_t>(vKey.size() + vData.size());
 
-        /* Check the cache pool for key first. */
+        /* Check the cache pool for key first, which holds records in their stored form. */
         if(cachePool->Get(vKey, vData))
-            return true;
+            return Decompress(vData);
 
         /* Get the key from the keychain. */
         SectorKey cKey;
         if(pSectorKeys->Get(vKey, cKey))
         {
+            /* Read from memory map if enabled, falling back to the file stream. */
+            if(!GetMapped(cKey, vData))
             {
                 LOCK(SECTOR_MUTEX);
 
@@ -206,7 +301,7 @@ namespace LLD
                 debug::log(5, FUNCTION, "Current File: ", cKey.nSectorFile,
                     " | Current File Size: ", cKey.nSectorStart, "\n", HexStr(vData.begin(), vData.end(), true));
 
-            return true;
+            return Decompress(vData);
         }
 
         return false;
@@ -218,14 +313,19 @@ namespace LLD
     template<class KeychainType, class CacheType>
     bool SectorDatabase<KeychainType, CacheType>::Get(const SectorKey& cKey, std::vector<uint8_t>& vData)
     {
-        {
-            LOCK(SECTOR_MUTEX);
+        /* Iterate if meters are enabled. */
+        nBytesRead += static_cast<uint32_t>(cKey.vKey.size() + vData.size());
 
-            nBytesRead += static_cast<uint32_t>(cKey.vKey.size() + vData.size());
+        /* Check the cache pool for key first. */
+        if(cachePool->Get(cKey.vKey, vData))
+            return Decompress(vData);
 
-            /* Check the cache pool for key first. */
-            if(cachePool->Get(cKey.vKey, vData))
-                return true;
+        /* Read from memory map if enabled, falling back to the file stream. */
+        if(GetMapped(cKey, vData))
+            return Decompress(vData);
+
+        {
+            LOCK(SECTOR_MUTEX);
 
             /* Find the file stream for LRU cache. */
             std::fstream *pstream;
@@ -262,367 +362,2173 @@ namespace LLD
                     " | Current File Size: ", cKey.nSectorStart, "\n", HexStr(vData.begin(), vData.end(), true));
         }
 
-        return true;
+        return Decompress(vData);
     }
 
 
-    /*  Update a record on disk. */
+    /*  Read a batch of records from disk into the cache, coalescing reads of records close together. */
     template<class KeychainType, class CacheType>
-    bool SectorDatabase<KeychainType, CacheType>::Update(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData)
+    uint32_t SectorDatabase<KeychainType, CacheType>::Prefetch(const std::vector< std::vector<uint8_t> >& vKeys)
     {
-        /* Check the keychain for key. */
-        SectorKey key;
-        if(!pSectorKeys->Get(vKey, key))
-            return false;
-
-        /* Get current size */
-        uint64_t nSize = vData.size() + GetSizeOfCompactSize(vData.size());
-
-        /* Check data size constraints. */
-        if(nSize != key.nSectorSize)
-            return false;
-
-        /* Write the data into the memory cache. */
-        cachePool->Put(key, vKey, vData, false);
+        /* Load the versions being committed, which hold newer records than disk. */
+        const std::shared_ptr< const std::vector< std::shared_ptr<SectorVersion> > > pList = std::atomic_load(&pVersions);
 
+        /* Find the keys that would be read from disk. */
+        std::vector< std::vector<uint8_t> > vMissing;
         {
-            LOCK(SECTOR_MUTEX);
+            LOCK(TRANSACTION_MUTEX);
 
-            /* Find the file stream for LRU cache. */
-            std::fstream* pstream;
-            if(!fileCache->Get(key.nSectorFile, pstream))
+            for(const auto& vKey : vKeys)
             {
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), key.nSectorFile), std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
+                /* Skip records that are already cached. */
+                if(cachePool->Has(vKey))
+                    continue;
+
+                /* Skip records pending in a transaction. */
+                if(pTransaction && (pTransaction->mapTransactions.count(vKey) || pTransaction->setKeychain.count(vKey)
+                                 || pTransaction->mapIndex.count(vKey)        || pTransaction->setErasedData.count(vKey)))
+                    continue;
+
+                /* Skip records held in a version, so the cache never gets what they replace. */
+                bool fVersion = false;
+                if(pList)
                 {
-                    delete pstream;
-                    return false;
+                    for(const auto& pVersion : *pList)
+                    {
+                        if(pVersion->mapData.count(vKey) || pVersion->setKeychain.count(vKey)
+                        || pVersion->mapIndex.count(vKey) || pVersion->setErased.count(vKey))
+                        {
+                            fVersion = true;
+                            break;
+                        }
+                    }
                 }
 
-                /* If file not found add to LRU cache. */
-                fileCache->Put(key.nSectorFile, pstream);
-            }
-
-            /* If it is a New Sector, Assign a Binary Position. */
-            pstream->seekp(key.nSectorStart, std::ios::beg);
+                if(fVersion)
+                    continue;
 
-            /* Write the size of record. */
-            WriteCompactSize(*pstream, vData.size());
+                vMissing.push_back(vKey);
+            }
+        }
 
-            /* Write the data record. */
-            if(!pstream->write((char*) &vData[0], vData.size()))
-                return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vData.size(), " bytes written");
+        /* Check that there is anything to read. */
+        if(vMissing.empty())
+            return 0;
 
-            pstream->flush();
+        /* Look the keys up in keychain bucket order. */
+        std::vector<SectorKey> vSectorKeys;
+        pSectorKeys->Get(vMissing, vSectorKeys);
 
-            /* Records flushed indicator. */
-            ++nRecordsFlushed;
-            nBytesWrote += static_cast<uint32_t>(vData.size());
+        /* Read the records in the order they are on disk. */
+        std::sort(vSectorKeys.begin(), vSectorKeys.end(),
+            [](const SectorKey& a, const SectorKey& b)
+            {
+                return std::make_pair(a.nSectorFile, a.nSectorStart) < std::make_pair(b.nSectorFile, b.nSectorStart);
+            });
 
-            /* Verbose output. */
-            if(config::nVerbose >= 5)
-                debug::log(5, FUNCTION, "Current File: ", key.nSectorFile,
-                    " | Current File Size: ", key.nSectorStart, "\n", HexStr(vData.begin(), vData.end(), true));
-        }
+        uint32_t nRead = 0;
+        for(uint32_t nBegin = 0; nBegin < vSectorKeys.size(); )
+        {
+            const SectorKey& cFirst = vSectorKeys[nBegin];
 
-        return true;
-    }
+            /* Extend the run over the records that follow closely in the same file. */
+            uint32_t nEnd = nBegin + 1;
+            uint64_t nRunEnd = uint64_t(cFirst.nSectorStart) + cFirst.nSectorSize;
+            for( ; nEnd < vSectorKeys.size(); ++nEnd)
+            {
+                const SectorKey& cNext = vSectorKeys[nEnd];
+                if(cNext.nSectorFile != cFirst.nSectorFile || cNext.nSectorStart > nRunEnd + SECTOR_COALESCE_GAP)
+                    break;
 
+                /* Keep the run within the read ahead size. */
+                const uint64_t nNextEnd = std::max(nRunEnd, uint64_t(cNext.nSectorStart) + cNext.nSectorSize);
+                if(nNextEnd - cFirst.nSectorStart > nReadAhead)
+                    break;
 
-    /*  Force a write to disk immediately bypassing write buffers. */
-    template<class KeychainType, class CacheType>
-    bool SectorDatabase<KeychainType, CacheType>::Force(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData)
-    {
-        if(nFlags & FLAGS::APPEND || !Update(vKey, vData))
-        {
+                nRunEnd = nNextEnd;
+            }
 
+            /* Memory mapped files have no seeks to save, so copy each record out of the map. */
+            if(nFlags & FLAGS::MMAP)
             {
-                LOCK(SECTOR_MUTEX);
-
-                /* Create new file if above current file size. */
-                if(nCurrentFileSize > MAX_SECTOR_FILE_SIZE)
+                for(uint32_t n = nBegin; n < nEnd; ++n)
                 {
-                    debug::log(4, FUNCTION, "allocating new sector file ", nCurrentFile + 1);
+                    std::vector<uint8_t> vData;
+                    if(!GetMapped(vSectorKeys[n], vData))
+                        continue;
 
-                    ++nCurrentFile;
-                    nCurrentFileSize = 0;
-
-                    std::ofstream stream
-                    (
-                        debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile),
-                        std::ios::out | std::ios::binary | std::ios::trunc
-                    );
-                    stream.close();
+                    cachePool->Put(vSectorKeys[n], vSectorKeys[n].vKey, vData);
+                    ++nRead;
                 }
 
+                nBegin = nEnd;
+                continue;
+            }
+
+            /* Read the whole run with one seek. */
+            std::vector<uint8_t> vRun(nRunEnd - cFirst.nSectorStart);
+            {
+                LOCK(SECTOR_MUTEX);
+
                 /* Find the file stream for LRU cache. */
                 std::fstream* pstream;
-                if(!fileCache->Get(nCurrentFile, pstream))
+                if(!fileCache->Get(cFirst.nSectorFile, pstream))
                 {
                     /* Set the new stream pointer. */
-                    pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile), std::ios::in | std::ios::out | std::ios::binary);
+                    pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), cFirst.nSectorFile), std::ios::in | std::ios::out | std::ios::binary);
                     if(!pstream->is_open())
                     {
                         delete pstream;
-                        return false;
+                        return nRead;
                     }
 
                     /* If file not found add to LRU cache. */
-                    fileCache->Put(nCurrentFile, pstream);
+                    fileCache->Put(cFirst.nSectorFile, pstream);
                 }
 
-                /* If it is a New Sector, Assign a Binary Position. */
-                pstream->seekp(nCurrentFileSize, std::ios::beg);
+                /* Seek to the start of the run. */
+                pstream->clear();
+                pstream->seekg(cFirst.nSectorStart, std::ios::beg);
 
-                /* Write the size of record. */
-                WriteCompactSize(*pstream, vData.size());
+                /* Read the records and the gaps between them. */
+                if(!pstream->read((char*) &vRun[0], vRun.size()))
+                {
+                    debug::error(FUNCTION, "only ", pstream->gcount(), "/", vRun.size(), " bytes read");
 
-                /* Write the data record. */
-                if(!pstream->write((char*) &vData[0], vData.size()))
-                    return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vData.size(), " bytes written");
+                    pstream->clear();
+                    return nRead;
+                }
 
-                pstream->flush();
+                /* Iterate if meters are enabled. */
+                nBytesRead += static_cast<uint32_t>(vRun.size());
             }
 
-            /* Get current size */
-            uint64_t nSize = vData.size() + GetSizeOfCompactSize(vData.size());
-
-            /* Create a new Sector Key. */
-            SectorKey key(STATE::READY, vKey, static_cast<uint16_t>(nCurrentFile),
-                            nCurrentFileSize, static_cast<uint32_t>(nSize));
-
-            /* Increment the current filesize */
-            nCurrentFileSize += static_cast<uint32_t>(nSize);
+            /* Split the run into records for the cache, in their stored form. */
+            for(uint32_t n = nBegin; n < nEnd; ++n)
+            {
+                const SectorKey& cKey = vSectorKeys[n];
 
-            /* Records flushed indicator. */
-            ++nRecordsFlushed;
-            nBytesWrote += static_cast<uint32_t>(nSize);
+                /* Skip past the compact size of the record. */
+                const uint64_t nSize   = GetSizeOfCompactSize(cKey.nSectorSize);
+                const uint64_t nOffset = cKey.nSectorStart - cFirst.nSectorStart;
 
-            /* Assign the Key to Keychain. */
-            if(!pSectorKeys->Put(key))
-                return debug::error(FUNCTION, "failed to write key to keychain");
+                const std::vector<uint8_t> vData(vRun.begin() + nOffset + nSize, vRun.begin() + nOffset + cKey.nSectorSize);
+                cachePool->Put(cKey, cKey.vKey, vData);
 
-            /* Write the data into the memory cache. */
-            cachePool->Put(key, vKey, vData, false);
+                ++nRead;
+            }
 
-            /* Verboe output. */
-            if(config::nVerbose >= 5)
-                debug::log(5, FUNCTION, "Current File: ", key.nSectorFile,
-                    " | Current File Size: ", key.nSectorStart, "\n", HexStr(vData.begin(), vData.end(), true));
+            nBegin = nEnd;
         }
 
-        return true;
+        /* Verbose Debug Logging. */
+        if(config::nVerbose >= 4)
+            debug::log(4, FUNCTION, strName, " read ", nRead, "/", vKeys.size(), " records into cache");
+
+        return nRead;
     }
 
 
-    /*  Write a record into the cache and disk buffer for flushing to disk. */
+    /*  Get a record as of a commit epoch, from the versions kept in memory or from disk. */
     template<class KeychainType, class CacheType>
-    bool SectorDatabase<KeychainType, CacheType>::Put(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData)
+    bool SectorDatabase<KeychainType, CacheType>::GetVersion(const std::vector<uint8_t>& vKey, std::vector<uint8_t>& vData,
+                                                             const uint64_t nEpoch, const bool fData)
     {
-        /* Handle force write mode. */
-        if(nFlags & FLAGS::FORCE)
-            return Force(vKey, vData);
-
-        /* Wait if the buffer is full. */
-        if(nBufferBytes.load() >= MAX_SECTOR_BUFFER_SIZE)
-        {
-            std::unique_lock<std::mutex> CONDITION_LOCK(CONDITION_MUTEX);
-            CONDITION.wait(CONDITION_LOCK, [this]{ return fDestruct.load() || nBufferBytes.load() < MAX_SECTOR_BUFFER_SIZE; });
-        }
-
-        /* Add to the write buffer thread. */
+        /* Load the list once per pass, commits replace it rather than change it. */
+        std::shared_ptr< const std::vector< std::shared_ptr<SectorVersion> > > pList = std::atomic_load(&pVersions);
+        while(true)
         {
-            LOCK(BUFFER_MUTEX);
+            /* The newest versions are whatever is on disk once the list is checked. */
+            if(nEpoch == 0)
+                return ReadVersion(pList, vKey, vData, nEpoch, fData);
 
-            vDiskBuffer.push_back(std::make_pair(vKey, vData));
-            nBufferBytes += static_cast<uint32_t>(vKey.size() + vData.size());
-        }
+            /* Capture the newer versions and their priors before going to disk. */
+            const std::vector< std::pair<const SectorVersion*, const SectorPrior*> > vNewer = NewerVersions(pList, nEpoch);
+            const bool fExists = ReadVersion(pList, vKey, vData, nEpoch, fData);
 
-        /* Notify if buffer was added to. */
-        CONDITION.notify_all();
+            /* A commit that published or stored its priors meanwhile may have applied to disk, so read again with it. */
+            std::shared_ptr< const std::vector< std::shared_ptr<SectorVersion> > > pNext = std::atomic_load(&pVersions);
+            if(NewerVersions(pNext, nEpoch) == vNewer)
+                return fExists;
 
-        return true;
+            pList = pNext;
+        }
     }
 
 
-    /*  Update a record on disk. */
+    /*  Get a record as of a commit epoch from one load of the version list, falling back to disk. */
     template<class KeychainType, class CacheType>
-    bool SectorDatabase<KeychainType, CacheType>::Delete(const std::vector<uint8_t>& vKey)
+    bool SectorDatabase<KeychainType, CacheType>::ReadVersion(const std::shared_ptr< const std::vector< std::shared_ptr<SectorVersion> > >& pList,
+                                                              const std::vector<uint8_t>& vKeyIn, std::vector<uint8_t>& vData,
+                                                              const uint64_t nEpoch, const bool fData)
     {
-        /* Check the keychain for key. */
-        SectorKey key;
-        if(!pSectorKeys->Get(vKey, key))
-            return false;
+        /* Sector key of the record, read once if a prior value is looked up by sector. */
+        std::vector<uint8_t> vKey = vKeyIn;
+        SectorKey cKey;
+        bool fSector = false;
+        bool fKey    = false;
 
-        /* Return the Key existance in the Keychain Database. */
-        if(!pSectorKeys->Erase(vKey))
-            return false;
+        if(pList && !pList->empty())
+        {
+            /* Resolve erases and indexes from the newest version the epoch sees. */
+            for(auto it = pList->rbegin(); it != pList->rend(); ++it)
+            {
+                const SectorVersion& version = **it;
+                if(nEpoch != 0 && version.nEpoch > nEpoch)
+                    continue;
 
-        /* Check that this key isn't a keychain only entry. */
-        if(key.nSectorFile ==0 && key.nSectorSize == 0 && key.nSectorStart == 0)
-            return true;
+                if(version.setErased.count(vKey))
+                    return false;
 
-        {
-            LOCK(SECTOR_MUTEX);
+                const auto itIndex = version.mapIndex.find(vKey);
+                if(itIndex != version.mapIndex.end())
+                {
+                    vKey = itIndex->second;
+                    break;
+                }
 
-            /* Find the file stream for LRU cache. */
-            std::fstream* pstream;
-            if(!fileCache->Get(key.nSectorFile, pstream))
+                if(version.mapData.count(vKey) || version.setKeychain.count(vKey))
+                    break;
+            }
+
+            /* Find the record in the newest version the epoch sees. */
+            for(auto it = pList->rbegin(); it != pList->rend(); ++it)
             {
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), key.nSectorFile), std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
+                const SectorVersion& version = **it;
+                if(nEpoch != 0 && version.nEpoch > nEpoch)
+                    continue;
+
+                if(version.setErased.count(vKey))
                     return false;
+
+                const auto itData = version.mapData.find(vKey);
+                if(itData != version.mapData.end())
+                {
+                    if(fData)
+                        vData = itData->second;
+
+                    return true;
                 }
 
-                /* If file not found add to LRU cache. */
-                fileCache->Put(key.nSectorFile, pstream);
+                if(version.setKeychain.count(vKey))
+                {
+                    if(!fData)
+                        return true;
+
+                    break;
+                }
             }
 
-            /* If it is a New Sector, Assign a Binary Position. */
-            pstream->seekg(key.nSectorStart, std::ios::beg);
+            /* Versions newer than a pinned epoch hold the values they replaced, the oldest one is what the epoch saw. */
+            for(auto it = pList->begin(); nEpoch != 0 && it != pList->end(); ++it)
+            {
+                const SectorVersion& version = **it;
+                if(version.nEpoch <= nEpoch)
+                    continue;
 
-            /* Write the size of record. */
-            uint64_t nSize = ReadCompactSize(*pstream);
+                const std::shared_ptr<const SectorPrior> pPrior = std::atomic_load(&version.pPrior);
+                if(!pPrior)
+                    continue;
 
-            /* Seek to write at specific location. */
-            pstream->seekp(key.nSectorStart + GetSizeOfCompactSize(nSize), std::ios::beg);
+                /* Check for the key itself. */
+                auto itKey = pPrior->mapKeys.find(vKey);
+                if(itKey == pPrior->mapKeys.end())
+                {
+                    /* Index keys share the sector of their record, so check the replaced sectors too. */
+                    if(!fSector)
+                    {
+                        fSector = true;
+                        fKey    = pSectorKeys->Get(vKey, cKey);
+                    }
 
-            /* Update the record with blank data. */
-            DataStream ssData(SER_LLD, DATABASE_VERSION);
-            ssData << std::string("NONE");
+                    if(!fKey)
+                        continue;
 
-            /* Write the data record. */
-            if(!pstream->write((char*)ssData.data(), ssData.size()))
-                return debug::error(FUNCTION, "only ", pstream->gcount(), " bytes written");
+                    const auto itSector = pPrior->mapSectors.find(std::make_pair(cKey.nSectorFile, cKey.nSectorStart));
+                    if(itSector == pPrior->mapSectors.end())
+                        continue;
 
-            /* Flush the rest of the write buffer in stream. */
-            pstream->flush();
+                    itKey = pPrior->mapKeys.find(itSector->second);
+                    if(itKey == pPrior->mapKeys.end())
+                        continue;
+                }
+
+                /* The record did not exist at the epoch. */
+                if(!itKey->second.first)
+                    return false;
+
+                if(fData)
+                    vData = itKey->second.second;
+
+                return true;
+            }
         }
 
-        return true;
+        /* Check for the key on disk. */
+        if(!fData)
+            return cachePool->Has(vKey) || (fSector ? fKey : pSectorKeys->Get(vKey, cKey));
+
+        /* Read the sector key that was already looked up. */
+        if(fSector)
+            return fKey && Get(cKey, vData);
+
+        return Get(vKey, vData);
     }
 
 
-    /*  Flushes periodically data from the cache buffer to disk. */
+    /*  Get the versions newer than a pinned epoch with their prior values. */
     template<class KeychainType, class CacheType>
-    void SectorDatabase<KeychainType, CacheType>::CacheWriter()
+    std::vector< std::pair<const SectorVersion*, const SectorPrior*> >
+    SectorDatabase<KeychainType, CacheType>::NewerVersions(const std::shared_ptr< const std::vector< std::shared_ptr<SectorVersion> > >& pList,
+                                                           const uint64_t nEpoch)
     {
-        /* Wait for initialization. */
-        while(!fInitialized)
-            runtime::sleep(100);
-
-        /* Check if writing is enabled. */
-        if(!(nFlags & FLAGS::WRITE) && !(nFlags & FLAGS::APPEND))
-            return;
+        std::vector< std::pair<const SectorVersion*, const SectorPrior*> > vNewer;
+        if(!pList)
+            return vNewer;
 
-        /* No cache write on force mode. */
-        if(nFlags & FLAGS::FORCE)
+        /* Versions newer than a pinned snapshot are not collected, so their addresses stay unique while it reads. */
+        for(const auto& pVersion : *pList)
         {
-            debug::log(0, FUNCTION, strBaseLocation, " in FORCE mode... closing");
-            return;
+            if(pVersion->nEpoch <= nEpoch)
+                continue;
+
+            vNewer.push_back(std::make_pair(pVersion.get(), std::atomic_load(&pVersion->pPrior).get()));
         }
 
+        return vNewer;
+    }
 
-        while(true)
+
+    /*  Drop the versions that are on disk and older than every pinned snapshot. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::CollectVersions(const bool fFailed)
+    {
+        LOCK(VERSION_MUTEX);
+
+        /* Check for versions to drop. */
+        const std::shared_ptr< const std::vector< std::shared_ptr<SectorVersion> > > pList = std::atomic_load(&pVersions);
+        if(!pList || pList->empty())
+            return;
+
+        /* Keep versions still being written and versions whose prior values an older snapshot may read. */
+        const uint64_t nOldest = Snapshot::Oldest();
+
+        std::shared_ptr< std::vector< std::shared_ptr<SectorVersion> > > pNext =
+            std::make_shared< std::vector< std::shared_ptr<SectorVersion> > >();
+
+        for(const auto& pVersion : *pList)
+        {
+            if(pVersion->fApplied.load() ? pVersion->nEpoch <= nOldest : fFailed)
+                continue;
+
+            pNext->push_back(pVersion);
+        }
+
+        /* Replace the list if any were dropped. */
+        if(pNext->size() != pList->size())
+            std::atomic_store(&pVersions, std::shared_ptr< const std::vector< std::shared_ptr<SectorVersion> > >(pNext));
+    }
+
+
+    /*  Get a record from the memory mapped sector file without taking the sector lock. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::GetMapped(const SectorKey& cKey, std::vector<uint8_t>& vData)
+    {
+        /* Check that memory maps are enabled. */
+        if(!(nFlags & FLAGS::MMAP))
+            return false;
+
+        /* Enter the map epoch before loading the map, so a map retired after the load outlives this read. */
+        std::atomic<uint32_t>& nReaders = nMapReaders[nMapEpoch.load() & 1];
+        ++nReaders;
+
+        /* Get the memory map for this sector file. */
+        MemoryMap* pmap = vMemoryMaps[cKey.nSectorFile].load();
+        if(!pmap)
+        {
+            LOCK(MAP_MUTEX);
+
+            /* Check again in case another thread mapped this file while we waited. */
+            pmap = vMemoryMaps[cKey.nSectorFile].load();
+
+            /* Files being truncated are read from their stream, a new map would fault once the file shrinks under it. */
+            if(!pmap && !setRetiring.count(cKey.nSectorFile))
+            {
+                /* Map the new sector file, which also handles rollover into new files. */
+                pmap = new MemoryMap(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), cKey.nSectorFile), MAX_SECTOR_MAP_SIZE);
+                if(pmap->IsNull())
+                {
+                    delete pmap;
+                    pmap = nullptr;
+                }
+
+                /* Publish the map for lock free readers. */
+                else
+                    vMemoryMaps[cKey.nSectorFile].store(pmap);
+            }
+        }
+
+        /* Copy the record out of the map, unless an in place write is in progress. */
+        bool fRead = false;
+        const uint64_t nWrites = nMapWrites.load();
+        if(pmap && !(nWrites & 1))
+        {
+            /* Get compact size from record. */
+            uint64_t nSize = GetSizeOfCompactSize(cKey.nSectorSize);
+
+            /* Resize for proper record length. */
+            vData.resize(cKey.nSectorSize - nSize);
+
+            fRead = pmap->Read(cKey.nSectorStart + nSize, vData);
+
+            /* A write that overlapped the copy could have torn the record, so read it from the stream instead. */
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(nMapWrites.load() != nWrites)
+                fRead = false;
+        }
+
+        /* Leave the map epoch. */
+        --nReaders;
+
+        return fRead;
+    }
+
+
+    /*  Wait for the readers that could still hold a retired memory map. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::WaitMapReaders()
+    {
+        /* Flip the epoch twice, so a reader that entered either half before the maps were taken has left. */
+        for(uint32_t n = 0; n < 2; ++n)
+        {
+            const uint64_t nEpoch = nMapEpoch.fetch_add(1);
+            while(nMapReaders[nEpoch & 1].load() > 0)
+                std::this_thread::yield();
+        }
+    }
+
+
+    /*  Lock the compact mutex for a write if compaction is enabled. */
+    template<class KeychainType, class CacheType>
+    std::unique_lock<std::mutex> SectorDatabase<KeychainType, CacheType>::CompactLock()
+    {
+        if(!fCompact)
+            return std::unique_lock<std::mutex>();
+
+        return std::unique_lock<std::mutex>(COMPACT_MUTEX);
+    }
+
+
+    /*  Stream the records of a type to a callback from the cursor position. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Scan(SectorCursor& cursor, const std::string& strType,
+        const std::function<bool(DataStream&)>& fnRecord)
+    {
+        /* Drop the type and position for the typed callback. */
+        auto fnValue = [&](const std::string& strThis, const uint32_t nStart, DataStream& ssValue)
+        {
+            return fnRecord(ssValue);
+        };
+
+        /* Read only the blocks in the posting list of the type once it is complete. */
+        if(fPostings.load())
+        {
+            while(true)
+            {
+                /* Find the next run of posted blocks at or after the cursor. */
+                SectorCursor cStart;
+                uint64_t nEnd = 0;
+                {
+                    LOCK(POSTING_MUTEX);
+
+                    auto itType = mapPostings.find(strType);
+                    if(itType == mapPostings.end())
+                        return false;
+
+                    const std::pair<uint32_t, uint32_t> pairBlock = std::make_pair(cursor.nFile, static_cast<uint32_t>(cursor.nStart / SECTOR_POSTING_BLOCK));
+
+                    auto it = itType->second.lower_bound(pairBlock);
+                    if(it == itType->second.end())
+                        return false;
+
+                    /* Start at the first record of the type, or the cursor inside the block. */
+                    cStart = SectorCursor(it->first.first, it->second);
+                    if(it->first == pairBlock && cursor.nStart > it->second)
+                        cStart.nStart = cursor.nStart;
+
+                    /* Extend the run over the adjacent posted blocks of the same file. */
+                    uint32_t nBlock = it->first.second;
+                    for(++it; it != itType->second.end() && it->first == std::make_pair(cStart.nFile, nBlock + 1); ++it)
+                        ++nBlock;
+
+                    nEnd = uint64_t(nBlock + 1) * SECTOR_POSTING_BLOCK;
+                }
+
+                /* Scan the run of blocks. */
+                cursor = cStart;
+                if(ScanFile(cursor, nEnd, strType, fnValue))
+                    return true;
+
+                /* Move the cursor past the run, it is left at the last record if nothing follows. */
+                if(cursor.nStart < nEnd)
+                {
+                    SectorCursor cNext(cursor.nFile, nEnd);
+
+                    LOCK(POSTING_MUTEX);
+
+                    auto& mapType = mapPostings[strType];
+                    if(mapType.lower_bound(std::make_pair(cNext.nFile, static_cast<uint32_t>(nEnd / SECTOR_POSTING_BLOCK))) == mapType.end())
+                        return false;
+
+                    cursor = cNext;
+                }
+            }
+        }
+
+        while(true)
+        {
+            /* Check that the file exists, the datachain ends at the first missing file. */
+            if(!filesystem::exists(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), cursor.nFile)))
+                return false;
+
+            /* Read the file to its end. */
+            if(ScanFile(cursor, std::numeric_limits<uint64_t>::max(), strType, fnValue))
+                return true;
+
+            /* Leave the cursor at the end of the newest file, so a later scan picks up new records. */
+            const std::string strNext = debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), cursor.nFile + 1);
+            if(!filesystem::exists(strNext))
+                return false;
+
+            /* Iterate to the next file. */
+            ++cursor.nFile;
+            cursor.nStart = 0;
+        }
+
+        return false;
+    }
+
+
+    /*  Stream the records of a sector file from the cursor position to a callback. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::ScanFile(SectorCursor& cursor, const uint64_t nEnd, const std::string& strType,
+        const std::function<bool(const std::string&, const uint32_t, DataStream&)>& fnRecord)
+    {
+        /* Get filestream object. */
+        std::ifstream stream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), cursor.nFile), std::ios::in | std::ios::binary);
+        if(!stream)
+            return false;
+
+        /* Read the file in chunks, growing the buffer only for records larger than it. */
+        uint64_t nBufferSize = std::min(uint64_t(nReadAhead), std::max(uint64_t(4096), nEnd - std::min(nEnd, cursor.nStart)));
+        while(cursor.nStart < nEnd)
+        {
+            /* Read the next chunk, which is short at the end of the file. */
+            DataStream ssData(SER_LLD, DATABASE_VERSION);
+            ssData.resize(nBufferSize);
+            {
+                LOCK(SECTOR_MUTEX);
+
+                stream.clear();
+                stream.seekg(cursor.nStart, std::ios::beg);
+                stream.read((char*)ssData.data(), nBufferSize);
+                ssData.resize(stream.gcount());
+
+                /* Iterate if meters are enabled. */
+                nBytesRead += static_cast<uint32_t>(ssData.size());
+            }
+
+            /* Check for the end of the file. */
+            if(ssData.size() == 0)
+                return false;
+
+            /* Read the whole records in this chunk. */
+            const uint64_t nChunk = cursor.nStart;
+            const bool fLast = (ssData.size() < nBufferSize);
+
+            bool fPartial = false;
+            while(!ssData.End() && cursor.nStart < nEnd)
+            {
+                /* Read the compact size, which may be split by the end of the chunk. */
+                const uint64_t nPos = ssData.GetPos();
+
+                uint64_t nSize = 0;
+                try
+                {
+                    nSize = ReadCompactSize(ssData);
+                }
+                catch(const std::exception& e)
+                {
+                    fPartial = true;
+                    break;
+                }
+
+                /* Check for the end of the records in this file. */
+                if(nSize == 0)
+                    return false;
+
+                /* Check that the whole record is in the chunk. */
+                const uint64_t nRecord = ssData.GetPos();
+                if(ssData.size() - nRecord < nSize)
+                {
+                    fPartial = true;
+                    break;
+                }
+
+                /* Move the cursor past this record before the callback, so a resumed scan starts after it. */
+                const uint32_t nStart = static_cast<uint32_t>(cursor.nStart);
+                cursor.nStart += (nRecord - nPos) + nSize;
+
+                try
+                {
+                    /* Decompress compressed records to check their type. */
+                    if(ssData.Bytes()[nRecord] == RECORD_COMPRESSED)
+                    {
+                        std::vector<uint8_t> vRecord(ssData.Bytes().begin() + nRecord, ssData.Bytes().begin() + nRecord + nSize);
+                        ssData.SetPos(nRecord + nSize);
+
+                        if(!Decompress(vRecord))
+                            continue;
+
+                        /* Check the type. */
+                        DataStream ssRecord(vRecord, SER_LLD, DATABASE_VERSION);
+
+                        std::string strThis;
+                        ssRecord >> strThis;
+
+                        if((strType.empty() || strType == strThis) && !fnRecord(strThis, nStart, ssRecord))
+                            return true;
+
+                        continue;
+                    }
+
+                    /* Check the type before copying the value. */
+                    std::string strThis;
+                    ssData >> strThis;
+
+                    const uint64_t nValue = ssData.GetPos();
+                    ssData.SetPos(nRecord + nSize);
+
+                    if((!strType.empty() && strType != strThis) || nValue > nRecord + nSize)
+                        continue;
+
+                    /* Give the value to the callback. */
+                    DataStream ssValue(ssData.Bytes().begin() + nValue, ssData.Bytes().begin() + nRecord + nSize, SER_LLD, DATABASE_VERSION);
+                    if(!fnRecord(strThis, nStart, ssValue))
+                        return true;
+                }
+                catch(const std::exception& e)
+                {
+                    /* Skip records with a malformed type. */
+                    debug::error(FUNCTION, "malformed record in file ", cursor.nFile, ": ", e.what());
+                    ssData.SetPos(nRecord + nSize);
+                }
+            }
+
+            /* Stop at a torn record or the end of the file. */
+            if(fLast && (fPartial || ssData.End()))
+                return false;
+
+            /* Grow the buffer if a single record didn't fit in it. */
+            if(fPartial && cursor.nStart == nChunk)
+                nBufferSize *= 2;
+        }
+
+        return false;
+    }
+
+
+    /*  Update a record on disk. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Update(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, const bool fFlush)
+    {
+        /* Compress the record, so the size check is against the stored size. */
+        std::vector<uint8_t> vCompressed;
+        const bool fCompressed = (nFlags & FLAGS::COMPRESS) && Compress(vData, vCompressed, nCompressMin);
+
+        std::unique_lock<std::mutex> lk = CompactLock();
+
+        SectorKey key;
+        if(!UpdateSector(vKey, fCompressed ? vCompressed : vData, key, fFlush))
+            return false;
+
+        /* Post the record in case its type changed in place. */
+        PostRecord(vData, key.nSectorFile, key.nSectorStart);
+
+        return true;
+    }
+
+
+    /*  Update a record on disk in place, with the compactor lock held. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::UpdateSector(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData,
+                                                               SectorKey& key, const bool fFlush)
+    {
+        /* Check the keychain for key. */
+        if(!pSectorKeys->Get(vKey, key))
+            return false;
+
+        /* Get current size */
+        uint64_t nSize = vData.size() + GetSizeOfCompactSize(vData.size());
+
+        /* Check data size constraints. */
+        if(nSize != key.nSectorSize)
+            return false;
+
+        /* Write the data into the memory cache. */
+        cachePool->Put(key, vKey, vData, false);
+
+        {
+            LOCK(SECTOR_MUTEX);
+
+            /* Find the file stream for LRU cache. */
+            std::fstream* pstream;
+            if(!fileCache->Get(key.nSectorFile, pstream))
+            {
+                /* Set the new stream pointer. */
+                pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), key.nSectorFile), std::ios::in | std::ios::out | std::ios::binary);
+                if(!pstream->is_open())
+                {
+                    delete pstream;
+                    return false;
+                }
+
+                /* If file not found add to LRU cache. */
+                fileCache->Put(key.nSectorFile, pstream);
+            }
+
+            /* Mark the write for memory map readers, which copy records without the sector lock. */
+            const bool fMapped = (nFlags & FLAGS::MMAP);
+            if(fMapped)
+                ++nMapWrites;
+
+            /* If it is a New Sector, Assign a Binary Position. */
+            pstream->seekp(key.nSectorStart, std::ios::beg);
+
+            /* Write the size of record. */
+            WriteCompactSize(*pstream, vData.size());
+
+            /* Write the data record. */
+            const bool fWritten = static_cast<bool>(pstream->write((char*) &vData[0], vData.size()));
+
+            /* Batched writes flush once at the end of the batch, mapped files flush now so the whole write lands inside the mark. */
+            if(fFlush || fMapped)
+                pstream->flush();
+
+            if(fMapped)
+                ++nMapWrites;
+
+            if(!fWritten)
+                return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vData.size(), " bytes written");
+
+            setDirty.insert(key.nSectorFile);
+
+            /* Records flushed indicator. */
+            ++nRecordsFlushed;
+            nBytesWrote += static_cast<uint32_t>(vData.size());
+
+            /* Verbose output. */
+            if(config::nVerbose >= 5)
+                debug::log(5, FUNCTION, "Current File: ", key.nSectorFile,
+                    " | Current File Size: ", key.nSectorStart, "\n", HexStr(vData.begin(), vData.end(), true));
+        }
+
+        return true;
+    }
+
+
+    /*  Force a write to disk immediately bypassing write buffers. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Force(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vRecord)
+    {
+        /* Compress the record, the stored bytes are what the sector size and cache hold. */
+        std::vector<uint8_t> vCompressed;
+        const bool fCompressed = (nFlags & FLAGS::COMPRESS) && Compress(vRecord, vCompressed, nCompressMin);
+
+        const std::vector<uint8_t>& vData = fCompressed ? vCompressed : vRecord;
+
+        std::unique_lock<std::mutex> lk = CompactLock();
+
+        /* The old sector key is returned when the record changed size. */
+        SectorKey cOld;
+        if(nFlags & FLAGS::APPEND || !UpdateSector(vKey, vData, cOld, true))
+        {
+            /* Append mode skips the update, so look up the old sector to count it as dead. */
+            if(nFlags & FLAGS::APPEND && fCompact)
+                pSectorKeys->Get(vKey, cOld);
+
+            {
+                LOCK(SECTOR_MUTEX);
+
+                /* Create new file if above current file size. */
+                if(nCurrentFileSize > MAX_SECTOR_FILE_SIZE)
+                {
+                    debug::log(4, FUNCTION, "allocating new sector file ", nCurrentFile + 1);
+
+                    ++nCurrentFile;
+                    nCurrentFileSize = 0;
+
+                    std::ofstream stream
+                    (
+                        debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile),
+                        std::ios::out | std::ios::binary | std::ios::trunc
+                    );
+                    stream.close();
+                }
+
+                /* Find the file stream for LRU cache. */
+                std::fstream* pstream;
+                if(!fileCache->Get(nCurrentFile, pstream))
+                {
+                    /* Set the new stream pointer. */
+                    pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile), std::ios::in | std::ios::out | std::ios::binary);
+                    if(!pstream->is_open())
+                    {
+                        delete pstream;
+                        return false;
+                    }
+
+                    /* If file not found add to LRU cache. */
+                    fileCache->Put(nCurrentFile, pstream);
+                }
+
+                /* If it is a New Sector, Assign a Binary Position. */
+                pstream->seekp(nCurrentFileSize, std::ios::beg);
+
+                /* Write the size of record. */
+                WriteCompactSize(*pstream, vData.size());
+
+                /* Write the data record. */
+                if(!pstream->write((char*) &vData[0], vData.size()))
+                    return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vData.size(), " bytes written");
+
+                pstream->flush();
+                setDirty.insert(nCurrentFile);
+            }
+
+            /* Get current size */
+            uint64_t nSize = vData.size() + GetSizeOfCompactSize(vData.size());
+
+            /* Create a new Sector Key. */
+            SectorKey key(STATE::READY, vKey, static_cast<uint16_t>(nCurrentFile),
+                            nCurrentFileSize, static_cast<uint32_t>(nSize));
+
+            /* Increment the current filesize */
+            nCurrentFileSize += static_cast<uint32_t>(nSize);
+
+            /* Records flushed indicator. */
+            ++nRecordsFlushed;
+            nBytesWrote += static_cast<uint32_t>(nSize);
+
+            /* Log the key for the compactor before the keychain points at the record. */
+            LogKeys(std::vector<SectorKey>(1, key));
+
+            /* Post the record for typed scans. */
+            PostRecord(vRecord, key.nSectorFile, key.nSectorStart);
+
+            /* Assign the Key to Keychain. */
+            if(!pSectorKeys->Put(key))
+                return debug::error(FUNCTION, "failed to write key to keychain");
+
+            /* The old record is no longer referenced. */
+            if(fCompact && cOld.nSectorSize > 0)
+                mapDeadBytes[cOld.nSectorFile] += cOld.nSectorSize;
+
+            /* Write the data into the memory cache. */
+            cachePool->Put(key, vKey, vData, false);
+
+            /* Verboe output. */
+            if(config::nVerbose >= 5)
+                debug::log(5, FUNCTION, "Current File: ", key.nSectorFile,
+                    " | Current File Size: ", key.nSectorStart, "\n", HexStr(vData.begin(), vData.end(), true));
+        }
+        else
+            PostRecord(vRecord, cOld.nSectorFile, cOld.nSectorStart);
+
+        return true;
+    }
+
+
+    /*  Write a batch of records to disk with a single append and flush. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::WriteBatch(const std::vector< std::pair<std::vector<uint8_t>, std::vector<uint8_t>> >& vRecords)
+    {
+        /* Keep only the last write of each key, so an older record appended in this batch can't replace a newer one updated in place. */
+        std::vector<uint32_t> vLatest;
+        vLatest.reserve(vRecords.size());
+        {
+            std::set< std::vector<uint8_t> > setKeys;
+            for(uint32_t n = static_cast<uint32_t>(vRecords.size()); n > 0; --n)
+            {
+                if(setKeys.insert(vRecords[n - 1].first).second)
+                    vLatest.push_back(n - 1);
+            }
+
+            std::reverse(vLatest.begin(), vLatest.end());
+        }
+
+        /* Compress the records, the stored bytes are what the sector sizes and cache hold. */
+        std::vector< std::pair<std::vector<uint8_t>, std::vector<uint8_t>> > vCompressed;
+        if(nFlags & FLAGS::COMPRESS)
+        {
+            vCompressed.resize(vRecords.size());
+            for(const uint32_t n : vLatest)
+            {
+                vCompressed[n].first = vRecords[n].first;
+                if(!Compress(vRecords[n].second, vCompressed[n].second, nCompressMin))
+                    vCompressed[n].second = vRecords[n].second;
+            }
+        }
+
+        const std::vector< std::pair<std::vector<uint8_t>, std::vector<uint8_t>> >& vBatch =
+            (nFlags & FLAGS::COMPRESS) ? vCompressed : vRecords;
+
+        std::unique_lock<std::mutex> lk = CompactLock();
+
+        /* Update existing records in place, and collect the rest for the append. */
+        std::vector<uint32_t> vAppend;
+        std::vector<SectorKey> vDead;
+        vAppend.reserve(vLatest.size());
+        for(const uint32_t n : vLatest)
+        {
+            SectorKey cOld;
+            if(nFlags & FLAGS::APPEND || !UpdateSector(vBatch[n].first, vBatch[n].second, cOld, false))
+            {
+                /* Append mode skips the update, so look up the old sector to count it as dead. */
+                if(nFlags & FLAGS::APPEND && fCompact)
+                    pSectorKeys->Get(vBatch[n].first, cOld);
+
+                /* Changed records leave their old sector behind. */
+                if(fCompact && cOld.nSectorSize > 0)
+                    vDead.push_back(cOld);
+
+                vAppend.push_back(n);
+            }
+            else
+                PostRecord(vRecords[n].second, cOld.nSectorFile, cOld.nSectorStart);
+        }
+
+        /* The new keys to write to the keychain. */
+        std::vector<SectorKey> vKeys;
+        vKeys.reserve(vAppend.size());
+        {
+            LOCK(SECTOR_MUTEX);
+
+            /* Write the records in runs, one run per sector file. */
+            uint32_t nIndex = 0;
+            while(nIndex < vAppend.size())
+            {
+                /* Create new file if above current file size. */
+                if(nCurrentFileSize > MAX_SECTOR_FILE_SIZE)
+                {
+                    debug::log(4, FUNCTION, "allocating new sector file ", nCurrentFile + 1);
+
+                    ++nCurrentFile;
+                    nCurrentFileSize = 0;
+
+                    std::ofstream stream
+                    (
+                        debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile),
+                        std::ios::out | std::ios::binary | std::ios::trunc
+                    );
+                    stream.close();
+                }
+
+                /* Find the file stream for LRU cache. */
+                std::fstream* pstream;
+                if(!fileCache->Get(nCurrentFile, pstream))
+                {
+                    /* Set the new stream pointer. */
+                    pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile), std::ios::in | std::ios::out | std::ios::binary);
+                    if(!pstream->is_open())
+                    {
+                        delete pstream;
+                        return debug::error(FUNCTION, "failed to open sector file ", nCurrentFile);
+                    }
+
+                    /* If file not found add to LRU cache. */
+                    fileCache->Put(nCurrentFile, pstream);
+                }
+
+                /* Serialize records into one contiguous buffer until the file is full. */
+                const uint32_t nStart = nCurrentFileSize;
+                DataStream ssData(SER_LLD, DATABASE_VERSION);
+                while(nIndex < vAppend.size() && nCurrentFileSize <= MAX_SECTOR_FILE_SIZE)
+                {
+                    const std::vector<uint8_t>& vData = vBatch[vAppend[nIndex]].second;
+
+                    /* Write the size and data of the record. */
+                    WriteCompactSize(ssData, vData.size());
+                    ssData.write((char*)&vData[0], vData.size());
+
+                    /* Create a new Sector Key. */
+                    uint64_t nSize = vData.size() + GetSizeOfCompactSize(vData.size());
+                    vKeys.push_back(SectorKey(STATE::READY, vBatch[vAppend[nIndex]].first, static_cast<uint16_t>(nCurrentFile),
+                                    nCurrentFileSize, static_cast<uint32_t>(nSize)));
+
+                    /* Increment the current filesize */
+                    nCurrentFileSize += static_cast<uint32_t>(nSize);
+                    ++nIndex;
+                }
+
+                /* Append the run to the sector file with a single write. */
+                const std::vector<uint8_t>& vBytes = ssData.Bytes();
+                pstream->seekp(nStart, std::ios::beg);
+                if(!pstream->write((char*) &vBytes[0], vBytes.size()))
+                    return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vBytes.size(), " bytes written");
+
+                setDirty.insert(nCurrentFile);
+
+                /* Records flushed indicator. */
+                nBytesWrote += static_cast<uint32_t>(vBytes.size());
+            }
+
+            /* Flush every open sector file once for the whole batch, including in place updates. */
+            TemplateNode<uint32_t, std::fstream*>* pnode = fileCache->pfirst;
+            while(pnode)
+            {
+                pnode->Data->flush();
+                pnode = pnode->pnext;
+            }
+        }
+
+        /* Records flushed indicator. */
+        nRecordsFlushed += static_cast<uint32_t>(vKeys.size());
+
+        /* Log the keys for the compactor before the keychain points at the records. */
+        LogKeys(vKeys);
+
+        /* Post the records for typed scans. */
+        for(uint32_t n = 0; n < vKeys.size(); ++n)
+            PostRecord(vRecords[vAppend[n]].second, vKeys[n].nSectorFile, vKeys[n].nSectorStart);
+
+        /* Assign the keys to the keychain in one batch. */
+        if(!pSectorKeys->Put(vKeys))
+            return debug::error(FUNCTION, "failed to write keys to keychain");
+
+        /* The old records are no longer referenced. */
+        for(const auto& cOld : vDead)
+            mapDeadBytes[cOld.nSectorFile] += cOld.nSectorSize;
+
+        /* Write the data into the memory cache. */
+        for(uint32_t n = 0; n < vKeys.size(); ++n)
+            cachePool->Put(vKeys[n], vKeys[n].vKey, vBatch[vAppend[n]].second, false);
+
+        return true;
+    }
+
+
+    /*  Write a record into the cache and disk buffer for flushing to disk. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Put(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData)
+    {
+        /* Handle force write mode. */
+        if(nFlags & FLAGS::FORCE)
+            return Force(vKey, vData);
+
+        /* Wait if the buffer is full. */
+        if(nBufferBytes.load() >= MAX_SECTOR_BUFFER_SIZE)
+        {
+            std::unique_lock<std::mutex> CONDITION_LOCK(CONDITION_MUTEX);
+            CONDITION.wait(CONDITION_LOCK, [this]{ return fDestruct.load() || nBufferBytes.load() < MAX_SECTOR_BUFFER_SIZE; });
+        }
+
+        /* Add to the write buffer thread. */
+        {
+            LOCK(BUFFER_MUTEX);
+
+            vDiskBuffer.push_back(std::make_pair(vKey, vData));
+            nBufferBytes += static_cast<uint32_t>(vKey.size() + vData.size());
+        }
+
+        /* Notify if buffer was added to. */
+        CONDITION.notify_all();
+
+        return true;
+    }
+
+
+    /*  Update a record on disk. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Delete(const std::vector<uint8_t>& vKey)
+    {
+        std::unique_lock<std::mutex> lk = CompactLock();
+
+        /* Check the keychain for key. */
+        SectorKey key;
+        if(!pSectorKeys->Get(vKey, key))
+            return false;
+
+        /* Return the Key existance in the Keychain Database. */
+        if(!pSectorKeys->Erase(vKey))
+            return false;
+
+        /* Check that this key isn't a keychain only entry. */
+        if(key.nSectorFile ==0 && key.nSectorSize == 0 && key.nSectorStart == 0)
+            return true;
+
+        /* The record is no longer referenced. */
+        if(fCompact)
+            mapDeadBytes[key.nSectorFile] += key.nSectorSize;
+
+        {
+            LOCK(SECTOR_MUTEX);
+
+            /* Find the file stream for LRU cache. */
+            std::fstream* pstream;
+            if(!fileCache->Get(key.nSectorFile, pstream))
+            {
+                /* Set the new stream pointer. */
+                pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), key.nSectorFile), std::ios::in | std::ios::out | std::ios::binary);
+                if(!pstream->is_open())
+                {
+                    delete pstream;
+                    return false;
+                }
+
+                /* If file not found add to LRU cache. */
+                fileCache->Put(key.nSectorFile, pstream);
+            }
+
+            /* If it is a New Sector, Assign a Binary Position. */
+            pstream->seekg(key.nSectorStart, std::ios::beg);
+
+            /* Write the size of record. */
+            uint64_t nSize = ReadCompactSize(*pstream);
+
+            /* Seek to write at specific location. */
+            pstream->seekp(key.nSectorStart + GetSizeOfCompactSize(nSize), std::ios::beg);
+
+            /* Update the record with blank data. */
+            DataStream ssData(SER_LLD, DATABASE_VERSION);
+            ssData << std::string("NONE");
+
+            /* Mark the write for memory map readers that got the key before it was erased. */
+            const bool fMapped = (nFlags & FLAGS::MMAP);
+            if(fMapped)
+                ++nMapWrites;
+
+            /* Write the data record. */
+            const bool fWritten = static_cast<bool>(pstream->write((char*)ssData.data(), ssData.size()));
+
+            /* Flush the rest of the write buffer in stream. */
+            pstream->flush();
+
+            if(fMapped)
+                ++nMapWrites;
+
+            if(!fWritten)
+                return debug::error(FUNCTION, "only ", pstream->gcount(), " bytes written");
+
+            setDirty.insert(key.nSectorFile);
+        }
+
+        return true;
+    }
+
+
+    /*  Erase a key from the keychain, counting its record as dead bytes. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::EraseSector(const std::vector<uint8_t>& vKey)
+    {
+        std::unique_lock<std::mutex> lk = CompactLock();
+
+        /* Get the sector of the key before it is erased. */
+        SectorKey cKey;
+        const bool fSector = fCompact && pSectorKeys->Get(vKey, cKey);
+
+        /* Erase the key from the keychain. */
+        if(!pSectorKeys->Erase(vKey))
+            return false;
+
+        /* The record is no longer referenced. */
+        if(fSector && cKey.nSectorSize > 0)
+            mapDeadBytes[cKey.nSectorFile] += cKey.nSectorSize;
+
+        return true;
+    }
+
+
+    /*  Append the keys to the key logs of their sector files. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::LogKeys(const std::vector<SectorKey>& vKeys)
+    {
+        /* Key logs are only needed by the compactor. */
+        if(!fCompact)
+            return;
+
+        /* Write each key to the log of its sector file, the compact lock is held so the stream stays open between writes. */
+        for(const auto& cKey : vKeys)
+        {
+            /* Skip keychain only entries. */
+            if(cKey.nSectorSize == 0)
+                continue;
+
+            /* Open the key log when the sector file changes. */
+            if(!streamKeys.is_open() || cKey.nSectorFile != nKeysFile)
+            {
+                streamKeys.close();
+                streamKeys.clear();
+
+                nKeysFile = cKey.nSectorFile;
+                streamKeys.open(debug::safe_printstr(strBaseLocation, "_keys.", std::setfill('0'), std::setw(5), nKeysFile), std::ios::out | std::ios::binary | std::ios::app);
+            }
+
+            /* Write the record position and the key. */
+            DataStream ssEntry(SER_LLD, DATABASE_VERSION);
+            ssEntry << cKey.nSectorStart << cKey.vKey;
+
+            /* A sector file with a missing entry is never compacted, so a failed write only costs disk space. */
+            if(!streamKeys.write((char*)ssEntry.data(), ssEntry.size()))
+            {
+                debug::error(FUNCTION, strName, " failed to write key log of sector file ", nKeysFile);
+                streamKeys.close();
+            }
+        }
+
+        /* Flush so the compactor reads every key logged before it takes the lock. */
+        streamKeys.flush();
+    }
+
+
+    /*  Flushes periodically data from the cache buffer to disk. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::CacheWriter()
+    {
+        /* Wait for initialization. */
+        while(!fInitialized)
+            runtime::sleep(100);
+
+        /* Check if writing is enabled. */
+        if(!(nFlags & FLAGS::WRITE) && !(nFlags & FLAGS::APPEND))
+            return;
+
+        /* No cache write on force mode. */
+        if(nFlags & FLAGS::FORCE)
+        {
+            debug::log(0, FUNCTION, strBaseLocation, " in FORCE mode... closing");
+            return;
+        }
+
+
+        while(true)
+        {
+            /* Wait for buffer to empty before shutting down. */
+            if((fDestruct.load()) && nBufferBytes.load() == 0)
+                return;
+
+            /* Check for data to be written. */
+            std::unique_lock<std::mutex> CONDITION_LOCK(CONDITION_MUTEX);
+            CONDITION.wait(CONDITION_LOCK, [this]{ return fDestruct.load() || nBufferBytes.load() > 0; });
+
+            /* Swap the buffer object to get ready for writes. */
+            std::vector< std::pair<std::vector<uint8_t>, std::vector<uint8_t>> > vIndexes;
+            {
+                LOCK(BUFFER_MUTEX);
+
+                vIndexes.swap(vDiskBuffer);
+                nBufferBytes = 0;
+            }
+
+            /* Write the whole buffer as a single batch. */
+            if(!WriteBatch(vIndexes))
+                debug::error(FUNCTION, strName, " failed to write batch of ", vIndexes.size(), " records");
+
+            /* Set no longer reserved in cache pool. */
+            for(const auto& vObj : vIndexes)
+                cachePool->Reserve(vObj.first, false);
+
+            /* Notify the condition. */
+            CONDITION.notify_all();
+
+            /* Verbose logging. */
+            debug::log(3, FUNCTION, "Flushed ", nRecordsFlushed.load(),
+                " Records of ", nBytesWrote.load(), " Bytes");
+
+            /* Reset counters if not in meter mode. */
+            if(!config::GetBoolArg("-meters"))
+            {
+                nBytesWrote     = 0;
+                nRecordsFlushed = 0;
+            }
+        }
+    }
+
+
+    /*  LLD Meter Thread. Tracks the Reads/Writes per second. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::Meter()
+    {
+        if(!config::GetBoolArg("-lldmeters", false))
+            return;
+
+        runtime::timer TIMER;
+        TIMER.Start();
+
+        while(!fDestruct.load())
+        {
+            runtime::sleep(100);
+            if(TIMER.Elapsed() < 30)
+                continue;
+
+            /* Write and Read data rates. */
+            double WPS = nBytesWrote.load() / (TIMER.Elapsed() * 1024.0);
+            double RPS = nBytesRead.load() / (TIMER.Elapsed() * 1024.0);
+
+            /* Check for zero values. */
+            if(WPS == 0 && RPS == 0 && nRecordsFlushed.load() == 0)
+                continue;
+
+            /* Debug output. */
+            debug::log(0,
+                ANSI_COLOR_FUNCTION, strName, " LLD : ", ANSI_COLOR_RESET,
+                "Writing ", WPS, " Kb/s | ",
+                "Reading ", RPS, " Kb/s | ",
+                "Records ", nRecordsFlushed.load());
+
+            /* Keychain lookup and cache output. */
+            pSectorKeys->Meters(strName);
+            cachePool->Meters(strName);
+
+            /* Compaction output. */
+            if(fCompact)
+            {
+                uint64_t nDead = 0;
+                {
+                    LOCK(COMPACT_MUTEX);
+                    for(const auto& dead : mapDeadBytes)
+                        nDead += dead.second;
+                }
+
+                debug::log(0,
+                    ANSI_COLOR_FUNCTION, strName, " LLD : ", ANSI_COLOR_RESET,
+                    "Dead ", nDead / (1024 * 1024), " mb | ",
+                    "Compacted ", nCompactedBytes.load() / (1024 * 1024), " mb | ",
+                    "Reclaimed ", nReclaimedBytes.load() / (1024 * 1024), " mb");
+            }
+
+            TIMER.Reset();
+            nBytesWrote.store(0);
+            nBytesRead.store(0);
+            nRecordsFlushed.store(0);
+        }
+    }
+
+
+    /*  Compactor Thread. Rewrites sector files that are mostly dead bytes. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::Compactor()
+    {
+        /* Wait for initialization. */
+        while(!fInitialized)
+            runtime::sleep(100);
+
+        /* Check if compaction is enabled. */
+        if(!fCompact)
+            return;
+
+        /* The seconds between passes, and the percent of dead bytes that makes a file worth compacting. */
+        const uint32_t nInterval = static_cast<uint32_t>(config::GetArg("-lldcompactinterval", 300));
+        const uint64_t nRatio    = static_cast<uint64_t>(config::GetArg("-lldcompactratio", 50));
+
+        runtime::timer TIMER;
+        TIMER.Start();
+
+        while(!fDestruct.load())
+        {
+            runtime::sleep(100);
+            if(TIMER.Elapsed() < nInterval)
+                continue;
+
+            /* Truncate the files compacted on the last pass. */
+            RetireFiles();
+
+            /* Get the current sector file, which is never compacted. */
+            uint32_t nCurrent = 0;
+            {
+                LOCK(SECTOR_MUTEX);
+                nCurrent = nCurrentFile;
+            }
+
+            /* Get a copy of the dead bytes to size up the files without holding the lock. */
+            std::map<uint32_t, uint64_t> mapDead;
+            {
+                LOCK(COMPACT_MUTEX);
+                mapDead = mapDeadBytes;
+            }
+
+            /* Find the sector file with the highest share of dead bytes. */
+            uint32_t nCompact = 0;
+            uint64_t nBest    = 0;
+            for(const auto& dead : mapDead)
+            {
+                if(dead.first >= nCurrent)
+                    continue;
+
+                /* Get the size of the sector file. */
+                std::ifstream stream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), dead.first), std::ios::in | std::ios::binary | std::ios::ate);
+                if(!stream)
+                    continue;
+
+                const uint64_t nSize = static_cast<uint64_t>(stream.tellg());
+                if(nSize == 0)
+                    continue;
+
+                /* Check the share of dead bytes against the threshold. */
+                const uint64_t nPercent = (dead.second * 100) / nSize;
+                if(nPercent >= nRatio && nPercent > nBest)
+                {
+                    nCompact = dead.first;
+                    nBest    = nPercent;
+                }
+            }
+
+            /* Compact the file, which is truncated on the next pass. */
+            if(nBest > 0)
+            {
+                debug::log(2, FUNCTION, strName, " compacting sector file ", nCompact, " with ", nBest, "% dead bytes");
+
+                if(!CompactFile(nCompact))
+                    debug::log(2, FUNCTION, strName, " sector file ", nCompact, " not compacted");
+            }
+
+            /* Save the dead bytes and retired files for the next start. */
+            WriteLiveness();
+
+            TIMER.Reset();
+        }
+
+        WriteLiveness();
+    }
+
+
+    /*  Move the live records of a sector file to the end of the current sector file. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::CompactFile(const uint32_t nFile)
+    {
+        const std::string strSector = debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nFile);
+        const std::string strKeys   = debug::safe_printstr(strBaseLocation, "_keys.", std::setfill('0'), std::setw(5), nFile);
+
+        /* Read one key log entry of the record position and key. */
+        auto read_entry = [](std::ifstream& stream, std::pair<uint32_t, std::vector<uint8_t>>& entry)
+        {
+            try
+            {
+                if(!stream.read((char*)&entry.first, sizeof(entry.first)))
+                    return false;
+
+                entry.second.resize(ReadCompactSize(stream));
+                return !entry.second.empty() && !!stream.read((char*)&entry.second[0], entry.second.size());
+            }
+            catch(const std::exception& e)
+            {
+                return false;
+            }
+        };
+
+        /* Get the record positions covered by the key log. */
+        std::vector<uint32_t> vLogged;
+        {
+            std::ifstream stream(strKeys, std::ios::in | std::ios::binary);
+            if(!stream)
+                return debug::error(FUNCTION, strName, " sector file ", nFile, " has no key log");
+
+            std::pair<uint32_t, std::vector<uint8_t>> entry;
+            while(read_entry(stream, entry))
+                vLogged.push_back(entry.first);
+        }
+
+        std::sort(vLogged.begin(), vLogged.end());
+        vLogged.erase(std::unique(vLogged.begin(), vLogged.end()), vLogged.end());
+
+        /* Open the sector file. */
+        std::ifstream stream(strSector, std::ios::in | std::ios::binary | std::ios::ate);
+        if(!stream)
+            return debug::error(FUNCTION, strName, " couldn't open sector file ", nFile);
+
+        /* Check that every record has a key log entry, so that no live record is left behind. */
+        const uint64_t nFileSize = static_cast<uint64_t>(stream.tellg());
+        for(uint64_t nPos = 0; nPos < nFileSize; )
+        {
+            if(!std::binary_search(vLogged.begin(), vLogged.end(), static_cast<uint32_t>(nPos)))
+                return debug::error(FUNCTION, strName, " sector file ", nFile, " record at ", nPos, " has no key log entry");
+
+            /* Read the size of the record. */
+            uint64_t nSize = 0;
+            try
+            {
+                stream.seekg(nPos, std::ios::beg);
+                nSize = ReadCompactSize(stream);
+            }
+            catch(const std::exception& e)
+            {
+                return debug::error(FUNCTION, strName, " sector file ", nFile, " record at ", nPos, " is malformed: ", e.what());
+            }
+
+            if(!stream)
+                return debug::error(FUNCTION, strName, " sector file ", nFile, " record at ", nPos, " is truncated");
+
+            nPos += nSize + GetSizeOfCompactSize(nSize);
+        }
+        std::vector<uint32_t>().swap(vLogged);
+
+        /* Limit the copy rate in Kb/s so that compaction doesn't starve the node of disk bandwidth. */
+        const uint64_t nRate = std::max(int64_t(1), config::GetArg("-lldcompactrate", 8192)) * 1024;
+
+        /* Move the live records in runs of key log entries. */
+        std::ifstream keys(strKeys, std::ios::in | std::ios::binary);
+        std::map<uint32_t, SectorKey> mapMoved;
+        std::vector< std::pair<uint32_t, std::vector<uint8_t>> > vEntries;
+        std::pair<uint32_t, std::vector<uint8_t>> entry;
+
+        runtime::timer TIMER;
+        TIMER.Start();
+
+        uint64_t nCopied = 0;
+        while(true)
+        {
+            /* Read the next run of entries. */
+            vEntries.clear();
+            while(vEntries.size() < 1024 && read_entry(keys, entry))
+                vEntries.push_back(entry);
+
+            if(vEntries.empty())
+                break;
+
+            /* Move the records, with no writes in between the keychain check and the swap. */
+            {
+                LOCK(COMPACT_MUTEX);
+
+                const int64_t nMoved = MoveRecords(nFile, stream, vEntries, mapMoved);
+                if(nMoved < 0)
+                    return false;
+
+                nCopied += nMoved;
+            }
+
+            /* Sleep to stay under the rate limit. */
+            const uint64_t nTarget = (nCopied * 1000) / nRate;
+            while(!fDestruct.load() && TIMER.ElapsedMilliseconds() < nTarget)
+                runtime::sleep(10);
+
+            /* Stop on shutdown, the moved records are already valid in their new location. */
+            if(fDestruct.load())
+                return false;
+        }
+
+        {
+            LOCK(COMPACT_MUTEX);
+
+            /* Move the records of index keys logged since the last run, which are only logged under this lock. */
+            keys.clear();
+
+            vEntries.clear();
+            while(read_entry(keys, entry))
+                vEntries.push_back(entry);
+
+            const int64_t nMoved = MoveRecords(nFile, stream, vEntries, mapMoved);
+            if(nMoved < 0)
+                return false;
+
+            nCopied += nMoved;
+
+            /* Close the streams of the file. */
+            {
+                LOCK2(SECTOR_MUTEX);
+                fileCache->Remove(nFile);
+            }
+
+            /* Retire the memory map, readers may still hold it until the file is truncated. */
+            if(nFlags & FLAGS::MMAP)
+            {
+                MemoryMap* pmap = vMemoryMaps[nFile].exchange(nullptr);
+                if(pmap)
+                    vRetiredMaps.push_back(pmap);
+            }
+
+            /* Keep the file until the next pass for readers that got its keys before the swap. */
+            mapDeadBytes.erase(nFile);
+            vRetired.push_back(nFile);
+        }
+
+        nCompactedBytes += nCopied;
+
+        debug::log(0, FUNCTION, strName, " compacted sector file ", nFile, " moving ", nCopied, " of ", nFileSize, " bytes");
+
+        return true;
+    }
+
+
+    /*  Move the records a run of key log entries reference. */
+    template<class KeychainType, class CacheType>
+    int64_t SectorDatabase<KeychainType, CacheType>::MoveRecords(const uint32_t nFile, std::ifstream& stream,
+                                                                 const std::vector< std::pair<uint32_t, std::vector<uint8_t>> >& vEntries,
+                                                                 std::map<uint32_t, SectorKey>& mapMoved)
+    {
+        /* Find the keys that still point into this sector file. */
+        std::vector<SectorKey> vLive;
+        for(const auto& entry : vEntries)
+        {
+            SectorKey cKey;
+            if(!pSectorKeys->Get(entry.second, cKey))
+                continue;
+
+            /* Skip keys that were updated, erased, or point at another record. */
+            if(cKey.nSectorFile != nFile || cKey.nSectorStart != entry.first || cKey.nSectorSize == 0)
+                continue;
+
+            cKey.SetKey(entry.second);
+            vLive.push_back(cKey);
+        }
+
+        /* Append one copy of each live record, pointing every key of the record at it. */
+        int64_t nBytes = 0;
+        std::vector<SectorKey> vKeys;
+        std::vector< std::pair<SectorKey, std::vector<uint8_t>> > vCopies;
+        {
+            LOCK(SECTOR_MUTEX);
+
+            for(const auto& cKey : vLive)
+            {
+                /* Point keys that share a moved record at the copy. */
+                auto it = mapMoved.find(cKey.nSectorStart);
+                if(it != mapMoved.end())
+                {
+                    SectorKey cNew = it->second;
+                    cNew.nState = cKey.nState;
+                    cNew.SetKey(cKey.vKey);
+
+                    vKeys.push_back(cNew);
+                    continue;
+                }
+
+                /* Read the record with its size prefix. */
+                std::vector<uint8_t> vRecord(cKey.nSectorSize);
+                stream.clear();
+                stream.seekg(cKey.nSectorStart, std::ios::beg);
+                if(!stream.read((char*)&vRecord[0], vRecord.size()))
+                {
+                    debug::error(FUNCTION, strName, " only ", stream.gcount(), "/", vRecord.size(), " bytes read");
+                    return -1;
+                }
+
+                /* Create new file if above current file size. */
+                if(nCurrentFileSize > MAX_SECTOR_FILE_SIZE)
+                {
+                    debug::log(4, FUNCTION, "allocating new sector file ", nCurrentFile + 1);
+
+                    ++nCurrentFile;
+                    nCurrentFileSize = 0;
+
+                    std::ofstream ofstream
+                    (
+                        debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile),
+                        std::ios::out | std::ios::binary | std::ios::trunc
+                    );
+                    ofstream.close();
+                }
+
+                /* Find the file stream for LRU cache. */
+                std::fstream* pstream;
+                if(!fileCache->Get(nCurrentFile, pstream))
+                {
+                    /* Set the new stream pointer. */
+                    pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile), std::ios::in | std::ios::out | std::ios::binary);
+                    if(!pstream->is_open())
+                    {
+                        delete pstream;
+                        debug::error(FUNCTION, "failed to open sector file ", nCurrentFile);
+                        return -1;
+                    }
+
+                    /* If file not found add to LRU cache. */
+                    fileCache->Put(nCurrentFile, pstream);
+                }
+
+                /* Append the record. */
+                pstream->seekp(nCurrentFileSize, std::ios::beg);
+                if(!pstream->write((char*)&vRecord[0], vRecord.size()))
+                {
+                    debug::error(FUNCTION, "only ", pstream->gcount(), "/", vRecord.size(), " bytes written");
+                    return -1;
+                }
+
+                pstream->flush();
+                setDirty.insert(nCurrentFile);
+
+                /* Create a new Sector Key. */
+                SectorKey cNew(cKey.nState, cKey.vKey, static_cast<uint16_t>(nCurrentFile), nCurrentFileSize, cKey.nSectorSize);
+                mapMoved[cKey.nSectorStart] = cNew;
+                vKeys.push_back(cNew);
+
+                /* Keep the copy to post its type outside of the lock. */
+                if(fTypeIndex)
+                    vCopies.push_back(std::make_pair(cNew, std::move(vRecord)));
+
+                /* Increment the current filesize */
+                nCurrentFileSize += cKey.nSectorSize;
+                nBytes           += cKey.nSectorSize;
+            }
+        }
+
+        /* Log the keys before the keychain points at the copies. */
+        LogKeys(vKeys);
+
+        /* Post the copies for typed scans. */
+        for(auto& copy : vCopies)
+        {
+            std::vector<uint8_t> vData(copy.second.begin() + GetSizeOfCompactSize(copy.first.nSectorSize), copy.second.end());
+            if(Decompress(vData))
+                PostRecord(vData, copy.first.nSectorFile, copy.first.nSectorStart);
+        }
+
+        /* Swap the keys to the new location. */
+        if(!pSectorKeys->Put(vKeys))
+        {
+            debug::error(FUNCTION, strName, " failed to write compacted keys to keychain");
+            return -1;
+        }
+
+        return nBytes;
+    }
+
+
+    /*  Truncate the sector files compacted on the last pass. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::RetireFiles()
+    {
+        /* Get the retired files and maps. */
+        std::vector<uint32_t> vFiles;
+        std::vector<MemoryMap*> vMaps;
+        {
+            LOCK(COMPACT_MUTEX);
+            vFiles.swap(vRetired);
+            vMaps.swap(vRetiredMaps);
+
+            /* Close the key log if it belongs to a file being removed. */
+            if(streamKeys.is_open() && std::find(vFiles.begin(), vFiles.end(), nKeysFile) != vFiles.end())
+                streamKeys.close();
+        }
+
+        if(vFiles.empty())
+            return;
+
+        /* The moved records and their keys have to be on disk before their old copies are truncated. */
+        if(!Sync(true))
+        {
+            debug::error(FUNCTION, strName, " failed to sync moved records, keeping the retired files");
+
+            LOCK(COMPACT_MUTEX);
+            vRetired.insert(vRetired.end(), vFiles.begin(), vFiles.end());
+            vRetiredMaps.insert(vRetiredMaps.end(), vMaps.begin(), vMaps.end());
+
+            return;
+        }
+
+        /* Stop new maps of the files, and take the maps that stale readers made since. */
+        if(nFlags & FLAGS::MMAP)
+        {
+            {
+                LOCK(MAP_MUTEX);
+                for(const auto& nFile : vFiles)
+                {
+                    setRetiring.insert(nFile);
+
+                    MemoryMap* pmap = vMemoryMaps[nFile].exchange(nullptr);
+                    if(pmap)
+                        vMaps.push_back(pmap);
+                }
+            }
+
+            /* Wait out the readers that loaded a map before it was taken, reads past the end of a truncated map would fault. */
+            WaitMapReaders();
+        }
+
+        /* Delete the maps, which no reader holds any more. */
+        for(auto& pmap : vMaps)
+            delete pmap;
+
+        /* Truncate the files, keeping them so the sector file numbers stay contiguous. */
+        for(const auto& nFile : vFiles)
+        {
+            const std::string strSector = debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nFile);
+
+            uint64_t nSize = 0;
+            {
+                LOCK(SECTOR_MUTEX);
+
+                /* Close any stream that a stale reader reopened. */
+                fileCache->Remove(nFile);
+
+                /* Get the size being reclaimed. */
+                std::ifstream istream(strSector, std::ios::in | std::ios::binary | std::ios::ate);
+                if(istream)
+                    nSize = static_cast<uint64_t>(istream.tellg());
+                istream.close();
+
+                std::ofstream ostream(strSector, std::ios::out | std::ios::binary | std::ios::trunc);
+            }
+
+            filesystem::remove(debug::safe_printstr(strBaseLocation, "_keys.", std::setfill('0'), std::setw(5), nFile));
+
+            /* Drop the postings into the file, the entries on disk are dropped on the next start. */
+            {
+                LOCK(POSTING_MUTEX);
+                for(auto& type : mapPostings)
+                    type.second.erase(type.second.lower_bound(std::make_pair(nFile, uint32_t(0))),
+                                      type.second.lower_bound(std::make_pair(nFile + 1, uint32_t(0))));
+            }
+
+            nReclaimedBytes += nSize;
+
+            debug::log(2, FUNCTION, strName, " truncated sector file ", nFile, " reclaiming ", nSize, " bytes");
+        }
+
+        /* The truncated files can be mapped again, memory map reads past the end of a file fail. */
+        if(nFlags & FLAGS::MMAP)
+        {
+            LOCK(MAP_MUTEX);
+            for(const auto& nFile : vFiles)
+                setRetiring.erase(nFile);
+        }
+    }
+
+
+    /*  Read the dead byte counts and retired files from disk. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::ReadLiveness()
+    {
+        /* Databases without a liveness file have nothing to compact yet. */
+        std::ifstream stream(debug::safe_printstr(strBaseLocation, "_liveness"), std::ios::in | std::ios::binary);
+        if(!stream)
+            return;
+
+        std::vector<uint8_t> vData((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        /* Deserialize the counts, which are only a guide to which files to compact. */
+        try
+        {
+            DataStream ssData(vData, SER_LLD, DATABASE_VERSION);
+            ssData >> mapDeadBytes >> vRetired;
+        }
+        catch(const std::exception& e)
+        {
+            debug::error(FUNCTION, strName, " malformed liveness file: ", e.what());
+
+            mapDeadBytes.clear();
+            vRetired.clear();
+        }
+    }
+
+
+    /*  Write the dead byte counts and retired files to disk. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::WriteLiveness()
+    {
+        /* Serialize the counts and retired files. */
+        DataStream ssData(SER_LLD, DATABASE_VERSION);
+        {
+            LOCK(COMPACT_MUTEX);
+            ssData << mapDeadBytes << vRetired;
+        }
+
+        /* Write a temporary file and swap it in, so the file is never partial. */
+        const std::string strFile = debug::safe_printstr(strBaseLocation, "_liveness");
+        {
+            std::ofstream stream(strFile + ".tmp", std::ios::out | std::ios::binary | std::ios::trunc);
+            if(!stream.write((char*)ssData.data(), ssData.size()))
+            {
+                debug::error(FUNCTION, strName, " failed to write liveness file");
+                return;
+            }
+        }
+
+        filesystem::rename(strFile + ".tmp", strFile);
+    }
+
+
+    /*  Add the block of a written record to the posting list of its type. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::PostRecord(const std::vector<uint8_t>& vData, const uint32_t nFile, const uint32_t nStart)
+    {
+        /* Check that posting lists are enabled. */
+        if(!fTypeIndex)
+            return;
+
+        /* Read the type from the front of the record. */
+        std::string strType;
+        try
         {
-            /* Wait for buffer to empty before shutting down. */
-            if((fDestruct.load()) && nBufferBytes.load() == 0)
+            const DataStream ssType(vData.begin(), vData.begin() + std::min(vData.size(), size_t(9)), SER_LLD, DATABASE_VERSION);
+
+            const uint64_t nSize   = ReadCompactSize(ssType);
+            const uint64_t nHeader = ssType.GetPos();
+            if(nHeader + nSize > vData.size())
                 return;
 
-            /* Check for data to be written. */
-            std::unique_lock<std::mutex> CONDITION_LOCK(CONDITION_MUTEX);
-            CONDITION.wait(CONDITION_LOCK, [this]{ return fDestruct.load() || nBufferBytes.load() > 0; });
+            strType.assign(vData.begin() + nHeader, vData.begin() + nHeader + nSize);
+        }
+        catch(const std::exception& e)
+        {
+            return;
+        }
 
-            /* Swap the buffer object to get ready for writes. */
-            std::vector< std::pair<std::vector<uint8_t>, std::vector<uint8_t>> > vIndexes;
+        LOCK(POSTING_MUTEX);
+        AddPosting(strType, nFile, nStart);
+    }
+
+
+    /*  Add a record position to the posting list of a type, with the posting lock held. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::AddPosting(const std::string& strType, const uint32_t nFile, const uint32_t nStart)
+    {
+        /* Keep the first record of the type in each block. */
+        const std::pair<uint32_t, uint32_t> pairBlock = std::make_pair(nFile, nStart / SECTOR_POSTING_BLOCK);
+
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t>& mapType = mapPostings[strType];
+
+        auto it = mapType.find(pairBlock);
+        if(it != mapType.end() && it->second <= nStart)
+            return;
+
+        mapType[pairBlock] = nStart;
+
+        /* Append the entry once the posting lists are on disk. */
+        if(fPostings.load() && streamPostings.is_open())
+        {
+            DataStream ssEntry(SER_LLD, DATABASE_VERSION);
+            ssEntry << strType << nFile << nStart;
+
+            streamPostings.write((char*)ssEntry.data(), ssEntry.size());
+            streamPostings.flush();
+        }
+    }
+
+
+    /*  Read the posting lists from disk, or start a rebuild if they are missing. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::ReadPostings()
+    {
+        /* Rebuild missing posting lists in the background, typed scans read every record until they are done. */
+        std::ifstream stream(debug::safe_printstr(strBaseLocation, "_postings"), std::ios::in | std::ios::binary);
+        if(!stream)
+        {
+            PostingThread = std::thread(std::bind(&SectorDatabase::BuildPostings, this));
+            return;
+        }
+
+        std::vector<uint8_t> vData((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        stream.close();
+
+        /* Count the entries across all types. */
+        auto count_entries = [this]()
+        {
+            uint64_t nTotal = 0;
+            for(const auto& type : mapPostings)
+                nTotal += type.second.size();
+
+            return nTotal;
+        };
+
+        /* Read the entries, dropping a torn entry at the end. */
+        uint64_t nEntries = 0;
+        SectorCursor cursor;
+        {
+            LOCK(POSTING_MUTEX);
+
+            DataStream ssData(vData, SER_LLD, DATABASE_VERSION);
+            while(!ssData.End())
             {
-                LOCK(BUFFER_MUTEX);
+                try
+                {
+                    std::string strType;
+                    uint32_t nFile  = 0;
+                    uint32_t nStart = 0;
+                    ssData >> strType >> nFile >> nStart;
 
-                vIndexes.swap(vDiskBuffer);
-                nBufferBytes = 0;
+                    AddPosting(strType, nFile, nStart);
+                    ++nEntries;
+                }
+                catch(const std::exception& e)
+                {
+                    break;
+                }
             }
 
-            /* Create a new file if the sector file size is over file size limits. */
-            if(nCurrentFileSize > MAX_SECTOR_FILE_SIZE)
+            /* Drop the entries into truncated sector files, and find the last posted record. */
+            std::map<uint32_t, uint64_t> mapSizes;
+            for(auto& type : mapPostings)
             {
-                debug::log(0, FUNCTION, "allocating new sector file ", nCurrentFile + 1);
+                for(auto it = type.second.begin(); it != type.second.end(); )
+                {
+                    /* Get the size of the sector file. */
+                    if(!mapSizes.count(it->first.first))
+                    {
+                        std::ifstream file(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), it->first.first), std::ios::in | std::ios::binary | std::ios::ate);
+                        mapSizes[it->first.first] = file ? static_cast<uint64_t>(file.tellg()) : 0;
+                    }
+
+                    if(it->second >= mapSizes[it->first.first])
+                    {
+                        it = type.second.erase(it);
+                        continue;
+                    }
 
-                /* Iterate the current file and reset current file sie. */
-                ++nCurrentFile;
-                nCurrentFileSize = 0;
+                    /* Track the last posted record. */
+                    if(std::make_pair(it->first.first, uint64_t(it->second)) > std::make_pair(cursor.nFile, cursor.nStart))
+                        cursor = SectorCursor(it->first.first, it->second);
 
-                /* Create a new file for next writes. */
-                std::fstream stream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile), std::ios::out | std::ios::binary | std::ios::trunc);
-                stream.close();
+                    ++it;
+                }
             }
+        }
 
-            /* Iterate through buffer to queue disk writes. */
-            for(const auto& vObj : vIndexes)
-            {
-                /* Force write data. */
-                Force(vObj.first, vObj.second);
+        /* Post the records written after the last entry, which a crash may have left out. */
+        IndexRecords(cursor);
 
-                /* Set no longer reserved in cache pool. */
-                cachePool->Reserve(vObj.first, false);
-            }
+        LOCK(POSTING_MUTEX);
 
-            /* Notify the condition. */
-            CONDITION.notify_all();
+        /* Rewrite the posting lists if entries were dropped, merged, or added, otherwise append to them. */
+        if(count_entries() != nEntries)
+        {
+            if(!WritePostings())
+                return;
+        }
+        else
+            streamPostings.open(debug::safe_printstr(strBaseLocation, "_postings"), std::ios::out | std::ios::binary | std::ios::app);
 
-            /* Verbose logging. */
-            debug::log(3, FUNCTION, "Flushed ", nRecordsFlushed.load(),
-                " Records of ", nBytesWrote.load(), " Bytes");
+        fPostings = true;
 
-            /* Reset counters if not in meter mode. */
-            if(!config::GetBoolArg("-meters"))
-            {
-                nBytesWrote     = 0;
-                nRecordsFlushed = 0;
-            }
+        debug::log(2, FUNCTION, strName, " loaded ", count_entries(), " postings for ", mapPostings.size(), " record types");
+    }
+
+
+    /*  Write all posting lists to disk and open the append stream, with the posting lock held. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::WritePostings()
+    {
+        /* Serialize every entry. */
+        DataStream ssData(SER_LLD, DATABASE_VERSION);
+        for(const auto& type : mapPostings)
+            for(const auto& entry : type.second)
+                ssData << type.first << entry.first.first << entry.second;
+
+        /* Write a temporary file and swap it in, so the file is never partial. */
+        const std::string strFile = debug::safe_printstr(strBaseLocation, "_postings");
+        {
+            std::ofstream stream(strFile + ".tmp", std::ios::out | std::ios::binary | std::ios::trunc);
+            if(ssData.size() > 0 && !stream.write((char*)ssData.data(), ssData.size()))
+                return debug::error(FUNCTION, strName, " failed to write posting lists");
         }
+
+        if(!filesystem::rename(strFile + ".tmp", strFile))
+            return debug::error(FUNCTION, strName, " failed to swap in posting lists");
+
+        /* Open the stream for new entries. */
+        if(streamPostings.is_open())
+            streamPostings.close();
+
+        streamPostings.open(strFile, std::ios::out | std::ios::binary | std::ios::app);
+
+        return streamPostings.is_open();
     }
 
 
-    /*  LLD Meter Thread. Tracks the Reads/Writes per second. */
+    /*  Posting Thread. Rebuilds the posting lists from every record in the datachain. */
     template<class KeychainType, class CacheType>
-    void SectorDatabase<KeychainType, CacheType>::Meter()
+    void SectorDatabase<KeychainType, CacheType>::BuildPostings()
     {
-        if(!config::GetBoolArg("-lldmeters", false))
+        debug::log(0, FUNCTION, strName, " rebuilding record type posting lists");
+
+        /* Post every record, new writes post their own records in the meantime. */
+        SectorCursor cursor;
+        if(!IndexRecords(cursor))
             return;
 
-        runtime::timer TIMER;
-        TIMER.Start();
+        LOCK(POSTING_MUTEX);
 
-        while(!fDestruct.load())
+        /* Write the lists before typed scans start to use them. */
+        if(!WritePostings())
+            return;
+
+        fPostings = true;
+
+        debug::log(0, FUNCTION, strName, " rebuilt posting lists for ", mapPostings.size(), " record types");
+    }
+
+
+    /*  Add every record from the cursor to the end of the datachain to the posting lists. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::IndexRecords(SectorCursor& cursor)
+    {
+        while(filesystem::exists(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), cursor.nFile)))
         {
-            runtime::sleep(100);
-            if(TIMER.Elapsed() < 30)
-                continue;
+            /* Post every record of the file, stopping on shutdown. */
+            const bool fStopped = ScanFile(cursor, std::numeric_limits<uint64_t>::max(), "",
+                [&](const std::string& strType, const uint32_t nStart, DataStream& ssValue)
+            {
+                LOCK(POSTING_MUTEX);
+                AddPosting(strType, cursor.nFile, nStart);
 
-            /* Write and Read data rates. */
-            double WPS = nBytesWrote.load() / (TIMER.Elapsed() * 1024.0);
-            double RPS = nBytesRead.load() / (TIMER.Elapsed() * 1024.0);
+                return !fDestruct.load();
+            });
 
-            /* Check for zero values. */
-            if(WPS == 0 && RPS == 0 && nRecordsFlushed.load() == 0)
-                continue;
+            if(fStopped)
+                return false;
 
-            /* Debug output. */
-            debug::log(0,
-                ANSI_COLOR_FUNCTION, strName, " LLD : ", ANSI_COLOR_RESET,
-                "Writing ", WPS, " Kb/s | ",
-                "Reading ", RPS, " Kb/s | ",
-                "Records ", nRecordsFlushed.load());
+            /* Iterate to the next file. */
+            ++cursor.nFile;
+            cursor.nStart = 0;
+        }
 
-            TIMER.Reset();
-            nBytesWrote.store(0);
-            nBytesRead.store(0);
-            nRecordsFlushed.store(0);
+        return true;
+    }
+
+
+    /*  Sync the sector files and keychain written since the last sync. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Sync(const bool fForce)
+    {
+        /* Syncing is left to the operating system under the none policy. */
+        if(!fForce && config::GetArg("-lldsync", "interval") == "none")
+            return true;
+
+        /* Hold the sync lock, so a sync doesn't return while the files it relies on are still syncing in another. */
+        LOCK(SYNC_MUTEX);
+
+        /* Flush the streams of batched writes and take the files to sync. */
+        std::set<uint32_t> setFiles;
+        {
+            LOCK(SECTOR_MUTEX);
+
+            TemplateNode<uint32_t, std::fstream*>* pnode = fileCache->pfirst;
+            while(pnode)
+            {
+                pnode->Data->flush();
+                pnode = pnode->pnext;
+            }
+
+            setFiles.swap(setDirty);
+        }
+
+        /* Sync the sector files. */
+        for(const uint32_t nFile : setFiles)
+        {
+            RandomAccessFile file(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nFile));
+            if(!file.Sync())
+            {
+                /* Keep the files to sync on the next try. */
+                LOCK2(SECTOR_MUTEX);
+                setDirty.insert(setFiles.begin(), setFiles.end());
+
+                return debug::error(FUNCTION, strName, " failed to sync sector file ", nFile);
+            }
         }
+
+        /* Sync the keychain. */
+        pSectorKeys->Flush();
+
+        return true;
     }
 
 
@@ -641,9 +2547,9 @@ namespace LLD
     }
 
 
-    /*  Write the transaction commitment message. */
+    /*  Encode the transaction records into a shared journal. */
     template<class KeychainType, class CacheType>
-    bool SectorDatabase<KeychainType, CacheType>::TxnCheckpoint()
+    bool SectorDatabase<KeychainType, CacheType>::TxnCheckpoint(DataStream& ssJournal)
     {
         LOCK(TRANSACTION_MUTEX);
 
@@ -651,23 +2557,105 @@ namespace LLD
         if(!pTransaction)
             return false;
 
-        /* Set commit message into journal. */
-        pTransaction->ssJournal << std::string("commit");
-
-        /* Create an append only stream. */
-        std::ofstream stream = std::ofstream(debug::safe_printstr(config::GetDataDir(), strName, "/journal.dat"), std::ios::app | std::ios::binary);
-        if(!stream.is_open())
-            return debug::error(FUNCTION, "failed to open journal file");
+        /* Tag the following records with this database. */
+        WriteAheadLog::Encode(ssJournal, JOURNAL::DATABASE, std::vector<uint8_t>(strName.begin(), strName.end()), std::vector<uint8_t>());
 
-        /* Write to the file.  */
+        /* Copy in the transaction records. */
         const std::vector<uint8_t>& vBytes = pTransaction->ssJournal.Bytes();
-        stream.write((char*)&vBytes[0], vBytes.size());
-        stream.close();
+        ssJournal.write((char*)&vBytes[0], vBytes.size());
+
+        return true;
+    }
+
+
+    /*  Move the transaction into a version for the reserved epoch. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::TxnPublish(const uint64_t nEpoch)
+    {
+        LOCK(TRANSACTION_MUTEX);
+
+        /* Check for active transaction. */
+        if(!pTransaction)
+            return false;
+
+        /* Move the changes out, reads find them in the version from here on. */
+        pCommit = std::make_shared<SectorVersion>(nEpoch);
+        pCommit->mapData.swap(pTransaction->mapTransactions);
+        pCommit->setKeychain.swap(pTransaction->setKeychain);
+        pCommit->mapIndex.swap(pTransaction->mapIndex);
+        pCommit->setErased.swap(pTransaction->setErasedData);
+
+        /* Append to a copy of the list and swap it in for lock free readers. */
+        LOCK2(VERSION_MUTEX);
+
+        const std::shared_ptr< const std::vector< std::shared_ptr<SectorVersion> > > pList = std::atomic_load(&pVersions);
+
+        std::shared_ptr< std::vector< std::shared_ptr<SectorVersion> > > pNext =
+            std::make_shared< std::vector< std::shared_ptr<SectorVersion> > >();
+
+        if(pList)
+            *pNext = *pList;
+
+        pNext->push_back(pCommit);
+        std::atomic_store(&pVersions, std::shared_ptr< const std::vector< std::shared_ptr<SectorVersion> > >(pNext));
 
         return true;
     }
 
 
+    /*  Capture the values the published version replaces, for snapshots pinned at older epochs. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::TxnPriors()
+    {
+        /* Get the published version. */
+        std::shared_ptr<SectorVersion> pVersion;
+        {
+            LOCK(TRANSACTION_MUTEX);
+            pVersion = pCommit;
+        }
+
+        if(!pVersion)
+            return;
+
+        /* Gather every key the version changes. */
+        std::set< std::vector<uint8_t> > setKeys(pVersion->setKeychain.begin(), pVersion->setKeychain.end());
+        setKeys.insert(pVersion->setErased.begin(), pVersion->setErased.end());
+
+        for(const auto& item : pVersion->mapData)
+            setKeys.insert(item.first);
+
+        for(const auto& item : pVersion->mapIndex)
+            setKeys.insert(item.first);
+
+        /* Read the current values, nothing of the version is on disk yet. */
+        std::shared_ptr<SectorPrior> pPrior = std::make_shared<SectorPrior>();
+        for(const auto& vKey : setKeys)
+        {
+            /* Keys that don't exist yet read as missing. */
+            SectorKey cKey;
+            if(!pSectorKeys->Get(vKey, cKey))
+            {
+                pPrior->mapKeys[vKey] = std::make_pair(false, std::vector<uint8_t>());
+                continue;
+            }
+
+            /* Keychain only entries have no record. */
+            std::vector<uint8_t> vData;
+            if(cKey.nSectorSize > 0 && !Get(cKey, vData))
+            {
+                debug::error(FUNCTION, strName, " failed to read prior value");
+                continue;
+            }
+
+            pPrior->mapSectors[std::make_pair(cKey.nSectorFile, cKey.nSectorStart)] = vKey;
+            pPrior->mapKeys[vKey] = std::make_pair(true, vData);
+        }
+
+        /* Publish the prior values to the snapshot readers. */
+        std::atomic_store(&pVersion->pPrior, std::shared_ptr<const SectorPrior>(pPrior));
+    }
+
+
     /*  Release the transaction checkpoint. */
     template<class KeychainType, class CacheType>
     void SectorDatabase<KeychainType, CacheType>::TxnRelease()
@@ -681,9 +2669,12 @@ namespace LLD
         /** Set the transaction pointer to null also acting like a flag **/
         pTransaction = nullptr;
 
-        /* Delete the transaction journal file. */
-        std::ofstream stream(debug::safe_printstr(config::GetDataDir(), strName, "/journal.dat"), std::ios::trunc);
-        stream.close();
+        /* Drop the version of a commit that never reached disk. */
+        if(pCommit)
+        {
+            pCommit.reset();
+            CollectVersions(true);
+        }
     }
 
 
@@ -691,33 +2682,55 @@ namespace LLD
     template<class KeychainType, class CacheType>
     bool SectorDatabase<KeychainType, CacheType>::TxnCommit()
     {
+        /* Publish the transaction first when it is committed on its own, so snapshots never see it half written. */
+        bool fPublished = false;
+        {
+            LOCK(TRANSACTION_MUTEX);
+            fPublished = (pCommit != nullptr);
+        }
+
+        if(!fPublished)
+        {
+            const uint64_t nEpoch = Snapshot::Reserve();
+            if(!TxnPublish(nEpoch))
+                return false;
+
+            if(Snapshot::Publish(nEpoch))
+                TxnPriors();
+        }
+
         LOCK(TRANSACTION_MUTEX);
 
         /* Check that there is a valid transaction to apply to the database. */
-        if(!pTransaction)
+        if(!pTransaction || !pCommit)
             return false;
 
-        /* Erase data set to be removed. */
-        for(const auto& item : pTransaction->setErasedData)
-            if(!pSectorKeys->Erase(item))
+        /* Erase data set to be removed, a key already gone was erased by an earlier attempt that is being recovered. */
+        for(const auto& item : pCommit->setErased)
+        {
+            SectorKey cKey;
+            if(!EraseSector(item) && pSectorKeys->Get(item, cKey))
                 return debug::error(FUNCTION, "failed to erase from keychain");
+        }
 
         /* Commit the sector data. */
-        for(const auto& item : pTransaction->mapTransactions)
+        for(const auto& item : pCommit->mapData)
             if(!Force(item.first, item.second))
                 return debug::error(FUNCTION, "failed to commit sector data");
 
         /* Commit keychain entries. */
-        for(const auto& item : pTransaction->setKeychain)
+        for(const auto& item : pCommit->setKeychain)
         {
             SectorKey cKey(STATE::READY, item, 0, 0, 0);
             if(!pSectorKeys->Put(cKey))
                 return debug::error(FUNCTION, "failed to commit to keychain");
         }
 
-        /* Commit the index data. */
+        /* Commit the index data, holding the sector locations steady while the indexes point at them. */
+        std::unique_lock<std::mutex> lk2 = CompactLock();
+
         std::map<std::vector<uint8_t>, SectorKey> mapIndex;
-        for(const auto& item : pTransaction->mapIndex)
+        for(const auto& item : pCommit->mapIndex)
         {
             /* Get the key. */
             SectorKey cKey;
@@ -731,12 +2744,20 @@ namespace LLD
                 mapIndex[item.second] = cKey;
             }
 
-            /* Write the new sector key. */
+            /* Write the new sector key, logging it so the compactor moves the index with the record. */
             cKey.SetKey(item.first);
+            LogKeys(std::vector<SectorKey>(1, cKey));
+
             if(!pSectorKeys->Put(cKey))
                 return debug::error(FUNCTION, "failed to write indexing entry");
         }
 
+        /* The version is on disk, drop the ones no snapshot needs. */
+        pCommit->fApplied = true;
+        pCommit.reset();
+
+        CollectVersions();
+
         /* Cleanup the transaction object. */
         delete pTransaction;
         pTransaction = nullptr;
@@ -745,119 +2766,82 @@ namespace LLD
     }
 
 
-    /*  Recover a transaction from the journal. */
+    /*  Apply a replayed journal record to the current transaction. */
     template<class KeychainType, class CacheType>
-    bool SectorDatabase<KeychainType, CacheType>::TxnRecovery()
+    void SectorDatabase<KeychainType, CacheType>::TxnRecord(const uint8_t nOpcode, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData)
     {
-        /* Create an append only stream. */
-        std::ifstream stream(debug::safe_printstr(config::GetDataDir(), strName, "/journal.dat"), std::ios::in | std::ios::out | std::ios::binary);
-        if(!stream.is_open())
-            return false;
-
-        /* Get the Binary Size. */
-        stream.ignore(std::numeric_limits<std::streamsize>::max());
-
-        /* Get the data buffer. */
-        uint32_t nSize = static_cast<uint32_t>(stream.gcount());
-
-        /* Check journal size for 0. */
-        if(nSize == 0)
-            return false;
-
-        /* Create buffer to read into. */
-        std::vector<uint8_t> vBuffer(nSize, 0);
-
-        /* Read the keychain file. */
-        stream.seekg (0, std::ios::beg);
-        stream.read((char*) &vBuffer[0], vBuffer.size());
-        stream.close();
-
-        debug::log(0, FUNCTION, strName, " transaction journal detected of ", nSize, " bytes");
+        LOCK(TRANSACTION_MUTEX);
 
-        /* Create the transaction object. */
-        TxnBegin();
+        /* Check for active transaction. */
+        if(!pTransaction)
+            return;
 
-        /* Serialize the key. */
-        const DataStream ssJournal(vBuffer, SER_LLD, DATABASE_VERSION);
-        while(!ssJournal.End())
+        switch(nOpcode)
         {
-            /* Read the data entry type. */
-            std::string strType;
-            ssJournal >> strType;
-
             /* Check for Erase. */
-            if(strType == "erase")
+            case JOURNAL::ERASE:
             {
-                /* Get the key to erase. */
-                std::vector<uint8_t> vKey;
-                ssJournal >> vKey;
-
                 /* Erase the key. */
                 pTransaction->EraseTransaction(vKey);
 
                 /* Debug output. */
                 debug::log(0, FUNCTION, "erasing key ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
+
+                break;
             }
-            else if(strType == "key")
-            {
-                /* Get the key to write. */
-                std::vector<uint8_t> vKey;
-                ssJournal >> vKey;
 
+            case JOURNAL::KEY:
+            {
                 /* Write the key. */
                 pTransaction->setKeychain.insert(vKey);
 
                 /* Debug output. */
                 debug::log(0, FUNCTION, "writing keychain ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
-            }
-            else if(strType == "write")
-            {
-                /* Get the key to write. */
-                std::vector<uint8_t> vKey;
-                ssJournal >> vKey;
 
-                /* Get the data to write. */
-                std::vector<uint8_t> vData;
-                ssJournal >> vData;
+                break;
+            }
 
+            case JOURNAL::WRITE:
+            {
                 /* Write the sector data. */
                 pTransaction->mapTransactions[vKey] = vData;
 
                 /* Debug output. */
                 debug::log(0, FUNCTION, "writing data ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
-            }
-            else if(strType == "index")
-            {
-                /* Get the key to index. */
-                std::vector<uint8_t> vKey;
-                ssJournal >> vKey;
 
-                /* Get the data to index to. */
-                std::vector<uint8_t> vIndex;
-                ssJournal >> vIndex;
+                break;
+            }
 
+            case JOURNAL::INDEX:
+            {
                 /* Set the indexing key. */
-                pTransaction->mapIndex[vKey] = vIndex;
+                pTransaction->mapIndex[vKey] = vData;
 
                 /* Debug output. */
                 debug::log(0, FUNCTION, "indexing key ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
-            }
-            if(strType == "commit")
-            {
-                debug::log(0, FUNCTION, strName, " transaction journal ready to be restored");
 
-                return true;
+                break;
             }
+
+            default:
+                debug::error(FUNCTION, "unknown journal opcode ", uint32_t(nOpcode));
         }
+    }
+
 
-        return debug::error(FUNCTION, strName, " transaction journal never reached commit");
+    /*  Get the name of this database. */
+    template<class KeychainType, class CacheType>
+    const std::string& SectorDatabase<KeychainType, CacheType>::GetName() const
+    {
+        return strName;
     }
 
 
     /* Explicity instantiate all template instances needed for compiler. */
+    template class SectorDatabase<Keychain,       BinaryLRU>;
     template class SectorDatabase<BinaryHashMap,  BinaryLRU>;
-    //template class SectorDatabase<ShardHashMap,   BinaryLRU>;
-    //template class SectorDatabase<BinaryHashMap,  BinaryLFU>;
-    //template class SectorDatabase<BinaryHashTree, BinaryLRU>;
+    template class SectorDatabase<ShardHashMap,   BinaryLRU>;
+    template class SectorDatabase<BinaryHashMap,  BinaryLFU>;
+    template class SectorDatabase<BinaryHashTree, BinaryLRU>;
 
 }
@@ -15,12 +15,15 @@ ________________________________________________________________________________
 #include <LLD/include/enum.h>
 #include <LLD/include/version.h>
 #include <LLD/hash/xxh3.h>
+#include <LLD/templates/randomfile.h>
 
 #include <Util/templates/datastream.h>
+#include <Util/include/args.h>
 #include <Util/include/filesystem.h>
 #include <Util/include/debug.h>
 #include <Util/include/hex.h>
 
+#include <algorithm>
 #include <iomanip>
 
 namespace LLD
@@ -40,6 +43,11 @@ namespace LLD
     , HASHMAP_KEY_ALLOCATION(static_cast<uint16_t>(HASHMAP_MAX_KEY_SIZE + 13))
     , nFlags(nFlagsIn)
     , RECORD_MUTEX(1024)
+    , fMeters(config::GetBoolArg("-lldmeters", false))
+    , nLookups(0)
+    , nFileReads(0)
+    , setDirty()
+    , setDirtyIndex()
     {
         Initialize();
     }
@@ -49,15 +57,20 @@ namespace LLD
     ShardHashMap::ShardHashMap(const ShardHashMap& map)
     : KEY_MUTEX()
     , strBaseLocation(map.strBaseLocation)
-    , fileCache(map.fileCache)
-    , diskShards(map.diskShards)
-    , indexCache(map.indexCache)
+    , fileCache(new TemplateLRU<std::pair<uint16_t, uint16_t>, std::fstream*>(8))
+    , diskShards(new TemplateLRU<uint16_t, std::vector<uint16_t>*>(map.HASHMAP_TOTAL_SHARDS))
+    , indexCache(new TemplateLRU<uint16_t, std::fstream*>(map.HASHMAP_TOTAL_SHARDS))
     , HASHMAP_TOTAL_BUCKETS(map.HASHMAP_TOTAL_BUCKETS)
     , HASHMAP_TOTAL_SHARDS(map.HASHMAP_TOTAL_SHARDS)
     , HASHMAP_MAX_KEY_SIZE(map.HASHMAP_MAX_KEY_SIZE)
     , HASHMAP_KEY_ALLOCATION(map.HASHMAP_KEY_ALLOCATION)
     , nFlags(map.nFlags)
     , RECORD_MUTEX(map.RECORD_MUTEX.size())
+    , fMeters(map.fMeters)
+    , nLookups(0)
+    , nFileReads(0)
+    , setDirty()
+    , setDirtyIndex()
     {
         Initialize();
     }
@@ -66,15 +79,21 @@ namespace LLD
     /* Copy Assignment Operator */
     ShardHashMap& ShardHashMap::operator=(const ShardHashMap& map)
     {
+        /* Each copy owns its own file handles, so replace rather than share the caches. */
+        delete fileCache;
+        delete diskShards;
+        delete indexCache;
+
         strBaseLocation        = map.strBaseLocation;
-        fileCache              = map.fileCache;
-        diskShards             = map.diskShards;
-        indexCache             = map.indexCache;
+        fileCache              = new TemplateLRU<std::pair<uint16_t, uint16_t>, std::fstream*>(8);
+        diskShards             = new TemplateLRU<uint16_t, std::vector<uint16_t>*>(map.HASHMAP_TOTAL_SHARDS);
+        indexCache             = new TemplateLRU<uint16_t, std::fstream*>(map.HASHMAP_TOTAL_SHARDS);
         HASHMAP_TOTAL_BUCKETS  = map.HASHMAP_TOTAL_BUCKETS;
         HASHMAP_TOTAL_SHARDS   = map.HASHMAP_TOTAL_SHARDS;
         HASHMAP_MAX_KEY_SIZE   = map.HASHMAP_MAX_KEY_SIZE;
         HASHMAP_KEY_ALLOCATION = map.HASHMAP_KEY_ALLOCATION;
         nFlags                 = map.nFlags;
+        fMeters                = map.fMeters;
 
         Initialize();
 
@@ -138,7 +157,7 @@ namespace LLD
         if(!filesystem::exists(index))
         {
             /* Generate empty space for new file. */
-            const static std::vector<uint8_t> vSpace(HASHMAP_TOTAL_BUCKETS * 2, 0);
+            const std::vector<uint8_t> vSpace(HASHMAP_TOTAL_BUCKETS * 2, 0);
 
             /* Write the new disk index .*/
             std::fstream stream(index, std::ios::out | std::ios::binary | std::ios::trunc);
@@ -250,6 +269,10 @@ namespace LLD
     {
         LOCK(KEY_MUTEX);
 
+        /* Update the lookup meter. */
+        if(fMeters)
+            ++nLookups;
+
         /* Get the assigned bucket for the hashmap. */
         uint32_t nShard  = 0;
         uint32_t nBucket = GetBucket(vKey, nShard);
@@ -301,6 +324,8 @@ namespace LLD
 
             /* Read the bucket binary data from file stream */
             pstream->read((char*) &vBucket[0], vBucket.size());
+            if(fMeters)
+                ++nFileReads;
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -495,6 +520,7 @@ namespace LLD
                     pstream->seekp (nFilePos, std::ios::beg);
                     pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
                     pstream->flush();
+                    setDirty.insert(std::make_pair(uint16_t(nShard), uint16_t(i)));
 
                     /* Debug Output of Sector Key Information. */
                     if(config::nVerbose >= 4)
@@ -571,6 +597,7 @@ namespace LLD
         pstream->seekp (nFilePos, std::ios::beg);
         pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
         pstream->flush();
+        setDirty.insert(std::make_pair(uint16_t(nShard), hashmap->at(nBucket)));
 
         /* Seek to the index position. */
         std::fstream* pindex;
@@ -603,6 +630,7 @@ namespace LLD
         /* Write the index into hashmap. */
         pindex->write((char*)&vBucket[0], vBucket.size());
         pindex->flush();
+        setDirtyIndex.insert(uint16_t(nShard));
 
         /* Debug Output of Sector Key Information. */
         if(config::nVerbose >= 4)
@@ -620,6 +648,97 @@ namespace LLD
     }
 
 
+    /*  Read a batch of keys from the disk hashmaps, ordered by shard and bucket. */
+    bool ShardHashMap::Get(const std::vector< std::vector<uint8_t> >& vKeys, std::vector<SectorKey>& vSectorKeys)
+    {
+        /* Calculate the shard and bucket for the batch. */
+        std::vector< std::pair<uint64_t, uint32_t> > vOrder;
+        vOrder.reserve(vKeys.size());
+        for(uint32_t n = 0; n < vKeys.size(); ++n)
+        {
+            uint32_t nShard  = 0;
+            uint32_t nBucket = GetBucket(vKeys[n], nShard);
+
+            vOrder.push_back(std::make_pair((uint64_t(nShard) << 32) | nBucket, n));
+        }
+
+        /* Sort so that keys sharing a shard and bucket are read together. */
+        std::sort(vOrder.begin(), vOrder.end());
+
+        /* Read the keys in shard and bucket order. */
+        bool fFound = true;
+        for(const auto& order : vOrder)
+        {
+            SectorKey cKey;
+            if(!Get(vKeys[order.second], cKey))
+            {
+                fFound = false;
+                continue;
+            }
+
+            vSectorKeys.push_back(cKey);
+        }
+
+        return fFound;
+    }
+
+
+    /*  Write a batch of keys to the disk hashmaps, ordered by shard and bucket. */
+    bool ShardHashMap::Put(const std::vector<SectorKey>& vKeys)
+    {
+        /* Calculate the shard and bucket for the batch. */
+        std::vector< std::pair<uint64_t, uint32_t> > vOrder;
+        vOrder.reserve(vKeys.size());
+        for(uint32_t n = 0; n < vKeys.size(); ++n)
+        {
+            uint32_t nShard  = 0;
+            uint32_t nBucket = GetBucket(vKeys[n].vKey, nShard);
+
+            vOrder.push_back(std::make_pair((uint64_t(nShard) << 32) | nBucket, n));
+        }
+
+        /* Stable sort so that duplicate keys keep their order and the last write wins. */
+        std::stable_sort(vOrder.begin(), vOrder.end(),
+            [](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b)
+            {
+                return a.first < b.first;
+            });
+
+        /* Write the keys in shard and bucket order. */
+        for(const auto& order : vOrder)
+            if(!Put(vKeys[order.second]))
+                return false;
+
+        return true;
+    }
+
+
+    /*  Flush all buffers to disk if using ACID transaction. */
+    void ShardHashMap::Flush()
+    {
+        LOCK(KEY_MUTEX);
+
+        /* Every write flushes its stream, so sync the files written since the last flush. */
+        for(const auto& pairFile : setDirty)
+        {
+            RandomAccessFile file(debug::safe_printstr(strBaseLocation, "_hashmap.",
+                std::setfill('0'), std::setw(3), pairFile.first, ".", std::setfill('0'), std::setw(5), pairFile.second));
+            if(!file.Sync())
+                debug::error(FUNCTION, "failed to sync hashmap file ", pairFile.second, " in shard ", pairFile.first);
+        }
+
+        for(const uint16_t nShard : setDirtyIndex)
+        {
+            RandomAccessFile file(debug::safe_printstr(strBaseLocation, "_index.", std::setfill('0'), std::setw(3), nShard));
+            if(!file.Sync())
+                debug::error(FUNCTION, "failed to sync index of shard ", nShard);
+        }
+
+        setDirty.clear();
+        setDirtyIndex.clear();
+    }
+
+
     /*  Erase a key from the disk hashmaps.
      *  TODO: This should be optimized further. */
     bool ShardHashMap::Erase(const std::vector<uint8_t>& vKey)
@@ -691,6 +810,7 @@ namespace LLD
                 std::vector<uint8_t> vEmpty(HASHMAP_KEY_ALLOCATION, 0);
                 pstream->write((char*) &vEmpty[0], vEmpty.size());
                 pstream->flush();
+                setDirty.insert(std::make_pair(uint16_t(nShard), uint16_t(i)));
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
@@ -747,10 +867,15 @@ namespace LLD
             {
                 /* Set the new stream pointer. */
                 std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                    std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), hashmap->at(nBucket));
+                    std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), i);
 
                 /* Set the new stream pointer. */
                 pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
+                if(!pstream->is_open())
+                {
+                    delete pstream;
+                    continue;
+                }
 
                 /* If file not found add to LRU cache. */
                 fileCache->Put(std::make_pair(nShard, i), pstream);
@@ -778,9 +903,10 @@ namespace LLD
                 pstream->seekp (nFilePos, std::ios::beg);
 
                 /* Read the bucket binary data from file stream */
-                std::vector<uint8_t> vReady(STATE::READY);
+                std::vector<uint8_t> vReady(1, STATE::READY);
                 pstream->write((char*) &vReady[0], vReady.size());
                 pstream->flush();
+                setDirty.insert(std::make_pair(uint16_t(nShard), uint16_t(i)));
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
@@ -802,4 +928,21 @@ namespace LLD
     }
 
 
+    /* Log and reset the keychain lookup meters. */
+    void ShardHashMap::Meters(const std::string& strName)
+    {
+        /* Get the current meters. */
+        const uint64_t nTotalLookups = nLookups.exchange(0);
+        const uint64_t nTotalReads   = nFileReads.exchange(0);
+
+        /* Check for zero values. */
+        if(nTotalLookups == 0)
+            return;
+
+        /* Debug output. */
+        debug::log(0,
+            ANSI_COLOR_FUNCTION, strName, " LLD : ", ANSI_COLOR_RESET,
+            "Shard Keychain ", nTotalLookups, " lookups | ",
+            "Reads ", double(nTotalReads) / nTotalLookups, " per lookup");
+    }
 }
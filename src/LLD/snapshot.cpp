@@ -0,0 +1,110 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/snapshot.h>
+
+#include <Util/include/mutex.h>
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+
+namespace LLD
+{
+
+    /* Mutex for the current epoch and the pinned epochs. */
+    std::mutex SNAPSHOT_MUTEX;
+
+
+    /* The epoch of the last published commit. */
+    uint64_t nCurrentEpoch = 1;
+
+
+    /* The epoch of the last reserved commit. */
+    std::atomic<uint64_t> nReservedEpoch(1);
+
+
+    /* The epochs pinned by live snapshots. */
+    std::multiset<uint64_t> setPinned;
+
+
+    /* The epoch pinned by this thread. */
+    thread_local uint64_t nThreadEpoch = 0;
+
+
+    /* Pin the current epoch. */
+    Snapshot::Snapshot()
+    : nEpoch (0)
+    {
+        /* Keep the outer snapshot's epoch. */
+        if(nThreadEpoch != 0)
+            return;
+
+        LOCK(SNAPSHOT_MUTEX);
+
+        nEpoch = nCurrentEpoch;
+        setPinned.insert(nEpoch);
+
+        nThreadEpoch = nEpoch;
+    }
+
+
+    /* Release the pinned epoch. */
+    Snapshot::~Snapshot()
+    {
+        if(nEpoch == 0)
+            return;
+
+        LOCK(SNAPSHOT_MUTEX);
+
+        setPinned.erase(setPinned.find(nEpoch));
+        nThreadEpoch = 0;
+    }
+
+
+    /* Get the epoch pinned by this thread. */
+    uint64_t Snapshot::Pinned()
+    {
+        return nThreadEpoch;
+    }
+
+
+    /* Get the oldest epoch that a snapshot could still read. */
+    uint64_t Snapshot::Oldest()
+    {
+        LOCK(SNAPSHOT_MUTEX);
+
+        if(setPinned.empty())
+            return nCurrentEpoch;
+
+        return *setPinned.begin();
+    }
+
+
+    /* Reserve the epoch of the next commit. */
+    uint64_t Snapshot::Reserve()
+    {
+        return ++nReservedEpoch;
+    }
+
+
+    /* Make a reserved epoch current. */
+    bool Snapshot::Publish(const uint64_t nEpochIn)
+    {
+        LOCK(SNAPSHOT_MUTEX);
+
+        nCurrentEpoch = std::max(nCurrentEpoch, nEpochIn);
+
+        return !setPinned.empty() && *setPinned.begin() < nEpochIn;
+    }
+}
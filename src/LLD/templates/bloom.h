@@ -0,0 +1,168 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_BLOOM_H
+#define NEXUS_LLD_TEMPLATES_BLOOM_H
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LLD
+{
+
+    /** BloomFilter
+     *
+     *  Register blocked bloom filter persisted to disk.
+     *
+     *  Every key sets all of its bits inside a single 64-bit word, so a lookup
+     *  touches one word in memory and an insert writes one word through to disk.
+     *  Words are atomic so lookups never need to take a lock.
+     *
+     **/
+    class BloomFilter
+    {
+        /** Mutex for the file stream. **/
+        std::mutex FILE_MUTEX;
+
+
+        /** The words of the filter. **/
+        std::vector< std::atomic<uint64_t> > vWords;
+
+
+        /** The file stream to persist the filter. **/
+        std::fstream* pstream;
+
+
+        /** The path of the filter file. **/
+        std::string strPath;
+
+
+    public:
+
+        /** The bits to allocate per key. **/
+        static const uint32_t BITS_PER_KEY = 8;
+
+
+        /** Default Constructor. **/
+        BloomFilter()                                  = delete;
+
+
+        /** Copy Constructor. **/
+        BloomFilter(const BloomFilter& filter)         = delete;
+
+
+        /** Move Constructor. **/
+        BloomFilter(BloomFilter&& filter)              = delete;
+
+
+        /** Copy assignment. **/
+        BloomFilter& operator=(const BloomFilter& filter) = delete;
+
+
+        /** Move assignment. **/
+        BloomFilter& operator=(BloomFilter&& filter)   = delete;
+
+
+        /** Capacity Constructor
+         *
+         *  @param[in] nKeys The expected maximum keys in the filter.
+         *
+         **/
+        BloomFilter(const uint64_t nKeys);
+
+
+        /** Default Destructor. **/
+        ~BloomFilter();
+
+
+        /** Load
+         *
+         *  Load the filter from disk and keep the file open for writes.
+         *
+         *  @param[in] strFile The path of the filter file.
+         *
+         *  @return False if the file is missing or the wrong size.
+         *
+         **/
+        bool Load(const std::string& strFile);
+
+
+        /** Create
+         *
+         *  Write the current filter to a new file and keep it open for writes.
+         *
+         *  @param[in] strFile The path of the filter file.
+         *
+         *  @return True if the file was written.
+         *
+         **/
+        bool Create(const std::string& strFile);
+
+
+        /** Insert
+         *
+         *  Add a key to the filter, writing the changed word through to disk.
+         *
+         *  @param[in] pKey The binary data of the key.
+         *  @param[in] nSize The size of the key.
+         *
+         **/
+        void Insert(const uint8_t* pKey, const uint64_t nSize);
+
+
+        /** Sync
+         *
+         *  Sync the filter file to disk, so it is never older than the keys it covers.
+         *
+         *  @return True if the file was synced.
+         *
+         **/
+        bool Sync();
+
+
+        /** Has
+         *
+         *  Check if a key may be in the filter.
+         *
+         *  @param[in] pKey The binary data of the key.
+         *  @param[in] nSize The size of the key.
+         *
+         *  @return False if the key is definitely not in the filter.
+         *
+         **/
+        bool Has(const uint8_t* pKey, const uint64_t nSize) const;
+
+
+    private:
+
+        /** Slot
+         *
+         *  Calculate the word and bit mask for a key.
+         *
+         *  @param[in] pKey The binary data of the key.
+         *  @param[in] nSize The size of the key.
+         *  @param[out] nMask The bits to set for this key.
+         *
+         *  @return The word index for the key.
+         *
+         **/
+        uint64_t slot(const uint8_t* pKey, const uint64_t nSize, uint64_t& nMask) const;
+    };
+}
+
+#endif
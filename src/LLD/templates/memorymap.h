@@ -0,0 +1,120 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_MEMORYMAP_H
+#define NEXUS_LLD_TEMPLATES_MEMORYMAP_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace LLD
+{
+
+    /** MemoryMap
+     *
+     *  Read-only memory mapping of a single sector file.
+     *
+     *  The mapping reserves a fixed window of address space that is larger than
+     *  the file is allowed to grow, so appends to the file become visible through
+     *  the existing mapping without having to remap. The known file size is tracked
+     *  atomically and refreshed from disk only when a read lands past it, which keeps
+     *  reads lock free and protects against touching pages beyond end of file.
+     *
+     **/
+    class MemoryMap
+    {
+        /** The file descriptor backing this map. **/
+        int nFile;
+
+
+        /** The beginning of the mapped region. **/
+        uint8_t* pBegin;
+
+
+        /** The total bytes of address space reserved. **/
+        uint64_t nReserved;
+
+
+        /** The last known size of the file on disk. **/
+        mutable std::atomic<uint64_t> nFileSize;
+
+
+    public:
+
+        /** Default Constructor. **/
+        MemoryMap()                                  = delete;
+
+
+        /** Copy Constructor. **/
+        MemoryMap(const MemoryMap& map)              = delete;
+
+
+        /** Move Constructor. **/
+        MemoryMap(MemoryMap&& map)                   = delete;
+
+
+        /** Copy assignment. **/
+        MemoryMap& operator=(const MemoryMap& map)   = delete;
+
+
+        /** Move assignment. **/
+        MemoryMap& operator=(MemoryMap&& map)        = delete;
+
+
+        /** File Constructor
+         *
+         *  @param[in] strFile The path of the file to map.
+         *  @param[in] nReserveIn The bytes of address space to reserve.
+         *
+         **/
+        MemoryMap(const std::string& strFile, const uint64_t nReserveIn);
+
+
+        /** Default Destructor. **/
+        ~MemoryMap();
+
+
+        /** IsNull
+         *
+         *  Determines if the mapping failed to be created.
+         *
+         **/
+        bool IsNull() const;
+
+
+        /** Read
+         *
+         *  Copy a range of bytes out of the mapped file.
+         *
+         *  @param[in] nStart The binary position to begin reading at.
+         *  @param[out] vData The buffer to read into, sized to the bytes to read.
+         *
+         *  @return True if the range was inside the file and mapping.
+         *
+         **/
+        bool Read(const uint64_t nStart, std::vector<uint8_t>& vData) const;
+
+
+        /** Supported
+         *
+         *  Determines if memory mapped reads are available on this platform.
+         *
+         **/
+        static bool Supported();
+    };
+}
+
+#endif
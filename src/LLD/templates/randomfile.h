@@ -0,0 +1,159 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_RANDOMFILE_H
+#define NEXUS_LLD_TEMPLATES_RANDOMFILE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LLD
+{
+
+    /** RandomAccessFile
+     *
+     *  File handle for positional reads and writes.
+     *
+     *  Unlike a std::fstream there is no shared seek position, so a single
+     *  handle can be used by many threads at once without a lock. Platforms
+     *  without pread/pwrite fall back to a seek and read under a mutex.
+     *
+     **/
+    class RandomAccessFile
+    {
+        /** The file descriptor. **/
+        int nFile;
+
+
+        /** Mutex for platforms without positional IO. **/
+        mutable std::mutex SEEK_MUTEX;
+
+
+    public:
+
+        /** Default Constructor. **/
+        RandomAccessFile()                                         = delete;
+
+
+        /** Copy Constructor. **/
+        RandomAccessFile(const RandomAccessFile& file)             = delete;
+
+
+        /** Move Constructor. **/
+        RandomAccessFile(RandomAccessFile&& file)                  = delete;
+
+
+        /** Copy assignment. **/
+        RandomAccessFile& operator=(const RandomAccessFile& file)  = delete;
+
+
+        /** Move assignment. **/
+        RandomAccessFile& operator=(RandomAccessFile&& file)       = delete;
+
+
+        /** File Constructor
+         *
+         *  @param[in] strFile The path of the file to open.
+         *  @param[in] fCreate Flag to create the file if it doesn't exist.
+         *
+         **/
+        RandomAccessFile(const std::string& strFile, const bool fCreate = false);
+
+
+        /** Default Destructor. **/
+        ~RandomAccessFile();
+
+
+        /** IsNull
+         *
+         *  Determines if the file failed to open.
+         *
+         **/
+        bool IsNull() const;
+
+
+        /** Read
+         *
+         *  Read bytes from a given position in the file.
+         *
+         *  @param[in] nPos The binary position to read from.
+         *  @param[out] vData The buffer to read into, sized to the bytes to read.
+         *
+         *  @return True if all the bytes were read.
+         *
+         **/
+        bool Read(const uint64_t nPos, std::vector<uint8_t>& vData) const;
+
+
+        /** Write
+         *
+         *  Write bytes to a given position in the file.
+         *
+         *  @param[in] nPos The binary position to write to.
+         *  @param[in] pData The bytes to write.
+         *  @param[in] nSize The total bytes to write.
+         *
+         *  @return True if all the bytes were written.
+         *
+         **/
+        bool Write(const uint64_t nPos, const uint8_t* pData, const uint64_t nSize);
+
+
+        /** Write
+         *
+         *  Write bytes to a given position in the file.
+         *
+         *  @param[in] nPos The binary position to write to.
+         *  @param[in] vData The bytes to write.
+         *
+         *  @return True if all the bytes were written.
+         *
+         **/
+        bool Write(const uint64_t nPos, const std::vector<uint8_t>& vData);
+
+
+        /** Sync
+         *
+         *  Flush the file contents from the operating system to disk.
+         *
+         *  @return True if the sync succeeded.
+         *
+         **/
+        bool Sync();
+
+
+        /** Truncate
+         *
+         *  Truncate or extend the file to a given size.
+         *
+         *  @param[in] nSize The new size of the file.
+         *
+         *  @return True if the file was resized.
+         *
+         **/
+        bool Truncate(const uint64_t nSize);
+
+
+        /** Size
+         *
+         *  Get the current size of the file.
+         *
+         **/
+        uint64_t Size() const;
+    };
+}
+
+#endif
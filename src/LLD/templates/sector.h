@@ -18,8 +18,12 @@ ________________________________________________________________________________
 
 #include <LLD/include/enum.h>
 #include <LLD/include/version.h>
+#include <LLD/include/compress.h>
+#include <LLD/include/snapshot.h>
 #include <LLD/templates/key.h>
 #include <LLD/templates/transaction.h>
+#include <LLD/templates/memorymap.h>
+#include <LLD/templates/wal.h>
 
 #include <LLD/cache/template_lru.h>
 
@@ -30,9 +34,13 @@ ________________________________________________________________________________
 #include <string>
 #include <cstdint>
 #include <atomic>
+#include <map>
+#include <set>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
+#include <memory>
 
 namespace LLD
 {
@@ -50,6 +58,56 @@ namespace LLD
     const uint32_t MAX_SECTOR_BUFFER_SIZE = 1024 * 1024 * 4; //32 MB Max Disk Buffer
 
 
+    /* The address space reserved for each memory mapped sector file. */
+    const uint64_t MAX_SECTOR_MAP_SIZE = uint64_t(MAX_SECTOR_FILE_SIZE) * 2; //1 GB Max Map Window
+
+
+    /* The span of a sector file that one posting list entry covers. */
+    const uint32_t SECTOR_POSTING_BLOCK = 1024 * 256; //256 KB per Posting
+
+
+    /* The largest gap between two records that a batched read coalesces into one read. */
+    const uint32_t SECTOR_COALESCE_GAP = 1024 * 4; //4 KB Max Read Gap
+
+
+    /** SectorCursor
+     *
+     *  Position token for a sequential scan of the datachain. It always points
+     *  at the next record to read, so it can be kept to resume a scan later.
+     *
+     **/
+    struct SectorCursor
+    {
+        /** The sector file being read. **/
+        uint32_t nFile;
+
+
+        /** The binary position of the next record in the file. **/
+        uint64_t nStart;
+
+
+        /** Default Constructor. **/
+        SectorCursor()
+        : nFile  (0)
+        , nStart (0)
+        {
+        }
+
+
+        /** Position Constructor
+         *
+         *  @param[in] nFileIn The sector file to start from.
+         *  @param[in] nStartIn The binary position to start from.
+         *
+         **/
+        SectorCursor(const uint32_t nFileIn, const uint64_t nStartIn)
+        : nFile  (nFileIn)
+        , nStart (nStartIn)
+        {
+        }
+    };
+
+
     /** SectorDatabase
      *
      *  Base Template Class for a Sector Database.
@@ -94,6 +152,19 @@ namespace LLD
         std::mutex SECTOR_MUTEX;
         std::mutex BUFFER_MUTEX;
         std::mutex TRANSACTION_MUTEX;
+        std::mutex MAP_MUTEX;
+
+
+        /* Mutex held while sector locations change in the keychain, so the compactor never moves a record mid write. */
+        std::mutex COMPACT_MUTEX;
+
+
+        /* Mutex for the posting lists. */
+        std::mutex POSTING_MUTEX;
+
+
+        /* Mutex held while syncing the sector files. */
+        std::mutex SYNC_MUTEX;
 
 
         /* The String to hold the Disk Location of Database File. */
@@ -109,6 +180,18 @@ namespace LLD
         SectorTransaction* pTransaction;
 
 
+        /* Mutex for replacing the version list. */
+        std::mutex VERSION_MUTEX;
+
+
+        /* Versions of recent commits from oldest to newest, replaced with atomic stores so snapshot reads take no lock. */
+        std::shared_ptr< const std::vector< std::shared_ptr<SectorVersion> > > pVersions;
+
+
+        /* The published version of the transaction being committed. */
+        std::shared_ptr<SectorVersion> pCommit;
+
+
         /* Sector Keys Database. */
         KeychainType* pSectorKeys;
 
@@ -121,11 +204,19 @@ namespace LLD
         mutable TemplateLRU<uint32_t, std::fstream*>* fileCache;
 
 
+        /* Memory maps of sector files, indexed by file number for lock free lookups. */
+        std::vector< std::atomic<MemoryMap*> > vMemoryMaps;
+
+
         /* The current File Position. */
         mutable uint32_t nCurrentFile;
         mutable uint32_t nCurrentFileSize;
 
 
+        /* The sector files written since the last sync. */
+        std::set<uint32_t> setDirty;
+
+
         /* Cache Writer Thread. */
         std::thread CacheWriterThread;
 
@@ -134,6 +225,14 @@ namespace LLD
         std::thread MeterThread;
 
 
+        /* The compactor thread. */
+        std::thread CompactorThread;
+
+
+        /* The thread that rebuilds missing posting lists. */
+        std::thread PostingThread;
+
+
         /* Disk Buffer Vector. */
         std::vector< std::pair< std::vector<uint8_t>, std::vector<uint8_t> > > vDiskBuffer;
 
@@ -154,6 +253,72 @@ namespace LLD
         std::atomic<bool> fInitialized;
 
 
+        /* Flag to track dead bytes and compact sector files. */
+        bool fCompact;
+
+
+        /* Bytes of each sector file that are no longer referenced by the keychain. */
+        std::map<uint32_t, uint64_t> mapDeadBytes;
+
+
+        /* Sector files compacted on the last pass, truncated on the next pass once no reader can hold their old keys. */
+        std::vector<uint32_t> vRetired;
+
+
+        /* Memory maps of the retired sector files, deleted with the files. */
+        std::vector<MemoryMap*> vRetiredMaps;
+
+
+        /* Sector files being truncated, which readers must not map again until they are. */
+        std::set<uint32_t> setRetiring;
+
+
+        /* The epoch of memory map readers, flipped to wait out the readers of retired maps. */
+        std::atomic<uint64_t> nMapEpoch;
+
+
+        /* The memory map readers in each half of the epoch. */
+        std::atomic<uint32_t> nMapReaders[2];
+
+
+        /* In place writes of mapped files, odd while one is in progress, so readers can detect a torn copy. */
+        std::atomic<uint64_t> nMapWrites;
+
+
+        /* Append stream for the key log of the sector file last written, guarded by the compact lock. */
+        std::ofstream streamKeys;
+        uint32_t nKeysFile;
+
+
+        /* Compaction totals for the meter. */
+        std::atomic<uint64_t> nCompactedBytes;
+        std::atomic<uint64_t> nReclaimedBytes;
+
+
+        /** The smallest record that is compressed in COMPRESS mode. **/
+        uint32_t nCompressMin;
+
+
+        /** The bytes read from disk at a time by sequential scans. **/
+        uint32_t nReadAhead;
+
+
+        /* Flag to keep posting lists of the sectors that hold each record type. */
+        bool fTypeIndex;
+
+
+        /* Flag that the posting lists are complete, so typed scans can use them. */
+        std::atomic<bool> fPostings;
+
+
+        /* Posting lists by record type, from sector file and posting block to the first record of the type in the block. */
+        std::map<std::string, std::map<std::pair<uint32_t, uint32_t>, uint32_t>> mapPostings;
+
+
+        /* Append stream for the posting lists on disk. */
+        std::ofstream streamPostings;
+
+
         /** Database Flags. **/
         uint8_t nFlags;
 
@@ -197,6 +362,14 @@ namespace LLD
             /* Get reference of key. */
             const std::vector<uint8_t>& vKey = ssKey.Bytes();
 
+            /* Snapshot reads skip the pending transaction and its lock. */
+            const uint64_t nSnapshot = Snapshot::Pinned();
+            if(nSnapshot != 0)
+            {
+                std::vector<uint8_t> vData;
+                return GetVersion(vKey, vData, nSnapshot, false);
+            }
+
             /* Check that the key is not pending in a transaction for Erase. */
             {
                 LOCK(TRANSACTION_MUTEX);
@@ -221,13 +394,9 @@ namespace LLD
                 }
             }
 
-            /* Check the cache pool. */
-            if(cachePool->Has(vKey))
-                return true;
-
-            /* Return the Key existance in the Keychain Database. */
-            SectorKey cKey;
-            return pSectorKeys->Get(vKey, cKey);
+            /* Check the versions being committed and the keychain. */
+            std::vector<uint8_t> vData;
+            return GetVersion(vKey, vData, 0, false);
         }
 
 
@@ -259,7 +428,7 @@ namespace LLD
                 if(pTransaction)
                 {
                     /* Write to journal in memory. */
-                    pTransaction->ssJournal << std::string("erase") << ssKey.Bytes();
+                    pTransaction->Journal(JOURNAL::ERASE, ssKey.Bytes());
 
                     /* Erase the transaction data. */
                     pTransaction->EraseTransaction(ssKey.Bytes());
@@ -268,7 +437,7 @@ namespace LLD
                 }
             }
 
-            return pSectorKeys->Erase(ssKey.Bytes());//Delete(ssKey.Bytes());
+            return EraseSector(ssKey.Bytes());
         }
 
 
@@ -341,105 +510,117 @@ namespace LLD
         {
             /* Clear any remaining data. */
             vValues.clear();
+            if(nLimit == 0)
+                return false;
 
-            /* Scan until limit is reached. */
-            while(nLimit == -1 || nLimit > 0)
+            /* Stream the values into the vector until the limit is reached. */
+            SectorCursor cursor(nFile, nStart);
+            ForEach<Type>(strType, cursor, [&](Type& value)
             {
-                /* Get filestream object. */
-                std::ifstream stream = std::ifstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nFile), std::ios::in | std::ios::binary);
-                if(!stream)
-                    break;
-
-                /* Check filesize. */
-                stream.seekg(0, std::ios::end);
-                uint64_t nFileSize = stream.tellg();
-                uint64_t nBufferSize = (nLimit == -1) ? nFileSize : (1024 * 1024); //1 MB read buffer
-                stream.seekg(0, std::ios::beg); //reset seek position
-
-                /* Loop until stream encounters exceptions. */
-                while(stream)
-                {
-                    /* Check that we aren't seeking past end of file. */
-                    if(nStart >= nFileSize)
-                        break;
+                vValues.push_back(std::move(value));
 
-                    /* Read into serialize stream. */
-                    DataStream ssData(SER_LLD, DATABASE_VERSION);
-                    ssData.resize(nBufferSize);
+                return (nLimit == -1 || --nLimit > 0);
+            });
 
-                    {
-                        LOCK(SECTOR_MUTEX);
-
-                        /* Seek stream to beginning. */
-                        stream.seekg(nStart, std::ios::beg);
+            return (vValues.size() > 0);
+        }
 
-                        /* Read the data into the buffer. */
-                        stream.read((char*)ssData.data(), nBufferSize);
-                        if(!stream)
-                            ssData.resize(stream.gcount());
 
-                        /* Iterate if meters are enabled. */
-                        nBytesRead += static_cast<uint32_t>(nBufferSize);
-                    }
+        /** ForEach
+         *
+         *  Stream the values of a type to a callback from the cursor position,
+         *  without holding more than one read buffer of records in memory.
+         *
+         *  @param[in] strType The type specifier to read records from
+         *  @param[out] cursor The position to read from, left at the next unread record.
+         *  @param[in] fnValue The callback for each value, returning false to stop the scan.
+         *  @param[in] fnFilter Optional predicate that values must pass to reach the callback.
+         *
+         *  @return True if the callback stopped the scan, false if the end of the datachain was reached.
+         *
+         **/
+        template<typename Type>
+        bool ForEach(const std::string& strType, SectorCursor& cursor, const std::function<bool(Type&)>& fnValue,
+            const std::function<bool(const Type&)>& fnFilter = nullptr)
+        {
+            return Scan(cursor, strType, [&](DataStream& ssValue)
+            {
+                /* Get the value. */
+                Type value;
+                try
+                {
+                    ssValue >> value;
+                }
+                catch(const std::exception& e)
+                {
+                    debug::error(FUNCTION, "skipping malformed ", strType, " record: ", e.what());
 
-                    /* Read records. */
-                    while(!ssData.End())
-                    {
-                        try
-                        {
-                            /* Get the current stream position. */
-                            uint64_t nPos  = ssData.GetPos();
-
-                            /* Read compact size. */
-                            uint64_t nSize = ReadCompactSize(ssData);
-                            if(nSize == 0) //reached end of current file
-                                break;
-
-                            /* Deserialize the String. */
-                            std::string strThis;
-                            ssData >> strThis;
-
-                            /* Check the type. */
-                            if(strType == strThis)
-                            {
-                                /* Get the value. */
-                                Type value;
-                                ssData >> value;
-
-                                /* Push next value. */
-                                vValues.push_back(value);
-
-                                /* Check limits. */
-                                if(nLimit != -1 && --nLimit == 0)
-                                    return (vValues.size() > 0);
-                            }
-                            else
-                                ssData.SetPos(nPos + nSize + GetSizeOfCompactSize(nSize));
-
-                            /* Iterate to next position. */
-                            nStart += nSize + GetSizeOfCompactSize(nSize);
-                        }
-                        catch(const std::exception& e)
-                        {
-                            /* Allocate a larger buffer if full record exceeds default buffer. */
-                            nBufferSize *= 2;
-
-                            break;
-                        }
-                    }
+                    return true;
                 }
 
-                /* Iterate to the next file. */
-                ++nFile;
+                /* Check the filter. */
+                if(fnFilter && !fnFilter(value))
+                    return true;
 
-                /* Reset the start position. */
-                nStart = 0;
-            }
+                return fnValue(value);
+            });
+        }
 
-            return (vValues.size() > 0);
+
+        /** ForEach
+         *
+         *  Stream the values of a type to a callback from the beginning of the datachain.
+         *
+         *  @param[in] strType The type specifier to read records from
+         *  @param[in] fnValue The callback for each value, returning false to stop the scan.
+         *  @param[in] fnFilter Optional predicate that values must pass to reach the callback.
+         *
+         *  @return True if the callback stopped the scan, false if the end of the datachain was reached.
+         *
+         **/
+        template<typename Type>
+        bool ForEach(const std::string& strType, const std::function<bool(Type&)>& fnValue,
+            const std::function<bool(const Type&)>& fnFilter = nullptr)
+        {
+            SectorCursor cursor;
+            return ForEach<Type>(strType, cursor, fnValue, fnFilter);
         }
 
 
+        /** Scan
+         *
+         *  Stream the records of a type to a callback from the cursor position.
+         *  Records are read in readahead sized chunks, and the callback runs
+         *  outside of the sector lock so it can read from the database. Once the
+         *  posting lists are complete only the blocks holding the type are read.
+         *
+         *  @param[out] cursor The position to read from, left at the next unread record.
+         *  @param[in] strType The type specifier to read records from
+         *  @param[in] fnRecord The callback given the serialized value, returning false to stop the scan.
+         *
+         *  @return True if the callback stopped the scan, false if the end of the datachain was reached.
+         *
+         **/
+        bool Scan(SectorCursor& cursor, const std::string& strType, const std::function<bool(DataStream&)>& fnRecord);
+
+
+        /** ScanFile
+         *
+         *  Stream the records of a sector file from the cursor position to a
+         *  callback, until a record starts at or past the end position.
+         *
+         *  @param[out] cursor The position to read from, left at the next unread record.
+         *  @param[in] nEnd The position to stop at.
+         *  @param[in] strType The type specifier to read records from, or empty for every type.
+         *  @param[in] fnRecord The callback given the type, position, and serialized value, returning false to stop the scan.
+         *
+         *  @return True if the callback stopped the scan, false otherwise.
+         *
+         **/
+        bool ScanFile(SectorCursor& cursor, const uint64_t nEnd, const std::string& strType,
+            const std::function<bool(const std::string&, const uint32_t, DataStream&)>& fnRecord);
+
+
         /** Read
          *
          *  Read a database entry identified by the given key.
@@ -463,7 +644,11 @@ namespace LLD
             /* Get reference of key. */
             std::vector<uint8_t>& vKey = ssKey.Bytes();
 
+            /* Snapshot reads skip the pending transaction and its lock. */
+            const uint64_t nSnapshot = Snapshot::Pinned();
+
             /* Check that the key is not pending in a transaction for Erase. */
+            if(nSnapshot == 0)
             {
                 LOCK(TRANSACTION_MUTEX);
                 if(pTransaction)
@@ -497,8 +682,8 @@ namespace LLD
                 }
             }
 
-            /* Get the data from the database. */
-            if(!Get(vKey, vData))
+            /* Get the data from the versions being committed or the database. */
+            if(!GetVersion(vKey, vData, nSnapshot))
                 return false;
 
             /* Deserialize Value. */
@@ -515,6 +700,36 @@ namespace LLD
         }
 
 
+        /** ReadMany
+         *
+         *  Read a batch of database entries into the cache, so that the reads of
+         *  them that follow are served from memory. Keys are looked up in keychain
+         *  bucket order, and records are read in sector file order with records
+         *  close together coalesced into one read.
+         *
+         *  @param[in] vKeys The keys to the database entries to read.
+         *
+         *  @return The number of entries read into the cache.
+         *
+         **/
+        template<typename Key>
+        uint32_t ReadMany(const std::vector<Key>& vKeys)
+        {
+            /* Serialize the keys into bytes. */
+            std::vector< std::vector<uint8_t> > vKeyBytes;
+            vKeyBytes.reserve(vKeys.size());
+            for(const auto& key : vKeys)
+            {
+                DataStream ssKey(SER_LLD, DATABASE_VERSION);
+                ssKey << key;
+
+                vKeyBytes.push_back(ssKey.Bytes());
+            }
+
+            return Prefetch(vKeyBytes);
+        }
+
+
         /** Index
          *
          *  Indexes a key into memory.
@@ -546,7 +761,7 @@ namespace LLD
                 if(pTransaction)
                 {
                     /* Write to journal in memory. */
-                    pTransaction->ssJournal << std::string("index") << vKey << vIndex;
+                    pTransaction->Journal(JOURNAL::INDEX, vKey, vIndex);
 
                     /* Check for erased data. */
                     pTransaction->setErasedData.erase(vKey);
@@ -558,6 +773,9 @@ namespace LLD
                 }
             }
 
+            /* Hold the sector location steady while the index points at it. */
+            std::unique_lock<std::mutex> lk = CompactLock();
+
             /* Get the key. */
             SectorKey cKey;
             if(!pSectorKeys->Get(vIndex, cKey))
@@ -567,8 +785,10 @@ namespace LLD
             cachePool->Remove(vIndex);
             cachePool->Remove(vKey);
 
-            /* Write the new sector key. */
+            /* Write the new sector key, logging it so the compactor moves the index with the record. */
             cKey.SetKey(vKey);
+            LogKeys(std::vector<SectorKey>(1, cKey));
+
             return pSectorKeys->Put(cKey);
         }
 
@@ -602,7 +822,7 @@ namespace LLD
                 if(pTransaction)
                 {
                     /* Write to journal in memory. */
-                    pTransaction->ssJournal << std::string("key") << vKey;
+                    pTransaction->Journal(JOURNAL::KEY, vKey);
 
                     /* Check if data is in erase queue, if so remove it. */
                     pTransaction->setErasedData.erase(vKey);
@@ -656,7 +876,7 @@ namespace LLD
                 if(pTransaction)
                 {
                     /* Write to journal in memory. */
-                    pTransaction->ssJournal << std::string("write") << vKey << vData;
+                    pTransaction->Journal(JOURNAL::WRITE, vKey, vData);
 
                     /* Check if data is in erase queue, if so remove it. */
                     pTransaction->setErasedData.erase(vKey);
@@ -699,17 +919,142 @@ namespace LLD
         bool Get(const SectorKey& cKey, std::vector<uint8_t>& vData);
 
 
+        /** Prefetch
+         *
+         *  Read a batch of records from disk into the cache. Records that are
+         *  cached, pending in a transaction, or held in a commit version are skipped.
+         *
+         *  @param[in] vKeys The binary data of the keys to read.
+         *
+         *  @return The number of records read into the cache.
+         *
+         **/
+        uint32_t Prefetch(const std::vector< std::vector<uint8_t> >& vKeys);
+
+
+        /** GetVersion
+         *
+         *  Get a record as of a commit epoch, from the versions kept in memory
+         *  or from disk. Takes no transaction lock.
+         *
+         *  @param[in] vKey The binary data of the key to get.
+         *  @param[out] vData The binary data of the record to get.
+         *  @param[in] nEpoch The pinned epoch, or zero for the newest versions.
+         *  @param[in] fData Flag to read the record, false to only check that the key exists.
+         *
+         *  @return True if the key exists at the epoch.
+         *
+         **/
+        bool GetVersion(const std::vector<uint8_t>& vKey, std::vector<uint8_t>& vData,
+                        const uint64_t nEpoch, const bool fData = true);
+
+
+        /** ReadVersion
+         *
+         *  Get a record as of a commit epoch from one load of the version list,
+         *  falling back to disk. A commit that applies between the two can leave
+         *  a value newer than the epoch, which GetVersion checks for.
+         *
+         *  @param[in] pList The version list to read from.
+         *  @param[in] vKey The binary data of the key to get.
+         *  @param[out] vData The binary data of the record to get.
+         *  @param[in] nEpoch The pinned epoch, or zero for the newest versions.
+         *  @param[in] fData Flag to read the record, false to only check that the key exists.
+         *
+         *  @return True if the key exists at the epoch.
+         *
+         **/
+        bool ReadVersion(const std::shared_ptr< const std::vector< std::shared_ptr<SectorVersion> > >& pList,
+                         const std::vector<uint8_t>& vKey, std::vector<uint8_t>& vData,
+                         const uint64_t nEpoch, const bool fData = true);
+
+
+        /** NewerVersions
+         *
+         *  Get the versions newer than a pinned epoch with their prior values,
+         *  so a read can tell if a commit was published or applied under it.
+         *
+         *  @param[in] pList The version list to check.
+         *  @param[in] nEpoch The pinned epoch.
+         *
+         *  @return The versions newer than the epoch, paired with their prior values if stored.
+         *
+         **/
+        std::vector< std::pair<const SectorVersion*, const SectorPrior*> >
+        NewerVersions(const std::shared_ptr< const std::vector< std::shared_ptr<SectorVersion> > >& pList, const uint64_t nEpoch);
+
+
+        /** CollectVersions
+         *
+         *  Drop the versions that are on disk and older than every pinned snapshot.
+         *
+         *  @param[in] fFailed Flag to also drop the version of a commit that never applied.
+         *
+         **/
+        void CollectVersions(const bool fFailed = false);
+
+
+        /** GetMapped
+         *
+         *  Get a record from the memory mapped sector file without
+         *  taking the sector lock. Only available with FLAGS::MMAP.
+         *
+         *  @param[in] cKey The sector key from keychain.
+         *  @param[out] vData The binary data of the record to get.
+         *
+         *  @return True if the record was read from the memory map.
+         *
+         **/
+        bool GetMapped(const SectorKey& cKey, std::vector<uint8_t>& vData);
+
+
+        /** WaitMapReaders
+         *
+         *  Wait for the readers that could still hold a memory map taken
+         *  out of the map slots, so it can be deleted.
+         *
+         **/
+        void WaitMapReaders();
+
+
+        /** CompactLock
+         *
+         *  Lock the compact mutex for a write, only held if compaction is
+         *  enabled since it only keeps the compactor from moving records.
+         *
+         *  @return The lock, which owns no mutex with compaction disabled.
+         *
+         **/
+        std::unique_lock<std::mutex> CompactLock();
+
+
         /** Update
          *
          *  Update a record on disk.
          *
          *  @param[in] vKey The binary data of the key to flush
          *  @param[in] vData The binary data of the record to flush
+         *  @param[in] fFlush Flag to flush the file stream after writing.
          *
          *  @return True if the flush was successful.
          *
          **/
-        bool Update(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData);
+        bool Update(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, const bool fFlush = true);
+
+
+        /** UpdateSector
+         *
+         *  Update a record on disk in place, with the compactor lock held.
+         *
+         *  @param[in] vKey The binary data of the key.
+         *  @param[in] vData The binary data of the record.
+         *  @param[out] cKey The current sector key, empty if the key is not in the keychain.
+         *  @param[in] fFlush Flush the sector file after the write.
+         *
+         *  @return False if the key is new or the record changed size.
+         *
+         **/
+        bool UpdateSector(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, SectorKey& cKey, const bool fFlush);
 
 
         /** Force
@@ -725,6 +1070,21 @@ namespace LLD
         bool Force(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData);
 
 
+        /** WriteBatch
+         *
+         *  Write a batch of records to disk with a single append and flush.
+         *  New records are serialized into one contiguous buffer per sector
+         *  file, and their keys are written to the keychain in one batch.
+         *  Only the last record of a key written more than once is kept.
+         *
+         *  @param[in] vBatch The keys and records to write.
+         *
+         *  @return True if the batch was written successfully.
+         *
+         **/
+        bool WriteBatch(const std::vector< std::pair<std::vector<uint8_t>, std::vector<uint8_t>> >& vBatch);
+
+
         /** Put
          *
          *  Write a record into the cache and disk buffer for flushing to disk.
@@ -751,6 +1111,30 @@ namespace LLD
         bool Delete(const std::vector<uint8_t>& vKey);
 
 
+        /** EraseSector
+         *
+         *  Erase a key from the keychain, counting its record as dead bytes.
+         *
+         *  @param[in] vKey The binary data of the key.
+         *
+         *  @return True if the key was erased.
+         *
+         **/
+        bool EraseSector(const std::vector<uint8_t>& vKey);
+
+
+        /** LogKeys
+         *
+         *  Append the keys to the key logs of their sector files. The key
+         *  logs let the compactor find which keys reference each record,
+         *  since sector files only hold the record data.
+         *
+         *  @param[in] vKeys The sector keys to log.
+         *
+         **/
+        void LogKeys(const std::vector<SectorKey>& vKeys);
+
+
         /** CacheWriter
          *
          *  Flushes periodically data from the cache buffer to disk.
@@ -767,6 +1151,146 @@ namespace LLD
         void Meter();
 
 
+        /** Compactor
+         *
+         *  Compactor Thread. Rewrites the live records of sector files
+         *  that are mostly dead bytes, and truncates the old files.
+         *
+         **/
+        void Compactor();
+
+
+        /** CompactFile
+         *
+         *  Move the live records of a sector file to the end of the current
+         *  sector file, pointing their keys at the new location.
+         *
+         *  @param[in] nFile The sector file to compact.
+         *
+         *  @return True if every live record was moved and the file retired.
+         *
+         **/
+        bool CompactFile(const uint32_t nFile);
+
+
+        /** MoveRecords
+         *
+         *  Move the records a run of key log entries reference, skipping
+         *  keys that no longer point into the sector file.
+         *
+         *  @param[in] nFile The sector file being compacted.
+         *  @param[in] stream The stream of the sector file.
+         *  @param[in] vEntries The key log entries as position and key.
+         *  @param[out] mapMoved The new location of each moved position.
+         *
+         *  @return The bytes that were copied, or -1 on failure.
+         *
+         **/
+        int64_t MoveRecords(const uint32_t nFile, std::ifstream& stream,
+                            const std::vector< std::pair<uint32_t, std::vector<uint8_t>> >& vEntries,
+                            std::map<uint32_t, SectorKey>& mapMoved);
+
+
+        /** RetireFiles
+         *
+         *  Truncate the sector files compacted on the last pass.
+         *
+         **/
+        void RetireFiles();
+
+
+        /** ReadLiveness
+         *
+         *  Read the dead byte counts and retired files from disk.
+         *
+         **/
+        void ReadLiveness();
+
+
+        /** WriteLiveness
+         *
+         *  Write the dead byte counts and retired files to disk.
+         *
+         **/
+        void WriteLiveness();
+
+
+        /** PostRecord
+         *
+         *  Add the block of a written record to the posting list of its type.
+         *
+         *  @param[in] vData The raw record, starting with its type.
+         *  @param[in] nFile The sector file of the record.
+         *  @param[in] nStart The binary position of the record.
+         *
+         **/
+        void PostRecord(const std::vector<uint8_t>& vData, const uint32_t nFile, const uint32_t nStart);
+
+
+        /** AddPosting
+         *
+         *  Add a record position to the posting list of a type, with the posting lock held.
+         *
+         *  @param[in] strType The type of the record.
+         *  @param[in] nFile The sector file of the record.
+         *  @param[in] nStart The binary position of the record.
+         *
+         **/
+        void AddPosting(const std::string& strType, const uint32_t nFile, const uint32_t nStart);
+
+
+        /** ReadPostings
+         *
+         *  Read the posting lists from disk, catching up on records written
+         *  after the last entry, or start a rebuild if they are missing.
+         *
+         **/
+        void ReadPostings();
+
+
+        /** WritePostings
+         *
+         *  Write all posting lists to disk and open the append stream, with the posting lock held.
+         *
+         *  @return True if the posting lists were written.
+         *
+         **/
+        bool WritePostings();
+
+
+        /** BuildPostings
+         *
+         *  Posting Thread. Rebuilds the posting lists from every record in the datachain.
+         *
+         **/
+        void BuildPostings();
+
+
+        /** IndexRecords
+         *
+         *  Add every record from the cursor to the end of the datachain to the posting lists.
+         *
+         *  @param[out] cursor The position to start from, left at the end of the datachain.
+         *
+         *  @return True if the end was reached, false if interrupted by shutdown.
+         *
+         **/
+        bool IndexRecords(SectorCursor& cursor);
+
+
+        /** Sync
+         *
+         *  Sync the sector files and keychain written since the last sync, so
+         *  the shared journal can be cleared. Skipped under the 'none' sync policy.
+         *
+         *  @param[in] fForce Sync even under the 'none' policy.
+         *
+         *  @return True if the files were synced.
+         *
+         **/
+        bool Sync(const bool fForce = false);
+
+
         /** TxnBegin
          *
          *  Start a database transaction.
@@ -777,10 +1301,37 @@ namespace LLD
 
         /** TxnCheckpoint
          *
-         *  Write the transaction commitment message.
+         *  Encode the transaction records into a shared journal, tagged with
+         *  this database's name. The caller writes the commit record.
+         *
+         *  @param[out] ssJournal The shared journal buffer.
+         *
+         *  @return True if there was a transaction to encode.
+         *
+         **/
+        bool TxnCheckpoint(DataStream& ssJournal);
+
+
+        /** TxnPublish
+         *
+         *  Move the transaction into a version for the reserved epoch, so reads
+         *  find it in memory while the commit writes it to disk.
+         *
+         *  @param[in] nEpoch The epoch reserved for the commit.
+         *
+         *  @return True if there was a transaction to publish.
+         *
+         **/
+        bool TxnPublish(const uint64_t nEpoch);
+
+
+        /** TxnPriors
+         *
+         *  Capture the values the published version replaces, for snapshots
+         *  pinned at older epochs. Must run before the commit writes to disk.
          *
          **/
-        bool TxnCheckpoint();
+        void TxnPriors();
 
 
         /** TxnRelease
@@ -801,12 +1352,24 @@ namespace LLD
         bool TxnCommit();
 
 
-        /** TxnRecovery
+        /** TxnRecord
+         *
+         *  Apply a replayed journal record to the current transaction.
+         *
+         *  @param[in] nOpcode The record opcode from JOURNAL enum.
+         *  @param[in] vKey The binary data of the key.
+         *  @param[in] vData The binary data of the record.
+         *
+         **/
+        void TxnRecord(const uint8_t nOpcode, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData);
+
+
+        /** GetName
          *
-         *  Recover a transaction from the journal.
+         *  Get the name of this database.
          *
          **/
-        bool TxnRecovery();
+        const std::string& GetName() const;
 
     };
 }
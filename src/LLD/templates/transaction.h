@@ -19,8 +19,11 @@ ________________________________________________________________________________
 
 #include <Util/templates/datastream.h>
 
+#include <atomic>
 #include <cstdint>
 #include <map>
+#include <memory>
+#include <set>
 #include <vector>
 
 namespace LLD
@@ -97,6 +100,78 @@ namespace LLD
          *
          **/
         bool EraseTransaction(const std::vector<uint8_t> &vKey);
+
+
+        /** Journal
+         *
+         *  Encode a write ahead log record into the journal in memory.
+         *
+         *  @param[in] nOpcode The record opcode from JOURNAL enum.
+         *  @param[in] vKey The key in binary.
+         *  @param[in] vData The data in binary, if any.
+         *
+         **/
+        void Journal(const uint8_t nOpcode, const std::vector<uint8_t>& vKey = std::vector<uint8_t>(),
+                     const std::vector<uint8_t>& vData = std::vector<uint8_t>());
+    };
+
+
+    /** SectorPrior
+     *
+     *  The values a commit replaces, captured before it writes to disk so that
+     *  snapshots pinned at older epochs can still read them.
+     *
+     **/
+    struct SectorPrior
+    {
+        /** The replaced records by key, with a flag if the key existed. **/
+        std::map< std::vector<uint8_t>, std::pair<bool, std::vector<uint8_t>> > mapKeys;
+
+        /** The keys of the replaced records by sector file and start, for index keys that share the sector. **/
+        std::map< std::pair<uint32_t, uint32_t>, std::vector<uint8_t> > mapSectors;
+    };
+
+
+    /** SectorVersion
+     *
+     *  The changes of one committed transaction, kept in memory from when its
+     *  epoch is published until no snapshot can read an older epoch.
+     *
+     **/
+    struct SectorVersion
+    {
+        /** The commit epoch. **/
+        const uint64_t nEpoch;
+
+        /** New data by key. **/
+        std::map< std::vector<uint8_t>, std::vector<uint8_t> > mapData;
+
+        /** Keychain items. **/
+        std::set< std::vector<uint8_t> > setKeychain;
+
+        /** Index items. **/
+        std::map< std::vector<uint8_t>, std::vector<uint8_t> > mapIndex;
+
+        /** Erased keys. **/
+        std::set< std::vector<uint8_t> > setErased;
+
+        /** The replaced values, set with atomic stores if older snapshots are pinned. **/
+        std::shared_ptr<const SectorPrior> pPrior;
+
+        /** Flag that the changes are written to disk. **/
+        std::atomic<bool> fApplied;
+
+        /** Epoch Constructor. **/
+        SectorVersion(const uint64_t nEpochIn)
+        : nEpoch      (nEpochIn)
+        , mapData     ( )
+        , setKeychain ( )
+        , mapIndex    ( )
+        , setErased   ( )
+        , pPrior      ( )
+        , fApplied    (false)
+        {
+        }
     };
 }
 
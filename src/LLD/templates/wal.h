@@ -0,0 +1,211 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_WAL_H
+#define NEXUS_LLD_TEMPLATES_WAL_H
+
+#include <LLD/templates/randomfile.h>
+
+#include <Util/templates/datastream.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace LLD
+{
+
+    /** WriteAheadLog
+     *
+     *  Append only journal of binary records for recovering transactions.
+     *
+     *  Each record is framed as opcode (1 byte), payload length (4 bytes),
+     *  payload, and an xxh3 checksum (8 bytes) of everything before it. A
+     *  torn or corrupted record fails its checksum and ends the replay.
+     *
+     *  Syncing follows the -lldsync policy: 'always' syncs every append,
+     *  'interval' syncs at most once per -lldsyncinterval milliseconds, and
+     *  'none' leaves it to the operating system. Appends that land inside an
+     *  interval mark the log dirty, and a flusher thread syncs them once the
+     *  interval ends. Appends that have to be durable before they are applied
+     *  can ask to be synced straight away.
+     *
+     **/
+    class WriteAheadLog
+    {
+        /** Mutex for the log file. **/
+        std::mutex WAL_MUTEX;
+
+
+        /** The condition to wake the flusher thread. **/
+        std::condition_variable FLUSH_CONDITION;
+
+
+        /** The log file. **/
+        RandomAccessFile* pfile;
+
+
+        /** The binary position to append the next record. **/
+        uint64_t nSize;
+
+
+        /** The sync policy from SYNC enum. **/
+        uint8_t nSyncPolicy;
+
+
+        /** The milliseconds between syncs for the interval policy. **/
+        uint64_t nSyncInterval;
+
+
+        /** The timestamp of the last sync in milliseconds. **/
+        uint64_t nLastSync;
+
+
+        /** Flag for appends that haven't been synced yet. **/
+        bool fDirty;
+
+
+        /** Flag to stop the flusher thread. **/
+        std::atomic<bool> fShutdown;
+
+
+        /** The thread that syncs dirty appends at the end of an interval. **/
+        std::thread FlushThread;
+
+
+    public:
+
+        /** The size of the record header and checksum. **/
+        static const uint32_t RECORD_OVERHEAD = 13;
+
+
+        /** Default Constructor. **/
+        WriteAheadLog()                                      = delete;
+
+
+        /** Copy Constructor. **/
+        WriteAheadLog(const WriteAheadLog& log)              = delete;
+
+
+        /** Move Constructor. **/
+        WriteAheadLog(WriteAheadLog&& log)                   = delete;
+
+
+        /** Copy assignment. **/
+        WriteAheadLog& operator=(const WriteAheadLog& log)   = delete;
+
+
+        /** Move assignment. **/
+        WriteAheadLog& operator=(WriteAheadLog&& log)        = delete;
+
+
+        /** File Constructor
+         *
+         *  @param[in] strFile The path of the log file.
+         *
+         **/
+        WriteAheadLog(const std::string& strFile);
+
+
+        /** Default Destructor. **/
+        ~WriteAheadLog();
+
+
+        /** Encode
+         *
+         *  Encode a record onto the end of a journal buffer.
+         *
+         *  @param[out] ssJournal The buffer to encode into.
+         *  @param[in] nOpcode The record opcode from JOURNAL enum.
+         *  @param[in] vKey The binary data of the key.
+         *  @param[in] vData The binary data of the record, if any.
+         *
+         **/
+        static void Encode(DataStream& ssJournal, const uint8_t nOpcode,
+                           const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData);
+
+
+        /** Append
+         *
+         *  Append encoded records to the log, syncing according to policy.
+         *  A failed append leaves the log as it was.
+         *
+         *  @param[in] vBytes The encoded records.
+         *  @param[in] fSync Sync before returning under the interval policy too,
+         *                   for records that must be on disk before they are applied.
+         *
+         *  @return True if the records were written.
+         *
+         **/
+        bool Append(const std::vector<uint8_t>& vBytes, const bool fSync = false);
+
+
+        /** Truncate
+         *
+         *  Clear all records from the log.
+         *
+         *  @return True if the log was cleared.
+         *
+         **/
+        bool Truncate();
+
+
+        /** Size
+         *
+         *  Get the current size of the log in bytes.
+         *
+         **/
+        uint64_t Size();
+
+
+        /** Replay
+         *
+         *  Read the records one at a time from the start of the log.
+         *
+         *  @param[in] fnRecord Called with the opcode, key, and data of each
+         *                      record. Return false to stop the replay.
+         *
+         *  @return False if a record was torn or failed its checksum.
+         *
+         **/
+        bool Replay(const std::function<bool(const uint8_t, const std::vector<uint8_t>&, const std::vector<uint8_t>&)>& fnRecord);
+
+
+    private:
+
+        /** Sync
+         *
+         *  Sync the log to disk according to the sync policy.
+         *
+         *  @param[in] fForce Sync now instead of at the end of the interval.
+         *
+         **/
+        bool sync(const bool fForce);
+
+
+        /** Flusher
+         *
+         *  Sync appends left dirty by the interval policy once their interval ends.
+         *
+         **/
+        void Flusher();
+    };
+}
+
+#endif
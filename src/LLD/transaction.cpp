@@ -12,6 +12,7 @@
 ____________________________________________________________________________________________*/
 
 #include <LLD/templates/transaction.h>
+#include <LLD/templates/wal.h>
 #include <LLD/include/version.h>
 
 namespace LLD
@@ -55,4 +56,11 @@ namespace LLD
         return true;
     }
 
+
+    /*  Encode a write ahead log record into the journal in memory. */
+    void SectorTransaction::Journal(const uint8_t nOpcode, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData)
+    {
+        WriteAheadLog::Encode(ssJournal, nOpcode, vKey, vData);
+    }
+
 }
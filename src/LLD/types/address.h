@@ -17,7 +17,7 @@ ________________________________________________________________________________
 
 #include <LLD/templates/sector.h>
 #include <LLD/cache/binary_lru.h>
-#include <LLD/keychain/hashmap.h>
+#include <LLD/keychain/keychain.h>
 
 #include <LLP/include/trust_address.h>
 
@@ -29,7 +29,7 @@ namespace LLD
      *  The database class for peer addresses to determine trust relationships.
      *
      **/
-    class AddressDB : public SectorDatabase<BinaryHashMap, BinaryLRU>
+    class AddressDB : public SectorDatabase<Keychain, BinaryLRU>
     {
     public:
 
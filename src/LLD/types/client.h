@@ -19,7 +19,7 @@ ________________________________________________________________________________
 
 #include <LLD/templates/sector.h>
 #include <LLD/cache/binary_lru.h>
-#include <LLD/keychain/hashmap.h>
+#include <LLD/keychain/keychain.h>
 
 #include <TAO/Ledger/include/enum.h>
 
@@ -45,7 +45,7 @@ namespace LLD
    *  Database class for storing local wallet transactions.
    *
    **/
-    class ClientDB : public SectorDatabase<BinaryHashMap, BinaryLRU>
+    class ClientDB : public SectorDatabase<Keychain, BinaryLRU>
     {
     public:
 
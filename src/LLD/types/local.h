@@ -19,7 +19,7 @@ ________________________________________________________________________________
 
 #include <LLD/templates/sector.h>
 #include <LLD/cache/binary_lru.h>
-#include <LLD/keychain/hashmap.h>
+#include <LLD/keychain/keychain.h>
 
 #include <TAO/Ledger/include/stake_change.h>
 
@@ -42,7 +42,7 @@ namespace LLD
    *  Database class for storing local wallet transactions.
    *
    **/
-    class LocalDB : public SectorDatabase<BinaryHashMap, BinaryLRU>
+    class LocalDB : public SectorDatabase<Keychain, BinaryLRU>
     {
 
     public:
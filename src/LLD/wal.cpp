@@ -0,0 +1,267 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/wal.h>
+#include <LLD/include/enum.h>
+#include <LLD/include/version.h>
+#include <LLD/hash/xxh3.h>
+
+#include <Util/include/args.h>
+#include <Util/include/mutex.h>
+#include <Util/include/debug.h>
+#include <Util/include/runtime.h>
+
+namespace LLD
+{
+
+    /* File Constructor. */
+    WriteAheadLog::WriteAheadLog(const std::string& strFile)
+    : WAL_MUTEX     ( )
+    , pfile         (new RandomAccessFile(strFile, true))
+    , nSize         (pfile->Size())
+    , nSyncPolicy   (SYNC::INTERVAL)
+    , nSyncInterval (config::GetArg("-lldsyncinterval", 1000))
+    , nLastSync     (runtime::timestamp(true))
+    , fDirty        (false)
+    , fShutdown     (false)
+    , FlushThread   ( )
+    {
+        /* Get the sync policy. */
+        const std::string strPolicy = config::GetArg("-lldsync", "interval");
+        if(strPolicy == "always")
+            nSyncPolicy = SYNC::ALWAYS;
+        else if(strPolicy == "none")
+            nSyncPolicy = SYNC::NONE;
+
+        /* Appends grouped by the interval policy are synced by the flusher. */
+        if(nSyncPolicy == SYNC::INTERVAL)
+            FlushThread = std::thread(std::bind(&WriteAheadLog::Flusher, this));
+    }
+
+
+    /* Default Destructor. */
+    WriteAheadLog::~WriteAheadLog()
+    {
+        /* Stop the flusher thread. */
+        fShutdown.store(true);
+        {
+            LOCK(WAL_MUTEX);
+            FLUSH_CONDITION.notify_all();
+        }
+
+        if(FlushThread.joinable())
+            FlushThread.join();
+
+        if(pfile)
+        {
+            pfile->Sync();
+            delete pfile;
+        }
+    }
+
+
+    /* Encode a record onto the end of a journal buffer. */
+    void WriteAheadLog::Encode(DataStream& ssJournal, const uint8_t nOpcode,
+                               const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData)
+    {
+        /* Serialize the payload. */
+        DataStream ssPayload(SER_LLD, DATABASE_VERSION);
+        ssPayload << vKey << vData;
+
+        /* Build the record header. */
+        const uint32_t nLength = static_cast<uint32_t>(ssPayload.size());
+        std::vector<uint8_t> vRecord(5 + nLength + 8, 0);
+        vRecord[0] = nOpcode;
+        std::copy((uint8_t*)&nLength, (uint8_t*)&nLength + 4, &vRecord[1]);
+
+        /* Copy in the payload. */
+        std::copy(ssPayload.Bytes().begin(), ssPayload.Bytes().end(), vRecord.begin() + 5);
+
+        /* Checksum the header and payload. */
+        const uint64_t nChecksum = XXH3_64bits(&vRecord[0], 5 + nLength);
+        std::copy((uint8_t*)&nChecksum, (uint8_t*)&nChecksum + 8, &vRecord[5 + nLength]);
+
+        ssJournal.write((char*)&vRecord[0], vRecord.size());
+    }
+
+
+    /* Append encoded records to the log, syncing according to policy. */
+    bool WriteAheadLog::Append(const std::vector<uint8_t>& vBytes, const bool fSync)
+    {
+        LOCK(WAL_MUTEX);
+
+        /* Write the records at the end of the log, dropping any part that made it to the file on failure. */
+        const uint64_t nPrev = nSize;
+        if(!pfile->Write(nSize, vBytes))
+        {
+            pfile->Truncate(nPrev);
+            return debug::error(FUNCTION, "failed to append ", vBytes.size(), " bytes to journal");
+        }
+
+        nSize += vBytes.size();
+
+        /* Records that can't be synced are dropped too, so a failed append leaves the log as it was. */
+        if(!sync(fSync))
+        {
+            pfile->Truncate(nPrev);
+            nSize = nPrev;
+
+            return false;
+        }
+
+        return true;
+    }
+
+
+    /* Clear all records from the log. */
+    bool WriteAheadLog::Truncate()
+    {
+        LOCK(WAL_MUTEX);
+
+        /* Skip the system call if there is nothing to clear. */
+        if(nSize == 0)
+            return true;
+
+        if(!pfile->Truncate(0))
+            return debug::error(FUNCTION, "failed to truncate journal");
+
+        nSize = 0;
+        fDirty = false;
+
+        return true;
+    }
+
+
+    /* Get the current size of the log in bytes. */
+    uint64_t WriteAheadLog::Size()
+    {
+        LOCK(WAL_MUTEX);
+
+        return nSize;
+    }
+
+
+    /* Read the records one at a time from the start of the log. */
+    bool WriteAheadLog::Replay(const std::function<bool(const uint8_t, const std::vector<uint8_t>&, const std::vector<uint8_t>&)>& fnRecord)
+    {
+        LOCK(WAL_MUTEX);
+
+        uint64_t nPos = 0;
+        while(nPos < nSize)
+        {
+            /* Check there is room for a full record. */
+            if(nSize - nPos < RECORD_OVERHEAD)
+                return debug::error(FUNCTION, "torn record header at ", nPos);
+
+            /* Read the record header. */
+            std::vector<uint8_t> vHeader(5, 0);
+            if(!pfile->Read(nPos, vHeader))
+                return debug::error(FUNCTION, "failed to read record header at ", nPos);
+
+            /* Check the payload fits in the log. */
+            uint32_t nLength = 0;
+            std::copy(&vHeader[1], &vHeader[1] + 4, (uint8_t*)&nLength);
+            if(nLength > nSize - nPos - RECORD_OVERHEAD)
+                return debug::error(FUNCTION, "torn record of ", nLength, " bytes at ", nPos);
+
+            /* Read the rest of the record. */
+            std::vector<uint8_t> vRecord(5 + nLength + 8, 0);
+            if(!pfile->Read(nPos, vRecord))
+                return debug::error(FUNCTION, "failed to read record at ", nPos);
+
+            /* Verify the checksum. */
+            uint64_t nChecksum = 0;
+            std::copy(&vRecord[5 + nLength], &vRecord[5 + nLength] + 8, (uint8_t*)&nChecksum);
+            if(nChecksum != XXH3_64bits(&vRecord[0], 5 + nLength))
+                return debug::error(FUNCTION, "record checksum mismatch at ", nPos);
+
+            /* Deserialize the payload. */
+            std::vector<uint8_t> vKey, vData;
+            try
+            {
+                const DataStream ssPayload(std::vector<uint8_t>(vRecord.begin() + 5, vRecord.begin() + 5 + nLength), SER_LLD, DATABASE_VERSION);
+                ssPayload >> vKey >> vData;
+            }
+            catch(const std::exception& e)
+            {
+                return debug::error(FUNCTION, "malformed record at ", nPos, ": ", e.what());
+            }
+
+            /* Hand the record to the caller. */
+            nPos += vRecord.size();
+            if(!fnRecord(vRecord[0], vKey, vData))
+                break;
+        }
+
+        return true;
+    }
+
+
+    /* Sync the log to disk according to the sync policy. */
+    bool WriteAheadLog::sync(const bool fForce)
+    {
+        /* Check the sync policy. */
+        if(nSyncPolicy == SYNC::NONE)
+            return true;
+
+        /* Group appends inside the interval into a single sync, leaving the flusher to sync them. */
+        const uint64_t nNow = runtime::timestamp(true);
+        if(nSyncPolicy == SYNC::INTERVAL && !fForce && nNow - nLastSync < nSyncInterval)
+        {
+            if(!fDirty)
+            {
+                fDirty = true;
+                FLUSH_CONDITION.notify_one();
+            }
+
+            return true;
+        }
+
+        nLastSync = nNow;
+        fDirty = false;
+        if(!pfile->Sync())
+            return debug::error(FUNCTION, "failed to sync journal");
+
+        return true;
+    }
+
+
+    /* Sync appends left dirty by the interval policy once their interval ends. */
+    void WriteAheadLog::Flusher()
+    {
+        std::unique_lock<std::mutex> FLUSH_LOCK(WAL_MUTEX);
+        while(!fShutdown.load())
+        {
+            /* Sleep until an append is left dirty. */
+            if(!fDirty)
+            {
+                FLUSH_CONDITION.wait(FLUSH_LOCK, [this]{ return fShutdown.load() || fDirty; });
+                continue;
+            }
+
+            /* Sleep out the rest of the interval, the next append may sync it first. */
+            const uint64_t nNow = runtime::timestamp(true);
+            if(nNow - nLastSync < nSyncInterval)
+            {
+                FLUSH_CONDITION.wait_for(FLUSH_LOCK, std::chrono::milliseconds(nSyncInterval - (nNow - nLastSync)));
+                continue;
+            }
+
+            /* Sync the trailing appends. */
+            nLastSync = nNow;
+            fDirty = false;
+            if(!pfile->Sync())
+                debug::error(FUNCTION, "failed to sync journal");
+        }
+    }
+}
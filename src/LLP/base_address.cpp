@@ -377,7 +377,7 @@ namespace LLP
     /* Gets a 64-bit hash of the IP. */
     uint64_t BaseAddress::GetHash() const
     {
-        return LLC::SK64(&ip[0], &ip[16]);
+        return LLC::SK64(&ip[0], &ip[16], true);
     }
 
 
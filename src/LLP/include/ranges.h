@@ -0,0 +1,244 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLP_INCLUDE_RANGES_H
+#define NEXUS_LLP_INCLUDE_RANGES_H
+
+#include <LLC/types/uint1024.h>
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace LLP
+{
+
+    /** SyncRange
+     *
+     *  A range of blocks cut from the headers of a headers sync.
+     *
+     **/
+    struct SyncRange
+    {
+        /** The block the range follows. **/
+        uint1024_t hashStart;
+
+
+        /** The last block of the range. **/
+        uint1024_t hashStop;
+
+
+        /** The height of the last block of the range. **/
+        uint32_t nHeight;
+
+
+        /** The number of blocks in the range. **/
+        uint32_t nBlocks;
+
+
+        /** The session the range is assigned to, or 0 if it is not assigned. **/
+        uint64_t nSession;
+
+
+        /** Flag to request the range by locator, for the first range after the best chain. **/
+        bool fLocator;
+
+
+        /** Default Constructor. **/
+        SyncRange();
+    };
+
+
+    /** SyncRanges
+     *
+     *  Tracks the ranges of a headers sync, so that each range is requested from
+     *  one node at a time, and only again if that node goes away or falls behind.
+     *
+     *  The headers are cut into ranges from the tail, the last header the ranges
+     *  have been cut up to, and the next headers are requested from the tail.
+     *
+     **/
+    class SyncRanges
+    {
+        /** Mutex for the ranges. **/
+        mutable std::mutex MUTEX;
+
+
+        /** The ranges that have not arrived, ordered by height. **/
+        std::deque<SyncRange> queueRanges;
+
+
+        /** The last header that ranges have been cut up to. **/
+        uint1024_t hashTail;
+
+
+        /** The height of the tail. **/
+        uint32_t nTailHeight;
+
+
+        /** Flag to request the first range by locator. **/
+        bool fLocator;
+
+
+        /** Flag for a headers request that has not been answered. **/
+        bool fRequested;
+
+
+    public:
+
+        /** Default Constructor. **/
+        SyncRanges();
+
+
+        /** Reset
+         *
+         *  Drop all ranges, and anchor the next headers at the given block.
+         *
+         *  @param[in] hashAnchor The block the next headers follow.
+         *  @param[in] nHeight The height of the anchor block.
+         *  @param[in] fLocatorIn True if the next headers are requested by locator.
+         *
+         **/
+        void Reset(const uint1024_t& hashAnchor = 0, const uint32_t nHeight = 0, const bool fLocatorIn = false);
+
+
+        /** Request
+         *
+         *  Mark a headers request as sent, and get the block it follows.
+         *
+         *  @param[out] hashStart The block the headers are requested from.
+         *  @param[out] fLocatorOut True if the headers are requested by locator.
+         *
+         *  @return false if a headers request is already waiting for an answer.
+         *
+         **/
+        bool Request(uint1024_t &hashStart, bool &fLocatorOut);
+
+
+        /** Add
+         *
+         *  Cut the answer to a headers request into ranges after the tail.
+         *
+         *  @param[in] vHeaders The block hashes that follow the tail.
+         *  @param[in] nRange The number of blocks in each range.
+         *
+         *  @return The number of ranges added, 0 if the headers were not requested.
+         *
+         **/
+        uint32_t Add(const std::vector<uint1024_t>& vHeaders, const uint32_t nRange);
+
+
+        /** Assign
+         *
+         *  Assign the lowest range that is not assigned and that a node has all of.
+         *
+         *  @param[in] nSession The session of the node to assign to.
+         *  @param[in] nHeight The best height of the node.
+         *  @param[out] range The range assigned.
+         *
+         *  @return true if a range was assigned.
+         *
+         **/
+        bool Assign(const uint64_t nSession, const uint32_t nHeight, SyncRange &range);
+
+
+        /** Reassign
+         *
+         *  Take over the lowest range assigned to another node, for when the ranges
+         *  ahead of the best chain have stalled behind it.
+         *
+         *  @param[in] nSession The session of the node to assign to.
+         *  @param[in] nHeight The best height of the node.
+         *  @param[out] range The range assigned.
+         *
+         *  @return true if a range was assigned.
+         *
+         **/
+        bool Reassign(const uint64_t nSession, const uint32_t nHeight, SyncRange &range);
+
+
+        /** Find
+         *
+         *  Get the lowest range assigned to a node.
+         *
+         *  @param[in] nSession The session of the node.
+         *  @param[out] range The range found.
+         *
+         *  @return true if the node has a range assigned.
+         *
+         **/
+        bool Find(const uint64_t nSession, SyncRange &range) const;
+
+
+        /** Received
+         *
+         *  Mark the range that a block ends as arrived.
+         *
+         *  @param[in] hashBlock The hash of the block received.
+         *
+         *  @return true if the block was the last block of a range.
+         *
+         **/
+        bool Received(const uint1024_t& hashBlock);
+
+
+        /** Release
+         *
+         *  Return the ranges assigned to a node, so they are assigned again.
+         *
+         *  @param[in] nSession The session of the node.
+         *
+         *  @return The number of ranges returned.
+         *
+         **/
+        uint32_t Release(const uint64_t nSession);
+
+
+        /** Assigned
+         *
+         *  Get the number of ranges assigned to a node.
+         *
+         *  @param[in] nSession The session of the node.
+         *
+         **/
+        uint32_t Assigned(const uint64_t nSession) const;
+
+
+        /** Pending
+         *
+         *  Get the number of ranges that are not assigned.
+         *
+         **/
+        uint32_t Pending() const;
+
+
+        /** Size
+         *
+         *  Get the number of ranges that have not arrived.
+         *
+         **/
+        uint32_t Size() const;
+
+
+        /** TailHeight
+         *
+         *  Get the height of the last header that ranges have been cut up to.
+         *
+         **/
+        uint32_t TailHeight() const;
+    };
+}
+
+#endif
@@ -23,7 +23,7 @@ namespace LLP
     /* The current Protocol Version. */
     #define PROTOCOL_MAJOR       3
     #define PROTOCOL_MINOR       0
-    #define PROTOCOL_REVISION    0
+    #define PROTOCOL_REVISION    1
     #define PROTOCOL_BUILD       0
 
 
@@ -44,6 +44,10 @@ namespace LLP
     const uint32_t MIN_TRITIUM_VERSION = 3000000;
 
 
+    /* Used to define the baseline of nodes that send block headers for multi-node sync. */
+    const uint32_t MIN_HEADERS_VERSION = 3000100;
+
+
     /* The name that will be shared with other nodes. */
     const std::string strProtocolName = "Tritium";
 
@@ -0,0 +1,247 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLP/include/ranges.h>
+
+#include <Util/include/mutex.h>
+
+#include <algorithm>
+
+namespace LLP
+{
+
+    /* Default Constructor. */
+    SyncRange::SyncRange()
+    : hashStart(0)
+    , hashStop(0)
+    , nHeight(0)
+    , nBlocks(0)
+    , nSession(0)
+    , fLocator(false)
+    {
+    }
+
+
+    /* Default Constructor. */
+    SyncRanges::SyncRanges()
+    : MUTEX()
+    , queueRanges()
+    , hashTail(0)
+    , nTailHeight(0)
+    , fLocator(false)
+    , fRequested(false)
+    {
+    }
+
+
+    /* Drop all ranges, and anchor the next headers at the given block. */
+    void SyncRanges::Reset(const uint1024_t& hashAnchor, const uint32_t nHeight, const bool fLocatorIn)
+    {
+        LOCK(MUTEX);
+
+        queueRanges.clear();
+        hashTail    = hashAnchor;
+        nTailHeight = nHeight;
+        fLocator    = fLocatorIn;
+        fRequested  = false;
+    }
+
+
+    /* Mark a headers request as sent, and get the block it follows. */
+    bool SyncRanges::Request(uint1024_t &hashStart, bool &fLocatorOut)
+    {
+        LOCK(MUTEX);
+
+        /* Only one headers request at a time, so the answer lines up with the tail. */
+        if(fRequested)
+            return false;
+
+        fRequested  = true;
+        hashStart   = hashTail;
+        fLocatorOut = fLocator;
+
+        return true;
+    }
+
+
+    /* Cut the answer to a headers request into ranges after the tail. */
+    uint32_t SyncRanges::Add(const std::vector<uint1024_t>& vHeaders, const uint32_t nRange)
+    {
+        LOCK(MUTEX);
+
+        /* Headers we didn't ask for don't follow the tail. */
+        if(!fRequested)
+            return 0;
+
+        fRequested = false;
+
+        /* Cut the ranges, each one following the last block of the range before it. */
+        const uint32_t nSize = std::max(nRange, 1u);
+        uint32_t nAdded = 0;
+        for(uint32_t nStart = 0; nStart < vHeaders.size(); nStart += nSize)
+        {
+            const uint32_t nStop = std::min(nStart + nSize, static_cast<uint32_t>(vHeaders.size())) - 1;
+
+            SyncRange range;
+            range.hashStart = hashTail;
+            range.hashStop  = vHeaders[nStop];
+            range.nBlocks   = (nStop - nStart + 1);
+            range.nHeight   = nTailHeight + range.nBlocks;
+            range.fLocator  = fLocator;
+
+            /* Move the tail to the end of this range. */
+            hashTail    = range.hashStop;
+            nTailHeight = range.nHeight;
+            fLocator    = false;
+
+            queueRanges.push_back(range);
+            ++nAdded;
+        }
+
+        return nAdded;
+    }
+
+
+    /* Assign the lowest range that is not assigned and that a node has all of. */
+    bool SyncRanges::Assign(const uint64_t nSession, const uint32_t nHeight, SyncRange &range)
+    {
+        LOCK(MUTEX);
+
+        for(auto& entry : queueRanges)
+        {
+            if(entry.nSession != 0 || entry.nHeight > nHeight)
+                continue;
+
+            entry.nSession = nSession;
+            range = entry;
+
+            return true;
+        }
+
+        return false;
+    }
+
+
+    /* Take over the lowest range assigned to another node. */
+    bool SyncRanges::Reassign(const uint64_t nSession, const uint32_t nHeight, SyncRange &range)
+    {
+        LOCK(MUTEX);
+
+        for(auto& entry : queueRanges)
+        {
+            if(entry.nSession == nSession || entry.nHeight > nHeight)
+                continue;
+
+            entry.nSession = nSession;
+            range = entry;
+
+            return true;
+        }
+
+        return false;
+    }
+
+
+    /* Get the lowest range assigned to a node. */
+    bool SyncRanges::Find(const uint64_t nSession, SyncRange &range) const
+    {
+        LOCK(MUTEX);
+
+        for(const auto& entry : queueRanges)
+        {
+            if(entry.nSession != nSession)
+                continue;
+
+            range = entry;
+            return true;
+        }
+
+        return false;
+    }
+
+
+    /* Mark the range that a block ends as arrived. */
+    bool SyncRanges::Received(const uint1024_t& hashBlock)
+    {
+        LOCK(MUTEX);
+
+        for(auto it = queueRanges.begin(); it != queueRanges.end(); ++it)
+        {
+            if(it->hashStop != hashBlock)
+                continue;
+
+            queueRanges.erase(it);
+            return true;
+        }
+
+        return false;
+    }
+
+
+    /* Return the ranges assigned to a node, so they are assigned again. */
+    uint32_t SyncRanges::Release(const uint64_t nSession)
+    {
+        LOCK(MUTEX);
+
+        /* Ranges that aren't assigned have no session. */
+        uint32_t nReleased = 0;
+        if(nSession == 0)
+            return nReleased;
+
+        for(auto& entry : queueRanges)
+        {
+            if(entry.nSession != nSession)
+                continue;
+
+            entry.nSession = 0;
+            ++nReleased;
+        }
+
+        return nReleased;
+    }
+
+
+    /* Get the number of ranges assigned to a node. */
+    uint32_t SyncRanges::Assigned(const uint64_t nSession) const
+    {
+        LOCK(MUTEX);
+
+        return static_cast<uint32_t>(std::count_if(queueRanges.begin(), queueRanges.end(),
+            [nSession](const SyncRange& entry) { return entry.nSession == nSession; }));
+    }
+
+
+    /* Get the number of ranges that are not assigned. */
+    uint32_t SyncRanges::Pending() const
+    {
+        return Assigned(0);
+    }
+
+
+    /* Get the number of ranges that have not arrived. */
+    uint32_t SyncRanges::Size() const
+    {
+        LOCK(MUTEX);
+
+        return static_cast<uint32_t>(queueRanges.size());
+    }
+
+
+    /* Get the height of the last header that ranges have been cut up to. */
+    uint32_t SyncRanges::TailHeight() const
+    {
+        LOCK(MUTEX);
+
+        return nTailHeight;
+    }
+}
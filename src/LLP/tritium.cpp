@@ -56,7 +56,9 @@ ________________________________________________________________________________
 #include <Util/include/version.h>
 
 
+#include <algorithm>
 #include <climits>
+#include <limits>
 #include <memory>
 #include <iomanip>
 #include <bitset>
@@ -70,6 +72,10 @@ namespace LLP
 {
     using namespace LLP::Tritium;
 
+    /* Declaration of the sync ranges. (private). */
+    SyncRanges TritiumNode::SYNC_RANGES;
+
+
     /* Declaration of sessions mutex. (private). */
     std::mutex TritiumNode::SESSIONS_MUTEX;
 
@@ -94,6 +100,10 @@ namespace LLP
     std::atomic<uint64_t> TritiumNode::nLastTimeReceived(0);
 
 
+    /* Bytes of blocks received while syncing. */
+    std::atomic<uint64_t> TritiumNode::nSyncBytes(0);
+
+
     /* Remaining time left to finish syncing. */
     std::atomic<uint64_t> TritiumNode::nRemainingTime(0);
 
@@ -133,6 +143,7 @@ namespace LLP
     , hashLastIndex(0)
     , nConsecutiveOrphans(0)
     , nConsecutiveFails(0)
+    , nSyncRange(0)
     , strFullVersion()
     , nUnsubscribed(0)
     , nTriggerNonce(0)
@@ -161,6 +172,7 @@ namespace LLP
     , hashLastIndex(0)
     , nConsecutiveOrphans(0)
     , nConsecutiveFails(0)
+    , nSyncRange(0)
     , strFullVersion()
     , nUnsubscribed(0)
     , nTriggerNonce(0)
@@ -189,6 +201,7 @@ namespace LLP
     , hashLastIndex(0)
     , nConsecutiveOrphans(0)
     , nConsecutiveFails(0)
+    , nSyncRange(0)
     , strFullVersion()
     , nUnsubscribed(0)
     , nTriggerNonce(0)
@@ -419,6 +432,13 @@ namespace LLP
                 if(TRITIUM_SERVER->GetAddressManager())
                     TRITIUM_SERVER->GetAddressManager()->AddAddress(GetAddress(), ConnectState::DROPPED);
 
+                /* Give the ranges of this node back, so they are requested from other nodes. */
+                if(SYNC_RANGES.Release(nCurrentSession) > 0)
+                    debug::log(1, NODE, "Sync ranges released");
+
+                /* Stop taking range blocks from this node. */
+                nSyncRange.store(0);
+
                 /* Handle if sync node is disconnected. */
                 if(nCurrentSession == TAO::Ledger::nSyncSession.load())
                 {
@@ -560,19 +580,34 @@ namespace LLP
 
                         /* Make sure the sync timer is stopped.  We don't start this until we receive our first sync block*/
                         SYNCTIMER.Stop();
+                        nSyncBytes.store(0);
 
                         /* Subscribe to this node. */
                         Subscribe(SUBSCRIPTION::LASTINDEX | SUBSCRIPTION::BESTCHAIN | SUBSCRIPTION::BESTHEIGHT);
 
+                        /* Ask for the headers first if the blocks are requested in ranges, found by locator from the best chain. */
+                        if(HeadersSync())
+                        {
+                            SYNC_RANGES.Reset(TAO::Ledger::ChainState::hashBestChain.load(), TAO::Ledger::ChainState::nBestHeight.load(), true);
+                            RequestHeaders();
+                        }
+
                         /* Ask for list of blocks if this is current sync node. */
-                        PushMessage(ACTION::LIST,
-                            config::fClient.load() ? uint8_t(SPECIFIER::CLIENT) : uint8_t(SPECIFIER::SYNC),
-                            uint8_t(TYPES::BLOCK),
-                            uint8_t(TYPES::LOCATOR),
-                            TAO::Ledger::Locator(TAO::Ledger::ChainState::hashBestChain.load()),
-                            uint1024_t(0)
-                        );
+                        else
+                        {
+                            PushMessage(ACTION::LIST,
+                                config::fClient.load() ? uint8_t(SPECIFIER::CLIENT) : uint8_t(SPECIFIER::SYNC),
+                                uint8_t(TYPES::BLOCK),
+                                uint8_t(TYPES::LOCATOR),
+                                TAO::Ledger::Locator(TAO::Ledger::ChainState::hashBestChain.load()),
+                                uint1024_t(0)
+                            );
+                        }
                     }
+
+                    /* Track the height of other nodes that can send ranges of blocks. */
+                    else if(HeadersSync())
+                        Subscribe(SUBSCRIPTION::BESTHEIGHT);
                 }
 
                 /* Relay to subscribed nodes a new connection was seen. */
@@ -1044,15 +1079,16 @@ namespace LLP
                     ssPacket >> nType;
 
                     /* Check for legacy or transactions specifiers. */
-                    bool fLegacy = false, fTransactions = false, fSyncBlock = false, fClientBlock = false;
+                    bool fLegacy = false, fTransactions = false, fSyncBlock = false, fClientBlock = false, fHeaders = false;
                     if(nType == SPECIFIER::LEGACY || nType == SPECIFIER::TRANSACTIONS
-                    || nType == SPECIFIER::SYNC   || nType == SPECIFIER::CLIENT)
+                    || nType == SPECIFIER::SYNC   || nType == SPECIFIER::CLIENT || nType == SPECIFIER::HEADERS)
                     {
                         /* Set specifiers. */
                         fLegacy       = (nType == SPECIFIER::LEGACY);
                         fTransactions = (nType == SPECIFIER::TRANSACTIONS);
                         fSyncBlock    = (nType == SPECIFIER::SYNC);
                         fClientBlock  = (nType == SPECIFIER::CLIENT);
+                        fHeaders      = (nType == SPECIFIER::HEADERS);
 
                         /* Go to next type in stream. */
                         ssPacket >> nType;
@@ -1145,6 +1181,7 @@ namespace LLP
                             /* Do a sequential read to obtain the list.
                                3000 seems to be the optimal amount to overcome higher-latency connections during sync */
                             std::vector<TAO::Ledger::BlockState> vStates;
+                            std::vector<uint1024_t> vHeaders;
                             while(!fBufferFull.load() && --nLimits >= 0 && hashStart != hashStop && LLD::Ledger->BatchRead(hashStart, "block", vStates, 3000, true))
                             {
                                 /* Loop through all available states. */
@@ -1177,8 +1214,12 @@ namespace LLP
                                     /* Cache the block hash. */
                                     stateLast = state;
 
+                                    /* Handle for headers, sent together after the list is read. */
+                                    if(fHeaders)
+                                        vHeaders.push_back(hashStart);
+
                                     /* Handle for special sync block type specifier. */
-                                    if(fSyncBlock)
+                                    else if(fSyncBlock)
                                     {
                                         /* Build the sync block from state. */
                                         TAO::Ledger::SyncBlock block(state);
@@ -1268,8 +1309,12 @@ namespace LLP
                                 }
                             }
 
+                            /* Send the headers in one message, which the node requests the blocks for by range. */
+                            if(fHeaders)
+                                PushMessage(TYPES::BLOCK, uint8_t(SPECIFIER::HEADERS), vHeaders);
+
                             /* Check for last subscription. */
-                            if(nNotifications & SUBSCRIPTION::LASTINDEX)
+                            else if(nNotifications & SUBSCRIPTION::LASTINDEX)
                                 PushMessage(ACTION::NOTIFY, uint8_t(TYPES::LASTINDEX), uint8_t(TYPES::BLOCK), fBufferFull.load() ? stateLast.hashPrevBlock : hashStart);
 
                             break;
@@ -1294,6 +1339,10 @@ namespace LLP
                             if(fSyncBlock)
                                 return debug::drop(NODE, "cannot use SPECIFIER::SYNC for transaction lists");
 
+                            /* Check for invalid specifiers. */
+                            if(fHeaders)
+                                return debug::drop(NODE, "cannot use SPECIFIER::HEADERS for transaction lists");
+
                             /* Check for legacy. */
                             if(fLegacy)
                             {
@@ -2344,6 +2393,9 @@ namespace LLP
                                             /* Unsubcribe from last. */
                                             Unsubscribe(SUBSCRIPTION::LASTINDEX);
 
+                                            /* Drop the sync ranges. */
+                                            ResetRanges();
+
                                             /* Total blocks synchronized */
                                             uint32_t nBlocks = TAO::Ledger::ChainState::stateBest.load().nHeight - nSyncStart.load();
 
@@ -2359,6 +2411,22 @@ namespace LLP
                                             debug::log(0, NODE, "ACTION::NOTIFY: Synchronized ", nBlocks, " blocks in ", nElapsed, " seconds [", dRate, " blocks/s]" );
 
                                         }
+                                        else if(HeadersSync())
+                                        {
+                                            /* Ask for the rest of our range if the list stopped short of it. */
+                                            SyncRange range;
+                                            if(SYNC_RANGES.Find(nCurrentSession, range) && hashLast != range.hashStop)
+                                            {
+                                                range.hashStart = hashLast;
+                                                range.fLocator  = false;
+
+                                                RequestRange(range);
+                                            }
+
+                                            /* Otherwise move on to the next range, or the next headers. */
+                                            else
+                                                NextRange();
+                                        }
                                         else
                                         {
                                             /* Ask for list of blocks. */
@@ -2408,6 +2476,9 @@ namespace LLP
                                 /* Unsubcribe from last. */
                                 Unsubscribe(SUBSCRIPTION::LASTINDEX);
 
+                                /* Drop the sync ranges. */
+                                ResetRanges();
+
                                 /* Log that sync is complete. */
                                 debug::log(0, NODE, "ACTION::NOTIFY: Synchonization COMPLETE at ", hashBestChain.SubString());
                             }
@@ -2552,20 +2623,30 @@ namespace LLP
             /* Handle incoming block. */
             case TYPES::BLOCK:
             {
-                /* Check for subscription. */
-                if(!(nSubscriptions & SUBSCRIPTION::BLOCK) && TAO::Ledger::nSyncSession.load() != nCurrentSession)
+                /* Check for subscription, without which only the sync blocks of a requested range are taken. */
+                const bool fRangeOnly = (!(nSubscriptions & SUBSCRIPTION::BLOCK) && TAO::Ledger::nSyncSession.load() != nCurrentSession);
+                if(fRangeOnly && nSyncRange.load() == 0)
                     return debug::drop(NODE, "TYPES::BLOCK: unsolicited data");
 
                 /* Star the sync timer if this is the first sync block */
                 if(!SYNCTIMER.Running())
                     SYNCTIMER.Start();
 
+                /* Count the bytes received for the sync throughput. */
+                if(TAO::Ledger::ChainState::Synchronizing())
+                    nSyncBytes += INCOMING.DATA.size();
+
                 /* Get the specifier. */
                 uint8_t nSpecifier = 0;
                 ssPacket >> nSpecifier;
 
+                /* Ranges are only requested as sync blocks. */
+                if(fRangeOnly && nSpecifier != SPECIFIER::SYNC)
+                    return debug::drop(NODE, "TYPES::BLOCK: unsolicited data");
+
                 /* Switch based on specifier. */
                 uint8_t nStatus = 0;
+                bool fRange = false;
                 switch(nSpecifier)
                 {
                     /* Handle for a legacy transaction. */
@@ -2691,15 +2772,24 @@ namespace LLP
                         TAO::Ledger::SyncBlock block;
                         ssPacket >> block;
 
+                        /* Blocks of a requested range arrive ahead of the best chain. */
+                        if(nSyncRange.load() > 0 && nCurrentSession != TAO::Ledger::nSyncSession.load())
+                        {
+                            --nSyncRange;
+                            fRange = true;
+                        }
+
                         /* Check version switch. */
+                        uint1024_t hashBlock = 0;
                         if(block.nVersion >= 7)
                         {
                             /* Build a tritium block from sync block. */
                             TAO::Ledger::TritiumBlock tritium(block);
+                            hashBlock = tritium.GetHash();
 
                             /* Verbose debug output. */
                             if(config::nVerbose >= 3)
-                                debug::log(3, FUNCTION, "received sync block ", tritium.GetHash().SubString(), " height = ", block.nHeight);
+                                debug::log(3, FUNCTION, "received sync block ", hashBlock.SubString(), " height = ", block.nHeight);
 
                             /* Process the block. */
                             TAO::Ledger::Process(tritium, nStatus);
@@ -2708,15 +2798,79 @@ namespace LLP
                         {
                             /* Build a tritium block from sync block. */
                             Legacy::LegacyBlock legacy(block);
+                            hashBlock = legacy.GetHash();
 
                             /* Verbose debug output. */
                             if(config::nVerbose >= 3)
-                                debug::log(3, FUNCTION, "received sync block ", legacy.GetHash().SubString(), " height = ", block.nHeight);
+                                debug::log(3, FUNCTION, "received sync block ", hashBlock.SubString(), " height = ", block.nHeight);
 
                             /* Process the block. */
                             TAO::Ledger::Process(legacy, nStatus);
                         }
 
+                        /* Check for the last block of a range, after which a range node takes its next range. */
+                        if(SYNC_RANGES.Received(hashBlock) && fRange)
+                            NextRange();
+
+                        break;
+                    }
+
+
+                    /* Handle for the headers of the blocks to sync. */
+                    case SPECIFIER::HEADERS:
+                    {
+                        /* Check for client mode since this method should never be called except by a client. */
+                        if(config::fClient.load())
+                            return debug::drop(NODE, "TYPES::BLOCK::HEADERS: disabled in -client mode");
+
+                        /* Check that headers come from the sync node. */
+                        if(nCurrentSession != TAO::Ledger::nSyncSession.load())
+                            return debug::drop(NODE, "TYPES::BLOCK::HEADERS: unsolicited headers");
+
+                        /* Get the headers from the stream. */
+                        std::vector<uint1024_t> vHeaders;
+                        ssPacket >> vHeaders;
+
+                        /* Check the headers size. */
+                        if(vHeaders.size() > 3001)
+                            return debug::drop(NODE, "TYPES::BLOCK::HEADERS: ", vHeaders.size(), " headers is too large");
+
+                        /* Reset last time received. */
+                        nLastTimeReceived.store(runtime::timestamp());
+
+                        /* Verbose debug output. */
+                        if(config::nVerbose >= 3)
+                            debug::log(3, FUNCTION, "received ", vHeaders.size(), " headers");
+
+                        /* Cut the headers into ranges after the ones we have, and give them out. */
+                        const uint32_t nRange = std::max(int64_t(1), config::GetArg("-syncrange", 0));
+                        if(SYNC_RANGES.Add(vHeaders, nRange) > 0)
+                            AssignRanges();
+
+                        /* Headers we didn't ask for don't follow our ranges. */
+                        else if(!vHeaders.empty())
+                            debug::log(3, NODE, "TYPES::BLOCK::HEADERS: ignoring ", vHeaders.size(), " unrequested headers");
+
+                        /* Take over a range from a node that is behind with it, once this node has no headers past our ranges. */
+                        else if(SYNC_RANGES.Size() > 0)
+                        {
+                            SyncRange range;
+                            if(SYNC_RANGES.Reassign(nCurrentSession, std::numeric_limits<uint32_t>::max(), range))
+                                RequestRange(range);
+                        }
+
+                        /* Ask for list of blocks from this node if it has no headers past ours. */
+                        else
+                        {
+                            PushMessage(ACTION::LIST,
+                                uint8_t(SPECIFIER::SYNC),
+                                uint8_t(TYPES::BLOCK),
+                                uint8_t(TYPES::LOCATOR),
+                                TAO::Ledger::Locator(TAO::Ledger::ChainState::hashBestChain.load()),
+                                uint1024_t(0)
+                            );
+                        }
+
                         break;
                     }
 
@@ -2775,8 +2929,8 @@ namespace LLP
                 if(nStatus & TAO::Ledger::PROCESS::REJECTED)
                     ++nConsecutiveFails;
 
-                /* Check for orphan status messages. */
-                if(nStatus & TAO::Ledger::PROCESS::ORPHAN)
+                /* Check for orphan status messages, which blocks of a range are until the ranges before connect. */
+                if((nStatus & TAO::Ledger::PROCESS::ORPHAN) && !fRange)
                     ++nConsecutiveOrphans;
 
                 /* Detect large orphan chains and ask for new blocks from origin again. */
@@ -2787,6 +2941,7 @@ namespace LLP
 
                         /* Clear the memory to prevent DoS attacks. */
                         TAO::Ledger::mapOrphans.clear();
+                        TAO::Ledger::setChecked.clear();
                     }
 
                     /* Switch to another available node. */
@@ -4073,13 +4228,23 @@ namespace LLP
 
                 /* Subscribe to this node. */
                 pnode->Subscribe(SUBSCRIPTION::LASTINDEX | SUBSCRIPTION::BESTCHAIN | SUBSCRIPTION::BESTHEIGHT);
-                pnode->PushMessage(ACTION::LIST,
-                    config::fClient.load() ? uint8_t(SPECIFIER::CLIENT) : uint8_t(SPECIFIER::SYNC),
-                    uint8_t(TYPES::BLOCK),
-                    uint8_t(TYPES::LOCATOR),
-                    TAO::Ledger::Locator(TAO::Ledger::ChainState::hashBestChain.load()),
-                    uint1024_t(0)
-                );
+
+                /* Start the sync ranges over from the best chain with the headers of this node. */
+                if(pnode->HeadersSync())
+                {
+                    SYNC_RANGES.Reset(TAO::Ledger::ChainState::hashBestChain.load(), TAO::Ledger::ChainState::nBestHeight.load(), true);
+                    pnode->RequestHeaders();
+                }
+                else
+                {
+                    pnode->PushMessage(ACTION::LIST,
+                        config::fClient.load() ? uint8_t(SPECIFIER::CLIENT) : uint8_t(SPECIFIER::SYNC),
+                        uint8_t(TYPES::BLOCK),
+                        uint8_t(TYPES::LOCATOR),
+                        TAO::Ledger::Locator(TAO::Ledger::ChainState::hashBestChain.load()),
+                        uint1024_t(0)
+                    );
+                }
 
                 /* Reset last time received. */
                 nLastTimeReceived.store(runtime::timestamp());
@@ -4101,4 +4266,153 @@ namespace LLP
             debug::log(0, FUNCTION, "No Sync Nodes Available");
         }
     }
+
+
+    /* Helper function to ask this sync node for the headers that follow the sync ranges. */
+    void TritiumNode::RequestHeaders()
+    {
+        /* Get the block the headers follow, with one request out at a time. */
+        uint1024_t hashStart = 0;
+        bool fLocator = false;
+        if(!SYNC_RANGES.Request(hashStart, fLocator))
+            return;
+
+        /* The first headers are found by locator, in case the best chain is on a fork. */
+        if(fLocator)
+        {
+            PushMessage(ACTION::LIST,
+                uint8_t(SPECIFIER::HEADERS),
+                uint8_t(TYPES::BLOCK),
+                uint8_t(TYPES::LOCATOR),
+                TAO::Ledger::Locator(hashStart),
+                uint1024_t(0)
+            );
+        }
+        else
+        {
+            PushMessage(ACTION::LIST,
+                uint8_t(SPECIFIER::HEADERS),
+                uint8_t(TYPES::BLOCK),
+                uint8_t(TYPES::UINT1024_T),
+                hashStart,
+                uint1024_t(0)
+            );
+        }
+    }
+
+
+    /* Helper function to ask this node for the blocks of a range. */
+    void TritiumNode::RequestRange(const SyncRange& range)
+    {
+        /* Allow the blocks of this range through as sync blocks from a node that isn't syncing us. */
+        if(nCurrentSession != TAO::Ledger::nSyncSession.load())
+            nSyncRange += range.nBlocks;
+
+        /* The first range follows the same locator as the headers it was cut from. */
+        if(range.fLocator)
+        {
+            PushMessage(ACTION::LIST,
+                uint8_t(SPECIFIER::SYNC),
+                uint8_t(TYPES::BLOCK),
+                uint8_t(TYPES::LOCATOR),
+                TAO::Ledger::Locator(range.hashStart),
+                range.hashStop
+            );
+        }
+        else
+        {
+            PushMessage(ACTION::LIST,
+                uint8_t(SPECIFIER::SYNC),
+                uint8_t(TYPES::BLOCK),
+                uint8_t(TYPES::UINT1024_T),
+                range.hashStart,
+                range.hashStop
+            );
+        }
+
+        debug::log(3, NODE, "Range ", range.hashStart.SubString(), " to ", range.hashStop.SubString(), " height ", range.nHeight);
+    }
+
+
+    /* Helper function to give this node its next range once it has none. */
+    void TritiumNode::NextRange()
+    {
+        /* The sync node has every header it sent us. */
+        const bool fSyncNode = (nCurrentSession == TAO::Ledger::nSyncSession.load());
+        const uint32_t nHeight = fSyncNode ? std::numeric_limits<uint32_t>::max() : nCurrentHeight;
+
+        /* Take the lowest range no node has. */
+        SyncRange range;
+        if(SYNC_RANGES.Assign(nCurrentSession, nHeight, range))
+        {
+            RequestRange(range);
+            return;
+        }
+
+        /* Only the sync node asks for headers. */
+        if(!fSyncNode)
+            return;
+
+        /* Ask for more headers while the ranges are less than two lists of headers ahead of the best chain. */
+        if(SYNC_RANGES.TailHeight() < TAO::Ledger::ChainState::nBestHeight.load() + 6000)
+        {
+            RequestHeaders();
+            return;
+        }
+
+        /* Otherwise the best chain is waiting on a range another node is behind with, so take it over. */
+        if(SYNC_RANGES.Reassign(nCurrentSession, nHeight, range))
+            RequestRange(range);
+    }
+
+
+    /* Helper function to give a range to each node that can send ranges and has none. */
+    void TritiumNode::AssignRanges()
+    {
+        for(const auto& connection : TRITIUM_SERVER->GetConnections())
+        {
+            /* Skip over inactive connections and the nodes that don't send ranges. */
+            TritiumNode* pnode = connection->load();
+            if(!pnode || !pnode->Connected() || !pnode->HeadersSync())
+                continue;
+
+            /* Nodes with a range move on to the next one when it arrives. */
+            if(SYNC_RANGES.Assigned(pnode->nCurrentSession) > 0)
+                continue;
+
+            try
+            {
+                pnode->NextRange();
+            }
+            catch(const std::exception& e)
+            {
+                debug::error(FUNCTION, e.what());
+            }
+        }
+    }
+
+
+    /* Helper function to drop the sync ranges and stop taking range blocks from any node. */
+    void TritiumNode::ResetRanges()
+    {
+        SYNC_RANGES.Reset();
+
+        for(const auto& connection : TRITIUM_SERVER->GetConnections())
+        {
+            TritiumNode* pnode = connection->load();
+            if(pnode)
+                pnode->nSyncRange.store(0);
+        }
+    }
+
+
+    /* Helper function to check if this node syncs by headers. */
+    bool TritiumNode::HeadersSync() const
+    {
+        /* Clients sync by client blocks. */
+        if(config::fClient.load())
+            return false;
+
+        return config::GetArg("-syncrange", 0) > 0 && nProtocolVersion >= MIN_HEADERS_VERSION;
+    }
 }
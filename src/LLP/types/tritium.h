@@ -18,6 +18,7 @@ ________________________________________________________________________________
 #include <LLC/include/random.h>
 
 #include <LLP/include/network.h>
+#include <LLP/include/ranges.h>
 #include <LLP/include/version.h>
 #include <LLP/packets/message.h>
 #include <LLP/templates/base_connection.h>
@@ -107,6 +108,7 @@ namespace LLP
                 TRANSACTIONS = 0x43, //specify to send memory transactions first
                 CLIENT       = 0x44, //specify for blocks to be sent and received for clients
                 POOLSTAKE    = 0x45, //specify for pooled coinstake transactions
+                HEADERS      = 0x46, //specify for block hashes sent ahead of the blocks during sync
             };
         }
 
@@ -163,6 +165,61 @@ namespace LLP
         static void SwitchNode();
 
 
+        /** Request Headers
+         *
+         *  Helper function to ask this sync node for the headers that follow the
+         *  last header the sync ranges have been cut up to.
+         *
+         **/
+        void RequestHeaders();
+
+
+        /** Request Range
+         *
+         *  Helper function to ask this node for the blocks of a range.
+         *
+         *  @param[in] range The range to request.
+         *
+         **/
+        void RequestRange(const SyncRange& range);
+
+
+        /** Next Range
+         *
+         *  Helper function to give this node its next range once it has none. The
+         *  sync node also asks for the next headers, or takes over a stalled range.
+         *
+         **/
+        void NextRange();
+
+
+        /** Assign Ranges
+         *
+         *  Helper function to give a range to each node that can send ranges and has none.
+         *
+         **/
+        static void AssignRanges();
+
+
+        /** Reset Ranges
+         *
+         *  Helper function to drop the sync ranges and stop taking range blocks from any node.
+         *
+         **/
+        static void ResetRanges();
+
+
+        /** Headers Sync
+         *
+         *  Helper function to check if this node syncs by headers, with -syncrange
+         *  set and the remote node on a protocol version that sends them.
+         *
+         *  @return True if the blocks are requested in ranges from more than one node.
+         *
+         **/
+        bool HeadersSync() const;
+
+
         /** State of if this node has logged in to remote node. **/
         std::atomic<bool> fLoggedIn;
 
@@ -175,6 +232,10 @@ namespace LLP
         std::atomic<bool> fInitialized;
 
 
+        /** The ranges of blocks being requested during a headers sync. **/
+        static SyncRanges SYNC_RANGES;
+
+
         /** Mutex for connected sessions. **/
         static std::mutex SESSIONS_MUTEX;
 
@@ -225,6 +286,10 @@ namespace LLP
         static std::atomic<uint64_t> nLastTimeReceived;
 
 
+        /** The bytes of blocks received since the start of the last sync session. **/
+        static std::atomic<uint64_t> nSyncBytes;
+
+
         /** Default Constructor **/
         TritiumNode();
 
@@ -293,6 +358,10 @@ namespace LLP
         uint32_t nConsecutiveFails;
 
 
+        /** Blocks requested from this node in sync ranges that have not arrived. **/
+        std::atomic<uint32_t> nSyncRange;
+
+
         /** The node's full version string. **/
         std::string strFullVersion;
 
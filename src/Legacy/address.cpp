@@ -109,7 +109,7 @@ namespace Legacy
     /* Sets the public key by hashing it to generate address hash */
     void NexusAddress::SetPubKey(const std::vector<uint8_t>& vchPubKey)
     {
-        SetHash256(LLC::SK256(vchPubKey));
+        SetHash256(LLC::SK256(vchPubKey, true));
     }
 
 
@@ -358,6 +358,9 @@ namespace Legacy
         /* Get the signature operations for legacy tx's. */
         uint32_t nSigOps = 0;
 
+        /* Hash all the transactions as one batch. */
+        const std::vector<uint512_t> vTxHashes = Transaction::GetHashes(vtx);
+
         /* Check all the transactions. */
         uint32_t nSize = (uint32_t)vtx.size();
         for(uint32_t i = 0; i < nSize; ++i)
@@ -367,7 +370,7 @@ namespace Legacy
                 return debug::error(FUNCTION, "more than one coinbase / coinstake");
 
             /* Get the tx hash. */
-            uint512_t hashTx  = vtx[i].GetHash();
+            const uint512_t& hashTx = vTxHashes[i];
 
             /* Insert txid into set to check for duplicates. */
             setUniqueTx.insert(hashTx);
@@ -736,7 +739,7 @@ namespace Legacy
             /* Serialize the data to hash into a stream. */
             ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << nTime << vOffsets;
 
-            return LLC::SK1024(ss.begin(), ss.end());
+            return CachedHash(ss.data(), ss.data() + ss.size(), pSignatureCache);
         }
 
         /* Create a data stream to get the hash. */
@@ -746,7 +749,7 @@ namespace Legacy
         /* Serialize the data to hash into a stream. */
         ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << uint32_t(nTime);
 
-        return LLC::SK1024(ss.begin(), ss.end());
+        return CachedHash(ss.data(), ss.data() + ss.size(), pSignatureCache);
     }
 
 
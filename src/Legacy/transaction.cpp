@@ -36,6 +36,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/chainstate.h>
 #include <TAO/Ledger/include/stake.h>
 
+#include <TAO/Ledger/types/sigcache.h>
 #include <TAO/Ledger/types/transaction.h>
 
 #include <Util/include/runtime.h>
@@ -215,6 +216,34 @@ namespace Legacy
 	}
 
 
+	/* Returns the hashes of many transactions, hashed as one batch. */
+	std::vector<uint512_t> Transaction::GetHashes(const std::vector<Transaction>& vtx)
+	{
+	    /* Serialize every transaction into one stream. */
+	    DataStream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
+	    std::vector<uint64_t> vEnd;
+	    for(const auto& tx : vtx)
+	    {
+	        ss << tx;
+	        vEnd.push_back(ss.size());
+	    }
+
+	    /* Hash each transaction's bytes. */
+	    std::vector< std::pair<const uint8_t*, const uint8_t*> > vMessages;
+	    for(uint32_t n = 0; n < vtx.size(); ++n)
+	        vMessages.push_back(std::make_pair(ss.data() + (n == 0 ? 0 : vEnd[n - 1]), ss.data() + vEnd[n]));
+
+	    std::vector<uint512_t> vHashes = LLC::SK512Batch(vMessages);
+
+        /* Type of 0xfe designates legacy tx beginning with v7 activation (tx version 2). */
+	    for(uint32_t n = 0; n < vtx.size(); ++n)
+	        if(vtx[n].nVersion >= 2)
+	            vHashes[n].SetType(TAO::Ledger::LEGACY);
+
+	    return vHashes;
+	}
+
+
 	/* Determine if a transaction is within LOCKTIME_THRESHOLD */
 	bool Transaction::IsFinal(int32_t nBlockHeight, int64_t nBlockTime) const
 	{
@@ -1154,8 +1183,23 @@ namespace Legacy
                         return debug::error(FUNCTION, "prev tx ", prevout.hash.SubString(), " is already spent");
 
                     /* Check the ECDSA signatures. (...When not syncronizing) */
-                    if(!TAO::Ledger::ChainState::Synchronizing() && !VerifySignature(txPrev, *this, i, 0))
-                        return debug::error(FUNCTION, "signature is invalid");
+                    if(!TAO::Ledger::ChainState::Synchronizing())
+                    {
+                        /* Key the cache by the spent script and input, the signature is part of the hash. */
+                        DataStream ssKey(SER_GETHASH, LLP::PROTOCOL_VERSION);
+                        ssKey << txPrev.vout[prevout.n].scriptPubKey << i;
+
+                        /* Skip inputs already verified in the memory pool. */
+                        const uint512_t hashTx  = GetHash();
+                        const uint256_t hashKey = LLC::SK256(ssKey.begin(), ssKey.end());
+                        if(!TAO::Ledger::sigcache.Has(hashTx, hashKey))
+                        {
+                            if(!VerifySignature(txPrev, *this, i, 0))
+                                return debug::error(FUNCTION, "signature is invalid");
+
+                            TAO::Ledger::sigcache.Add(hashTx, hashKey);
+                        }
+                    }
 
                     /* Commit to disk if flagged. */
                     if((nFlags == TAO::Ledger::FLAGS::BLOCK) && !LLD::Legacy->WriteSpend(prevout.hash, prevout.n))
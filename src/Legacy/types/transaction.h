@@ -167,6 +167,18 @@ namespace Legacy
 		uint512_t GetHash() const;
 
 
+		/** Get Hashes
+		 *
+		 *  Returns the hashes of many transactions, hashed as one batch.
+		 *
+		 *  @param[in] vtx The transactions to hash.
+		 *
+		 *  @return the 512-bit hash of each transaction, in order.
+		 *
+		 **/
+		static std::vector<uint512_t> GetHashes(const std::vector<Transaction>& vtx);
+
+
 		/** Is Final
 		 *
 		 *  Determine if a transaction is within LOCKTIME_THRESHOLD
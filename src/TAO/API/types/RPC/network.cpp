@@ -160,11 +160,6 @@ namespace TAO
             /* Map will store trust keys, keyed by stake rate, sorted in descending order */
             std::multimap<double, Legacy::TrustKey, std::greater<double> > mapTrustKeys;
 
-            /* Retrieve all raw trust database keys from keychain */
-            std::vector<Legacy::TrustKey> vKeys;
-            if(!LLD::Trust->BatchRead("NONE", vKeys, -1))
-                return debug::safe_printstr("No Trust Keys ", vKeys.size());
-
             /* Cutoff time for v4 trust keys. Anything prior to v4 end plus the original one timespan grace period.
              * This addresses an issue that some v4 keys produced one v5 block during grace period, but then incorrectly "expired"
              * and were replaced with a new v5 key.
@@ -176,21 +171,29 @@ namespace TAO
             uint64_t nActiveTime = (uint64_t)(config::fTestNet ? (TAO::Ledger::TRUST_KEY_TIMESPAN_TESTNET * 10)
                                                                : (TAO::Ledger::TRUST_KEY_TIMESPAN * 10));
 
-            /* Search through the trust keys. */
-            for(const auto& trustKey : vKeys)
+            /* Stream all raw trust database keys, keeping the active ones. */
+            uint32_t nKeys = 0;
+            LLD::Trust->ForEach<Legacy::TrustKey>("NONE", [&](Legacy::TrustKey& trustKey)
             {
+                ++nKeys;
+
                 /* Ignore v4 trust keys */
                 if(trustKey.nLastBlockTime < nCutoff)
-                    continue;
+                    return true;
 
                 /* Ignore inactive trust keys */
                 if((trustKey.nLastBlockTime + nActiveTime) < TAO::Ledger::ChainState::stateBest.load().GetBlockTime())
-                    continue;
+                    return true;
 
                 /* Put trust keys into a map keyed by stake rate (sorts them by rate) */
                 double stakeRate = ((uint32_t)(trustKey.nStakeRate * 10000)) / 100.0;
                 mapTrustKeys.insert (std::make_pair(stakeRate, trustKey));
-            }
+
+                return true;
+            });
+
+            if(nKeys == 0)
+                return debug::safe_printstr("No Trust Keys ", nKeys);
 
             /* Now have map of all trust keys. Assemble into response data */
             for(auto& item : mapTrustKeys)
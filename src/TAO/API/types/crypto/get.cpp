@@ -14,6 +14,7 @@ ________________________________________________________________________________
 #include <LLD/include/global.h>
 
 #include <LLC/hash/argon2.h>
+#include <LLC/include/argon2_pool.h>
 
 #include <TAO/API/types/objects.h>
 #include <TAO/API/include/global.h>
@@ -288,8 +289,8 @@ namespace TAO
                     /* Algorithm Version */
                     ARGON2_VERSION_13,
 
-                    /* Custom memory allocation / deallocation functions. */
-                    NULL, NULL,
+                    /* Reuse the memory of earlier hashes. */
+                    LLC::Argon2Allocate, LLC::Argon2Free,
 
                     /* By default only internal memory is cleared (pwd is not wiped) */
                     ARGON2_DEFAULT_FLAGS
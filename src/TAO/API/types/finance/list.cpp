@@ -12,6 +12,7 @@
 ____________________________________________________________________________________________*/
 
 #include <LLD/include/global.h>
+#include <LLD/include/snapshot.h>
 
 #include <TAO/API/types/finance.h>
 #include <TAO/API/types/objects.h>
@@ -59,6 +60,9 @@ namespace TAO
             if(params.find("limit") != params.end())
                 nLimit = std::stoul(params["limit"].get<std::string>());
 
+            /* Read the ledger and registers at one commit epoch, so a block being committed can't split the list. */
+            const LLD::Snapshot snapshot;
+
             /* Get the list of registers owned by this sig chain */
             std::vector<TAO::Register::Address> vAccounts;
             if(!ListAccounts(user->Genesis(), vAccounts, false, true))
@@ -25,6 +25,8 @@ ________________________________________________________________________________
 #include <TAO/Register/types/address.h>
 #include <TAO/Register/types/object.h>
 
+#include <algorithm>
+
 
 /* Global TAO namespace. */
 namespace TAO
@@ -54,88 +56,98 @@ namespace TAO
             if(params.find("sort") != params.end())
                 strSort = params["sort"].get<std::string>();
 
-            /* The vector of trust accounts */
-            std::vector<TAO::Register::Object> vAccounts;
-
             /* Timestamp of 30 days ago, to use to include active accounts */
             uint64_t nActive = runtime::unifiedtimestamp() - (60 * 60 * 24 * 30);
 
-            /* Batch read up to 100,000 */
-            if(LLD::Register->BatchRead("trust", vAccounts, 100000))
+            /* Only the accounts up to the end of the requested page are kept. */
+            const uint64_t nKeep = uint64_t(nPage + 1) * nLimit;
+
+            /* Sort in decending order */
+            const bool fSort = (strSort == "stake" || strSort == "balance" || strSort == "trust");
+            auto fnCompare = [strSort](const TAO::Register::Object &a, const TAO::Register::Object &b)
             {
-                /* The vector of active accounts */
-                std::vector<TAO::Register::Object> vActive;
+                return ( a.get<uint64_t>(strSort) > b.get<uint64_t>(strSort) );
+            };
 
-                /* Make sure they are all parsed so that we can sort them */
-                for(auto& account : vAccounts)
-                {
-                    /* Only include active within last 30 days */
-                    if(account.nModified < nActive)
-                        continue;
+            /* The vector of active accounts, kept as a heap with the lowest ranked account on top when sorting */
+            std::vector<TAO::Register::Object> vActive;
 
-                    /* Parse so we can access the data */
-                    account.Parse();
+            /* Stream the trust accounts, skipping those not active within last 30 days before parsing */
+            LLD::Register->ForEach<TAO::Register::Object>("trust", [&](TAO::Register::Object& account)
+            {
+                /* Parse so we can access the data */
+                account.Parse();
 
-                    /* Only include accounts with stake or trust (genesis has stake w/o trust; can unstake to trust w/o stake) */
-                    if(account.get<uint64_t>("stake") == 0 && account.get<uint64_t>("trust") == 0)
-                        continue;
+                /* Only include accounts with stake or trust (genesis has stake w/o trust; can unstake to trust w/o stake) */
+                if(account.get<uint64_t>("stake") == 0 && account.get<uint64_t>("trust") == 0)
+                    return true;
 
-                    /* Add the account to our active list */
-                    vActive.push_back(account);
-                }
+                /* Add the account to our active list */
+                vActive.push_back(account);
 
-                /* Sort the list */
-                if(strSort == "stake" || strSort == "balance" || strSort == "trust")
-                    std::sort(vActive.begin(), vActive.end(), [strSort]
-                            (const TAO::Register::Object &a, const TAO::Register::Object &b)
-                    {
-                        /* Sort in decending order */
-                        return ( a.get<uint64_t>(strSort) > b.get<uint64_t>(strSort) );
-                    });
-
-                /* Iterate the list and build the response */
-                uint32_t nTotal = 0;
-                for(auto& account : vActive)
+                /* Without sorting the scan can stop once the page is filled. */
+                if(!fSort)
+                    return (vActive.size() < nKeep);
+
+                /* Drop the lowest ranked account once there are more than the pages need. */
+                std::push_heap(vActive.begin(), vActive.end(), fnCompare);
+                if(vActive.size() > nKeep)
                 {
-                    /* Get the current page. */
-                    uint32_t nCurrentPage = (nTotal / nLimit) ;
+                    std::pop_heap(vActive.begin(), vActive.end(), fnCompare);
+                    vActive.pop_back();
+                }
+
+                return true;
+            },
+            [nActive](const TAO::Register::Object& account)
+            {
+                return (account.nModified >= nActive);
+            });
 
-                    /* Increment the counter */
-                    ++nTotal;
+            /* Sort the list */
+            if(fSort)
+                std::sort_heap(vActive.begin(), vActive.end(), fnCompare);
 
-                    /* Check the paged data. */
-                    if(nCurrentPage < nPage)
-                        continue;
+            /* Iterate the list and build the response */
+            uint32_t nTotal = 0;
+            for(auto& account : vActive)
+            {
+                /* Get the current page. */
+                uint32_t nCurrentPage = (nTotal / nLimit) ;
 
-                    if(nCurrentPage > nPage)
-                        break;
+                /* Increment the counter */
+                ++nTotal;
 
-                    /* The JSON for this account */
-                    json::json jsonAccount;
+                /* Check the paged data. */
+                if(nCurrentPage < nPage)
+                    continue;
 
-                    /* The register address */
-                    TAO::Register::Address address("trust", account.hashOwner, TAO::Register::Address::TRUST);
+                if(nCurrentPage > nPage)
+                    break;
 
-                    /* Populate the response */
-                    jsonAccount["address"] = address.ToString();
-                    jsonAccount["owner"] = account.hashOwner.ToString();
-                    jsonAccount["created"] = account.nCreated;
-                    jsonAccount["modified"] = account.nModified;
-                    jsonAccount["balance"] = (double) account.get<uint64_t>("balance") / pow(10, TAO::Ledger::NXS_DIGITS);
-                    jsonAccount["stake"] = (double) account.get<uint64_t>("stake") / pow(10, TAO::Ledger::NXS_DIGITS);
+                /* The JSON for this account */
+                json::json jsonAccount;
 
-                    /* Calculate and add the stake rate */
-                    uint64_t nTrust = account.get<uint64_t>("trust");
-                    jsonAccount["trust"] = nTrust;
-                    jsonAccount["stakerate"] = TAO::Ledger::StakeRate(nTrust, (nTrust == 0)) * 100.0;
+                /* The register address */
+                TAO::Register::Address address("trust", account.hashOwner, TAO::Register::Address::TRUST);
 
-                    jsonRet.push_back(jsonAccount);
+                /* Populate the response */
+                jsonAccount["address"] = address.ToString();
+                jsonAccount["owner"] = account.hashOwner.ToString();
+                jsonAccount["created"] = account.nCreated;
+                jsonAccount["modified"] = account.nModified;
+                jsonAccount["balance"] = (double) account.get<uint64_t>("balance") / pow(10, TAO::Ledger::NXS_DIGITS);
+                jsonAccount["stake"] = (double) account.get<uint64_t>("stake") / pow(10, TAO::Ledger::NXS_DIGITS);
 
-                    if(nTotal - (nPage * nLimit) > nLimit)
-                        break;
-                }
+                /* Calculate and add the stake rate */
+                uint64_t nTrust = account.get<uint64_t>("trust");
+                jsonAccount["trust"] = nTrust;
+                jsonAccount["stakerate"] = TAO::Ledger::StakeRate(nTrust, (nTrust == 0)) * 100.0;
 
+                jsonRet.push_back(jsonAccount);
 
+                if(nTotal - (nPage * nLimit) > nLimit)
+                    break;
             }
 
 
@@ -63,72 +63,61 @@ namespace TAO
             uint64_t nTotalSigChains = nTotalCrypto;
 
 
-            /* Batch read all trust keys. */
-            std::vector<TAO::Register::Object> vTrust;
-            if(LLD::Register->BatchRead("trust", vTrust, -1))
+            /* Stream all trust keys. */
+            LLD::Register->ForEach<TAO::Register::Object>("trust", [&](TAO::Register::Object& object)
             {
-                /* Check through all trust accounts. */
-                for(auto& object : vTrust)
-                {
-                    /* Skip over invalid objects (THIS SHOULD NEVER HAPPEN). */
-                    if(!object.Parse())
-                        continue;
-
-                    /* Check stake value over 0. */
-                    if(object.get<uint64_t>("stake") == 0)
-                        continue;
-
-                    /* Update stake amount. */
-                    nTotalStake += object.get<uint64_t>("stake");
-                    nTotalTrust += object.get<uint64_t>("trust");
-                    nTotalTrustKeys  ++;
-
-                }
-            }
-
-            /* Batch read all names. */
-            std::vector<TAO::Register::Object> vNames;
-            if(LLD::Register->BatchRead("name", vNames, -1))
+                /* Skip over invalid objects (THIS SHOULD NEVER HAPPEN). */
+                if(!object.Parse())
+                    return true;
+
+                /* Check stake value over 0. */
+                if(object.get<uint64_t>("stake") == 0)
+                    return true;
+
+                /* Update stake amount. */
+                nTotalStake += object.get<uint64_t>("stake");
+                nTotalTrust += object.get<uint64_t>("trust");
+                nTotalTrustKeys  ++;
+
+                return true;
+            });
+
+            /* Stream all names. */
+            LLD::Register->ForEach<TAO::Register::Object>("name", [&](TAO::Register::Object& object)
             {
-                /* Check through all names. */
-                for(auto& object : vNames)
-                {
-                    /* Skip over invalid objects (THIS SHOULD NEVER HAPPEN). */
-                    if(!object.Parse())
-                        continue;
-
-                    /* global */
-                    if(object.get<std::string>("namespace") == TAO::Register::NAMESPACE::GLOBAL)
-                        nTotalGlobalNames ++;
-                    /* namespaced */
-                    else if(object.get<std::string>("namespace") != "" )
-                        nTotalNamespacedNames ++;
-
-                    /* Update count*/
-                    nTotalNames  ++;
-
-                }
-            }
-
-            /* Batch read all object registers. */
-            std::vector<TAO::Register::Object> vObjects;
-            if(LLD::Register->BatchRead("object", vObjects, -1))
+                /* Skip over invalid objects (THIS SHOULD NEVER HAPPEN). */
+                if(!object.Parse())
+                    return true;
+
+                /* global */
+                if(object.get<std::string>("namespace") == TAO::Register::NAMESPACE::GLOBAL)
+                    nTotalGlobalNames ++;
+                /* namespaced */
+                else if(object.get<std::string>("namespace") != "" )
+                    nTotalNamespacedNames ++;
+
+                /* Update count*/
+                nTotalNames  ++;
+
+                return true;
+            });
+
+            /* Stream all object registers. */
+            LLD::Register->ForEach<TAO::Register::Object>("object", [&](TAO::Register::Object& object)
             {
-                /* Check through all names. */
-                for(auto& object : vObjects)
-                {
-                    /* Skip over invalid objects (THIS SHOULD NEVER HAPPEN). */
-                    if(!object.Parse())
-                        continue;
-
-                    /* Check if tokenized*/
-                    if(TAO::Register::Address(object.hashOwner).IsToken() )
-                        nTotalTokenized ++;
-
-                    /* Update count*/
-                    nTotalObjects  ++;
-                }
-            }
+                /* Skip over invalid objects (THIS SHOULD NEVER HAPPEN). */
+                if(!object.Parse())
+                    return true;
+
+                /* Check if tokenized*/
+                if(TAO::Register::Address(object.hashOwner).IsToken() )
+                    nTotalTokenized ++;
+
+                /* Update count*/
+                nTotalObjects  ++;
+
+                return true;
+            });
 
             /* Calculate count of all registers */
             uint64_t nTotalRegisters = nTotalTrustKeys + nTotalNames +nTotalNamespaces + nTotalAccounts + nTotalCrypto
@@ -220,11 +209,17 @@ namespace TAO
         /* Returns the count of registers of the given type in the register DB */
         uint64_t System::count_registers(const std::string& strType)
         {
-            /* Batch read all registers . */
-            std::vector<TAO::Register::Object> vRegisters;
-            LLD::Register->BatchRead(strType, vRegisters, -1);
-            
-            return vRegisters.size();
+            /* Count the records of this type without deserializing them. */
+            uint64_t nCount = 0;
+
+            LLD::SectorCursor cursor;
+            LLD::Register->Scan(cursor, strType, [&](DataStream& ssValue)
+            {
+                ++nCount;
+                return true;
+            });
+
+            return nCount;
         }
     }
 }
@@ -25,6 +25,7 @@ ________________________________________________________________________________
 #include <TAO/API/types/system.h>
 #include <TAO/Ledger/include/chainstate.h>
 #include <TAO/Ledger/types/mempool.h>
+#include <TAO/Ledger/types/sigcache.h>
 
 #include <Util/include/debug.h>
 #include <Util/include/runtime.h>
@@ -115,9 +116,23 @@ namespace TAO
             /* The percentage complete when synchronizing */
             jsonRet["synccomplete"] = (int)TAO::Ledger::ChainState::PercentSynchronized();
 
+            /* The blocks per second and megabytes per second received when synchronizing */
+            if(TAO::Ledger::ChainState::Synchronizing() && LLP::TritiumNode::SYNCTIMER.Running())
+            {
+                const double dElapsed = std::max(uint32_t(1), LLP::TritiumNode::SYNCTIMER.Elapsed());
+                const uint32_t nBlocks = TAO::Ledger::ChainState::nBestHeight.load() - LLP::TritiumNode::nSyncStart.load();
+
+                jsonRet["syncrate"]       = nBlocks / dElapsed;
+                jsonRet["syncthroughput"] = LLP::TritiumNode::nSyncBytes.load() / (dElapsed * 1024 * 1024);
+            }
+
             /* Number of transactions in the node's mempool*/
             jsonRet["txtotal"] = TAO::Ledger::mempool.Size();
 
+            /* Signatures found already verified, and verified for the first time */
+            jsonRet["sigcachehits"]   = TAO::Ledger::sigcache.Hits();
+            jsonRet["sigcachemisses"] = TAO::Ledger::sigcache.Misses();
+
             /* Number of peer connections*/
             uint16_t nConnections = 0;
 
@@ -15,8 +15,11 @@ ________________________________________________________________________________
 #include <LLC/hash/macro.h>
 #include <LLC/include/eckey.h>
 #include <LLC/include/flkey.h>
+#include <LLC/include/random.h>
 #include <LLC/types/bignum.h>
 
+#include <LLD/hash/xxh3.h>
+
 #include <Util/templates/datastream.h>
 #include <Util/include/hex.h>
 #include <Util/include/args.h>
@@ -56,6 +59,8 @@ namespace TAO
         , vMerkleTree    ( )
         , hashMissing    (0)
         , fConflicted    (false)
+        , pProofCache     ( )
+        , pSignatureCache ( )
         {
             SetNull();
         }
@@ -76,6 +81,8 @@ namespace TAO
         , vMerkleTree    (block.vMerkleTree)
         , hashMissing    (block.hashMissing)
         , fConflicted    (block.fConflicted)
+        , pProofCache     (std::atomic_load(&block.pProofCache))
+        , pSignatureCache (std::atomic_load(&block.pSignatureCache))
         {
         }
 
@@ -95,6 +102,8 @@ namespace TAO
         , vMerkleTree    (std::move(block.vMerkleTree))
         , hashMissing    (std::move(block.hashMissing))
         , fConflicted    (std::move(block.fConflicted))
+        , pProofCache     (std::atomic_load(&block.pProofCache))
+        , pSignatureCache (std::atomic_load(&block.pSignatureCache))
         {
         }
 
@@ -117,6 +126,9 @@ namespace TAO
             hashMissing    = block.hashMissing;
             fConflicted    = block.fConflicted;
 
+            std::atomic_store(&pProofCache,     std::atomic_load(&block.pProofCache));
+            std::atomic_store(&pSignatureCache, std::atomic_load(&block.pSignatureCache));
+
             return *this;
         }
 
@@ -140,6 +152,9 @@ namespace TAO
 
             fConflicted    = std::move(block.fConflicted);
 
+            std::atomic_store(&pProofCache,     std::atomic_load(&block.pProofCache));
+            std::atomic_store(&pSignatureCache, std::atomic_load(&block.pSignatureCache));
+
             return *this;
         }
 
@@ -165,6 +180,8 @@ namespace TAO
         , vMerkleTree    ( )
         , hashMissing    (0)
         , fConflicted    (false)
+        , pProofCache     ( )
+        , pSignatureCache ( )
         {
         }
 
@@ -242,10 +259,10 @@ namespace TAO
         {
             /** Hashing template for CPU miners uses nVersion to nBits **/
             if(nChannel == 1)
-                return LLC::SK1024(BEGIN(nVersion), END(nBits));
+                return CachedHash(UBEGIN(nVersion), UEND(nBits), pProofCache);
 
             /** Hashing template for GPU uses nVersion to nNonce **/
-            return LLC::SK1024(BEGIN(nVersion), END(nNonce));
+            return CachedHash(UBEGIN(nVersion), UEND(nNonce), pProofCache);
         }
 
 
@@ -301,16 +318,27 @@ namespace TAO
             uint32_t j = 0;
             for(uint32_t nSize = static_cast<uint32_t>(vtx.size()); nSize > 1; nSize = (nSize + 1) >> 1)
             {
+                /* Copy the left and right leaves of each pair, so a level is hashed as one batch. */
+                const uint32_t nPairs = (nSize + 1) >> 1;
+
+                std::vector<uint8_t> vData(nPairs * 2 * sizeof(uint512_t));
+                std::vector< std::pair<const uint8_t*, const uint8_t*> > vMessages;
                 for(i = 0; i < nSize; i += 2)
                 {
                     /* get the references to the left and right leaves in the merkle tree */
                     const uint512_t& hashLeft  = vMerkleTree[j + i];
                     const uint512_t& hashRight = vMerkleTree[j + std::min(i + 1, nSize - 1)];
 
-                    vMerkleTree.push_back(LLC::SK512(BEGIN(hashLeft),  END(hashLeft),
-                                                     BEGIN(hashRight), END(hashRight)));
+                    uint8_t* pData = &vData[i * sizeof(uint512_t)];
+                    std::copy(BEGIN(hashLeft),  END(hashLeft),  pData);
+                    std::copy(BEGIN(hashRight), END(hashRight), pData + sizeof(uint512_t));
+
+                    vMessages.push_back(std::make_pair(pData, pData + 2 * sizeof(uint512_t)));
                 }
 
+                const std::vector<uint512_t> vLevel = LLC::SK512Batch(vMessages);
+                vMerkleTree.insert(vMerkleTree.end(), vLevel.begin(), vLevel.end());
+
                 j += nSize;
             }
 
@@ -321,30 +349,13 @@ namespace TAO
         /* Generate the Merkle Tree from uint512_t hashes. */
         uint512_t Block::BuildMerkleTree(const std::vector<std::pair<uint8_t, uint512_t> >& vtx) const
         {
-            /* Build the in memory cache of merkle tree. */
-            vMerkleTree.clear();
-            for(const auto& hash : vtx)
-                vMerkleTree.push_back(hash.second);
+            std::vector<uint512_t> vHashes;
+            vHashes.reserve(vtx.size());
 
-            /* Compute the merkle root. */
-            uint32_t i = 0;
-            uint32_t j = 0;
-            for(uint32_t nSize = static_cast<uint32_t>(vtx.size()); nSize > 1; nSize = (nSize + 1) / 2)
-            {
-                for(i = 0; i < nSize; i += 2)
-                {
-                    /* get the references to the left and right leaves in the merkle tree */
-                    const uint512_t& hashLeft  = vMerkleTree[j + i];
-                    const uint512_t& hashRight = vMerkleTree[j + std::min(i + 1, nSize - 1)];
-
-                    vMerkleTree.push_back(LLC::SK512(BEGIN(hashLeft),  END(hashLeft),
-                                                     BEGIN(hashRight), END(hashRight)));
-                }
-
-                j += nSize;
-            }
+            for(const auto& hash : vtx)
+                vHashes.push_back(hash.second);
 
-            return (vMerkleTree.empty() ? 0 : vMerkleTree.back());
+            return BuildMerkleTree(vHashes);
         }
 
 
@@ -574,6 +585,27 @@ namespace TAO
         }
 
 
+        /* Get the SK1024 hash of the given data, reusing the cached hash when the data is the same. */
+        uint1024_t Block::CachedHash(const uint8_t* pbegin, const uint8_t* pend, HashCachePtr& pCache) const
+        {
+            /* Seeded at random so that fingerprint collisions can't be chosen. */
+            static const uint64_t nSeed = LLC::GetRand();
+
+            /* Check the fingerprint of the data against the cached hash. */
+            const uint64_t nFingerprint = XXH64(pbegin, pend - pbegin, nSeed);
+
+            const HashCachePtr pCached = std::atomic_load(&pCache);
+            if(pCached && pCached->nFingerprint == nFingerprint)
+                return pCached->hash;
+
+            /* Publish the hash with the fingerprint of its data, readers see either the old or the new pair. */
+            const uint1024_t hash = LLC::SK1024(pbegin, pend);
+            std::atomic_store(&pCache, std::make_shared<const HashCache<uint1024_t>>(nFingerprint, hash));
+
+            return hash;
+        }
+
+
         /* Generates the StakeHash for this block from a uint256_t hashGenesis */
         uint1024_t Block::StakeHash(const uint256_t& hashGenesis) const
         {
@@ -753,7 +753,7 @@ namespace TAO
                 /* Serialize the data to hash into a stream. */
                 ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << nTime << vOffsets;
 
-                return LLC::SK1024(ss.begin(), ss.end());
+                return CachedHash(ss.data(), ss.data() + ss.size(), pSignatureCache);
             }
 
             /* Create a data stream to get the hash. */
@@ -763,7 +763,7 @@ namespace TAO
             /* Serialize the data to hash into a stream. */
             ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << uint32_t(nTime);
 
-            return LLC::SK1024(ss.begin(), ss.end());
+            return CachedHash(ss.data(), ss.data() + ss.size(), pSignatureCache);
         }
     }
 }
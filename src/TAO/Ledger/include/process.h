@@ -22,6 +22,7 @@ ________________________________________________________________________________
 #include <map>
 #include <mutex>
 #include <memory>
+#include <set>
 
 /* Global TAO namespace. */
 namespace TAO
@@ -50,6 +51,10 @@ namespace TAO
         extern std::map<uint1024_t, std::unique_ptr<TAO::Ledger::Block>> mapOrphans;
 
 
+        /** Orphan blocks that passed their stateless checks when they arrived. **/
+        extern std::set<uint1024_t> setChecked;
+
+
         /** Mutex to protect checking more than one block at a time. **/
         extern std::mutex PROCESSING_MUTEX;
 
@@ -63,7 +68,10 @@ namespace TAO
 
         /** Process Block Function
          *
-         *  Processes a block incoming over the network.
+         *  Processes a block incoming over the network. The stateless checks run
+         *  before the processing lock is taken, so blocks arriving from different
+         *  nodes are checked in parallel ahead of the chain tip, and only accepting
+         *  and connecting blocks is serialized.
          *
          *  @param[in] block The block being processed
          *  @param[out] pnode The node that block came from.
@@ -0,0 +1,106 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_TAO_LEDGER_INCLUDE_SCHEDULE_H
+#define NEXUS_TAO_LEDGER_INCLUDE_SCHEDULE_H
+
+#include <LLC/types/uint1024.h>
+
+#include <set>
+#include <utility>
+#include <vector>
+
+class thread_pool;
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /* Forward Declarations */
+        class Transaction;
+
+
+        /** ConnectPool
+         *
+         *  Get the worker pool for connecting independent transactions of a block,
+         *  started on first use with -connectthreads workers.
+         *
+         *  @return The pool, or nullptr if blocks are connected on one thread.
+         *
+         **/
+        thread_pool* ConnectPool();
+
+
+        /** PrefetchTx
+         *
+         *  Read the transactions of a block into the ledger and legacy caches, with
+         *  one batched read for each database, before they are read one at a time.
+         *
+         *  @param[in] vtx The types and hashes of the block's transactions.
+         *  @param[in] fMempool Flag to skip transactions that are read from the memory pool.
+         *
+         **/
+        void PrefetchTx(const std::vector< std::pair<uint8_t, uint512_t> >& vtx, const bool fMempool);
+
+
+        /** MovedRegisters
+         *
+         *  Get the registers a transaction creates or changes the owner of. Events
+         *  for these go to an owner that is only known once the block is connected.
+         *
+         *  @param[in] tx The transaction to check.
+         *  @param[out] setMoved The registers created, transferred, or claimed.
+         *
+         **/
+        void MovedRegisters(const Transaction& tx, std::set<uint256_t>& setMoved);
+
+
+        /** ConflictKeys
+         *
+         *  Get the keys a transaction reads or writes when connected: its sigchain,
+         *  its own hash, the registers its contracts touch, the owners that receive
+         *  its events, and the transactions it claims from. Transactions that share
+         *  no keys can be connected in any order.
+         *
+         *  @param[in] tx The transaction to check.
+         *  @param[in] hash The hash of the transaction.
+         *  @param[in] setMoved The registers that change owner in the same run of transactions.
+         *  @param[out] setKeys The conflict keys.
+         *
+         *  @return False if the transaction has contracts that can't be keyed and must connect on its own.
+         *
+         **/
+        bool ConflictKeys(const Transaction& tx, const uint512_t& hash,
+                          const std::set<uint256_t>& setMoved, std::set<uint512_t>& setKeys);
+
+
+        /** ConflictGroups
+         *
+         *  Group transactions that share conflict keys, directly or through others.
+         *
+         *  @param[in] vKeys The conflict keys of each transaction, in block order.
+         *
+         *  @return The groups as positions into vKeys, each in block order, ordered by their first transaction.
+         *
+         **/
+        std::vector< std::vector<uint32_t> > ConflictGroups(const std::vector< std::set<uint512_t> >& vKeys);
+
+    }
+}
+
+#endif
@@ -83,8 +83,6 @@ namespace TAO
         /* Accepts a transaction with validation rules. */
         bool Mempool::Accept(const TAO::Ledger::Transaction& tx, LLP::TritiumNode* pnode)
         {
-            RLOCK(MUTEX);
-
             /* Get the transaction hash. */
             uint512_t hashTx = tx.GetHash();
 
@@ -109,10 +107,16 @@ namespace TAO
             if(tx.IsCoinStake())
                 return debug::error(FUNCTION, "coinstake ", hashTx.SubString(), " not accepted in pool");
 
-            /* Check that the transaction is in a valid state. */
+            /* Check that the transaction is in a valid state outside of the pool lock, on the caller's thread so callers verify in parallel. */
             if(!tx.Check())
                 return debug::error(FUNCTION, "tx ", hashTx.SubString(), " REJECTED: ", debug::GetLastError());
 
+            RLOCK(MUTEX);
+
+            /* Check for the transaction being accepted by another thread while verifying. */
+            if(LLD::Ledger->HasTx(hashTx, FLAGS::MEMPOOL))
+                return false;
+
             /* Check for orphans and conflicts when not first transaction. */
             if(!tx.IsFirst())
             {
@@ -29,6 +29,10 @@ namespace TAO
         std::map<uint1024_t, std::unique_ptr<TAO::Ledger::Block>> mapOrphans;
 
 
+        /* Orphan blocks that passed their stateless checks when they arrived. */
+        std::set<uint1024_t> setChecked;
+
+
         /* Mutex to protect checking more than one block at a time. */
         std::mutex PROCESSING_MUTEX;
 
@@ -48,14 +52,51 @@ namespace TAO
         /* Processes a block incoming over the network. */
         void Process(const TAO::Ledger::Block& block, uint8_t &nStatus)
         {
-            LOCK(PROCESSING_MUTEX);
-
             /* Get the block's hash. */
             const uint1024_t hashBlock = block.GetHash();
 
+            /* Run the stateless checks outside of the processing lock. */
+            bool fChecked = false;
+            if(!config::fClient.load())
+            {
+                try
+                {
+                    /* Check for a block that is already in the database. */
+                    if(LLD::Ledger->HasBlock(hashBlock))
+                    {
+                        nStatus |= PROCESS::DUPLICATE;
+                        return;
+                    }
+
+                    /* Blocks with missing transactions are handled under the lock. */
+                    fChecked = block.Check();
+                    if(!fChecked && block.vMissing.size() == 0)
+                    {
+                        nStatus |= PROCESS::REJECTED;
+                        return;
+                    }
+
+                    block.vMissing.clear();
+                }
+                catch(const std::exception& e)
+                {
+                    nStatus |= PROCESS::REJECTED;
+                    return;
+                }
+            }
+
+            LOCK(PROCESSING_MUTEX);
+
             /* We want to catch any exceptions that were thrown during processing and set REJECTED if exceptions are thrown. */
             try
             {
+                /* Check for a block that another node delivered while this one was checked. */
+                if(fChecked && LLD::Ledger->HasBlock(hashBlock))
+                {
+                    nStatus |= PROCESS::DUPLICATE;
+                    return;
+                }
+
                 /* Check for orphan. */
                 if(!LLD::Ledger->HasBlock(block.hashPrevBlock))
                 {
@@ -79,6 +120,10 @@ namespace TAO
                         setIncomplete.erase(block.hashPrevBlock);
                         setIncomplete.insert(hashBlock); //insert this block as current head of incomplete chain
 
+                        /* Skip the checks when the orphan is processed. */
+                        if(fChecked)
+                            setChecked.insert(hashBlock);
+
                         /* Debug output. */
                         debug::log(0, FUNCTION, "INCOMPLETE height=", block.nHeight, " prev=", block.hashPrevBlock.SubString());
 
@@ -108,6 +153,10 @@ namespace TAO
                             std::unique_ptr<TAO::Ledger::Block>(block.Clone()))
                         );
 
+                        /* Skip the checks when the orphan is processed. */
+                        if(fChecked)
+                            setChecked.insert(hashBlock);
+
                         /* Debug output. */
                         debug::log(0, FUNCTION, "ORPHAN height=", block.nHeight, " prev=", block.hashPrevBlock.SubString());
                     }
@@ -118,7 +167,7 @@ namespace TAO
                 }
 
                 /* Check if the block is valid. */
-                if(!block.Check())
+                if(!fChecked && !block.Check())
                 {
                     /* Check for missing transactions. */
                     if(block.vMissing.size() == 0)
@@ -209,8 +258,8 @@ namespace TAO
                     /* Debug output. */
                     debug::log(0, FUNCTION, "processing ORPHAN prev=", hashPrev.SubString(), " size=", mapOrphans.size());
 
-                    /* Check if the block is valid. */
-                    if(!pOrphan->Check())
+                    /* Check if the block is valid, unless it was checked when it arrived. */
+                    if(!setChecked.count(hashPrev) && !pOrphan->Check())
                     {
                         /* Check for missing transactions. */
                         if(pOrphan->vMissing.size() == 0)
@@ -231,6 +280,7 @@ namespace TAO
                         return;
 
                     /* Erase orphans from map. */
+                    setChecked.erase(hashPrev);
                     mapOrphans.erase(hash);
                     hash = hashPrev;
                 }
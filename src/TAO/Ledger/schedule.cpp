@@ -0,0 +1,402 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/global.h>
+
+#include <TAO/Operation/include/enum.h>
+#include <TAO/Operation/types/contract.h>
+
+#include <TAO/Register/types/state.h>
+
+#include <TAO/Ledger/include/enum.h>
+#include <TAO/Ledger/include/schedule.h>
+#include <TAO/Ledger/types/mempool.h>
+#include <TAO/Ledger/types/transaction.h>
+
+#include <Util/include/args.h>
+#include <Util/include/thread_pool.h>
+
+#include <map>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /* Key shared by every register creation, since creates check other registers exist. */
+        const uint512_t CREATE_KEY = 1;
+
+
+        /* Get the worker pool for connecting independent transactions of a block. */
+        thread_pool* ConnectPool()
+        {
+            /* Connect on one thread unless workers are configured. */
+            static const uint32_t nThreads = static_cast<uint32_t>(config::GetArg("-connectthreads", 0));
+            if(nThreads < 2)
+                return nullptr;
+
+            /* Started on first use, and joined at exit. */
+            static thread_pool pool(nThreads);
+
+            return &pool;
+        }
+
+
+        /* Read the transactions of a block into the ledger and legacy caches. */
+        void PrefetchTx(const std::vector< std::pair<uint8_t, uint512_t> >& vtx, const bool fMempool)
+        {
+            /* Clients read transactions from the client database. */
+            if(config::fClient.load())
+                return;
+
+            /* Collect the keys of the transactions read from disk. */
+            std::vector<uint512_t> vTritium;
+            std::vector< std::pair<std::string, uint512_t> > vLegacy;
+            for(const auto& proof : vtx)
+            {
+                /* Skip transactions in the memory pool. */
+                if(fMempool && mempool.Has(proof.second))
+                    continue;
+
+                if(proof.first == TRANSACTION::TRITIUM)
+                    vTritium.push_back(proof.second);
+
+                else if(proof.first == TRANSACTION::LEGACY)
+                    vLegacy.push_back(std::make_pair(std::string("tx"), proof.second));
+            }
+
+            /* Read each database in one batch. */
+            if(!vTritium.empty())
+                LLD::Ledger->ReadMany(vTritium);
+
+            if(!vLegacy.empty())
+                LLD::Legacy->ReadMany(vLegacy);
+        }
+
+
+        /* Get the registers a transaction creates or changes the owner of. */
+        void MovedRegisters(const Transaction& tx, std::set<uint256_t>& setMoved)
+        {
+            for(uint32_t n = 0; n < tx.Size(); ++n)
+            {
+                const TAO::Operation::Contract& contract = tx[n];
+
+                try
+                {
+                    /* Skip past a condition to the primitive. */
+                    contract.Reset();
+
+                    uint8_t nOP = 0;
+                    contract >> nOP;
+
+                    if(nOP == TAO::Operation::OP::CONDITION)
+                        contract >> nOP;
+
+                    switch(nOP)
+                    {
+                        /* The address comes first. */
+                        case TAO::Operation::OP::CREATE:
+                        case TAO::Operation::OP::TRANSFER:
+                        {
+                            uint256_t hashAddress = 0;
+                            contract >> hashAddress;
+
+                            setMoved.insert(hashAddress);
+                            break;
+                        }
+
+                        /* The address follows the claimed transfer. */
+                        case TAO::Operation::OP::CLAIM:
+                        {
+                            uint512_t hashTx = 0;
+                            contract >> hashTx;
+
+                            uint32_t nContract = 0;
+                            contract >> nContract;
+
+                            uint256_t hashAddress = 0;
+                            contract >> hashAddress;
+
+                            setMoved.insert(hashAddress);
+                            break;
+                        }
+                    }
+                }
+                catch(const std::exception& e)
+                {
+                    /* Malformed contracts fail when connected on their own. */
+                }
+            }
+        }
+
+
+        /* Add the owner of a register, who receives events for it. */
+        bool OwnerKey(const uint256_t& hashAddress, const std::set<uint256_t>& setMoved, std::set<uint512_t>& setKeys)
+        {
+            /* The owner isn't known until the transactions before are connected. */
+            if(setMoved.count(hashAddress))
+                return false;
+
+            TAO::Register::State state;
+            if(LLD::Register->ReadState(hashAddress, state, FLAGS::BLOCK))
+                setKeys.insert(state.hashOwner);
+
+            return true;
+        }
+
+
+        /* Get the keys a transaction reads or writes when connected. */
+        bool ConflictKeys(const Transaction& tx, const uint512_t& hash,
+                          const std::set<uint256_t>& setMoved, std::set<uint512_t>& setKeys)
+        {
+            /* Coinstakes depend on the pool fees of the transactions before them. */
+            if(tx.IsCoinStake())
+                return false;
+
+            /* Every transaction touches its sigchain and is claimed from by its hash. */
+            setKeys.insert(tx.hashGenesis);
+            setKeys.insert(hash);
+
+            for(uint32_t n = 0; n < tx.Size(); ++n)
+            {
+                const TAO::Operation::Contract& contract = tx[n];
+
+                try
+                {
+                    /* Get the primitive, validations run conditions that can read any register. */
+                    contract.Reset();
+
+                    uint8_t nOP = 0;
+                    contract >> nOP;
+
+                    if(nOP == TAO::Operation::OP::CONDITION)
+                        contract >> nOP;
+
+                    switch(nOP)
+                    {
+                        /* Register updates by address. */
+                        case TAO::Operation::OP::WRITE:
+                        case TAO::Operation::OP::APPEND:
+                        case TAO::Operation::OP::FEE:
+                        {
+                            uint256_t hashAddress = 0;
+                            contract >> hashAddress;
+
+                            setKeys.insert(hashAddress);
+                            break;
+                        }
+
+                        /* Creates also check that other registers exist. */
+                        case TAO::Operation::OP::CREATE:
+                        {
+                            uint256_t hashAddress = 0;
+                            contract >> hashAddress;
+
+                            setKeys.insert(hashAddress);
+                            setKeys.insert(CREATE_KEY);
+                            break;
+                        }
+
+                        /* Transfers write an event for the recipient. */
+                        case TAO::Operation::OP::TRANSFER:
+                        {
+                            uint256_t hashAddress = 0;
+                            contract >> hashAddress;
+
+                            uint256_t hashTransfer = 0;
+                            contract >> hashTransfer;
+
+                            setKeys.insert(hashAddress);
+                            setKeys.insert(hashTransfer);
+                            break;
+                        }
+
+                        /* Debits write an event for the owner of the recipient. */
+                        case TAO::Operation::OP::DEBIT:
+                        {
+                            uint256_t hashFrom = 0;
+                            contract >> hashFrom;
+
+                            uint256_t hashTo = 0;
+                            contract >> hashTo;
+
+                            setKeys.insert(hashFrom);
+                            setKeys.insert(hashTo);
+
+                            if(!OwnerKey(hashTo, setMoved, setKeys))
+                                return false;
+
+                            break;
+                        }
+
+                        /* Coinbases write an event for the recipient. */
+                        case TAO::Operation::OP::COINBASE:
+                        {
+                            uint256_t hashGenesis = 0;
+                            contract >> hashGenesis;
+
+                            setKeys.insert(hashGenesis);
+                            break;
+                        }
+
+                        /* Claims depend on the transfer, which must have no conditions. */
+                        case TAO::Operation::OP::CLAIM:
+                        {
+                            uint512_t hashTx = 0;
+                            contract >> hashTx;
+
+                            uint32_t nContract = 0;
+                            contract >> nContract;
+
+                            uint256_t hashAddress = 0;
+                            contract >> hashAddress;
+
+                            const TAO::Operation::Contract transfer = LLD::Ledger->ReadContract(hashTx, nContract, FLAGS::BLOCK);
+                            if(!transfer.Empty(TAO::Operation::Contract::CONDITIONS))
+                                return false;
+
+                            setKeys.insert(hashTx);
+                            setKeys.insert(hashAddress);
+                            break;
+                        }
+
+                        /* Credits depend on the debit or coinbase, and read the proof and the recipient's owner. */
+                        case TAO::Operation::OP::CREDIT:
+                        {
+                            uint512_t hashTx = 0;
+                            contract >> hashTx;
+
+                            uint32_t nContract = 0;
+                            contract >> nContract;
+
+                            uint256_t hashAddress = 0;
+                            contract >> hashAddress;
+
+                            uint256_t hashProof = 0;
+                            contract >> hashProof;
+
+                            setKeys.insert(hashTx);
+                            setKeys.insert(hashAddress);
+                            setKeys.insert(hashProof);
+
+                            /* Check the contract being credited. */
+                            const TAO::Operation::Contract debit = LLD::Ledger->ReadContract(hashTx, nContract, FLAGS::BLOCK);
+                            if(!debit.Empty(TAO::Operation::Contract::CONDITIONS))
+                                return false;
+
+                            debit.Reset();
+
+                            uint8_t nType = 0;
+                            debit >> nType;
+
+                            if(nType == TAO::Operation::OP::COINBASE)
+                                break;
+
+                            if(nType != TAO::Operation::OP::DEBIT)
+                                return false;
+
+                            uint256_t hashFrom = 0;
+                            debit >> hashFrom;
+
+                            uint256_t hashTo = 0;
+                            debit >> hashTo;
+
+                            setKeys.insert(hashFrom);
+                            setKeys.insert(hashTo);
+
+                            if(!OwnerKey(hashTo, setMoved, setKeys))
+                                return false;
+
+                            break;
+                        }
+
+                        /* Trust, legacy, migrate, authorize and validate are connected on their own. */
+                        default:
+                            return false;
+                    }
+                }
+                catch(const std::exception& e)
+                {
+                    /* Malformed contracts fail when connected on their own. */
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+
+        /* Group transactions that share conflict keys, directly or through others. */
+        std::vector< std::vector<uint32_t> > ConflictGroups(const std::vector< std::set<uint512_t> >& vKeys)
+        {
+            /* Union find over transaction positions. */
+            std::vector<uint32_t> vParent(vKeys.size());
+            for(uint32_t n = 0; n < vParent.size(); ++n)
+                vParent[n] = n;
+
+            auto fnRoot = [&vParent](uint32_t n)
+            {
+                while(vParent[n] != n)
+                {
+                    vParent[n] = vParent[vParent[n]];
+                    n = vParent[n];
+                }
+
+                return n;
+            };
+
+            /* Join each transaction with the first one that used each of its keys. */
+            std::map<uint512_t, uint32_t> mapFirst;
+            for(uint32_t n = 0; n < vKeys.size(); ++n)
+            {
+                for(const auto& hashKey : vKeys[n])
+                {
+                    auto it = mapFirst.find(hashKey);
+                    if(it == mapFirst.end())
+                    {
+                        mapFirst[hashKey] = n;
+                        continue;
+                    }
+
+                    /* Keep the earlier position as root so groups order by their first transaction. */
+                    const uint32_t nRoot  = fnRoot(n);
+                    const uint32_t nOther = fnRoot(it->second);
+                    if(nRoot < nOther)
+                        vParent[nOther] = nRoot;
+                    else
+                        vParent[nRoot] = nOther;
+                }
+            }
+
+            /* Collect the groups in block order. */
+            std::vector< std::vector<uint32_t> > vGroups;
+            std::map<uint32_t, uint32_t> mapGroup;
+            for(uint32_t n = 0; n < vKeys.size(); ++n)
+            {
+                const uint32_t nRoot = fnRoot(n);
+                if(!mapGroup.count(nRoot))
+                {
+                    mapGroup[nRoot] = static_cast<uint32_t>(vGroups.size());
+                    vGroups.push_back(std::vector<uint32_t>());
+                }
+
+                vGroups[mapGroup[nRoot]].push_back(n);
+            }
+
+            return vGroups;
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <TAO/Ledger/types/sigcache.h>
+
+#include <Util/include/args.h>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+        SignatureCache sigcache;
+
+
+        /* Default Constructor. */
+        SignatureCache::SignatureCache()
+        : cacheVerified ( )
+        , nHits         (0)
+        , nMisses       (0)
+        {
+        }
+
+
+        /* Check if a signature was verified. */
+        bool SignatureCache::Has(const uint512_t& hashTx, const uint256_t& hashKey)
+        {
+            /* Count the lookup as a hit or miss, outside the shard lock. */
+            const bool fHas = cacheVerified.has(std::make_pair(hashTx, hashKey));
+            if(fHas)
+                ++nHits;
+            else
+                ++nMisses;
+
+            return fHas;
+        }
+
+
+        /* Add a verified signature. */
+        void SignatureCache::Add(const uint512_t& hashTx, const uint256_t& hashKey)
+        {
+            /* The bound over all shards, read on first use. */
+            static const uint32_t nMax = static_cast<uint32_t>(config::GetArg("-maxsigcache", 100000));
+
+            cacheVerified.put(std::make_pair(hashTx, hashKey), true, nMax);
+        }
+
+
+        /* Remove the verified signatures of a transaction. */
+        void SignatureCache::Evict(const uint512_t& hashTx)
+        {
+            /* Erase every key verified for the transaction, from the cache and its eviction order. */
+            cacheVerified.erase_range(std::make_pair(hashTx, uint256_t(0)),
+                [&hashTx](const std::pair<uint512_t, uint256_t>& pairKey)
+                {
+                    return pairKey.first == hashTx;
+                });
+        }
+
+
+        /* Get the number of lookups that found a verified signature. */
+        uint64_t SignatureCache::Hits() const
+        {
+            return nHits.load();
+        }
+
+
+        /* Get the number of lookups that missed. */
+        uint64_t SignatureCache::Misses() const
+        {
+            return nMisses.load();
+        }
+
+
+        /* Get the number of verified signatures that are cached. */
+        uint64_t SignatureCache::Size()
+        {
+            return cacheVerified.size();
+        }
+    }
+}
@@ -16,6 +16,7 @@ ________________________________________________________________________________
 #include <LLC/hash/macro.h>
 #include <LLC/hash/argon2.h>
 
+#include <LLC/include/argon2_pool.h>
 #include <LLC/include/flkey.h>
 #include <LLC/include/eckey.h>
 
@@ -128,8 +129,8 @@ namespace TAO
                 /* Algorithm Version */
                 ARGON2_VERSION_13,
 
-                /* Custom memory allocation / deallocation functions. */
-                NULL, NULL,
+                /* Reuse the memory of earlier hashes. */
+                LLC::Argon2Allocate, LLC::Argon2Free,
 
                 /* By default only internal memory is cleared (pwd is not wiped) */
                 ARGON2_DEFAULT_FLAGS
@@ -237,8 +238,8 @@ namespace TAO
                 /* Algorithm Version */
                 ARGON2_VERSION_13,
 
-                /* Custom memory allocation / deallocation functions. */
-                NULL, NULL,
+                /* Reuse the memory of earlier hashes. */
+                LLC::Argon2Allocate, LLC::Argon2Free,
 
                 /* By default only internal memory is cleared (pwd is not wiped) */
                 ARGON2_DEFAULT_FLAGS
@@ -322,8 +323,8 @@ namespace TAO
                 /* Algorithm Version */
                 ARGON2_VERSION_13,
 
-                /* Custom memory allocation / deallocation functions. */
-                NULL, NULL,
+                /* Reuse the memory of earlier hashes. */
+                LLC::Argon2Allocate, LLC::Argon2Free,
 
                 /* By default only internal memory is cleared (pwd is not wiped) */
                 ARGON2_DEFAULT_FLAGS
@@ -405,8 +406,8 @@ namespace TAO
                 /* Algorithm Version */
                 ARGON2_VERSION_13,
 
-                /* Custom memory allocation / deallocation functions. */
-                NULL, NULL,
+                /* Reuse the memory of earlier hashes. */
+                LLC::Argon2Allocate, LLC::Argon2Free,
 
                 /* By default only internal memory is cleared (pwd is not wiped) */
                 ARGON2_DEFAULT_FLAGS
@@ -470,8 +471,8 @@ namespace TAO
                 /* Algorithm Version */
                 ARGON2_VERSION_13,
 
-                /* Custom memory allocation / deallocation functions. */
-                NULL, NULL,
+                /* Reuse the memory of earlier hashes. */
+                LLC::Argon2Allocate, LLC::Argon2Free,
 
                 /* By default only internal memory is cleared (pwd is not wiped) */
                 ARGON2_DEFAULT_FLAGS
@@ -766,7 +767,7 @@ namespace TAO
             uint8_t nType = hashCheck.GetType();
 
             /* Grab hash of incoming pubkey and set its type. */
-            uint256_t hashPubKey = LLC::SK256(vchPubKey);
+            uint256_t hashPubKey = LLC::SK256(vchPubKey, true);
             hashPubKey.SetType(nType);
 
             /* Check the public key to expected authorization key. */
@@ -206,8 +206,6 @@ namespace TAO
         /* Accepts a transaction with validation rules. */
         bool Stakepool::Accept(const TAO::Ledger::Transaction& tx, LLP::TritiumNode* pnode)
         {
-            RLOCK(MUTEX);
-
             /* Get the transaction hash. */
             uint512_t hashTx = tx.GetHash();
 
@@ -220,10 +218,12 @@ namespace TAO
             if(!(tx.IsTrustPool() || tx.IsGenesisPool()))
                 return debug::error(FUNCTION, "Pooled stake tx ", hashTx.SubString(), " REJECTED: not a pooled staking coinstake");
 
-            /* Check that the transaction is in a valid state. */
+            /* Check that the transaction is in a valid state, outside of the pool lock. */
             if(!tx.Check())
                 return debug::error(FUNCTION, "Pooled stake tx ", hashTx.SubString(), " REJECTED: ", debug::GetLastError());
 
+            RLOCK(MUTEX);
+
             /* Check memory and disk for previous transaction. */
             if(!LLD::Ledger->HasTx(tx.hashPrevTx, FLAGS::MEMPOOL))
             {
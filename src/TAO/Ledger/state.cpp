@@ -40,13 +40,16 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/supply.h>
 #include <TAO/Ledger/include/timelocks.h>
 #include <TAO/Ledger/include/retarget.h>
+#include <TAO/Ledger/include/schedule.h>
 #include <TAO/Ledger/include/dispatch.h>
 
 #include <TAO/Ledger/types/genesis.h>
 #include <TAO/Ledger/types/mempool.h>
+#include <TAO/Ledger/types/sigcache.h>
 #include <TAO/Ledger/types/client.h>
 
 #include <Util/include/string.h>
+#include <Util/include/thread_pool.h>
 
 
 
@@ -1010,9 +1013,12 @@ namespace TAO
                     }
                 }
 
-                /* Delete from mempool. */
+                /* Delete from mempool, and drop the verified signatures that won't be checked again. */
                 for(const auto& proof : vDelete)
+                {
                     mempool.Remove(proof.second);
+                    sigcache.Evict(proof.second);
+                }
 
 
 
@@ -1082,9 +1088,20 @@ namespace TAO
             uint64_t nPoolFeeTotal = 0;
             uint512_t hashBlockFinder = vtx.back().second; //block finder is last in vtx
 
+            /* Read the block's transactions from disk in one batch. */
+            PrefetchTx(vtx, false);
+
+            /* Runs of independent transactions connected ahead on the connect pool. */
+            thread_pool* ppool = ConnectPool();
+            std::vector<Transaction> vRun;
+            uint32_t nRunBegin = 0;
+            uint32_t nRunEnd   = 0;
+
             /* Check through all the transactions. */
-            for(const auto& proof : vtx)
+            for(uint32_t nIndex = 0; nIndex < vtx.size(); ++nIndex)
             {
+                const auto& proof = vtx[nIndex];
+
                 /* Only work on tritium transactions for now. */
                 if(proof.first == TRANSACTION::TRITIUM)
                 {
@@ -1094,6 +1111,36 @@ namespace TAO
                     /* Get the transaction hash. */
                     const uint512_t& hash = proof.second;
 
+                    /* Connect the run of transactions from here that can be scheduled by conflict keys. */
+                    if(ppool && nIndex >= nRunEnd)
+                    {
+                        if(!ConnectRun(nIndex, vRun, ppool))
+                            return false;
+
+                        nRunBegin = nIndex;
+                        nRunEnd   = nIndex + std::max(uint32_t(1), static_cast<uint32_t>(vRun.size()));
+                    }
+
+                    /* Finish transactions of the run in block order. */
+                    if(nIndex - nRunBegin < vRun.size())
+                    {
+                        const Transaction& tx = vRun[nIndex - nRunBegin];
+
+                        /* Add legacy transactions to the wallet where appropriate */
+                        #ifndef NO_WALLET
+                        Legacy::Wallet::GetInstance().AddToWalletIfInvolvingMe(tx, *this, true);
+                        #endif
+
+                        /* Accumulate the fees. */
+                        nFees += tx.Fees();
+
+                        /* Keep track of total contracts processed. */
+                        nTotalContracts += tx.Size();
+                        swContract.stop();
+
+                        continue;
+                    }
+
                     /* Check for existing indexes. */
                     if(LLD::Ledger->HasIndex(hash))
                         return debug::error(FUNCTION, "transaction overwrites not allowed");
@@ -1255,6 +1302,132 @@ namespace TAO
         }
 
 
+        /* Connect the run of tritium transactions from a position in vtx that can be ordered by conflict keys. */
+        bool BlockState::ConnectRun(const uint32_t nIndex, std::vector<Transaction>& vRun, thread_pool* ppool) const
+        {
+            vRun.clear();
+
+            /* Read ahead to the next transaction that isn't tritium. */
+            std::vector<uint512_t> vHashes;
+            for(uint32_t n = nIndex; n < vtx.size() && vtx[n].first == TRANSACTION::TRITIUM; ++n)
+            {
+                /* Leave read errors to the sequential connect. */
+                Transaction tx;
+                if(!LLD::Ledger->ReadTx(vtx[n].second, tx))
+                    break;
+
+                vRun.push_back(tx);
+                vHashes.push_back(vtx[n].second);
+            }
+
+            /* Registers that change owner within the run. */
+            std::set<uint256_t> setMoved;
+            for(const auto& tx : vRun)
+                MovedRegisters(tx, setMoved);
+
+            /* Stop the run at the first transaction that can't be keyed. */
+            std::vector< std::set<uint512_t> > vKeys;
+            for(uint32_t n = 0; n < vRun.size(); ++n)
+            {
+                std::set<uint512_t> setKeys;
+                if(!ConflictKeys(vRun[n], vHashes[n], setMoved, setKeys))
+                    break;
+
+                vKeys.push_back(setKeys);
+            }
+
+            /* A single transaction gains nothing from the pool. */
+            if(vKeys.size() < 2)
+            {
+                vRun.clear();
+                return true;
+            }
+
+            vRun.resize(vKeys.size());
+
+            /* Connect each group in block order, groups share no keys so they can run in any order. */
+            const std::vector< std::vector<uint32_t> > vGroups = ConflictGroups(vKeys);
+            std::vector<uint8_t> vConnected(vGroups.size(), 0);
+
+            const uint1024_t hashBlock = GetHash();
+
+            for(uint32_t nGroup = 0; nGroup < vGroups.size(); ++nGroup)
+            {
+                ppool->add([this, &vGroups, &vRun, &vHashes, &vConnected, &hashBlock, nGroup]
+                {
+                    /* Exceptions must not escape the worker thread. */
+                    try
+                    {
+                        for(const auto& n : vGroups[nGroup])
+                        {
+                            const Transaction& tx = vRun[n];
+                            const uint512_t& hash = vHashes[n];
+
+                            /* Check for existing indexes. */
+                            if(LLD::Ledger->HasIndex(hash))
+                            {
+                                debug::error(FUNCTION, "transaction overwrites not allowed");
+                                return;
+                            }
+
+                            if(config::nVerbose >= 3)
+                                tx.print();
+
+                            /* Check the ledger rules for sigchain at end. */
+                            if(!tx.IsFirst())
+                            {
+                                /* Check for the last hash. */
+                                uint512_t hashLast = 0;
+                                if(!LLD::Ledger->ReadLast(tx.hashGenesis, hashLast))
+                                {
+                                    debug::error(FUNCTION, "failed to read last on non-genesis");
+                                    return;
+                                }
+
+                                /* Check that the last transaction is correct. */
+                                if(tx.hashPrevTx != hashLast)
+                                {
+                                    debug::error(FUNCTION, "last hash hash mismatch");
+                                    return;
+                                }
+                            }
+
+                            /* Verify the Ledger Pre-States. */
+                            if(!tx.Verify(FLAGS::BLOCK))
+                                return;
+
+                            /* Connect the transaction. */
+                            if(!tx.Connect(FLAGS::BLOCK, this))
+                            {
+                                debug::error(FUNCTION, "failed to connect transaction");
+                                return;
+                            }
+
+                            /* Write the indexing entries, later transactions of the group may depend on it. */
+                            LLD::Ledger->IndexBlock(hash, hashBlock);
+                        }
+
+                        vConnected[nGroup] = 1;
+                    }
+                    catch(const std::exception& e)
+                    {
+                        debug::error(FUNCTION, e.what());
+                    }
+                });
+            }
+            ppool->wait();
+
+            /* Fail the block if any group failed. */
+            for(const auto& fConnected : vConnected)
+                if(!fConnected)
+                    return debug::error(FUNCTION, "failed to connect scheduled transactions");
+
+            debug::log(3, FUNCTION, "connected ", vRun.size(), " transactions in ", vGroups.size(), " groups");
+
+            return true;
+        }
+
+
         /** Disconnect a block state from the chain. **/
         bool BlockState::Disconnect()
         {
@@ -1533,7 +1706,7 @@ namespace TAO
                 /* Serialize the data to hash into a stream. */
                 ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << nTime << vOffsets;
 
-                return LLC::SK1024(ss.begin(), ss.end());
+                return CachedHash(ss.data(), ss.data() + ss.size(), pSignatureCache);
             }
 
             /* Create a data stream to get the hash. */
@@ -1543,7 +1716,7 @@ namespace TAO
             /* Serialize the data to hash into a stream. */
             ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << uint32_t(nTime);
 
-            return LLC::SK1024(ss.begin(), ss.end());
+            return CachedHash(ss.data(), ss.data() + ss.size(), pSignatureCache);
         }
 
 
@@ -18,8 +18,10 @@ ________________________________________________________________________________
 
 #include <LLC/include/flkey.h>
 #include <LLC/include/eckey.h>
+#include <LLC/include/random.h>
 
 #include <LLD/include/global.h>
+#include <LLD/hash/xxh3.h>
 
 #include <LLP/include/version.h>
 
@@ -46,6 +48,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/timelocks.h>
 #include <TAO/Ledger/types/merkle.h>
 #include <TAO/Ledger/types/mempool.h>
+#include <TAO/Ledger/types/sigcache.h>
 
 #include <Util/include/debug.h>
 #include <Util/include/runtime.h>
@@ -72,6 +75,7 @@ namespace TAO
         , nNextType    (0)
         , vchPubKey    ( )
         , vchSig       ( )
+        , pHashCache   ( )
         {
         }
 
@@ -90,6 +94,7 @@ namespace TAO
         , nNextType    (tx.nNextType)
         , vchPubKey    (tx.vchPubKey)
         , vchSig       (tx.vchSig)
+        , pHashCache   (std::atomic_load(&tx.pHashCache))
         {
         }
 
@@ -108,6 +113,7 @@ namespace TAO
         , nNextType    (std::move(tx.nNextType))
         , vchPubKey    (std::move(tx.vchPubKey))
         , vchSig       (std::move(tx.vchSig))
+        , pHashCache   (std::atomic_load(&tx.pHashCache))
         {
         }
 
@@ -126,6 +132,7 @@ namespace TAO
         , nNextType    (tx.nNextType)
         , vchPubKey    (tx.vchPubKey)
         , vchSig       (tx.vchSig)
+        , pHashCache   (std::atomic_load(&tx.pHashCache))
         {
         }
 
@@ -144,6 +151,7 @@ namespace TAO
         , nNextType    (std::move(tx.nNextType))
         , vchPubKey    (std::move(tx.vchPubKey))
         , vchSig       (std::move(tx.vchSig))
+        , pHashCache   (std::atomic_load(&tx.pHashCache))
         {
         }
 
@@ -164,6 +172,8 @@ namespace TAO
             vchPubKey    = tx.vchPubKey;
             vchSig       = tx.vchSig;
 
+            std::atomic_store(&pHashCache, std::atomic_load(&tx.pHashCache));
+
             return *this;
         }
 
@@ -184,6 +194,8 @@ namespace TAO
             vchPubKey    = std::move(tx.vchPubKey);
             vchSig       = std::move(tx.vchSig);
 
+            std::atomic_store(&pHashCache, std::atomic_load(&tx.pHashCache));
+
             return *this;
         }
 
@@ -204,6 +216,8 @@ namespace TAO
             vchPubKey    = tx.vchPubKey;
             vchSig       = tx.vchSig;
 
+            std::atomic_store(&pHashCache, std::atomic_load(&tx.pHashCache));
+
             return *this;
         }
 
@@ -224,6 +238,8 @@ namespace TAO
             vchPubKey    = std::move(tx.vchPubKey);
             vchSig       = std::move(tx.vchSig);
 
+            std::atomic_store(&pHashCache, std::atomic_load(&tx.pHashCache));
+
             return *this;
         }
 
@@ -443,6 +459,12 @@ namespace TAO
             /* Verify the block signature (if not synchronizing) */
             if(!TAO::Ledger::ChainState::Synchronizing())
             {
+                /* Skip signatures that were already verified. */
+                const uint512_t hashTx  = GetHash();
+                const uint256_t hashKey = SignatureKey();
+                if(sigcache.Has(hashTx, hashKey))
+                    return true;
+
                 /* Switch based on signature type. */
                 switch(nKeyType)
                 {
@@ -477,12 +499,58 @@ namespace TAO
                     default:
                         return debug::error(FUNCTION, "unknown signature type");
                 }
+
+                /* Cache the verified signature for block validation. */
+                sigcache.Add(hashTx, hashKey);
             }
 
             return true;
         }
 
 
+        /* Verify the FALCON signatures of transactions in one batch. */
+        bool Transaction::VerifySignatures(const std::vector<Transaction>& vtx)
+        {
+            /* Signatures are not verified while synchronizing. */
+            if(TAO::Ledger::ChainState::Synchronizing())
+                return true;
+
+            /* Get the signed hashes of the signatures that weren't verified yet. */
+            std::vector< std::pair<uint512_t, uint256_t> > vKeys;
+            std::vector< std::vector<uint8_t> > vData;
+            std::vector<uint32_t> vIndex;
+            for(uint32_t n = 0; n < vtx.size(); ++n)
+            {
+                const Transaction& tx = vtx[n];
+                if(tx.nKeyType != SIGNATURE::FALCON)
+                    continue;
+
+                const uint512_t hashTx  = tx.GetHash();
+                const uint256_t hashKey = tx.SignatureKey();
+                if(sigcache.Has(hashTx, hashKey))
+                    continue;
+
+                vKeys.push_back(std::make_pair(hashTx, hashKey));
+                vData.push_back(hashTx.GetBytes());
+                vIndex.push_back(n);
+            }
+
+            /* The batch refers to the signed hashes, which are complete now. */
+            std::vector<LLC::FLSignature> vSignatures;
+            for(uint32_t n = 0; n < vIndex.size(); ++n)
+                vSignatures.push_back(LLC::FLSignature(vtx[vIndex[n]].vchPubKey, vData[n], vtx[vIndex[n]].vchSig));
+
+            if(!LLC::FLKey::VerifyMany(vSignatures))
+                return debug::error(FUNCTION, "invalid transaction signature");
+
+            /* Cache the verified signatures for the checks of each transaction. */
+            for(const auto& pairKey : vKeys)
+                sigcache.Add(pairKey.first, pairKey.second);
+
+            return true;
+        }
+
+
         /* Verify a transaction contracts. */
         bool Transaction::Verify(const uint8_t nFlags) const
         {
@@ -1262,6 +1330,13 @@ namespace TAO
         /* Gets the hash of the transaction object. */
         uint512_t Transaction::GetHash() const
         {
+            /* Use the cached hash if the data hasn't changed since it was computed. */
+            const uint64_t nFingerprint = Fingerprint();
+
+            const std::shared_ptr<const HashCache<uint512_t>> pCache = std::atomic_load(&pHashCache);
+            if(pCache && pCache->nFingerprint == nFingerprint)
+                return pCache->hash;
+
             DataStream ss(SER_GETHASH, nVersion);
             ss << *this;
 
@@ -1271,10 +1346,63 @@ namespace TAO
             /* Type of 0xff designates tritium tx. */
             hash.SetType(TAO::Ledger::TRITIUM);
 
+            /* Publish the hash with the fingerprint of its data, readers see either the old or the new pair. */
+            std::atomic_store(&pHashCache, std::make_shared<const HashCache<uint512_t>>(nFingerprint, hash));
+
             return hash;
         }
 
 
+        /* Gets a fast fingerprint of the data that is hashed. */
+        uint64_t Transaction::Fingerprint() const
+        {
+            /* Seeded at random so that fingerprint collisions can't be chosen. */
+            static const uint64_t nSeed = LLC::GetRand();
+
+            XXH64_state_t state;
+            XXH64_reset(&state, nSeed);
+
+            /* Add the contracts. */
+            for(const auto& contract : vContracts)
+            {
+                const std::vector<uint8_t>& vOperations = contract.Operations();
+                const std::vector<uint8_t>& vConditions = contract.Conditions();
+                const std::vector<uint8_t>& vRegisters  = contract.Registers();
+
+                /* Add the sizes so that bytes can't move between streams. */
+                const uint64_t nSizes[3] = { vOperations.size(), vConditions.size(), vRegisters.size() };
+                XXH64_update(&state, nSizes, sizeof(nSizes));
+
+                XXH64_update(&state, vOperations.data(), vOperations.size());
+                XXH64_update(&state, vConditions.data(), vConditions.size());
+                XXH64_update(&state, vRegisters.data(),  vRegisters.size());
+            }
+
+            /* Add the header. */
+            XXH64_update(&state, &nVersion,     sizeof(nVersion));
+            XXH64_update(&state, &nSequence,    sizeof(nSequence));
+            XXH64_update(&state, &nTimestamp,   sizeof(nTimestamp));
+            XXH64_update(&state, &hashNext,     sizeof(hashNext));
+            XXH64_update(&state, &hashRecovery, sizeof(hashRecovery));
+            XXH64_update(&state, &hashGenesis,  sizeof(hashGenesis));
+            XXH64_update(&state, &hashPrevTx,   sizeof(hashPrevTx));
+            XXH64_update(&state, &nKeyType,     sizeof(nKeyType));
+            XXH64_update(&state, &nNextType,    sizeof(nNextType));
+
+            return XXH64_digest(&state);
+        }
+
+
+        /* Gets the hash of the public key and signature. */
+        uint256_t Transaction::SignatureKey() const
+        {
+            std::vector<uint8_t> vchKey = vchPubKey;
+            vchKey.insert(vchKey.end(), vchSig.begin(), vchSig.end());
+
+            return LLC::SK256(vchKey);
+        }
+
+
         /* Gets a proof hash of the transaction object. */
         uint512_t Transaction::ProofHash() const
         {
@@ -32,6 +32,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/checkpoints.h>
 #include <TAO/Ledger/include/difficulty.h>
 #include <TAO/Ledger/include/retarget.h>
+#include <TAO/Ledger/include/schedule.h>
 #include <TAO/Ledger/include/stake.h>
 #include <TAO/Ledger/include/enum.h>
 #include <TAO/Ledger/include/supply.h>
@@ -412,6 +413,10 @@ namespace TAO
                 if(vProducer.size() == 0)
                     return debug::error(FUNCTION, "missing producer transaction");
 
+                /* Verify the producer signatures in one batch, so each check finds them verified. */
+                if(!Transaction::VerifySignatures(vProducer))
+                    return debug::error(FUNCTION, "producer transaction is invalid");
+
                 for(const TAO::Ledger::Transaction& txProducer : vProducer)
                 {
                     /* Check coinbase/coinstake timestamp against block time */
@@ -570,6 +575,9 @@ namespace TAO
             /* Get list of producer transactions. */
             std::map<uint256_t, uint512_t> mapLast;
 
+            /* Read the transactions that are not in the memory pool in one batch. */
+            PrefetchTx(vtx, true);
+
             /* Get the signature operations for legacy tx's. */
             uint32_t nSize = (uint32_t)vtx.size();
             for(uint32_t i = 0; i < nSize; ++i)
@@ -807,6 +815,9 @@ namespace TAO
             /* Process the block state. */
             TAO::Ledger::BlockState state(*this);
 
+            /* Read the transactions that are not in the memory pool in one batch. */
+            PrefetchTx(vtx, true);
+
             /* Start the database transaction. */
             LLD::TxnBegin();
 
@@ -1175,7 +1186,7 @@ namespace TAO
             /* Serialize the data to hash into a stream. */
             ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << nTime << vOffsets;
 
-            return LLC::SK1024(ss.begin(), ss.end());
+            return CachedHash(ss.data(), ss.data() + ss.size(), pSignatureCache);
         }
 
 
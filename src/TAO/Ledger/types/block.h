@@ -17,6 +17,8 @@ ________________________________________________________________________________
 
 #include <LLC/types/uint1024.h>
 
+#include <TAO/Ledger/types/hashcache.h>
+
 #include <set>
 
 //forward declerations for BigNum
@@ -97,6 +99,18 @@ namespace TAO
             mutable bool fConflicted;
 
 
+            /** Shared pointer to an immutable cached hash. **/
+            typedef std::shared_ptr<const HashCache<uint1024_t>> HashCachePtr;
+
+
+            /** MEMORY ONLY: the cached proof hash with its fingerprint, null if not computed. **/
+            mutable HashCachePtr pProofCache;
+
+
+            /** MEMORY ONLY: the cached signature hash with its fingerprint, null if not computed. **/
+            mutable HashCachePtr pSignatureCache;
+
+
             /** The default constructor. Sets block state to Null. **/
             Block();
 
@@ -412,6 +426,22 @@ namespace TAO
         protected:
 
 
+            /** CachedHash
+             *
+             *  Get the SK1024 hash of the given data, reusing the cached hash when
+             *  the data is the same as the last data hashed. Each kind of hash has
+             *  its own cache, so proof and signature hashes don't evict each other.
+             *
+             *  @param[in] pbegin The beginning of the data to hash.
+             *  @param[in] pend The end of the data to hash.
+             *  @param[in] pCache The cache of the kind of hash being computed.
+             *
+             *  @return 1024-bit hash of the data.
+             *
+             **/
+            uint1024_t CachedHash(const uint8_t* pbegin, const uint8_t* pend, HashCachePtr& pCache) const;
+
+
             /** StakeHash
              *
              *  Generates the StakeHash for this block from a uint256_t hashGenesis
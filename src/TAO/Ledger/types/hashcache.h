@@ -0,0 +1,58 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_TAO_LEDGER_TYPES_HASHCACHE_H
+#define NEXUS_TAO_LEDGER_TYPES_HASHCACHE_H
+
+#include <cstdint>
+#include <memory>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /** HashCache
+         *
+         *  A computed hash with the fingerprint of the data it was computed from.
+         *  It never changes once made, so objects share it through a shared pointer
+         *  that is swapped with atomic loads and stores, and hash from any thread
+         *  without a lock.
+         *
+         **/
+        template<typename HashType>
+        struct HashCache
+        {
+            /** The fingerprint of the data that was hashed. **/
+            const uint64_t nFingerprint;
+
+
+            /** The hash of the data. **/
+            const HashType hash;
+
+
+            /** Constructor from the fingerprint and its hash. **/
+            HashCache(const uint64_t nFingerprintIn, const HashType& hashIn)
+            : nFingerprint (nFingerprintIn)
+            , hash         (hashIn)
+            {
+            }
+        };
+    }
+}
+
+#endif
@@ -123,6 +123,10 @@ namespace TAO
                     READWRITE(vMerkleBranch);
                     READWRITE(nIndex);
                 }
+
+                /* Clear the cached hash of a transaction read from a stream. */
+                if(fRead)
+                    std::atomic_store(&pHashCache, HashCachePtr());
             )
 
 
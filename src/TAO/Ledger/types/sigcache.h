@@ -0,0 +1,141 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_TAO_LEDGER_TYPES_SIGCACHE_H
+#define NEXUS_TAO_LEDGER_TYPES_SIGCACHE_H
+
+#include <LLC/types/uint1024.h>
+
+#include <Util/templates/sharded_cache.h>
+
+#include <atomic>
+#include <utility>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /** SignatureCache
+         *
+         *  Bounded cache of signatures that were verified, keyed by transaction hash
+         *  and a hash of the public key and signature, so transactions verified in
+         *  the memory pool are not verified again when their block is checked and
+         *  connected. The signature is part of the key because it is not part of
+         *  the transaction hash.
+         *
+         *  Entries are split over independently locked shards by transaction hash.
+         *
+         **/
+        class SignatureCache
+        {
+            /** ShardHash
+             *
+             *  Picks the shard of an entry by its transaction, so the keys of a
+             *  transaction are evicted together.
+             *
+             **/
+            struct ShardHash
+            {
+                uint64_t operator()(const std::pair<uint512_t, uint256_t>& pairKey) const
+                {
+                    return pairKey.first.Get64();
+                }
+            };
+
+
+            /** The verified transaction and key hashes. **/
+            sharded_cache<std::pair<uint512_t, uint256_t>, bool, ShardHash> cacheVerified;
+
+
+            /** The number of lookups that found a verified signature. **/
+            std::atomic<uint64_t> nHits;
+
+
+            /** The number of lookups that missed. **/
+            std::atomic<uint64_t> nMisses;
+
+
+        public:
+
+            /** Default Constructor. **/
+            SignatureCache();
+
+
+            /** Has
+             *
+             *  Check if a signature was verified, counting the lookup as a hit or miss.
+             *
+             *  @param[in] hashTx The hash of the signed transaction.
+             *  @param[in] hashKey The hash of the public key and signature, or of the input script.
+             *
+             *  @return true if the signature was verified.
+             *
+             **/
+            bool Has(const uint512_t& hashTx, const uint256_t& hashKey);
+
+
+            /** Add
+             *
+             *  Add a verified signature, evicting the oldest entries over -maxsigcache.
+             *
+             *  @param[in] hashTx The hash of the signed transaction.
+             *  @param[in] hashKey The hash of the public key and signature, or of the input script.
+             *
+             **/
+            void Add(const uint512_t& hashTx, const uint256_t& hashKey);
+
+
+            /** Evict
+             *
+             *  Remove the verified signatures of a transaction once it is in a block.
+             *
+             *  @param[in] hashTx The hash of the transaction.
+             *
+             **/
+            void Evict(const uint512_t& hashTx);
+
+
+            /** Hits
+             *
+             *  Get the number of lookups that found a verified signature.
+             *
+             **/
+            uint64_t Hits() const;
+
+
+            /** Misses
+             *
+             *  Get the number of lookups that missed.
+             *
+             **/
+            uint64_t Misses() const;
+
+
+            /** Size
+             *
+             *  Get the number of verified signatures that are cached.
+             *
+             **/
+            uint64_t Size();
+        };
+
+        extern SignatureCache sigcache;
+    }
+}
+
+#endif
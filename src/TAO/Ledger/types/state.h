@@ -19,6 +19,8 @@ ________________________________________________________________________________
 
 #include <TAO/Ledger/types/block.h>
 
+class thread_pool;
+
 namespace Legacy
 {
     class LegacyBlock;
@@ -264,6 +266,22 @@ namespace TAO
             bool Connect();
 
 
+            /** ConnectRun
+             *
+             *  Connect the run of tritium transactions from a position in vtx that
+             *  can be ordered by conflict keys, with groups that share no keys
+             *  connected in parallel on a worker pool.
+             *
+             *  @param[in] nIndex The position in vtx to start from.
+             *  @param[out] vRun The transactions connected, empty if the first must be connected on its own.
+             *  @param[in] ppool The pool to connect the groups on.
+             *
+             *  @return true if connected.
+             *
+             **/
+            bool ConnectRun(const uint32_t nIndex, std::vector<Transaction>& vRun, thread_pool* ppool) const;
+
+
             /** Disconnect
              *
              *  Remove a block state from the chain.
@@ -18,6 +18,7 @@ ________________________________________________________________________________
 #include <TAO/Operation/types/contract.h>
 
 #include <TAO/Ledger/include/enum.h>
+#include <TAO/Ledger/types/hashcache.h>
 
 #include <vector>
 
@@ -114,6 +115,10 @@ namespace TAO
                 /* Handle for when not getting hash or skipsig. */
                 if(!(nSerType & SER_GETHASH) && !(nSerType & SER_SKIPSIG))
                     READWRITE(vchSig);
+
+                /* Clear the cached hash of a transaction read from a stream. */
+                if(fRead)
+                    std::atomic_store(&pHashCache, HashCachePtr());
             )
 
 
@@ -207,6 +212,19 @@ namespace TAO
             bool Check() const;
 
 
+            /** VerifySignatures
+             *
+             *  Verify the FALCON signatures of transactions in one batch, and add them to the
+             *  signature cache so checking each transaction doesn't verify it again.
+             *
+             *  @param[in] vtx The transactions to verify.
+             *
+             *  @return true if every signature is valid.
+             *
+             **/
+            static bool VerifySignatures(const std::vector<Transaction>& vtx);
+
+
             /** Verify
              *
              *  Verify a transaction contracts.
@@ -475,6 +493,37 @@ namespace TAO
             /** Class friends. **/
             friend class MerkleTx;
 
+        private:
+
+            /** Shared pointer to an immutable cached hash. **/
+            typedef std::shared_ptr<const HashCache<uint512_t>> HashCachePtr;
+
+
+            /** MEMORY ONLY: the cached hash of the transaction with its fingerprint, null if not computed. **/
+            mutable HashCachePtr pHashCache;
+
+
+            /** Fingerprint
+             *
+             *  Gets a fast fingerprint of the data that is hashed, which changes with any
+             *  write to the contracts or header and so invalidates the cached hash.
+             *
+             *  @return 64-bit fingerprint of the contracts and header.
+             *
+             **/
+            uint64_t Fingerprint() const;
+
+
+            /** SignatureKey
+             *
+             *  Gets the hash of the public key and signature, which keys the signature cache
+             *  since neither is part of the transaction hash.
+             *
+             *  @return 256-bit hash of the public key and signature.
+             *
+             **/
+            uint256_t SignatureKey() const;
+
         };
     }
 }
@@ -617,6 +617,13 @@ namespace TAO
         }
 
 
+        /* Get the raw register bytes from the contract.*/
+        const std::vector<uint8_t>& Contract::Registers() const
+        {
+            return ssRegister.Bytes();
+        }
+
+
         /* Seek the internal operation stream read pointers.*/
         void Contract::Seek(const uint32_t nPos, const uint8_t nFlags, const uint8_t nType) const
         {
@@ -323,6 +323,16 @@ namespace TAO
             const std::vector<uint8_t>& Conditions() const;
 
 
+            /** Registers
+             *
+             *  Get the raw register bytes from the contract.
+             *
+             *  @return raw byte const reference
+             *
+             **/
+            const std::vector<uint8_t>& Registers() const;
+
+
             /** Seek
              *
              *  Seek the internal operation stream read pointers.
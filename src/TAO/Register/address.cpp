@@ -94,7 +94,7 @@ namespace TAO
 
         /* Build an address deterministically from a namespace name*/
         Address::Address(const std::string& strName, const uint8_t nType)
-        : uint256_t(LLC::SK256(strName))
+        : uint256_t(LLC::SK256(strName, true))
         {
             /* Check for valid types. */
             if(nType != NAMESPACE)
@@ -117,7 +117,7 @@ namespace TAO
             vData.insert(vData.end(), (uint8_t*)&hashNamespace, (uint8_t*)&hashNamespace + 32);
 
             /* Set the internal uint256 data based on the SK hash of the vData */
-            *this = LLC::SK256(vData);
+            *this = LLC::SK256(vData, true);
 
             /* Check for valid types. */
             if(nType != TRUST && nType != NAME && nType != CRYPTO)
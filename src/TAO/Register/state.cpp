@@ -213,7 +213,7 @@ namespace TAO
             DataStream ss(SER_GETHASH, nVersion);
             ss << *this;
 
-            return LLC::SK64(ss.begin(), ss.end());
+            return LLC::SK64(ss.begin(), ss.end(), true);
         }
 
 
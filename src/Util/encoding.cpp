@@ -133,7 +133,7 @@ namespace encoding
     {
         // add 4-byte hash check to the end
         std::vector<unsigned char> vch(vchIn);
-        uint256_t hash = LLC::SK256(vch.begin(), vch.end());
+        uint256_t hash = LLC::SK256(vch.begin(), vch.end(), true);
         vch.insert(vch.end(), (unsigned char*)&hash, (unsigned char*)&hash + 4);
         return EncodeBase58(vch);
     }
@@ -149,7 +149,7 @@ namespace encoding
             vchRet.clear();
             return false;
         }
-        uint256_t hash = LLC::SK256(vchRet.begin(), vchRet.end()-4);
+        uint256_t hash = LLC::SK256(vchRet.begin(), vchRet.end()-4, true);
         //if(memcmp(&hash, &vchRet.end()[-4], 4) != 0)
         if(memory::compare((uint8_t *)&hash, (uint8_t *)&vchRet.end()[-4], 4) != 0)
         {
@@ -0,0 +1,139 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_UTIL_INCLUDE_THREAD_POOL_H
+#define NEXUS_UTIL_INCLUDE_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+/** thread_pool
+ *
+ *  Fixed set of worker threads that run queued tasks. Callers add a group
+ *  of tasks and then wait for the queue to drain, so a pool should be owned
+ *  by a single subsystem rather than shared between unrelated callers.
+ *
+ **/
+class thread_pool
+{
+    /** Mutex for the task queue. **/
+    std::mutex POOL_MUTEX;
+
+
+    /** Condition to wake workers when tasks are added. **/
+    std::condition_variable CONDITION;
+
+
+    /** Condition to wake waiters when all tasks are done. **/
+    std::condition_variable FINISHED;
+
+
+    /** The queued tasks. **/
+    std::queue< std::function<void()> > queueTasks;
+
+
+    /** The worker threads. **/
+    std::vector<std::thread> vWorkers;
+
+
+    /** The number of tasks currently running. **/
+    uint32_t nActive;
+
+
+    /** Flag to stop the workers. **/
+    std::atomic<bool> fStop;
+
+
+public:
+
+    /** Default Constructor. **/
+    thread_pool()                                  = delete;
+
+
+    /** Copy Constructor. **/
+    thread_pool(const thread_pool& pool)           = delete;
+
+
+    /** Move Constructor. **/
+    thread_pool(thread_pool&& pool)                = delete;
+
+
+    /** Copy assignment. **/
+    thread_pool& operator=(const thread_pool& pool) = delete;
+
+
+    /** Move assignment. **/
+    thread_pool& operator=(thread_pool&& pool)     = delete;
+
+
+    /** Thread Constructor
+     *
+     *  @param[in] nThreads The number of worker threads to start.
+     *
+     **/
+    thread_pool(const uint32_t nThreads);
+
+
+    /** Default Destructor
+     *
+     *  Finishes the queued tasks and joins the workers.
+     *
+     **/
+    ~thread_pool();
+
+
+    /** add
+     *
+     *  Queue a task to run on a worker thread.
+     *
+     *  @param[in] task The task to run.
+     *
+     **/
+    void add(const std::function<void()>& task);
+
+
+    /** wait
+     *
+     *  Wait until all queued and running tasks are done.
+     *
+     **/
+    void wait();
+
+
+    /** size
+     *
+     *  Get the number of worker threads.
+     *
+     **/
+    uint32_t size() const;
+
+
+private:
+
+    /** worker
+     *
+     *  Thread loop that runs tasks until the pool is stopped.
+     *
+     **/
+    void worker();
+};
+
+#endif
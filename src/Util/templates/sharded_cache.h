@@ -0,0 +1,221 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_UTIL_TEMPLATES_SHARDED_CACHE_H
+#define NEXUS_UTIL_TEMPLATES_SHARDED_CACHE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include <Util/include/mutex.h>
+
+
+/** sharded_cache
+ *
+ *  Bounded map that drops its oldest entries first, split over independently
+ *  locked shards so threads using different keys don't contend. Each entry
+ *  keeps its place in the insertion order, so erasing an entry removes it from
+ *  both and the bound always counts live entries.
+ *
+ *  ShardHash maps a key to the 64 bits that pick its shard. Keys that have to
+ *  be erased together must map to the same shard.
+ *
+ **/
+template<typename KeyType, typename ValueType, typename ShardHash, uint32_t SHARDS = 16>
+class sharded_cache
+{
+    /** Shard
+     *
+     *  A locked map of entries with their insertion order.
+     *
+     **/
+    struct Shard
+    {
+        /** Mutex for the shard. **/
+        std::mutex MUTEX;
+
+
+        /** Keys in the order they were added, to drop the oldest. **/
+        std::list<KeyType> listOrder;
+
+
+        /** The entries by key, with their place in the insertion order. **/
+        std::map<KeyType, std::pair<ValueType, typename std::list<KeyType>::iterator> > mapEntries;
+    };
+
+
+    /** The shards of the cache. **/
+    Shard vShards[SHARDS];
+
+
+    /** Get the shard for a key. **/
+    Shard& get_shard(const KeyType& key)
+    {
+        return vShards[ShardHash()(key) % SHARDS];
+    }
+
+
+    /** Erase an entry from the map and the insertion order, with the shard locked. **/
+    typename std::map<KeyType, std::pair<ValueType, typename std::list<KeyType>::iterator> >::iterator
+    erase_entry(Shard& shard, const typename std::map<KeyType, std::pair<ValueType, typename std::list<KeyType>::iterator> >::iterator& it)
+    {
+        shard.listOrder.erase(it->second.second);
+        return shard.mapEntries.erase(it);
+    }
+
+
+public:
+
+    /** Default Constructor. **/
+    sharded_cache()
+    : vShards ( )
+    {
+    }
+
+
+    /** get
+     *
+     *  Copy out the value of a key.
+     *
+     *  @param[in] key The key to look up.
+     *  @param[out] value The value of the key.
+     *
+     *  @return true if the key is cached.
+     *
+     **/
+    bool get(const KeyType& key, ValueType& value)
+    {
+        Shard& shard = get_shard(key);
+        LOCK(shard.MUTEX);
+
+        /* Copy under the lock, since the entry can be dropped once it is released. */
+        auto it = shard.mapEntries.find(key);
+        if(it == shard.mapEntries.end())
+            return false;
+
+        value = it->second.first;
+        return true;
+    }
+
+
+    /** has
+     *
+     *  Check if a key is cached.
+     *
+     *  @param[in] key The key to look up.
+     *
+     **/
+    bool has(const KeyType& key)
+    {
+        Shard& shard = get_shard(key);
+        LOCK(shard.MUTEX);
+
+        return shard.mapEntries.count(key);
+    }
+
+
+    /** put
+     *
+     *  Add a key, dropping the oldest entries of its shard over the bound.
+     *  A key that is already cached keeps its value and its place.
+     *
+     *  @param[in] key The key to add.
+     *  @param[in] value The value of the key.
+     *  @param[in] nMax The bound on the entries of the whole cache, split evenly over the shards.
+     *
+     *  @return true if the key was added.
+     *
+     **/
+    bool put(const KeyType& key, const ValueType& value, const uint32_t nMax)
+    {
+        Shard& shard = get_shard(key);
+        LOCK(shard.MUTEX);
+
+        if(shard.mapEntries.count(key))
+            return false;
+
+        shard.listOrder.push_back(key);
+        shard.mapEntries.insert(std::make_pair(key, std::make_pair(value, std::prev(shard.listOrder.end()))));
+
+        /* Drop the oldest entries over the bound. */
+        const uint32_t nShardMax = std::max(uint32_t(1), nMax / SHARDS);
+        while(shard.mapEntries.size() > nShardMax)
+            erase_entry(shard, shard.mapEntries.find(shard.listOrder.front()));
+
+        return true;
+    }
+
+
+    /** erase
+     *
+     *  Erase a key.
+     *
+     *  @param[in] key The key to erase.
+     *
+     **/
+    void erase(const KeyType& key)
+    {
+        Shard& shard = get_shard(key);
+        LOCK(shard.MUTEX);
+
+        auto it = shard.mapEntries.find(key);
+        if(it != shard.mapEntries.end())
+            erase_entry(shard, it);
+    }
+
+
+    /** erase_range
+     *
+     *  Erase the keys from a first key on, for as long as they match.
+     *
+     *  @param[in] keyFirst The first key of the range, which picks the shard.
+     *  @param[in] fnMatch Returns true for the keys of the range.
+     *
+     **/
+    template<typename Function>
+    void erase_range(const KeyType& keyFirst, const Function& fnMatch)
+    {
+        Shard& shard = get_shard(keyFirst);
+        LOCK(shard.MUTEX);
+
+        auto it = shard.mapEntries.lower_bound(keyFirst);
+        while(it != shard.mapEntries.end() && fnMatch(it->first))
+            it = erase_entry(shard, it);
+    }
+
+
+    /** size
+     *
+     *  Get the number of cached entries.
+     *
+     **/
+    uint64_t size()
+    {
+        uint64_t nSize = 0;
+        for(uint32_t n = 0; n < SHARDS; ++n)
+        {
+            LOCK(vShards[n].MUTEX);
+            nSize += vShards[n].mapEntries.size();
+        }
+
+        return nSize;
+    }
+};
+
+#endif
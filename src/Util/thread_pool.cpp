@@ -0,0 +1,115 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <Util/include/thread_pool.h>
+#include <Util/include/mutex.h>
+
+/* Thread Constructor. */
+thread_pool::thread_pool(const uint32_t nThreads)
+: POOL_MUTEX ( )
+, CONDITION  ( )
+, FINISHED   ( )
+, queueTasks ( )
+, vWorkers   ( )
+, nActive    (0)
+, fStop      (false)
+{
+    for(uint32_t n = 0; n < nThreads; ++n)
+        vWorkers.push_back(std::thread(&thread_pool::worker, this));
+}
+
+
+/* Default Destructor. */
+thread_pool::~thread_pool()
+{
+    {
+        LOCK(POOL_MUTEX);
+        fStop = true;
+    }
+
+    CONDITION.notify_all();
+
+    for(auto& thread : vWorkers)
+        if(thread.joinable())
+            thread.join();
+}
+
+
+/* Queue a task to run on a worker thread. */
+void thread_pool::add(const std::function<void()>& task)
+{
+    /* Run inline if there are no workers. */
+    if(vWorkers.empty())
+    {
+        task();
+        return;
+    }
+
+    {
+        LOCK(POOL_MUTEX);
+        queueTasks.push(task);
+    }
+
+    CONDITION.notify_one();
+}
+
+
+/* Wait until all queued and running tasks are done. */
+void thread_pool::wait()
+{
+    std::unique_lock<std::mutex> lk(POOL_MUTEX);
+    FINISHED.wait(lk, [this]{ return queueTasks.empty() && nActive == 0; });
+}
+
+
+/* Get the number of worker threads. */
+uint32_t thread_pool::size() const
+{
+    return static_cast<uint32_t>(vWorkers.size());
+}
+
+
+/* Thread loop that runs tasks until the pool is stopped. */
+void thread_pool::worker()
+{
+    while(true)
+    {
+        /* Get the next task. */
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lk(POOL_MUTEX);
+            CONDITION.wait(lk, [this]{ return fStop.load() || !queueTasks.empty(); });
+
+            /* Drain the queue before stopping. */
+            if(queueTasks.empty())
+                return;
+
+            task = std::move(queueTasks.front());
+            queueTasks.pop();
+
+            ++nActive;
+        }
+
+        /* Run the task outside of the lock. */
+        task();
+
+        /* Wake waiters if this was the last task. */
+        {
+            LOCK(POOL_MUTEX);
+            --nActive;
+
+            if(queueTasks.empty() && nActive == 0)
+                FINISHED.notify_all();
+        }
+    }
+}
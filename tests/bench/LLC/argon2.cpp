@@ -0,0 +1,88 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/hash/argon2.h>
+#include <LLC/include/argon2_pool.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/runtime.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+/* Run the sigchain credential hash a number of times, returning the average milliseconds per hash. */
+uint64_t Argon2Credentials(const uint32_t nHashes, const bool fPool)
+{
+    std::vector<uint8_t> vHash(64);
+    std::vector<uint8_t> vPassword(32, 0x01);
+    std::vector<uint8_t> vSalt(16, 0x02);
+
+    /* The parameters of SignatureChain::Generate. */
+    argon2_context context =
+    {
+        &vHash[0], static_cast<uint32_t>(vHash.size()),
+        &vPassword[0], static_cast<uint32_t>(vPassword.size()),
+        &vSalt[0], static_cast<uint32_t>(vSalt.size()),
+        NULL, 0,
+        NULL, 0,
+        12, (1 << 16),
+        1, 1,
+        ARGON2_VERSION_13,
+        (fPool ? LLC::Argon2Allocate : NULL), (fPool ? LLC::Argon2Free : NULL),
+        ARGON2_DEFAULT_FLAGS
+    };
+
+    runtime::timer bench;
+    bench.Reset();
+
+    for(uint32_t n = 0; n < nHashes; ++n)
+    {
+        const int32_t nRet = argon2id_ctx(&context);
+        REQUIRE(nRet == ARGON2_OK);
+    }
+
+    return bench.ElapsedMilliseconds() / nHashes;
+}
+
+
+TEST_CASE( "Argon2 Benchmarks", "[LLC]")
+{
+    debug::log(0, "===== Begin Argon2 Benchmarks =====");
+
+    //each kernel the CPU supports, with 64 MB and 12 passes as for a login
+    const argon2_kernel kernels[] = { ARGON2_KERNEL_REF, ARGON2_KERNEL_SSE2, ARGON2_KERNEL_SSSE3,
+                                      ARGON2_KERNEL_AVX2, ARGON2_KERNEL_AVX512F };
+    for(const argon2_kernel kernel : kernels)
+    {
+        if(argon2_select_kernel(kernel) != ARGON2_OK)
+            continue;
+
+        const uint64_t nTime = Argon2Credentials(2, false);
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Kernel::", ANSI_COLOR_RESET, argon2_kernel2string(kernel), " ", nTime, " ms / hash");
+    }
+
+    REQUIRE(argon2_select_kernel(ARGON2_KERNEL_AUTO) == ARGON2_OK);
+
+    //repeated logins, mapping memory each time or reusing it from the pool
+    {
+        const uint64_t nMalloc = Argon2Credentials(4, false);
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Malloc::", ANSI_COLOR_RESET, argon2_kernel2string(argon2_current_kernel()), " ", nMalloc, " ms / hash");
+
+        Argon2Credentials(1, true);
+
+        const uint64_t nPool = Argon2Credentials(4, true);
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Pool::", ANSI_COLOR_RESET, argon2_kernel2string(argon2_current_kernel()), " ", nPool, " ms / hash");
+    }
+
+    debug::log(0, "===== End Argon2 Benchmarks =====\n");
+}
@@ -0,0 +1,224 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/random.h>
+#include <LLC/types/uint1024.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/runtime.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <functional>
+
+
+/* The 32-bit word loops that base_uint<1024> used before 64-bit limbs, to compare against. */
+namespace Words
+{
+    const uint32_t WIDTH = 32;
+
+
+    /* Get the words of a number. */
+    uint32_t* Get(uint1024_t& n)
+    {
+        return reinterpret_cast<uint32_t*>(n.begin());
+    }
+
+
+    void Add(uint1024_t& a, const uint1024_t& b)
+    {
+        uint32_t* pa = Get(a);
+        const uint32_t* pb = Get(const_cast<uint1024_t&>(b));
+
+        uint64_t carry = 0;
+        for(uint32_t i = 0; i < WIDTH; ++i)
+        {
+            uint64_t n = carry + pa[i] + pb[i];
+            pa[i] = n & 0xffffffff;
+            carry = n >> 32;
+        }
+    }
+
+
+    void Sub(uint1024_t& a, const uint1024_t& b)
+    {
+        /* Add the negation, as the 32-bit operator did. */
+        uint1024_t c = ~b;
+        uint32_t* pc = Get(c);
+
+        uint32_t i = 0;
+        while(++pc[i] == 0 && i < WIDTH - 1)
+            ++i;
+
+        Add(a, c);
+    }
+
+
+    void Mul(uint1024_t& a, const uint1024_t& b)
+    {
+        uint32_t* pa = Get(a);
+        const uint32_t* pb = Get(const_cast<uint1024_t&>(b));
+
+        uint32_t r[WIDTH] = { };
+        for(uint32_t j = 0; j < WIDTH; ++j)
+        {
+            uint64_t carry = 0;
+            for(uint32_t i = 0; i + j < WIDTH; ++i)
+            {
+                uint64_t n = carry + r[i + j] + (uint64_t)pa[j] * pb[i];
+                r[i + j] = n & 0xffffffff;
+                carry = n >> 32;
+            }
+        }
+
+        std::copy(r, r + WIDTH, pa);
+    }
+
+
+    void Shift(uint1024_t& a, uint32_t shift)
+    {
+        uint32_t* pa = Get(a);
+
+        uint32_t r[WIDTH] = { };
+        int32_t k = shift / 32;
+        shift = shift % 32;
+        for(int32_t i = 0; i < int32_t(WIDTH); ++i)
+        {
+            if(i+k+1 < int32_t(WIDTH) && shift != 0)
+                r[i+k+1] |= (pa[i] >> (32-shift));
+            if(i+k < int32_t(WIDTH))
+                r[i+k] |= (pa[i] << shift);
+        }
+
+        std::copy(r, r + WIDTH, pa);
+    }
+
+
+    bool Less(const uint1024_t& a, const uint1024_t& b)
+    {
+        const uint32_t* pa = Get(const_cast<uint1024_t&>(a));
+        const uint32_t* pb = Get(const_cast<uint1024_t&>(b));
+
+        for(int32_t i = WIDTH - 1; i >= 0; --i)
+        {
+            if(pa[i] < pb[i])
+                return true;
+            else if(pa[i] > pb[i])
+                return false;
+        }
+
+        return false;
+    }
+}
+
+
+/* Time an operation over every pair of numbers, returning nanoseconds per operation. */
+double BaseUintTime(const std::vector<uint1024_t>& vNumbers, const std::function<void(uint1024_t&, const uint1024_t&)>& fnOp)
+{
+    const uint32_t nRounds = 20;
+
+    /* Sum the results to keep them live. */
+    uint32_t nSum = 0;
+
+    runtime::timer bench;
+    bench.Reset();
+
+    for(uint32_t nRound = 0; nRound < nRounds; ++nRound)
+    {
+        for(uint32_t n = 0; n + 1 < vNumbers.size(); ++n)
+        {
+            uint1024_t a = vNumbers[n];
+            fnOp(a, vNumbers[n + 1]);
+
+            nSum += a.get(0);
+        }
+    }
+
+    const double nTime = bench.ElapsedMicroseconds() * 1000.0 / (nRounds * (vNumbers.size() - 1));
+    REQUIRE(nSum + 1 != 0);
+
+    return nTime;
+}
+
+
+TEST_CASE( "Base Uint Benchmarks", "[LLC]")
+{
+    debug::log(0, "===== Begin Base Uint Benchmarks =====");
+
+    //numbers as large as chain trust and prime difficulty targets, with equal high words for compares
+    std::vector<uint1024_t> vNumbers(10000);
+    for(auto& n : vNumbers)
+    {
+        n = LLC::GetRand1024();
+        n.SetType(0xff);
+    }
+
+    struct Operation
+    {
+        std::string strName;
+        std::function<void(uint1024_t&, const uint1024_t&)> fnWords;
+        std::function<void(uint1024_t&, const uint1024_t&)> fnLimbs;
+    };
+
+    const std::vector<Operation> vOperations =
+    {
+        { "Add",     [](uint1024_t& a, const uint1024_t& b) { Words::Add(a, b); },
+                     [](uint1024_t& a, const uint1024_t& b) { a += b; } },
+        { "Sub",     [](uint1024_t& a, const uint1024_t& b) { Words::Sub(a, b); },
+                     [](uint1024_t& a, const uint1024_t& b) { a -= b; } },
+        { "Mul",     [](uint1024_t& a, const uint1024_t& b) { Words::Mul(a, b); },
+                     [](uint1024_t& a, const uint1024_t& b) { a *= b; } },
+        { "Shift",   [](uint1024_t& a, const uint1024_t& b) { Words::Shift(a, b.get(0) % 1024); },
+                     [](uint1024_t& a, const uint1024_t& b) { a <<= (b.get(0) % 1024); } },
+        { "Compare", [](uint1024_t& a, const uint1024_t& b) { if(Words::Less(a, b)) a = b; },
+                     [](uint1024_t& a, const uint1024_t& b) { if(a < b) a = b; } }
+    };
+
+    for(const auto& op : vOperations)
+    {
+        //both give the same results
+        for(uint32_t n = 0; n + 1 < 1000; ++n)
+        {
+            uint1024_t a = vNumbers[n];
+            uint1024_t b = vNumbers[n];
+            op.fnWords(a, vNumbers[n + 1]);
+            op.fnLimbs(b, vNumbers[n + 1]);
+
+            REQUIRE(a == b);
+        }
+
+        const double nWords = BaseUintTime(vNumbers, op.fnWords);
+        const double nLimbs = BaseUintTime(vNumbers, op.fnLimbs);
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, op.strName, "::", ANSI_COLOR_RESET, "32-bit words ", nWords, " ns, 64-bit limbs ",
+            nLimbs, " ns (", nWords / nLimbs, "x)");
+    }
+
+    //division, as in difficulty retargeting, runs on the operators above
+    {
+        runtime::timer bench;
+        bench.Reset();
+
+        uint32_t nZero = 0;
+        for(uint32_t n = 0; n + 1 < vNumbers.size(); ++n)
+        {
+            const uint1024_t a = vNumbers[n] / (vNumbers[n + 1] >> 512);
+            nZero += (a == 0);
+        }
+        REQUIRE(nZero < vNumbers.size());
+
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Div::", ANSI_COLOR_RESET, "64-bit limbs ",
+            bench.ElapsedMicroseconds() * 1000.0 / (vNumbers.size() - 1), " ns");
+    }
+
+    debug::log(0, "===== End Base Uint Benchmarks =====\n");
+}
@@ -0,0 +1,110 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/flkey.h>
+#include <LLC/include/random.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/runtime.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+TEST_CASE( "FLKey Verify Benchmarks", "[LLC]")
+{
+    debug::log(0, "===== Begin FLKey Verify Benchmarks =====");
+
+    //a few sigchains signing 64 byte transaction hashes, as in a block
+    const uint32_t nKeys = 8;
+    const uint32_t nSigs = 2000;
+
+    std::vector<LLC::FLKey> vKeys(nKeys);
+    for(auto& key : vKeys)
+        key.MakeNewKey();
+
+    std::vector< std::vector<uint8_t> > vPubKeys;
+    std::vector< std::vector<uint8_t> > vData;
+    std::vector< std::vector<uint8_t> > vSigs;
+    for(uint32_t n = 0; n < nSigs; ++n)
+    {
+        std::vector<uint8_t> vchData(64);
+        for(auto& ch : vchData)
+            ch = static_cast<uint8_t>(LLC::GetRand());
+
+        std::vector<uint8_t> vchSig;
+        REQUIRE(vKeys[n % nKeys].Sign(vchData, vchSig));
+
+        vPubKeys.push_back(vKeys[n % nKeys].GetPubKey());
+        vData.push_back(vchData);
+        vSigs.push_back(vchSig);
+    }
+
+    //reference, allocating temp memory and decoding the key for every signature
+    uint64_t nReference = 0;
+    {
+        runtime::timer bench;
+        bench.Reset();
+
+        for(uint32_t n = 0; n < nSigs; ++n)
+        {
+            std::vector<uint8_t> vchTemp(FALCON_TMPSIZE_VERIFY(9), 0);
+            const int nRet = falcon_verify(&vSigs[n][0], vSigs[n].size(), &vPubKeys[n][0], vPubKeys[n].size(),
+                &vData[n][0], vData[n].size(), &vchTemp[0], vchTemp.size());
+            REQUIRE(nRet == 0);
+        }
+
+        nReference = std::max(uint64_t(1), bench.ElapsedMicroseconds());
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Reference::", ANSI_COLOR_RESET, nSigs, " signatures in ", nReference, " microseconds");
+    }
+
+    //cached keys and thread scratch memory, with the portable and AVX2 NTT
+    for(int fAVX2 = 0; fAVX2 < 2; ++fAVX2)
+    {
+        if(falcon_verify_avx2(fAVX2) != fAVX2)
+            continue;
+
+        runtime::timer bench;
+        bench.Reset();
+
+        for(uint32_t n = 0; n < nSigs; ++n)
+        {
+            const bool fValid = vKeys[n % nKeys].Verify(vData[n], vSigs[n]);
+            REQUIRE(fValid);
+        }
+
+        const uint64_t nTime = std::max(uint64_t(1), bench.ElapsedMicroseconds());
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, fAVX2 ? "AVX2::" : "Portable::", ANSI_COLOR_RESET,
+            nSigs, " signatures in ", nTime, " microseconds (", double(nReference) / nTime, "x)");
+    }
+    falcon_verify_avx2(1);
+
+    //one batch, with the signatures of each key together
+    {
+        std::vector<LLC::FLSignature> vBatch;
+        for(uint32_t nKey = 0; nKey < nKeys; ++nKey)
+            for(uint32_t n = nKey; n < nSigs; n += nKeys)
+                vBatch.push_back(LLC::FLSignature(vPubKeys[n], vData[n], vSigs[n]));
+
+        runtime::timer bench;
+        bench.Reset();
+
+        const bool fValid = LLC::FLKey::VerifyMany(vBatch);
+        REQUIRE(fValid);
+
+        const uint64_t nTime = std::max(uint64_t(1), bench.ElapsedMicroseconds());
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "VerifyMany::", ANSI_COLOR_RESET,
+            nSigs, " signatures in ", nTime, " microseconds (", double(nReference) / nTime, "x)");
+    }
+
+    debug::log(0, "===== End FLKey Verify Benchmarks =====\n");
+}
@@ -0,0 +1,95 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/hash/SK.h>
+#include <LLC/include/random.h>
+
+#include <LLD/cache/template_lru.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/runtime.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <thread>
+
+
+/* Run a hashing function over a working set on a number of threads, returning million hashes per second. */
+template<typename Function>
+double HashThreads(const std::vector< std::vector<uint8_t> >& vData, const uint32_t nThreads, const uint32_t nHashes, const Function& func)
+{
+    runtime::timer bench;
+    bench.Reset();
+
+    std::vector<std::thread> vThreads;
+    for(uint32_t n = 0; n < nThreads; ++n)
+    {
+        vThreads.push_back(std::thread([&vData, &func, n, nHashes]()
+        {
+            for(uint32_t i = 0; i < nHashes; ++i)
+                func(vData[(i + n) % vData.size()]);
+        }));
+    }
+
+    for(auto& thread : vThreads)
+        thread.join();
+
+    const uint64_t nTime = std::max(uint64_t(1), bench.ElapsedMicroseconds());
+    return double(nThreads) * nHashes / nTime;
+}
+
+
+TEST_CASE( "SK Memo Benchmarks", "[LLC]")
+{
+    debug::log(0, "===== Begin SK Memo Benchmarks =====");
+
+    /* Small inputs that repeat, such as names, public keys and addresses. */
+    std::vector< std::vector<uint8_t> > vData(16, std::vector<uint8_t>(64));
+    for(auto& vch : vData)
+        for(auto& n : vch)
+            n = static_cast<uint8_t>(LLC::GetRand());
+
+    /* The previous scheme, one shared LRU behind a mutex keyed by a copy of the input. */
+    LLD::TemplateLRU<std::vector<uint8_t>, uint256_t> cache(32);
+
+    const uint32_t nHashes = 100000;
+    for(uint32_t nThreads : { 1, 8, 32 })
+    {
+        const double nShared = HashThreads(vData, nThreads, nHashes, [&cache](const std::vector<uint8_t>& vch)
+        {
+            std::vector<uint8_t> vCopy(vch.begin(), vch.end());
+
+            uint256_t hash;
+            if(!cache.Get(vCopy, hash))
+            {
+                hash = LLC::SK256(vch.begin(), vch.end());
+                cache.Put(vCopy, hash);
+            }
+        });
+
+        const double nMemo = HashThreads(vData, nThreads, nHashes, [](const std::vector<uint8_t>& vch)
+        {
+            LLC::SK256(vch, true);
+        });
+
+        const double nNone = HashThreads(vData, nThreads, nHashes, [](const std::vector<uint8_t>& vch)
+        {
+            LLC::SK256(vch);
+        });
+
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, nThreads, " Threads::", ANSI_COLOR_RESET,
+            "shared LRU ", nShared, ", memo ", nMemo, ", no memo ", nNone, " million hashes / second");
+    }
+
+    debug::log(0, "===== End SK Memo Benchmarks =====\n");
+}
@@ -3,6 +3,7 @@
 #include <LLC/include/random.h>
 
 #include <LLD/cache/binary_lru.h>
+#include <LLD/templates/key.h>
 
 #include <LLD/include/version.h>
 
@@ -10,13 +11,15 @@
 
 #include <unit/catch2/catch.hpp>
 
+#include <thread>
+
 
 TEST_CASE( "Binary LRU Benchmarks", "[LLD]")
 {
     debug::log(0, "===== Begin Binary LRU Benchmarks =====");
 
     //benchmarks
-    LLD::BinaryLRU* cache = new LLD::BinaryLRU();
+    LLD::BinaryLRU* cache = new LLD::BinaryLRU(1024 * 1024 * 256);
     uint256_t hash = LLC::GetRand256();
     {
         runtime::timer timer;
@@ -30,7 +33,7 @@ TEST_CASE( "Binary LRU Benchmarks", "[LLD]")
             DataStream ssData(SER_LLD, LLD::DATABASE_VERSION);
             ssData << uint1024_t(4934943);
 
-            cache->Put(ssKey.Bytes(), ssData.Bytes());
+            cache->Put(LLD::SectorKey(), ssKey.Bytes(), ssData.Bytes());
         }
 
         uint64_t nTime = timer.ElapsedMicroseconds();
@@ -56,6 +59,60 @@ TEST_CASE( "Binary LRU Benchmarks", "[LLD]")
         debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Get::", ANSI_COLOR_RESET, 1000000.0 / nTime, " million records / second");
     }
 
+    delete cache;
 
     debug::log(0, "===== End Binary LRU Benchmarks =====\n");
 }
+
+
+TEST_CASE( "Binary LRU Multi-Threaded Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Binary LRU Multi-Threaded Benchmarks =====");
+
+    LLD::BinaryLRU* cache = new LLD::BinaryLRU(1024 * 1024 * 256);
+
+    //build the keys ahead of time so only the cache is timed
+    std::vector< std::vector<uint8_t> > vKeys;
+    uint256_t hash = LLC::GetRand256();
+    for(int i = 0; i < 1000000; i++)
+    {
+        DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+        ssKey << std::make_pair(std::string("data"), hash + i);
+
+        vKeys.push_back(ssKey.Bytes());
+    }
+
+    DataStream ssData(SER_LLD, LLD::DATABASE_VERSION);
+    ssData << uint1024_t(4934943);
+
+    for(const auto& vKey : vKeys)
+        cache->Put(LLD::SectorKey(), vKey, ssData.Bytes());
+
+    //read the keys across threads
+    for(uint32_t nThreads = 1; nThreads <= 8; nThreads *= 2)
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        std::vector<std::thread> vThreads;
+        for(uint32_t n = 0; n < nThreads; ++n)
+        {
+            vThreads.push_back(std::thread([cache, &vKeys, n, nThreads]()
+            {
+                std::vector<uint8_t> vBytes;
+                for(uint32_t i = n; i < vKeys.size(); i += nThreads)
+                    cache->Get(vKeys[i], vBytes);
+            }));
+        }
+
+        for(auto& thread : vThreads)
+            thread.join();
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Get::", ANSI_COLOR_RESET, nThreads, " threads ", double(vKeys.size()) / nTime, " million records / second");
+    }
+
+    delete cache;
+
+    debug::log(0, "===== End Binary LRU Multi-Threaded Benchmarks =====\n");
+}
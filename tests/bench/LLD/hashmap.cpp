@@ -0,0 +1,84 @@
+#include <Util/include/runtime.h>
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/keychain/hashmap.h>
+#include <LLD/include/version.h>
+
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <thread>
+
+
+/* Run a keychain operation over the given keys on a number of threads, returning total microseconds. */
+template<typename Function>
+uint64_t ThreadedKeychain(const std::vector< std::vector<uint8_t> >& vKeys, const uint32_t nThreads, const Function& func)
+{
+    runtime::timer timer;
+    timer.Start();
+
+    std::vector<std::thread> vThreads;
+    for(uint32_t n = 0; n < nThreads; ++n)
+    {
+        vThreads.push_back(std::thread([&vKeys, &func, n, nThreads]()
+        {
+            for(uint32_t i = n; i < vKeys.size(); i += nThreads)
+                func(vKeys[i]);
+        }));
+    }
+
+    for(auto& thread : vThreads)
+        thread.join();
+
+    return std::max(uint64_t(1), timer.ElapsedMicroseconds());
+}
+
+
+TEST_CASE( "Binary Hash Map Concurrency Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Binary Hash Map Concurrency Benchmarks =====");
+
+    //build the keys
+    std::vector< std::vector<uint8_t> > vKeys;
+    uint256_t hash = LLC::GetRand256();
+    for(int i = 0; i < 100000; i++)
+    {
+        DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+        ssKey << std::make_pair(std::string("key"), hash + i);
+
+        vKeys.push_back(ssKey.Bytes());
+    }
+
+    for(uint32_t nThreads = 1; nThreads <= 8; nThreads *= 2)
+    {
+        /* Use a fresh keychain each round so that writes allocate the same files. */
+        std::string strPath = config::GetDataDir() + "_BENCH_HASHMAP_" + std::to_string(nThreads) + "/keychain/";
+        filesystem::remove_directories(strPath);
+
+        LLD::BinaryHashMap* pkeychain = new LLD::BinaryHashMap(strPath, LLD::FLAGS::CREATE, 77773);
+
+        //write the keys
+        uint64_t nTime = ThreadedKeychain(vKeys, nThreads, [pkeychain](const std::vector<uint8_t>& vKey)
+        {
+            LLD::SectorKey cKey(LLD::STATE::READY, vKey, 0, 0, 1);
+            pkeychain->Put(cKey);
+        });
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Put::", ANSI_COLOR_RESET, nThreads, " threads ", (vKeys.size() * 1000000) / nTime, " keys / second");
+
+        //read the keys
+        nTime = ThreadedKeychain(vKeys, nThreads, [pkeychain](const std::vector<uint8_t>& vKey)
+        {
+            LLD::SectorKey cKey;
+            pkeychain->Get(vKey, cKey);
+        });
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Get::", ANSI_COLOR_RESET, nThreads, " threads ", (vKeys.size() * 1000000) / nTime, " keys / second");
+
+        delete pkeychain;
+    }
+
+    debug::log(0, "===== End Binary Hash Map Concurrency Benchmarks =====\n");
+}
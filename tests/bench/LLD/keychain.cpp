@@ -0,0 +1,151 @@
+#include <Util/include/runtime.h>
+#include <Util/include/config.h>
+#include <Util/include/args.h>
+#include <Util/include/filesystem.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/keychain/hashmap.h>
+#include <LLD/keychain/shard_hashmap.h>
+#include <LLD/keychain/hashtree.h>
+#include <LLD/include/version.h>
+
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <algorithm>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+
+/* Get the total bytes of the files that start with the keychain path. */
+uint64_t KeychainDiskSize(const std::string& strPath)
+{
+    uint64_t nTotal = 0;
+
+    DIR* pdir = opendir(strPath.c_str());
+    if(!pdir)
+        return 0;
+
+    struct dirent* pentry;
+    while((pentry = readdir(pdir)) != nullptr)
+    {
+        struct stat info;
+        if(stat((strPath + pentry->d_name).c_str(), &info) == 0 && S_ISREG(info.st_mode))
+            nTotal += info.st_size;
+    }
+    closedir(pdir);
+
+    return nTotal;
+}
+
+
+/* Write and then read the keys through a keychain, logging insert rate, lookup latency, and size. */
+void KeychainBenchmark(const std::string& strType, LLD::Keychain* pkeychain, const std::string& strPath,
+                       const std::vector< std::vector<uint8_t> >& vKeys)
+{
+    //write the keys
+    runtime::timer timer;
+    timer.Start();
+    for(uint32_t n = 0; n < vKeys.size(); ++n)
+    {
+        LLD::SectorKey cKey(LLD::STATE::READY, vKeys[n], 0, n, 1);
+        REQUIRE(pkeychain->Put(cKey));
+    }
+    const uint64_t nWrite = std::max(uint64_t(1), timer.ElapsedMicroseconds());
+
+    //read the keys in a different order than they were written
+    std::vector<uint32_t> vOrder(vKeys.size());
+    for(uint32_t n = 0; n < vOrder.size(); ++n)
+        vOrder[n] = static_cast<uint32_t>((uint64_t(n) * 7919) % vOrder.size());
+
+    std::vector<uint64_t> vLatency;
+    vLatency.reserve(vKeys.size());
+
+    uint32_t nMissing = 0;
+    for(const auto& n : vOrder)
+    {
+        LLD::SectorKey cKey;
+
+        timer.Reset();
+        if(!pkeychain->Get(vKeys[n], cKey))
+            ++nMissing;
+
+        vLatency.push_back(timer.ElapsedNanoseconds());
+    }
+    std::sort(vLatency.begin(), vLatency.end());
+
+    debug::log(0, ANSI_COLOR_BRIGHT_CYAN, strType, "::", ANSI_COLOR_RESET,
+        "Put ", (vKeys.size() * 1000000) / nWrite, " keys / second | ",
+        "Get p50 ", vLatency[vLatency.size() / 2] / 1000.0, " us | ",
+        "Get p99 ", vLatency[(vLatency.size() * 99) / 100] / 1000.0, " us | ",
+        "Disk ", KeychainDiskSize(strPath) / (1024 * 1024), " mb | ",
+        "Missing ", nMissing);
+
+    REQUIRE(nMissing == 0);
+}
+
+
+TEST_CASE( "Keychain Backend Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Keychain Backend Benchmarks =====");
+
+    /* Sizing runs for a database should set this to 10M keys or more. */
+    const uint32_t nTotalKeys = static_cast<uint32_t>(config::GetArg("-keychainbenchkeys", 1000000));
+    const uint32_t nBuckets   = static_cast<uint32_t>(config::GetArg("-keychainbenchbuckets", 256 * 256 * 16));
+
+    //build the keys
+    std::vector< std::vector<uint8_t> > vKeys;
+    vKeys.reserve(nTotalKeys);
+
+    uint256_t hash = LLC::GetRand256();
+    for(uint32_t i = 0; i < nTotalKeys; ++i)
+    {
+        DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+        ssKey << std::make_pair(std::string("key"), hash + i);
+
+        vKeys.push_back(ssKey.Bytes());
+    }
+
+    debug::log(0, "Keychain ", nTotalKeys, " keys over ", nBuckets, " buckets");
+
+    //binary hashmap
+    {
+        std::string strPath = config::GetDataDir() + "_BENCH_KEYCHAIN_HASHMAP/keychain/";
+        filesystem::remove_directories(strPath);
+
+        LLD::Keychain* pkeychain = new LLD::BinaryHashMap(strPath, LLD::FLAGS::CREATE, nBuckets);
+        KeychainBenchmark("BinaryHashMap", pkeychain, strPath, vKeys);
+
+        delete pkeychain;
+        filesystem::remove_directories(strPath);
+    }
+
+    //shard hashmap
+    {
+        std::string strPath = config::GetDataDir() + "_BENCH_KEYCHAIN_SHARD/keychain/";
+        filesystem::remove_directories(strPath);
+
+        LLD::Keychain* pkeychain = new LLD::ShardHashMap(strPath, LLD::FLAGS::CREATE, nBuckets);
+        KeychainBenchmark("ShardHashMap", pkeychain, strPath, vKeys);
+
+        delete pkeychain;
+        filesystem::remove_directories(strPath);
+    }
+
+    //binary hashtree
+    {
+        std::string strPath = config::GetDataDir() + "_BENCH_KEYCHAIN_HASHTREE/keychain/";
+        filesystem::remove_directories(strPath);
+
+        LLD::Keychain* pkeychain = new LLD::BinaryHashTree(strPath, LLD::FLAGS::CREATE, nBuckets);
+        KeychainBenchmark("BinaryHashTree", pkeychain, strPath, vKeys);
+
+        delete pkeychain;
+        filesystem::remove_directories(strPath);
+    }
+
+    debug::log(0, "===== End Keychain Backend Benchmarks =====\n");
+}
@@ -6,6 +6,8 @@
 
 #include <LLD/include/global.h>
 
+#include <TAO/Ledger/types/transaction.h>
+
 #include <Util/templates/datastream.h>
 
 #include <unit/catch2/catch.hpp>
@@ -67,3 +69,43 @@ TEST_CASE( "LLD Benchamrks", "[LLD]")
 
     debug::log(0, "===== End Ledger Sequential Read Benchmarks =====\n");
 }
+
+
+TEST_CASE( "Ledger WriteTx Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Ledger WriteTx Benchmarks =====");
+
+    //write enough records to fill the disk buffer several times, so the rate is bound by the cache writer
+    uint512_t hash = LLC::GetRand512();
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        TAO::Ledger::Transaction tx;
+        for(int i = 0; i < 100000; i++)
+        {
+            tx.nTimestamp = i;
+            LLD::Ledger->WriteTx(hash + i, tx);
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "WriteTx::", ANSI_COLOR_RESET, "100k records in ", nTime, " microseconds (", (100000000000) / nTime, ") per/s");
+    }
+
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        TAO::Ledger::Transaction tx;
+        for(int i = 0; i < 100000; i++)
+        {
+            LLD::Ledger->ReadTx(hash + i, tx);
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "ReadTx::", ANSI_COLOR_RESET, "100k records in ", nTime, " microseconds (", (100000000000) / nTime, ") per/s");
+    }
+
+    debug::log(0, "===== End Ledger WriteTx Benchmarks =====\n");
+}
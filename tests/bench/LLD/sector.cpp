@@ -0,0 +1,79 @@
+#include <Util/include/runtime.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/templates/sector.h>
+#include <LLD/cache/binary_lru.h>
+#include <LLD/keychain/hashmap.h>
+
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <thread>
+
+
+/* Read the given keys from a database on a number of threads, returning total microseconds. */
+template<typename DatabaseType>
+uint64_t ThreadedRead(DatabaseType* db, const std::vector<uint256_t>& vKeys, const uint32_t nThreads)
+{
+    runtime::timer timer;
+    timer.Start();
+
+    std::vector<std::thread> vThreads;
+    for(uint32_t n = 0; n < nThreads; ++n)
+    {
+        vThreads.push_back(std::thread([db, &vKeys, n, nThreads]()
+        {
+            for(uint32_t i = n; i < vKeys.size(); i += nThreads)
+            {
+                uint1024_t value;
+                db->Read(std::make_pair(std::string("data"), vKeys[i]), value);
+            }
+        }));
+    }
+
+    for(auto& thread : vThreads)
+        thread.join();
+
+    return timer.ElapsedMicroseconds();
+}
+
+
+TEST_CASE( "Sector Memory Map Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Sector Memory Map Benchmarks =====");
+
+    /* Use a tiny cache so that reads hit the sector files. */
+    LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>* dbStream =
+        new LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>("_BENCH_STREAM", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 77773, 1024 * 128);
+
+    LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>* dbMapped =
+        new LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>("_BENCH_MMAP", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE | LLD::FLAGS::MMAP, 77773, 1024 * 128);
+
+    //write the records
+    std::vector<uint256_t> vKeys;
+    uint256_t hash = LLC::GetRand256();
+    for(int i = 0; i < 100000; i++)
+    {
+        vKeys.push_back(hash + i);
+
+        dbStream->Write(std::make_pair(std::string("data"), vKeys.back()), uint1024_t(i));
+        dbMapped->Write(std::make_pair(std::string("data"), vKeys.back()), uint1024_t(i));
+    }
+
+    //read the records across threads
+    for(uint32_t nThreads = 1; nThreads <= 8; nThreads *= 2)
+    {
+        uint64_t nTime = ThreadedRead(dbStream, vKeys, nThreads);
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Stream::", ANSI_COLOR_RESET, nThreads, " threads ", (vKeys.size() * 1000000) / nTime, " records / second");
+
+        nTime = ThreadedRead(dbMapped, vKeys, nThreads);
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Mapped::", ANSI_COLOR_RESET, nThreads, " threads ", (vKeys.size() * 1000000) / nTime, " records / second");
+    }
+
+    delete dbStream;
+    delete dbMapped;
+
+    debug::log(0, "===== End Sector Memory Map Benchmarks =====\n");
+}
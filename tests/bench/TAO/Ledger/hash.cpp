@@ -0,0 +1,101 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/hash/SK.h>
+#include <LLC/include/random.h>
+
+#include <TAO/Operation/include/enum.h>
+
+#include <TAO/Ledger/types/transaction.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/runtime.h>
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+TEST_CASE( "Transaction Hash Benchmarks", "[ledger]")
+{
+    using namespace TAO::Operation;
+
+    debug::log(0, "===== Begin Transaction Hash Benchmarks =====");
+
+    /* Build transactions with a few contracts each. */
+    const uint32_t nContracts = 3;
+
+    std::vector<TAO::Ledger::Transaction> vTx(10000);
+    for(auto& tx : vTx)
+    {
+        tx.hashGenesis = LLC::GetRand256();
+        for(uint32_t n = 0; n < nContracts; ++n)
+            tx[n] << uint8_t(OP::WRITE) << LLC::GetRand256() << std::vector<uint8_t>(64, 0xff);
+    }
+
+    /* Hashes taken while accepting a transaction: the mempool key, relay, indexing, and one bind per contract read. */
+    const uint32_t nLookups = 3 + nContracts;
+
+    //the first hash of each transaction, which is always computed
+    {
+        runtime::timer bench;
+        bench.Reset();
+
+        for(const auto& tx : vTx)
+            tx.GetHash();
+
+        const uint64_t nTime = bench.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "First::", ANSI_COLOR_RESET, "1 SK512 per tx, 10k tx in ", nTime, " microseconds");
+    }
+
+    //uncached, one SK512 for each of the remaining lookups
+    uint64_t nUncached = 0;
+    {
+        runtime::timer bench;
+        bench.Reset();
+
+        for(const auto& tx : vTx)
+        {
+            for(uint32_t n = 1; n < nLookups; ++n)
+            {
+                DataStream ss(SER_GETHASH, tx.nVersion);
+                ss << tx;
+
+                uint512_t hash = LLC::SK512(ss.begin(), ss.end());
+                hash.SetType(TAO::Ledger::TRITIUM);
+            }
+        }
+
+        nUncached = std::max(uint64_t(1), bench.ElapsedMicroseconds());
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Uncached::", ANSI_COLOR_RESET, nLookups - 1, " more SK512 per tx, 10k tx in ", nUncached, " microseconds");
+    }
+
+    //cached, a fingerprint check for each of the remaining lookups
+    {
+        runtime::timer bench;
+        bench.Reset();
+
+        for(const auto& tx : vTx)
+        {
+            tx.GetHash();
+            tx.GetHash();
+
+            for(uint32_t n = 0; n < tx.Size(); ++n)
+                tx[n].Hash();
+        }
+
+        const uint64_t nCached = std::max(uint64_t(1), bench.ElapsedMicroseconds());
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Cached::", ANSI_COLOR_RESET, "0 more SK512 per tx, 10k tx in ", nCached, " microseconds (", double(nUncached) / nCached, "x)");
+    }
+
+    debug::log(0, "===== End Transaction Hash Benchmarks =====\n");
+}
@@ -22,6 +22,13 @@
 #include <time.h>
 
 #include <LLC/hash/argon2.h>
+#include <LLC/include/argon2_pool.h>
+
+#include <Util/include/hex.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #define OUT_LEN 32
 #define ENCODED_LEN 108
@@ -287,3 +294,80 @@ TEST_CASE( "Argon2 Hashing Tests", "[LLC]")
     REQUIRE(ret == ARGON2_SALT_TOO_SHORT);
     printf("Fail on salt too short: PASS\n");
 }
+
+
+TEST_CASE( "Argon2 Kernel Tests", "[LLC]")
+{
+    /* The fastest supported kernel is picked by default */
+    REQUIRE(argon2_current_kernel() != ARGON2_KERNEL_AUTO);
+
+    /* Every kernel the CPU supports must give the reference hashes */
+    const argon2_kernel kernels[] = { ARGON2_KERNEL_REF, ARGON2_KERNEL_SSE2, ARGON2_KERNEL_SSSE3,
+                                      ARGON2_KERNEL_AVX2, ARGON2_KERNEL_AVX512F };
+    for(const argon2_kernel kernel : kernels)
+    {
+        if(argon2_select_kernel(kernel) != ARGON2_OK)
+        {
+            printf("Kernel %s not supported\n", argon2_kernel2string(kernel));
+            continue;
+        }
+
+        REQUIRE(argon2_current_kernel() == kernel);
+        printf("Kernel %s\n", argon2_kernel2string(kernel));
+
+        hashtest(ARGON2_VERSION_10, 2, 8, 2, "password", "somesalt",
+                 "b6c11560a6a9d61eac706b79a2f97d68b4463aa3ad87e00c07e2b01e90c564fb",
+                 "$argon2i$m=256,t=2,p=2$c29tZXNhbHQ"
+                 "$tsEVYKap1h6scGt5ovl9aLRGOqOth+AMB+KwHpDFZPs", Argon2_i);
+        hashtest(ARGON2_VERSION_13, 2, 8, 2, "password", "somesalt",
+                 "4ff5ce2769a1d7f4c8a491df09d41a9fbe90e5eb02155a13e4c01e20cd4eab61",
+                 "$argon2i$v=19$m=256,t=2,p=2$c29tZXNhbHQ"
+                 "$T/XOJ2mh1/TIpJHfCdQan76Q5esCFVoT5MAeIM1Oq2E", Argon2_i);
+        hashtest(ARGON2_VERSION_13, 2, 8, 2, "password", "somesalt",
+                 "6d093c501fd5999645e0ea3bf620d7b8be7fd2db59c20d9fff9539da2bf57037",
+                 "$argon2id$v=19$m=256,t=2,p=2$c29tZXNhbHQ"
+                 "$bQk8UB/VmZZF4Oo79iDXuL5/0ttZwg2f/5U52iv1cDc", Argon2_id);
+        hashtest(ARGON2_VERSION_13, 2, 16, 1, "password", "somesalt",
+                 "09316115d5cf24ed5a15a31a3ba326e5cf32edc24702987c02b6566f61913cf7",
+                 "$argon2id$v=19$m=65536,t=2,p=1$c29tZXNhbHQ"
+                 "$CTFhFdXPJO1aFaMaO6Mm5c8y7cJHAph8ArZWb2GRPPc", Argon2_id);
+    }
+
+    REQUIRE(argon2_select_kernel(ARGON2_KERNEL_AUTO) == ARGON2_OK);
+    REQUIRE(argon2_kernel2string(ARGON2_KERNEL_AUTO) != NULL);
+}
+
+
+TEST_CASE( "Argon2 Pool Tests", "[LLC]")
+{
+    const std::string strPassword = "password";
+    const std::string strSalt     = "somesalt";
+
+    std::vector<uint8_t> vHash(OUT_LEN);
+    argon2_context context =
+    {
+        &vHash[0], OUT_LEN,
+        (uint8_t*)strPassword.data(), static_cast<uint32_t>(strPassword.size()),
+        (uint8_t*)strSalt.data(), static_cast<uint32_t>(strSalt.size()),
+        NULL, 0,
+        NULL, 0,
+        2, (1 << 16),
+        1, 1,
+        ARGON2_VERSION_13,
+        LLC::Argon2Allocate, LLC::Argon2Free,
+        ARGON2_DEFAULT_FLAGS
+    };
+
+    /* Hashing again with pooled memory gives the same hash */
+    for(uint32_t n = 0; n < 3; ++n)
+    {
+        std::fill(vHash.begin(), vHash.end(), 0);
+        REQUIRE(argon2id_ctx(&context) == ARGON2_OK);
+
+        std::vector<uint8_t> vExpected = ParseHex("09316115d5cf24ed5a15a31a3ba326e5cf32edc24702987c02b6566f61913cf7");
+        REQUIRE(vHash == vExpected);
+
+        /* The released memory is kept for the next hash */
+        REQUIRE(LLC::Argon2PoolSize() >= 1);
+    }
+}
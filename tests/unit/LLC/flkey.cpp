@@ -0,0 +1,182 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/flkey.h>
+#include <LLC/include/flcache.h>
+#include <LLC/include/random.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+/* Verify with the reference falcon verification, decoding the key each time. */
+bool ReferenceVerify(const std::vector<uint8_t>& vchPubKey, const std::vector<uint8_t>& vchData, const std::vector<uint8_t>& vchSig)
+{
+    std::vector<uint8_t> vchTemp(FALCON_TMPSIZE_VERIFY(9), 0);
+    return falcon_verify(&vchSig[0], vchSig.size(), &vchPubKey[0], vchPubKey.size(),
+        &vchData[0], vchData.size(), &vchTemp[0], vchTemp.size()) == 0;
+}
+
+
+TEST_CASE( "FLKey Verify Tests", "[LLC]")
+{
+    std::vector<LLC::FLKey> vKeys(3);
+    for(auto& key : vKeys)
+        key.MakeNewKey();
+
+    //signed data of a few sizes, with a signature from each key
+    std::vector< std::vector<uint8_t> > vData;
+    std::vector< std::vector<uint8_t> > vSigs;
+    std::vector<uint32_t> vSigner;
+    for(uint32_t n = 0; n < 12; ++n)
+    {
+        std::vector<uint8_t> vchData(1 + n * 13);
+        for(auto& ch : vchData)
+            ch = static_cast<uint8_t>(LLC::GetRand());
+
+        std::vector<uint8_t> vchSig;
+        REQUIRE(vKeys[n % 3].Sign(vchData, vchSig));
+
+        vData.push_back(vchData);
+        vSigs.push_back(vchSig);
+        vSigner.push_back(n % 3);
+    }
+
+    //the portable and AVX2 verification agree with the reference, for valid and invalid signatures
+    for(int fAVX2 = 0; fAVX2 < 2; ++fAVX2)
+    {
+        falcon_verify_avx2(fAVX2);
+        for(uint32_t n = 0; n < vData.size(); ++n)
+        {
+            const LLC::FLKey& key = vKeys[vSigner[n]];
+            const LLC::FLKey& keyOther = vKeys[(vSigner[n] + 1) % 3];
+
+            bool fValid = key.Verify(vData[n], vSigs[n]);
+            REQUIRE(fValid);
+            REQUIRE(ReferenceVerify(key.GetPubKey(), vData[n], vSigs[n]));
+
+            //a different key
+            fValid = keyOther.Verify(vData[n], vSigs[n]);
+            REQUIRE(!fValid);
+
+            //changed data
+            std::vector<uint8_t> vchData = vData[n];
+            vchData[0] ^= 1;
+            fValid = key.Verify(vchData, vSigs[n]);
+            REQUIRE(!fValid);
+
+            //changed signature
+            std::vector<uint8_t> vchSig = vSigs[n];
+            vchSig[vchSig.size() / 2] ^= 0x10;
+            fValid = key.Verify(vData[n], vchSig);
+            REQUIRE(fValid == ReferenceVerify(key.GetPubKey(), vData[n], vchSig));
+        }
+    }
+    falcon_verify_avx2(1);
+
+    //compressed signatures verify too
+    {
+        const LLC::CPrivKey vchPrivKey = vKeys[0].GetPrivKey();
+
+        shake256_context ctx;
+        shake256_init_prng_from_system(&ctx);
+
+        std::vector<uint8_t> vchSig(FALCON_SIG_VARTIME_MAXSIZE(9));
+        std::vector<uint8_t> vchTemp(FALCON_TMPSIZE_SIGNDYN(9));
+        size_t nSize = vchSig.size();
+        REQUIRE(falcon_sign_dyn(&ctx, &vchSig[0], &nSize, &vchPrivKey[0], vchPrivKey.size(),
+            &vData[0][0], vData[0].size(), 0, &vchTemp[0], vchTemp.size()) == 0);
+        vchSig.resize(nSize);
+
+        REQUIRE(vKeys[0].Verify(vData[0], vchSig));
+        REQUIRE(!vKeys[1].Verify(vData[0], vchSig));
+    }
+
+    //keys that were verified with are decoded from the cache
+    {
+        const uint64_t nHits = LLC::flcache.Hits();
+        REQUIRE(vKeys[0].Verify(vData[0], vSigs[0]));
+        REQUIRE(LLC::flcache.Hits() == nHits + 1);
+    }
+
+    //invalid public keys and signatures fail
+    {
+        LLC::FLKey key;
+        std::vector<uint8_t> vchPubKey = vKeys[0].GetPubKey();
+        vchPubKey.pop_back();
+        key.SetPubKey(vchPubKey);
+        REQUIRE(!key.Verify(vData[0], vSigs[0]));
+
+        REQUIRE(!vKeys[0].Verify(vData[0], std::vector<uint8_t>()));
+        REQUIRE(!vKeys[0].Verify(vData[0], std::vector<uint8_t>(vSigs[0].begin(), vSigs[0].begin() + 40)));
+    }
+
+    //FALCON-1024 keys and signatures are rejected, as they always were
+    {
+        shake256_context ctx;
+        shake256_init_prng_from_system(&ctx);
+
+        std::vector<uint8_t> vchPubKey(FALCON_PUBKEY_SIZE(10));
+        std::vector<uint8_t> vchPrivKey(FALCON_PRIVKEY_SIZE(10));
+        std::vector<uint8_t> vchTemp(FALCON_TMPSIZE_KEYGEN(10));
+        REQUIRE(falcon_keygen_make(&ctx, 10, &vchPrivKey[0], vchPrivKey.size(),
+            &vchPubKey[0], vchPubKey.size(), &vchTemp[0], vchTemp.size()) == 0);
+
+        std::vector<uint8_t> vchSig(FALCON_SIG_VARTIME_MAXSIZE(10));
+        vchTemp.resize(FALCON_TMPSIZE_SIGNDYN(10));
+        size_t nSize = vchSig.size();
+        REQUIRE(falcon_sign_dyn(&ctx, &vchSig[0], &nSize, &vchPrivKey[0], vchPrivKey.size(),
+            &vData[0][0], vData[0].size(), 0, &vchTemp[0], vchTemp.size()) == 0);
+        vchSig.resize(nSize);
+
+        REQUIRE(!ReferenceVerify(vchPubKey, vData[0], vchSig));
+
+        LLC::FLKey key;
+        key.SetPubKey(vchPubKey);
+        REQUIRE(!key.Verify(vData[0], vchSig));
+
+        std::vector<LLC::FLSignature> vLarge;
+        vLarge.push_back(LLC::FLSignature(vchPubKey, vData[0], vchSig));
+        REQUIRE(!LLC::FLKey::VerifyMany(vLarge));
+    }
+
+    //batches verify when every signature is valid
+    std::vector<std::vector<uint8_t>> vPubKeys;
+    for(uint32_t n = 0; n < vData.size(); ++n)
+        vPubKeys.push_back(vKeys[vSigner[n]].GetPubKey());
+
+    std::vector<LLC::FLSignature> vBatch;
+    for(uint32_t n = 0; n < vData.size(); ++n)
+        vBatch.push_back(LLC::FLSignature(vPubKeys[n], vData[n], vSigs[n]));
+
+    REQUIRE(LLC::FLKey::VerifyMany(vBatch));
+    REQUIRE(LLC::FLKey::VerifyMany(std::vector<LLC::FLSignature>()));
+
+    //one invalid signature fails the batch, including after a run with the same key
+    std::vector<uint8_t> vchData = vData[5];
+    vchData[0] ^= 1;
+
+    std::vector<LLC::FLSignature> vInvalid;
+    for(uint32_t n = 0; n < vData.size(); ++n)
+        vInvalid.push_back(LLC::FLSignature(vPubKeys[vSigner[5]], n == 5 ? vchData : vData[n], vSigs[n]));
+
+    REQUIRE(!LLC::FLKey::VerifyMany(vInvalid));
+
+    std::vector<LLC::FLSignature> vSame;
+    vSame.push_back(LLC::FLSignature(vPubKeys[2], vData[2], vSigs[2]));
+    vSame.push_back(LLC::FLSignature(vPubKeys[5], vData[5], vSigs[5]));
+    vSame.push_back(LLC::FLSignature(vPubKeys[5], vchData, vSigs[5]));
+    REQUIRE(!LLC::FLKey::VerifyMany(vSame));
+
+    vSame.pop_back();
+    REQUIRE(LLC::FLKey::VerifyMany(vSame));
+}
@@ -0,0 +1,95 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/hash/SK.h>
+#include <LLC/include/random.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+TEST_CASE( "SK512Batch Tests", "[LLC]")
+{
+    //messages around the 64 byte block size, including empty, in uneven order
+    std::vector< std::vector<uint8_t> > vData;
+    for(uint32_t nSize : { 0, 1, 63, 64, 65, 127, 128, 129, 200, 1000, 64, 0, 3000, 17 })
+    {
+        std::vector<uint8_t> vch(nSize);
+        for(auto& n : vch)
+            n = static_cast<uint8_t>(LLC::GetRand());
+
+        vData.push_back(vch);
+    }
+
+    std::vector< std::pair<const uint8_t*, const uint8_t*> > vMessages;
+    for(const auto& vch : vData)
+        vMessages.push_back(std::make_pair(vch.data(), vch.data() + vch.size()));
+
+    //every hash matches SK512 over the same bytes
+    const std::vector<uint512_t> vHashes = LLC::SK512Batch(vMessages);
+    REQUIRE(vHashes.size() == vData.size());
+
+    for(uint32_t n = 0; n < vData.size(); ++n)
+    {
+        const uint512_t hash = LLC::SK512(vData[n].begin(), vData[n].end());
+        REQUIRE(vHashes[n] == hash);
+    }
+
+    //one message and none
+    vMessages.resize(1);
+    const uint512_t hash = LLC::SK512(vData[0].begin(), vData[0].end());
+    REQUIRE(LLC::SK512Batch(vMessages)[0] == hash);
+
+    vMessages.clear();
+    REQUIRE(LLC::SK512Batch(vMessages).empty());
+}
+
+
+TEST_CASE( "SK Memo Tests", "[LLC]")
+{
+    //inputs of the same size, including ones too large for the memo
+    for(uint64_t nSize : { uint64_t(0), uint64_t(32), uint64_t(LLC::SK_MEMO_MAX), uint64_t(LLC::SK_MEMO_MAX + 1) })
+    {
+        std::vector< std::vector<uint8_t> > vData(200, std::vector<uint8_t>(nSize));
+        for(auto& vch : vData)
+            for(auto& n : vch)
+                n = static_cast<uint8_t>(LLC::GetRand());
+
+        //memoized hashes match, when first taken and when found again
+        for(uint32_t nPass = 0; nPass < 2; ++nPass)
+        {
+            for(const auto& vch : vData)
+            {
+                const uint64_t  hash64   = LLC::SK64(vch.begin(), vch.end());
+                const uint256_t hash256  = LLC::SK256(vch.begin(), vch.end());
+                const uint512_t hash512  = LLC::SK512(vch.begin(), vch.end());
+                const uint1024_t hash1024 = LLC::SK1024(vch.begin(), vch.end());
+
+                REQUIRE(LLC::SK64(vch, true)                        == hash64);
+                REQUIRE(LLC::SK256(vch, true)                       == hash256);
+                REQUIRE(LLC::SK512(vch, true)                       == hash512);
+                REQUIRE(LLC::SK1024(vch.begin(), vch.end(), true)   == hash1024);
+            }
+        }
+    }
+
+    //strings hash the same as their bytes
+    const std::string strName = "distordia";
+    const std::vector<uint8_t> vName(strName.begin(), strName.end());
+    REQUIRE(LLC::SK256(strName, true) == LLC::SK256(vName));
+    REQUIRE(LLC::SK256(strName, true) == LLC::SK256(vName));
+
+    //fingerprints differ by content
+    const std::vector<uint8_t> vOther(vName.size(), 0);
+    REQUIRE(LLC::SKFingerprint(vName.data(), vName.size()) == LLC::SKFingerprint(vName.data(), vName.size()));
+    REQUIRE(LLC::SKFingerprint(vName.data(), vName.size()) != LLC::SKFingerprint(vOther.data(), vOther.size()));
+}
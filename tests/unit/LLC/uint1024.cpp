@@ -145,10 +145,14 @@ TEST_CASE( "Base Uint Math Tests", "[LLC]")
 
         /* Subtraction (no overflow) */
         if(b1 <= a1)
+        {
             REQUIRE( (a1 - b1) == (a2 - b2).getuint1024());
+        }
 
         if(r64 <= a1)
+        {
             REQUIRE( (a1 - r64) == (a2 - r64).getuint1024());
+        }
 
         uint1024_t t = b1;
 
@@ -156,7 +160,9 @@ TEST_CASE( "Base Uint Math Tests", "[LLC]")
         b2.setuint1024(b1);
 
         if(b1 <= r64)
+        {
             REQUIRE( (r64 - b1) == (r64 - b2).getuint1024());
+        }
 
         b1 = t;
         b2.setuint1024(b1);
@@ -185,9 +191,180 @@ TEST_CASE( "Base Uint Math Tests", "[LLC]")
 
         /* Modulo 16-bit */
         if(r16 != 0)
+        {
             REQUIRE( (a1 % r16) == (a2 % r16).getuint32());
+        }
 
 
     }
 
 }
+
+
+/* Get the 32-bit words of a number, least significant first. */
+template<uint32_t BITS>
+std::vector<uint32_t> Words(const base_uint<BITS>& n)
+{
+    std::vector<uint32_t> vWords(BITS / 32);
+    for(uint32_t i = 0; i < vWords.size(); ++i)
+        vWords[i] = n.get(i);
+
+    return vWords;
+}
+
+
+/* Get a random number with a random number of low words set, so carries and compares cross limbs. */
+template<uint32_t BITS>
+base_uint<BITS> RandWords()
+{
+    std::vector<uint32_t> vWords(BITS / 32, 0);
+
+    const uint32_t nWords = GetRand(vWords.size()) + 1;
+    for(uint32_t i = 0; i < nWords; ++i)
+    {
+        const uint32_t nType = GetRand(4);
+        vWords[i] = (nType == 0 ? 0 : nType == 1 ? 0xffffffff : static_cast<uint32_t>(GetRand(0xffffffff)));
+    }
+
+    base_uint<BITS> n;
+    n.set(vWords);
+
+    return n;
+}
+
+
+/* Check the 64-bit limb operators of a width against 32-bit word arithmetic. */
+template<uint32_t BITS>
+void CheckLimbs()
+{
+    const uint32_t WIDTH = BITS / 32;
+
+    for(int i = 0; i < 2000; ++i)
+    {
+        const base_uint<BITS> a = RandWords<BITS>();
+        const base_uint<BITS> b = (i % 3 == 0) ? a : RandWords<BITS>();
+
+        const std::vector<uint32_t> va = Words(a);
+        const std::vector<uint32_t> vb = Words(b);
+
+        /* Word reference for addition, subtraction and multiplication. */
+        std::vector<uint32_t> vAdd(WIDTH), vSub(WIDTH), vMul(WIDTH, 0);
+        uint64_t nCarry = 0, nBorrow = 0;
+        for(uint32_t j = 0; j < WIDTH; ++j)
+        {
+            const uint64_t nSum = nCarry + va[j] + vb[j];
+            vAdd[j] = static_cast<uint32_t>(nSum);
+            nCarry  = nSum >> 32;
+
+            const uint64_t nDiff = uint64_t(va[j]) - vb[j] - nBorrow;
+            vSub[j] = static_cast<uint32_t>(nDiff);
+            nBorrow = (nDiff >> 32) ? 1 : 0;
+
+            uint64_t nMulCarry = 0;
+            for(uint32_t k = 0; j + k < WIDTH; ++k)
+            {
+                const uint64_t nProduct = nMulCarry + vMul[j + k] + uint64_t(va[j]) * vb[k];
+                vMul[j + k] = static_cast<uint32_t>(nProduct);
+                nMulCarry   = nProduct >> 32;
+            }
+        }
+
+        bool fAdd = (Words(a + b) == vAdd);
+        bool fSub = (Words(a - b) == vSub);
+        bool fMul = (Words(a * b) == vMul);
+        REQUIRE(fAdd);
+        REQUIRE(fSub);
+        REQUIRE(fMul);
+
+        /* The same through aliased operands. */
+        base_uint<BITS> c = a;
+        c += c;
+        REQUIRE(c == a + a);
+
+        c = a;
+        c *= c;
+        REQUIRE(c == a * a);
+
+        c = a;
+        c -= c;
+        REQUIRE(c == 0);
+
+        /* 64-bit operands. */
+        const uint64_t n64 = b.Get64();
+        REQUIRE(a + n64 == a + base_uint<BITS>(n64));
+        REQUIRE(a - n64 == a - base_uint<BITS>(n64));
+        REQUIRE(a * n64 == a * base_uint<BITS>(n64));
+
+        /* Word reference for shifts. */
+        const uint32_t nShift = GetRand(BITS + 64);
+        std::vector<uint32_t> vLeft(WIDTH, 0), vRight(WIDTH, 0);
+        for(uint32_t j = 0; j < BITS; ++j)
+        {
+            if(!((va[j / 32] >> (j % 32)) & 1))
+                continue;
+
+            if(j + nShift < BITS)
+                vLeft[(j + nShift) / 32] |= (1u << ((j + nShift) % 32));
+
+            if(j >= nShift)
+                vRight[(j - nShift) / 32] |= (1u << ((j - nShift) % 32));
+        }
+
+        bool fLeft  = (Words(a << nShift) == vLeft);
+        bool fRight = (Words(a >> nShift) == vRight);
+        REQUIRE(fLeft);
+        REQUIRE(fRight);
+
+        /* Word reference for compares and bits. */
+        int32_t nCompare = 0;
+        uint32_t nBits = 0;
+        for(int32_t j = WIDTH - 1; j >= 0; --j)
+        {
+            if(nCompare == 0 && va[j] != vb[j])
+                nCompare = (va[j] < vb[j]) ? -1 : 1;
+
+            if(nBits == 0 && va[j] != 0)
+                for(int32_t k = 31; k >= 0 && nBits == 0; --k)
+                    if((va[j] >> k) & 1)
+                        nBits = 32 * j + k + 1;
+        }
+
+        REQUIRE((a <  b) == (nCompare <  0));
+        REQUIRE((a <= b) == (nCompare <= 0));
+        REQUIRE((a >  b) == (nCompare >  0));
+        REQUIRE((a >= b) == (nCompare >= 0));
+        REQUIRE((a == b) == (nCompare == 0));
+        REQUIRE(a.bits() == nBits);
+        REQUIRE(!a == (nBits == 0));
+        REQUIRE((a == va[0]) == (nBits <= 32));
+    }
+
+    /* Carries and borrows through every limb, including a half limb on odd widths. */
+    const base_uint<BITS> nMax = ~base_uint<BITS>(0);
+    REQUIRE(nMax + 1 == 0);
+    REQUIRE(nMax + base_uint<BITS>(1) == 0);
+    REQUIRE(base_uint<BITS>(0) - 1 == nMax);
+    REQUIRE(nMax * nMax == 1);
+    REQUIRE(nMax.bits() == BITS);
+    REQUIRE((nMax >> (BITS - 1)) == 1);
+    REQUIRE((nMax << BITS) == 0);
+    REQUIRE((nMax >> BITS) == 0);
+    REQUIRE((nMax << 0) == nMax);
+    REQUIRE(Words(nMax << 32)[0] == 0);
+    REQUIRE(Words(nMax << 32)[1] == 0xffffffff);
+    REQUIRE(Words(nMax >> 32)[WIDTH - 1] == 0);
+    REQUIRE(Words(nMax >> 64)[WIDTH - 2] == 0);
+    REQUIRE(Words(nMax >> 64)[WIDTH - 3] == 0xffffffff);
+}
+
+
+TEST_CASE( "Base Uint Limb Tests", "[LLC]")
+{
+    CheckLimbs<128>();
+    CheckLimbs<256>();
+    CheckLimbs<512>();
+    CheckLimbs<576>();
+    CheckLimbs<1024>();
+    CheckLimbs<1056>();
+    CheckLimbs<1088>();
+}
@@ -0,0 +1,156 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/keychain/hashmap.h>
+#include <LLD/templates/bloom.h>
+#include <LLD/include/enum.h>
+#include <LLD/include/version.h>
+
+#include <Util/include/args.h>
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <iomanip>
+
+/* Get a serialized key for the bloom tests. */
+std::vector<uint8_t> BloomKey(const uint32_t n)
+{
+    DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+    ssKey << std::string("bloom") << n;
+
+    return ssKey.Bytes();
+}
+
+
+/* Count the keys that are missing or point to the wrong sector. */
+uint32_t BloomMissing(LLD::BinaryHashMap* pmap, const uint32_t nKeys)
+{
+    uint32_t nMissing = 0;
+    for(uint32_t n = 0; n < nKeys; ++n)
+    {
+        LLD::SectorKey cKey;
+        if(!pmap->Get(BloomKey(n), cKey) || cKey.nSectorStart != n)
+            ++nMissing;
+    }
+
+    return nMissing;
+}
+
+
+/* Count the hashmap file reads for keys that were never written. */
+uint64_t BloomNegativeReads(LLD::BinaryHashMap* pmap, const uint32_t nKeys)
+{
+    const uint64_t nReads = pmap->FileReads();
+    for(uint32_t n = 0; n < nKeys; ++n)
+    {
+        LLD::SectorKey cKey;
+        REQUIRE_FALSE(pmap->Get(BloomKey(1000000 + n), cKey));
+    }
+
+    return pmap->FileReads() - nReads;
+}
+
+
+TEST_CASE("LLD hashmap bloom filter tests", "[LLD]")
+{
+    std::string strDir = config::GetDataDir() + "_BLOOM_TEST/";
+    filesystem::remove_directories(strDir);
+
+    //count file reads through the meters
+    config::mapArgs["-lldmeters"] = "1";
+
+    //a small table so buckets collide and keys spread over several hashmap files
+    const uint32_t nBuckets = 1024;
+    const uint32_t nKeys    = 4096;
+
+    const std::string strFilter = strDir + "_bloom.00000";
+    {
+        LLD::BinaryHashMap* pmap = new LLD::BinaryHashMap(strDir, LLD::FLAGS::CREATE, nBuckets);
+        for(uint32_t n = 0; n < nKeys; ++n)
+        {
+            REQUIRE(pmap->Put(LLD::SectorKey(LLD::STATE::READY, BloomKey(n), 0, n, 1)));
+        }
+
+        REQUIRE(BloomMissing(pmap, nKeys) == 0);
+        REQUIRE(filesystem::exists(strFilter));
+
+        //negative lookups are answered by the filters, apart from false positives
+        REQUIRE(BloomNegativeReads(pmap, nKeys) < nKeys / 10);
+
+        delete pmap;
+    }
+
+    //after a restart the filters are loaded from disk, and still hold every key
+    {
+        LLD::BinaryHashMap* pmap = new LLD::BinaryHashMap(strDir, LLD::FLAGS::APPEND, nBuckets);
+        REQUIRE(BloomMissing(pmap, nKeys) == 0);
+        REQUIRE(BloomNegativeReads(pmap, nKeys) < nKeys / 10);
+
+        delete pmap;
+    }
+
+    //missing filters are rebuilt from the hashmap files
+    {
+        for(uint16_t nFile = 0; ; ++nFile)
+        {
+            const std::string strFile = debug::safe_printstr(strDir, "_bloom.", std::setfill('0'), std::setw(5), nFile);
+            if(!filesystem::exists(strFile))
+                break;
+
+            REQUIRE(filesystem::remove(strFile));
+        }
+        REQUIRE_FALSE(filesystem::exists(strFilter));
+
+        LLD::BinaryHashMap* pmap = new LLD::BinaryHashMap(strDir, LLD::FLAGS::APPEND, nBuckets);
+        REQUIRE(filesystem::exists(strFilter));
+
+        REQUIRE(BloomMissing(pmap, nKeys) == 0);
+        REQUIRE(BloomNegativeReads(pmap, nKeys) < nKeys / 10);
+
+        //keys written after the rebuild reach the rebuilt filters
+        REQUIRE(pmap->Put(LLD::SectorKey(LLD::STATE::READY, BloomKey(nKeys), 0, nKeys, 1)));
+        REQUIRE(BloomMissing(pmap, nKeys + 1) == 0);
+
+        delete pmap;
+    }
+
+    //a synced filter holds every key written before the sync
+    {
+        const std::string strSynced = strDir + "_bloom.synced";
+
+        LLD::BloomFilter filter(nKeys);
+        REQUIRE(filter.Sync());
+        REQUIRE(filter.Create(strSynced));
+
+        for(uint32_t n = 0; n < nKeys; ++n)
+        {
+            const std::vector<uint8_t> vKey = BloomKey(n);
+            filter.Insert(&vKey[0], vKey.size());
+        }
+        REQUIRE(filter.Sync());
+
+        LLD::BloomFilter loaded(nKeys);
+        REQUIRE(loaded.Load(strSynced));
+        for(uint32_t n = 0; n < nKeys; ++n)
+        {
+            const std::vector<uint8_t> vKey = BloomKey(n);
+            REQUIRE(loaded.Has(&vKey[0], vKey.size()));
+        }
+    }
+
+    config::mapArgs.erase("-lldmeters");
+    filesystem::remove_directories(strDir);
+}
@@ -0,0 +1,230 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_lru.h>
+
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/mutex.h>
+#include <Util/include/runtime.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <thread>
+
+
+/* A memory mapped sector database that compacts and retires its files on demand. */
+class CompactDB : public LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>
+{
+public:
+
+    /* A cache too small to hold the records, so reads go to the memory maps. */
+    CompactDB(const uint8_t nFlagsIn)
+    : LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>("_COMPACT_TEST", nFlagsIn | LLD::FLAGS::MMAP, 7777, 1024)
+    {
+    }
+
+    /* Start a new sector file on the next write. */
+    void Rollover()
+    {
+        LOCK(SECTOR_MUTEX);
+        nCurrentFileSize = LLD::MAX_SECTOR_FILE_SIZE + 1;
+    }
+
+    /* Check if the database compacts its files. */
+    bool Compacting() const
+    {
+        return fCompact;
+    }
+
+    /* Get the dead bytes of a sector file. */
+    uint64_t DeadBytes(const uint32_t nFile)
+    {
+        LOCK(COMPACT_MUTEX);
+
+        auto it = mapDeadBytes.find(nFile);
+        return (it == mapDeadBytes.end()) ? 0 : it->second;
+    }
+
+    /* Move the live records out of a sector file. */
+    bool Compact(const uint32_t nFile)
+    {
+        return CompactFile(nFile);
+    }
+
+    /* Truncate the compacted sector files. */
+    void Retire()
+    {
+        RetireFiles();
+    }
+};
+
+
+/* Get the size of a sector file of the compaction tests. */
+uint64_t CompactFileSize(const uint32_t nFile)
+{
+    std::ifstream stream(debug::safe_printstr(config::GetDataDir(), "_COMPACT_TEST/datachain/_block.", std::setfill('0'), std::setw(5), nFile),
+                         std::ios::in | std::ios::binary | std::ios::ate);
+
+    return stream ? static_cast<uint64_t>(stream.tellg()) : 0;
+}
+
+
+/* Get the value of a record of the compaction tests. */
+std::string CompactValue(const uint32_t nKey, const uint32_t nVersion)
+{
+    return std::string(900 + nVersion * 100, 'a' + nKey % 26) + std::to_string(nKey);
+}
+
+
+TEST_CASE("LLD compaction tests", "[LLD]")
+{
+    filesystem::remove_directories(config::GetDataDir() + "_COMPACT_TEST/");
+
+    const std::string strCompact = config::GetArg("-lldcompact", "");
+    config::mapArgs["-lldcompact"] = "1";
+
+    CompactDB* db = new CompactDB(LLD::FLAGS::CREATE | LLD::FLAGS::FORCE);
+    REQUIRE(db->Compacting());
+
+    //records in file 0, two of three rewritten at a new size into file 1
+    std::map<uint32_t, std::string> mapExpected;
+    for(uint32_t n = 0; n < 300; ++n)
+    {
+        mapExpected[n] = CompactValue(n, 0);
+        REQUIRE(db->Write(n, mapExpected[n]));
+    }
+
+    db->Rollover();
+    for(uint32_t n = 0; n < 300; ++n)
+    {
+        if(n % 3 == 0)
+            continue;
+
+        mapExpected[n] = CompactValue(n, 1);
+        REQUIRE(db->Write(n, mapExpected[n]));
+    }
+
+    db->Rollover();
+    REQUIRE(db->Write(uint32_t(1000), std::string("current")));
+    mapExpected[1000] = "current";
+
+    const uint64_t nSize = CompactFileSize(0);
+    REQUIRE(nSize > 0);
+    REQUIRE(db->DeadBytes(0) > nSize / 2);
+
+    //readers and writers keep going while file 0 is compacted and truncated
+    {
+        std::atomic<bool> fStop(false);
+        std::atomic<uint32_t> nReads(0);
+        std::atomic<uint32_t> nFailed(0);
+
+        std::vector<std::thread> vThreads;
+        for(uint32_t n = 0; n < 4; ++n)
+        {
+            vThreads.push_back(std::thread([&]()
+            {
+                while(!fStop.load())
+                {
+                    for(const auto& record : mapExpected)
+                    {
+                        std::string strValue;
+                        if(!db->Read(record.first, strValue) || strValue != record.second)
+                            ++nFailed;
+
+                        ++nReads;
+                    }
+                }
+            }));
+        }
+
+        /* New records are written to the current file while the old ones move into it. */
+        std::thread tWriter([&]()
+        {
+            for(uint32_t n = 2000; n < 2300; ++n)
+            {
+                if(!db->Write(n, CompactValue(n, 2)))
+                    ++nFailed;
+            }
+        });
+
+        REQUIRE(db->Compact(0));
+
+        /* Let readers that got their keys before the move finish, as the compactor does between passes. */
+        runtime::sleep(200);
+
+        db->Retire();
+        REQUIRE(CompactFileSize(0) == 0);
+
+        /* Keep reading from the new locations after the truncation. */
+        runtime::sleep(200);
+
+        fStop = true;
+        tWriter.join();
+        for(auto& thread : vThreads)
+            thread.join();
+
+        REQUIRE(nReads.load() > mapExpected.size());
+        REQUIRE(nFailed.load() == 0);
+    }
+
+    //the moved records and the records written during the move survive a restart
+    delete db;
+    db = new CompactDB(LLD::FLAGS::APPEND);
+
+    for(const auto& record : mapExpected)
+    {
+        std::string strValue;
+        REQUIRE(db->Read(record.first, strValue));
+        REQUIRE(strValue == record.second);
+    }
+
+    for(uint32_t n = 2000; n < 2300; ++n)
+    {
+        std::string strValue;
+        REQUIRE(db->Read(n, strValue));
+        REQUIRE(strValue == CompactValue(n, 2));
+    }
+
+    REQUIRE(CompactFileSize(0) == 0);
+    REQUIRE(db->DeadBytes(0) == 0);
+
+    delete db;
+
+    //compaction is off by default
+    {
+        config::mapArgs.erase("-lldcompact");
+
+        db = new CompactDB(LLD::FLAGS::APPEND);
+        REQUIRE_FALSE(db->Compacting());
+
+        const uint64_t nDead = db->DeadBytes(2);
+        REQUIRE(db->Write(uint32_t(0), CompactValue(0, 3)));
+        REQUIRE(db->DeadBytes(2) == nDead);
+
+        delete db;
+    }
+
+    /* Restore the arguments. */
+    config::mapArgs.erase("-lldcompact");
+    if(!strCompact.empty())
+        config::mapArgs["-lldcompact"] = strCompact;
+
+    filesystem::remove_directories(config::GetDataDir() + "_COMPACT_TEST/");
+}
@@ -0,0 +1,52 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/compress.h>
+#include <LLD/include/version.h>
+
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+TEST_CASE("LLD record compression tests", "[LLD]")
+{
+    //build a record the way the sector database does
+    DataStream ssData(SER_LLD, LLD::DATABASE_VERSION);
+    ssData << std::string("test") << std::string(4096, 'x');
+
+    const std::vector<uint8_t> vRecord = ssData.Bytes();
+
+    //compressible records are stored smaller with the marker
+    std::vector<uint8_t> vStored;
+    REQUIRE(LLD::Compress(vRecord, vStored, 128));
+    REQUIRE(vStored.size() < vRecord.size());
+    REQUIRE(vStored[0] == LLD::RECORD_COMPRESSED);
+
+    //round trip back to the raw record
+    REQUIRE(LLD::Decompress(vStored));
+    REQUIRE(vStored == vRecord);
+
+    //raw records pass through unchanged
+    std::vector<uint8_t> vRaw = vRecord;
+    REQUIRE(LLD::Decompress(vRaw));
+    REQUIRE(vRaw == vRecord);
+
+    //small records stay raw
+    std::vector<uint8_t> vSmall(vRecord.begin(), vRecord.begin() + 64);
+    REQUIRE_FALSE(LLD::Compress(vSmall, vStored, 128));
+
+    //corrupted payloads fail to decompress
+    REQUIRE(LLD::Compress(vRecord, vStored, 128));
+    vStored.resize(vStored.size() / 2);
+    REQUIRE_FALSE(LLD::Decompress(vStored));
+}
@@ -0,0 +1,247 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/random.h>
+
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_lru.h>
+
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/mutex.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <fstream>
+#include <iomanip>
+
+
+/* A sector database that can start a new sector file on the next write. */
+class CursorDB : public LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>
+{
+public:
+
+    CursorDB(const uint8_t nFlagsIn)
+    : LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>("_CURSOR_TEST", nFlagsIn, 7777, 1024 * 1024)
+    {
+    }
+
+    /* Start a new sector file on the next write. */
+    void Rollover()
+    {
+        LOCK(SECTOR_MUTEX);
+        nCurrentFileSize = LLD::MAX_SECTOR_FILE_SIZE + 1;
+    }
+
+    /* Get the sector file being written. */
+    uint32_t CurrentFile() const
+    {
+        return nCurrentFile;
+    }
+};
+
+
+/* Get the path of a sector file of the cursor tests. */
+std::string CursorFile(const uint32_t nFile)
+{
+    return debug::safe_printstr(config::GetDataDir(), "_CURSOR_TEST/datachain/_block.", std::setfill('0'), std::setw(5), nFile);
+}
+
+
+/* Get the size of a sector file of the cursor tests. */
+uint64_t CursorFileSize(const uint32_t nFile)
+{
+    std::ifstream stream(CursorFile(nFile), std::ios::in | std::ios::binary | std::ios::ate);
+    return stream ? static_cast<uint64_t>(stream.tellg()) : 0;
+}
+
+
+/* Get every value of a type from a cursor, stopping every few records to resume from the cursor. */
+std::vector<std::string> CursorScan(CursorDB* db, const std::string& strType, LLD::SectorCursor& cursor, const uint32_t nStep)
+{
+    std::vector<std::string> vValues;
+
+    bool fStopped = true;
+    while(fStopped)
+    {
+        fStopped = db->ForEach<std::string>(strType, cursor, [&](std::string& strValue)
+        {
+            vValues.push_back(strValue);
+            return (vValues.size() % nStep != 0);
+        });
+    }
+
+    return vValues;
+}
+
+
+TEST_CASE("LLD cursor tests", "[LLD]")
+{
+    filesystem::remove_directories(config::GetDataDir() + "_CURSOR_TEST/");
+
+    /* Read in the smallest chunks, so large records have to grow the buffer. */
+    const std::string strReadAhead = config::GetArg("-lldreadahead", "");
+    config::mapArgs["-lldreadahead"] = "64";
+
+    CursorDB* db = new CursorDB(LLD::FLAGS::CREATE | LLD::FLAGS::FORCE | LLD::FLAGS::COMPRESS);
+
+    //records in three sector files, with compressible, incompressible, and large records
+    std::vector<std::string> vText;
+    std::vector<std::string> vOther;
+    for(uint32_t nFile = 0; nFile < 3; ++nFile)
+    {
+        for(uint32_t n = 0; n < 100; ++n)
+        {
+            const uint32_t nKey = nFile * 100 + n;
+
+            std::string strValue;
+            if(n % 3 == 0)
+                strValue = std::string(1000, 'a' + n % 26);
+            else if(n % 3 == 1)
+            {
+                for(uint32_t i = 0; i < 300; ++i)
+                    strValue.push_back(static_cast<char>(LLC::GetRand(256)));
+            }
+            else
+                strValue = "short" + std::to_string(nKey);
+
+            /* A record larger than the read buffer, which has to grow for it. */
+            if(n == 50)
+            {
+                strValue.clear();
+                for(uint32_t i = 0; i < 200 * 1024; ++i)
+                    strValue.push_back(static_cast<char>(LLC::GetRand(256)));
+            }
+
+            REQUIRE(db->Write(nKey, strValue, "text"));
+            vText.push_back(strValue);
+
+            REQUIRE(db->Write(std::string("other") + std::to_string(nKey), strValue, "other"));
+            vOther.push_back(strValue);
+        }
+
+        if(nFile < 2)
+            db->Rollover();
+    }
+
+    REQUIRE(db->CurrentFile() == 2);
+    REQUIRE(filesystem::exists(CursorFile(1)));
+    REQUIRE_FALSE(filesystem::exists(CursorFile(3)));
+
+    //compressible records are stored compressed, and scanned in their original form
+    {
+        const uint64_t nSize = CursorFileSize(2);
+
+        const std::string strValue = std::string(64 * 1024, 'z');
+        REQUIRE(db->Write(std::string("compressed"), strValue, "compressed"));
+        REQUIRE(CursorFileSize(2) - nSize < 4096);
+
+        LLD::SectorCursor cursor;
+        REQUIRE(CursorScan(db, "compressed", cursor, 1000) == std::vector<std::string>(1, strValue));
+    }
+
+    //a scan crosses the sector files in order, from any stopping point
+    {
+        LLD::SectorCursor cursor;
+        REQUIRE(CursorScan(db, "text", cursor, 1000) == vText);
+        REQUIRE(cursor.nFile == 2);
+
+        cursor = LLD::SectorCursor();
+        REQUIRE(CursorScan(db, "text", cursor, 7) == vText);
+
+        cursor = LLD::SectorCursor();
+        REQUIRE(CursorScan(db, "other", cursor, 1) == vOther);
+    }
+
+    //a cursor at the end of the datachain picks up records appended after it
+    {
+        LLD::SectorCursor cursor;
+        REQUIRE(CursorScan(db, "text", cursor, 1000).size() == vText.size());
+        REQUIRE(CursorScan(db, "text", cursor, 1000).empty());
+
+        REQUIRE(db->Write(uint32_t(1000), std::string("appended"), "text"));
+        vText.push_back("appended");
+
+        REQUIRE(CursorScan(db, "text", cursor, 1000) == std::vector<std::string>(1, "appended"));
+        REQUIRE(CursorScan(db, "text", cursor, 1000).empty());
+    }
+
+    //erased records stay in the datachain until they are compacted
+    {
+        for(uint32_t n = 0; n < 100; n += 2)
+        {
+            REQUIRE(db->Erase(n));
+        }
+
+        LLD::SectorCursor cursor;
+        REQUIRE(CursorScan(db, "text", cursor, 13) == vText);
+    }
+
+    //a value that doesn't deserialize is skipped, and the scan goes on
+    {
+        REQUIRE(db->Write(uint32_t(1001), uint8_t(200), "text"));
+        REQUIRE(db->Write(uint32_t(1002), std::string("after"), "text"));
+        vText.push_back("after");
+
+        LLD::SectorCursor cursor;
+        REQUIRE(CursorScan(db, "text", cursor, 1000) == vText);
+    }
+
+    delete db;
+
+    //a torn record at the end of the newest file ends the scan before it
+    {
+        db = new CursorDB(LLD::FLAGS::APPEND | LLD::FLAGS::COMPRESS);
+
+        /* Find the start of the last record. */
+        LLD::SectorCursor cursor;
+        std::vector<std::string> vValues;
+        db->ForEach<std::string>("text", cursor, [&](std::string& strValue)
+        {
+            vValues.push_back(strValue);
+            return (vValues.size() < vText.size() - 1);
+        });
+
+        const uint64_t nLast = cursor.nStart;
+        delete db;
+
+        /* Tear the last record. */
+        {
+            std::ifstream stream(CursorFile(2), std::ios::in | std::ios::binary);
+            std::vector<char> vData((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            stream.close();
+
+            REQUIRE(vData.size() > nLast + 4);
+
+            std::ofstream file(CursorFile(2), std::ios::out | std::ios::binary | std::ios::trunc);
+            file.write(&vData[0], nLast + 4);
+        }
+
+        db = new CursorDB(LLD::FLAGS::APPEND | LLD::FLAGS::COMPRESS);
+
+        cursor = LLD::SectorCursor();
+        REQUIRE(CursorScan(db, "text", cursor, 1000) == std::vector<std::string>(vText.begin(), vText.end() - 1));
+        REQUIRE(cursor.nFile  == 2);
+        REQUIRE(cursor.nStart == nLast);
+
+        delete db;
+    }
+
+    /* Restore the arguments. */
+    config::mapArgs.erase("-lldreadahead");
+    if(!strReadAhead.empty())
+        config::mapArgs["-lldreadahead"] = strReadAhead;
+
+    filesystem::remove_directories(config::GetDataDir() + "_CURSOR_TEST/");
+}
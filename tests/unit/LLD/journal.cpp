@@ -0,0 +1,180 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/global.h>
+
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <fstream>
+
+/* Get the size of the shared transaction journal on disk. */
+uint64_t JournalSize()
+{
+    std::ifstream stream(config::GetDataDir() + "journal.wal", std::ios::in | std::ios::binary | std::ios::ate);
+    if(!stream.is_open())
+        return 0;
+
+    return static_cast<uint64_t>(stream.tellg());
+}
+
+
+TEST_CASE("LLD global transaction recovery tests", "[LLD]")
+{
+    typedef LLD::SectorDatabase<LLD::Keychain, LLD::BinaryLRU> JournalDB;
+
+    JournalDB* pLocal  = LLD::Local;
+    JournalDB* pLedger = LLD::Ledger;
+
+    REQUIRE(pLocal);
+    REQUIRE(pLedger);
+
+    //start clean
+    REQUIRE(JournalSize() == 0);
+
+    //index a key that doesn't exist yet, so the ledger fails partway through its commit
+    {
+        LLD::TxnBegin();
+
+        REQUIRE(pLocal->Write(std::string("journal-local"), std::string("first")));
+        REQUIRE(pLedger->Write(std::string("journal-ledger"), std::string("ledger")));
+        REQUIRE(pLedger->Index(std::string("journal-index"), std::string("journal-missing")));
+
+        LLD::TxnCommit();
+    }
+
+    //the local database committed, the ledger index didn't, and the journal is kept
+    std::string strValue;
+    REQUIRE(pLocal->Read(std::string("journal-local"), strValue));
+    REQUIRE(strValue == "first");
+    REQUIRE_FALSE(pLedger->Read(std::string("journal-index"), strValue));
+
+    const uint64_t nKept = JournalSize();
+    REQUIRE(nKept > 0);
+
+    //a later commit succeeds, but can't clear the journal ahead of the failed one
+    {
+        LLD::TxnBegin();
+
+        REQUIRE(pLocal->Write(std::string("journal-local"), std::string("second")));
+
+        LLD::TxnCommit();
+    }
+
+    REQUIRE(JournalSize() > nKept);
+
+    //write the missing key and recover
+    REQUIRE(pLedger->Write(std::string("journal-missing"), std::string("missing")));
+    LLD::TxnRecovery();
+
+    //both transactions are replayed in order and the journal is cleared
+    REQUIRE(JournalSize() == 0);
+
+    REQUIRE(pLedger->Read(std::string("journal-index"), strValue));
+    REQUIRE(strValue == "missing");
+
+    REQUIRE(pLedger->Read(std::string("journal-ledger"), strValue));
+    REQUIRE(strValue == "ledger");
+
+    REQUIRE(pLocal->Read(std::string("journal-local"), strValue));
+    REQUIRE(strValue == "second");
+
+    //commits clear the journal again
+    {
+        LLD::TxnBegin();
+
+        REQUIRE(pLocal->Write(std::string("journal-local"), std::string("third")));
+
+        LLD::TxnCommit();
+    }
+
+    REQUIRE(JournalSize() == 0);
+
+    REQUIRE(pLocal->Read(std::string("journal-local"), strValue));
+    REQUIRE(strValue == "third");
+}
+
+
+/* Write a per database journal in the string tagged format of older releases. */
+void LegacyJournal(const std::string& strName, const std::string& strKey, const std::string& strValue, const bool fCommit)
+{
+    DataStream ssJournal(SER_LLD, LLD::DATABASE_VERSION);
+    if(!strKey.empty())
+    {
+        DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+        ssKey << strKey;
+
+        /* Records are journaled as written, with their type first. */
+        DataStream ssData(SER_LLD, LLD::DATABASE_VERSION);
+        ssData << std::string("NONE") << strValue;
+
+        ssJournal << std::string("write") << ssKey.Bytes() << ssData.Bytes();
+    }
+
+    if(fCommit)
+        ssJournal << std::string("commit");
+
+    std::ofstream stream(config::GetDataDir() + strName + "/journal.dat", std::ios::out | std::ios::binary | std::ios::trunc);
+    stream.write((char*)ssJournal.data(), ssJournal.size());
+}
+
+
+TEST_CASE("LLD legacy journal recovery tests", "[LLD]")
+{
+    typedef LLD::SectorDatabase<LLD::Keychain, LLD::BinaryLRU> JournalDB;
+
+    std::vector<std::string> vNames;
+    for(JournalDB* pdb : std::vector<JournalDB*>({ LLD::Contract, LLD::Register, LLD::Ledger, LLD::Local, LLD::Client, LLD::Trust, LLD::Legacy }))
+    {
+        if(pdb)
+            vNames.push_back(pdb->GetName());
+    }
+
+    REQUIRE(vNames.size() > 1);
+
+    //a transaction that reached its commit on every database is replayed, and the journals are removed
+    {
+        for(const auto& strName : vNames)
+            LegacyJournal(strName, (strName == "_LOCAL") ? "legacy-local" : "", "recovered", true);
+
+        LLD::TxnRecovery();
+
+        std::string strValue;
+        REQUIRE(LLD::Local->Read(std::string("legacy-local"), strValue));
+        REQUIRE(strValue == "recovered");
+
+        for(const auto& strName : vNames)
+        {
+            REQUIRE_FALSE(filesystem::exists(config::GetDataDir() + strName + "/journal.dat"));
+        }
+    }
+
+    //a transaction that one database never committed is dropped, and the journals are removed
+    {
+        for(const auto& strName : vNames)
+            LegacyJournal(strName, (strName == "_LOCAL") ? "legacy-dropped" : "", "dropped", strName != "_LEDGER");
+
+        LLD::TxnRecovery();
+
+        std::string strValue;
+        REQUIRE_FALSE(LLD::Local->Read(std::string("legacy-dropped"), strValue));
+
+        for(const auto& strName : vNames)
+        {
+            REQUIRE_FALSE(filesystem::exists(config::GetDataDir() + strName + "/journal.dat"));
+        }
+    }
+}
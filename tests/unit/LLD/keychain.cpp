@@ -0,0 +1,71 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/keychain/keychain.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/keychain/shard_hashmap.h>
+#include <LLD/include/enum.h>
+
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <memory>
+
+TEST_CASE("LLD keychain backend tests", "[LLD]")
+{
+    const std::string strDir = config::GetDataDir() + "_KEYCHAIN_TEST/keychain/";
+    const uint8_t nFlags = LLD::FLAGS::CREATE | LLD::FLAGS::FORCE;
+
+    filesystem::remove_directories(config::GetDataDir() + "_KEYCHAIN_TEST/");
+
+    //a new keychain records the default backend
+    {
+        std::unique_ptr<LLD::Keychain> pKeychain(LLD::Keychain::Create("_KEYCHAIN_TEST", strDir, nFlags, 256));
+        REQUIRE(dynamic_cast<LLD::BinaryHashMap*>(pKeychain.get()));
+    }
+    REQUIRE(LLD::ReadKeychainType(strDir) == "hashmap");
+
+    //asking for another backend over an existing keychain is refused
+    config::mapArgs["-keychain_testkeychain"] = "shard";
+    REQUIRE_THROWS(LLD::Keychain::Create("_KEYCHAIN_TEST", strDir, nFlags, 256));
+
+    //a new keychain records the backend it was created with
+    filesystem::remove_directories(config::GetDataDir() + "_KEYCHAIN_TEST/");
+    {
+        std::unique_ptr<LLD::Keychain> pKeychain(LLD::Keychain::Create("_KEYCHAIN_TEST", strDir, nFlags, 256));
+        REQUIRE(dynamic_cast<LLD::ShardHashMap*>(pKeychain.get()));
+    }
+    REQUIRE(LLD::ReadKeychainType(strDir) == "shard");
+
+    //and opens with it when the argument is dropped
+    config::mapArgs.erase("-keychain_testkeychain");
+    {
+        std::unique_ptr<LLD::Keychain> pKeychain(LLD::Keychain::Create("_KEYCHAIN_TEST", strDir, nFlags, 256));
+        REQUIRE(dynamic_cast<LLD::ShardHashMap*>(pKeychain.get()));
+    }
+
+    //keychains from before the backend was recorded are detected from their files
+    filesystem::remove_directories(config::GetDataDir() + "_KEYCHAIN_TEST/");
+    {
+        std::unique_ptr<LLD::Keychain> pKeychain(new LLD::BinaryHashMap(strDir, nFlags, 256));
+    }
+    REQUIRE(LLD::ReadKeychainType(strDir) == "hashmap");
+
+    config::mapArgs["-keychain_testkeychain"] = "hashtree";
+    REQUIRE_THROWS(LLD::Keychain::Create("_KEYCHAIN_TEST", strDir, nFlags, 256));
+    config::mapArgs.erase("-keychain_testkeychain");
+
+    filesystem::remove_directories(config::GetDataDir() + "_KEYCHAIN_TEST/");
+}
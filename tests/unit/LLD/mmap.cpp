@@ -0,0 +1,96 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_lru.h>
+
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/runtime.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <atomic>
+#include <thread>
+
+
+/* A memory mapped sector database with a cache too small to hold its records. */
+class MappedDB : public LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>
+{
+public:
+
+    MappedDB(const uint8_t nFlagsIn)
+    : LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>("_MMAP_TEST", nFlagsIn | LLD::FLAGS::MMAP, 7777, 1024)
+    {
+    }
+};
+
+
+TEST_CASE("LLD memory map tests", "[LLD]")
+{
+    filesystem::remove_directories(config::GetDataDir() + "_MMAP_TEST/");
+
+    MappedDB* db = new MappedDB(LLD::FLAGS::CREATE | LLD::FLAGS::FORCE);
+
+    /* Two values of the same size, so every write is in place. */
+    const std::string strFirst  = std::string(8192, 'a');
+    const std::string strSecond = std::string(8192, 'b');
+
+    for(uint32_t n = 0; n < 8; ++n)
+    {
+        REQUIRE(db->Write(n, strFirst));
+    }
+
+    //reads through the map never see a record half written in place
+    {
+        std::atomic<bool> fStop(false);
+        std::atomic<uint32_t> nReads(0);
+        std::atomic<uint32_t> nTorn(0);
+
+        std::vector<std::thread> vThreads;
+        for(uint32_t n = 0; n < 4; ++n)
+        {
+            vThreads.push_back(std::thread([&]()
+            {
+                while(!fStop.load())
+                {
+                    for(uint32_t nKey = 0; nKey < 8; ++nKey)
+                    {
+                        std::string strValue;
+                        if(!db->Read(nKey, strValue) || (strValue != strFirst && strValue != strSecond))
+                            ++nTorn;
+
+                        ++nReads;
+                    }
+                }
+            }));
+        }
+
+        for(uint32_t n = 0; n < 2000; ++n)
+        {
+            REQUIRE(db->Write(n % 8, (n % 2) ? strFirst : strSecond));
+        }
+
+        fStop = true;
+        for(auto& thread : vThreads)
+            thread.join();
+
+        REQUIRE(nReads.load() > 0);
+        REQUIRE(nTorn.load() == 0);
+    }
+
+    delete db;
+
+    filesystem::remove_directories(config::GetDataDir() + "_MMAP_TEST/");
+}
@@ -0,0 +1,259 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_lru.h>
+
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/mutex.h>
+#include <Util/include/runtime.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <fstream>
+#include <map>
+
+
+/* A sector database that exposes its posting lists. */
+class PostingDB : public LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>
+{
+public:
+
+    PostingDB(const uint8_t nFlagsIn)
+    : LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>("_POSTINGS_TEST", nFlagsIn, 7777, 1024 * 1024)
+    {
+    }
+
+    /* Check if typed scans use the posting lists. */
+    bool Posted() const
+    {
+        return fPostings.load();
+    }
+
+    /* Wait for a rebuild of the posting lists to finish. */
+    bool WaitPosted()
+    {
+        for(uint32_t n = 0; n < 10000 && !fPostings.load(); ++n)
+            runtime::sleep(1);
+
+        return fPostings.load();
+    }
+
+    /* Get the number of blocks posted for a type. */
+    uint32_t Blocks(const std::string& strType)
+    {
+        LOCK(POSTING_MUTEX);
+
+        auto it = mapPostings.find(strType);
+        return (it == mapPostings.end()) ? 0 : static_cast<uint32_t>(it->second.size());
+    }
+};
+
+
+/* Get every value of a type by a typed scan. */
+std::vector<std::string> PostingScan(PostingDB* db, const std::string& strType)
+{
+    std::vector<std::string> vValues;
+    db->ForEach<std::string>(strType, [&](std::string& strValue)
+    {
+        vValues.push_back(strValue);
+        return true;
+    });
+
+    return vValues;
+}
+
+
+/* Get every value of each type the tests write. */
+std::map<std::string, std::vector<std::string>> PostingScanAll(PostingDB* db)
+{
+    std::map<std::string, std::vector<std::string>> mapValues;
+    for(const std::string strType : { "alpha", "beta", "gamma", "delta", "none" })
+        mapValues[strType] = PostingScan(db, strType);
+
+    return mapValues;
+}
+
+
+/* Get the size of a file. */
+uint64_t PostingFileSize(const std::string& strFile)
+{
+    std::ifstream stream(strFile, std::ios::in | std::ios::binary | std::ios::ate);
+    return stream ? static_cast<uint64_t>(stream.tellg()) : 0;
+}
+
+
+TEST_CASE("LLD posting list tests", "[LLD]")
+{
+    const std::string strPath     = config::GetDataDir() + "_POSTINGS_TEST/";
+    const std::string strPostings = strPath + "datachain/_postings";
+    filesystem::remove_directories(strPath);
+
+    const std::string strTypeIndex = config::GetArg("-lldtypeindex", "");
+    const std::string strCompact   = config::GetArg("-lldcompact", "");
+
+    /* Keep the erased records in the datachain, so the scans are the same with or without the lists. */
+    config::mapArgs["-lldtypeindex"] = "1";
+    config::mapArgs["-lldcompact"]   = "0";
+
+    /* A new database builds its empty lists straight away. */
+    PostingDB* db = new PostingDB(LLD::FLAGS::CREATE | LLD::FLAGS::FORCE);
+    REQUIRE(db->WaitPosted());
+
+    //records that span three posting blocks, with gamma only in the later two
+    std::map<std::string, std::vector<std::string>> mapExpected;
+    for(uint32_t n = 0; n < 900; ++n)
+    {
+        const std::string strType  = (n >= 600) ? "gamma" : (n % 2 ? "alpha" : "beta");
+        const std::string strValue = std::string(700, 'a' + n % 26) + std::to_string(n);
+
+        REQUIRE(db->Write(n, strValue, strType));
+        mapExpected[strType].push_back(strValue);
+    }
+
+    //writes post their own records
+    {
+        REQUIRE(PostingScan(db, "alpha") == mapExpected["alpha"]);
+        REQUIRE(PostingScan(db, "beta")  == mapExpected["beta"]);
+        REQUIRE(PostingScan(db, "gamma") == mapExpected["gamma"]);
+        REQUIRE(PostingScan(db, "delta").empty());
+
+        REQUIRE(db->Blocks("alpha") == 2);
+        REQUIRE(db->Blocks("gamma") == 2);
+        REQUIRE(db->Blocks("delta") == 0);
+    }
+
+    //typed scans resume from a cursor inside a posted block
+    {
+        std::vector<std::string> vValues;
+        LLD::SectorCursor cursor;
+
+        bool fStopped = true;
+        while(fStopped)
+        {
+            fStopped = db->ForEach<std::string>("gamma", cursor, [&](std::string& strValue)
+            {
+                vValues.push_back(strValue);
+                return (vValues.size() % 50 != 0);
+            });
+        }
+
+        REQUIRE(vValues == mapExpected["gamma"]);
+    }
+
+    //erased records stay in the datachain, and a key written again is posted under its new type
+    for(uint32_t n = 1; n < 100; n += 2)
+    {
+        REQUIRE(db->Erase(n));
+    }
+
+    for(uint32_t n = 1; n < 20; n += 2)
+    {
+        const std::string strValue = "delta" + std::to_string(n);
+
+        REQUIRE(db->Write(n, strValue, "delta"));
+        mapExpected["delta"].push_back(strValue);
+    }
+
+    REQUIRE(PostingScan(db, "alpha") == mapExpected["alpha"]);
+    REQUIRE(PostingScan(db, "delta") == mapExpected["delta"]);
+    REQUIRE(db->Blocks("delta") == 1);
+
+    delete db;
+
+    //the same scans read the whole datachain without the lists
+    config::mapArgs["-lldtypeindex"] = "0";
+    db = new PostingDB(LLD::FLAGS::APPEND);
+    REQUIRE_FALSE(db->Posted());
+
+    const std::map<std::string, std::vector<std::string>> mapScan = PostingScanAll(db);
+    REQUIRE(mapScan.at("alpha") == mapExpected["alpha"]);
+    REQUIRE(mapScan.at("delta") == mapExpected["delta"]);
+
+    delete db;
+    config::mapArgs["-lldtypeindex"] = "1";
+
+    //lists on disk are loaded on open
+    {
+        const uint64_t nSize = PostingFileSize(strPostings);
+        REQUIRE(nSize > 0);
+
+        db = new PostingDB(LLD::FLAGS::APPEND);
+        REQUIRE(db->Posted());
+        REQUIRE((PostingScanAll(db) == mapScan));
+        delete db;
+
+        REQUIRE(PostingFileSize(strPostings) == nSize);
+    }
+
+    //a torn end of the lists is dropped, and the records after the last entry are posted again
+    {
+        const uint64_t nSize = PostingFileSize(strPostings);
+        {
+            std::ifstream stream(strPostings, std::ios::in | std::ios::binary);
+            std::vector<char> vData((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            stream.close();
+
+            std::ofstream file(strPostings, std::ios::out | std::ios::binary | std::ios::trunc);
+            file.write(&vData[0], nSize - 3);
+        }
+
+        db = new PostingDB(LLD::FLAGS::APPEND);
+        REQUIRE(db->Posted());
+        REQUIRE((PostingScanAll(db) == mapScan));
+        REQUIRE(db->Blocks("delta") == 1);
+        delete db;
+
+        REQUIRE(PostingFileSize(strPostings) == nSize);
+    }
+
+    //missing lists are rebuilt in the background, with scans reading every record until then
+    {
+        REQUIRE(filesystem::remove(strPostings));
+
+        db = new PostingDB(LLD::FLAGS::APPEND);
+        REQUIRE((PostingScanAll(db) == mapScan));
+        REQUIRE(db->WaitPosted());
+        REQUIRE((PostingScanAll(db) == mapScan));
+        REQUIRE(db->Blocks("alpha") == 2);
+        REQUIRE(db->Blocks("gamma") == 2);
+        delete db;
+
+        REQUIRE(filesystem::exists(strPostings));
+    }
+
+    //the lists are off by default
+    {
+        REQUIRE(filesystem::remove(strPostings));
+
+        config::mapArgs.erase("-lldtypeindex");
+        db = new PostingDB(LLD::FLAGS::APPEND);
+        REQUIRE_FALSE(db->Posted());
+        REQUIRE((PostingScanAll(db) == mapScan));
+        delete db;
+
+        REQUIRE_FALSE(filesystem::exists(strPostings));
+    }
+
+    /* Restore the arguments. */
+    config::mapArgs.erase("-lldtypeindex");
+    config::mapArgs.erase("-lldcompact");
+    if(!strTypeIndex.empty())
+        config::mapArgs["-lldtypeindex"] = strTypeIndex;
+    if(!strCompact.empty())
+        config::mapArgs["-lldcompact"] = strCompact;
+
+    filesystem::remove_directories(strPath);
+}
@@ -0,0 +1,77 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_lru.h>
+
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+
+#include <unit/catch2/catch.hpp>
+
+TEST_CASE("LLD batched read tests", "[LLD]")
+{
+    filesystem::remove_directories(config::GetDataDir() + "_READMANY_TEST/");
+
+    LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>* db =
+        new LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>("_READMANY_TEST", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 7777, 1024 * 1024);
+
+    //records of different sizes, so coalesced reads have to split them at the right offsets
+    std::vector<uint32_t> vKeys;
+    for(uint32_t n = 0; n < 500; ++n)
+    {
+        REQUIRE(db->Write(n, std::string(n % 37 + 1, 'a' + n % 26)));
+        vKeys.push_back(n);
+    }
+
+    REQUIRE(db->Index(std::string("alias"), uint32_t(42)));
+
+    //reopen so the cache is cold and the records are read from disk
+    delete db;
+    db = new LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>("_READMANY_TEST", LLD::FLAGS::APPEND, 7777, 1024 * 1024);
+
+    //records pending in a transaction are not read from disk
+    db->TxnBegin();
+    REQUIRE(db->Erase(uint32_t(7)));
+    REQUIRE(db->ReadMany(std::vector<uint32_t>(1, 7)) == 0);
+    db->TxnRelease();
+
+    //keys in reverse order, with some that were never written
+    std::vector<uint32_t> vBatch(vKeys.rbegin(), vKeys.rend());
+    vBatch.push_back(1000);
+    vBatch.push_back(1001);
+
+    REQUIRE(db->ReadMany(vBatch) == 500);
+
+    //cached records are not read again
+    REQUIRE(db->ReadMany(vBatch) == 0);
+
+    //the cache holds the right record for each key
+    for(uint32_t n = 0; n < 500; ++n)
+    {
+        std::string strValue;
+        REQUIRE(db->Read(n, strValue));
+        REQUIRE(strValue == std::string(n % 37 + 1, 'a' + n % 26));
+    }
+
+    //index keys read the sector of their record
+    REQUIRE(db->ReadMany(std::vector<std::string>(1, "alias")) == 1);
+
+    std::string strAlias;
+    REQUIRE(db->Read(std::string("alias"), strAlias));
+    REQUIRE(strAlias == std::string(42 % 37 + 1, 'a' + 42 % 26));
+
+    delete db;
+    filesystem::remove_directories(config::GetDataDir() + "_READMANY_TEST/");
+}
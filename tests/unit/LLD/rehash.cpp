@@ -0,0 +1,110 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/keychain/hashmap.h>
+#include <LLD/include/enum.h>
+#include <LLD/include/version.h>
+
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <chrono>
+#include <thread>
+
+/* Count the keys that are missing or point to the wrong sector. */
+uint32_t RehashMissing(LLD::BinaryHashMap* pmap, const std::vector< std::vector<uint8_t> >& vKeys)
+{
+    uint32_t nMissing = 0;
+    for(uint32_t n = 0; n < vKeys.size(); ++n)
+    {
+        LLD::SectorKey cKey;
+        if(!pmap->Get(vKeys[n], cKey) || cKey.nSectorStart != n)
+            ++nMissing;
+    }
+
+    return nMissing;
+}
+
+
+TEST_CASE("LLD hashmap rehash tests", "[LLD]")
+{
+    std::string strDir = config::GetDataDir() + "_REHASH_TEST/";
+    filesystem::remove_directories(strDir);
+
+    //build short keys and keys long enough to be compressed, which like hash keys vary across their bytes
+    std::vector< std::vector<uint8_t> > vKeys;
+    for(uint32_t n = 0; n < 20000; ++n)
+    {
+        DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+        if(n % 2 == 0)
+            ssKey << std::string("key") << n;
+        else
+            ssKey << n << (n * 7919) << std::string("long key that is compressed on disk");
+
+        vKeys.push_back(ssKey.Bytes());
+    }
+
+    //write half of the keys, then the rest while the rehash runs
+    {
+        LLD::BinaryHashMap* pmap = new LLD::BinaryHashMap(strDir, LLD::FLAGS::CREATE, 1000);
+        for(uint32_t n = 0; n < vKeys.size() / 2; ++n)
+        {
+            REQUIRE(pmap->Put(LLD::SectorKey(LLD::STATE::READY, vKeys[n], 0, n, 1)));
+        }
+
+        REQUIRE(pmap->Rehash(8000));
+        for(uint32_t n = vKeys.size() / 2; n < vKeys.size(); ++n)
+        {
+            REQUIRE(pmap->Put(LLD::SectorKey(LLD::STATE::READY, vKeys[n], 0, n, 1)));
+        }
+
+        REQUIRE(RehashMissing(pmap, vKeys) == 0);
+
+        //erased keys stay erased through the migration
+        REQUIRE(pmap->Erase(vKeys[0]));
+
+        LLD::SectorKey cKey;
+        REQUIRE_FALSE(pmap->Get(vKeys[0], cKey));
+        REQUIRE(pmap->Put(LLD::SectorKey(LLD::STATE::READY, vKeys[0], 0, 0, 1)));
+
+        //stopping part way checkpoints the rehash
+        delete pmap;
+    }
+
+    //reopening resumes the rehash and finishes it
+    {
+        LLD::BinaryHashMap* pmap = new LLD::BinaryHashMap(strDir, LLD::FLAGS::APPEND, 1000);
+        REQUIRE(RehashMissing(pmap, vKeys) == 0);
+
+        for(uint32_t n = 0; n < 100 && filesystem::exists(strDir + "_hashmap.index"); ++n)
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        REQUIRE_FALSE(filesystem::exists(strDir + "_hashmap.index"));
+        REQUIRE(RehashMissing(pmap, vKeys) == 0);
+
+        delete pmap;
+    }
+
+    //the new table is loaded from the metadata
+    {
+        LLD::BinaryHashMap* pmap = new LLD::BinaryHashMap(strDir, LLD::FLAGS::APPEND, 1000);
+        REQUIRE(RehashMissing(pmap, vKeys) == 0);
+
+        delete pmap;
+    }
+
+    filesystem::remove_directories(strDir);
+}
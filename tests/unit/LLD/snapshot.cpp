@@ -0,0 +1,193 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/sector.h>
+#include <LLD/include/snapshot.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_lru.h>
+
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+
+#include <unit/catch2/catch.hpp>
+
+TEST_CASE("LLD snapshot read tests", "[LLD]")
+{
+    filesystem::remove_directories(config::GetDataDir() + "_SNAPSHOT_TEST/");
+
+    LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>* db =
+        new LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>("_SNAPSHOT_TEST", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 7777, 1024 * 16);
+
+    REQUIRE(db->Write(std::string("one"), uint32_t(1)));
+    REQUIRE(db->Write(std::string("two"), uint32_t(2)));
+    REQUIRE(db->Index(std::string("alias"), std::string("one")));
+
+    uint32_t nValue = 0;
+
+    //a pinned snapshot keeps reading the epoch it pinned while a transaction commits
+    {
+        LLD::Snapshot snapshot;
+        REQUIRE(LLD::Snapshot::Pinned() != 0);
+
+        db->TxnBegin();
+        REQUIRE(db->Write(std::string("one"), uint32_t(10)));
+        REQUIRE(db->Erase(std::string("two")));
+        REQUIRE(db->Write(std::string("three"), uint32_t(3)));
+        REQUIRE(db->TxnCommit());
+        db->TxnRelease();
+
+        REQUIRE(db->Read(std::string("one"), nValue));
+        REQUIRE(nValue == 1);
+
+        //index keys share the sector that was overwritten in place
+        REQUIRE(db->Read(std::string("alias"), nValue));
+        REQUIRE(nValue == 1);
+
+        REQUIRE(db->Exists(std::string("two")));
+        REQUIRE_FALSE(db->Exists(std::string("three")));
+
+        //nested snapshots keep the outer epoch
+        {
+            LLD::Snapshot inner;
+            REQUIRE(db->Read(std::string("one"), nValue));
+            REQUIRE(nValue == 1);
+        }
+
+        REQUIRE(LLD::Snapshot::Pinned() != 0);
+    }
+
+    //without a snapshot reads see the committed epoch
+    REQUIRE(LLD::Snapshot::Pinned() == 0);
+
+    REQUIRE(db->Read(std::string("one"), nValue));
+    REQUIRE(nValue == 10);
+
+    REQUIRE(db->Read(std::string("alias"), nValue));
+    REQUIRE(nValue == 10);
+
+    REQUIRE_FALSE(db->Exists(std::string("two")));
+
+    REQUIRE(db->Read(std::string("three"), nValue));
+    REQUIRE(nValue == 3);
+
+    //a new snapshot pins the newest epoch
+    {
+        LLD::Snapshot snapshot;
+
+        REQUIRE(db->Read(std::string("three"), nValue));
+        REQUIRE(nValue == 3);
+    }
+
+    //reads outside a snapshot still see the pending transaction
+    db->TxnBegin();
+    REQUIRE(db->Write(std::string("one"), uint32_t(20)));
+
+    REQUIRE(db->Read(std::string("one"), nValue));
+    REQUIRE(nValue == 20);
+
+    db->TxnRelease();
+
+    REQUIRE(db->Read(std::string("one"), nValue));
+    REQUIRE(nValue == 10);
+
+    delete db;
+    filesystem::remove_directories(config::GetDataDir() + "_SNAPSHOT_TEST/");
+}
+
+
+/* A sector database that exposes its version list, to step through a snapshot read. */
+class VersionDB : public LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>
+{
+public:
+
+    VersionDB(const uint8_t nFlagsIn)
+    : LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>("_VERSION_TEST", nFlagsIn, 7777, 1024 * 16)
+    {
+    }
+
+    /* Load the current version list. */
+    std::shared_ptr< const std::vector< std::shared_ptr<LLD::SectorVersion> > > Versions()
+    {
+        return std::atomic_load(&pVersions);
+    }
+};
+
+
+/* Get the value of a record of the version tests, which is stored after its type. */
+uint32_t VersionValue(const std::vector<uint8_t>& vData)
+{
+    DataStream ssData(vData, SER_LLD, LLD::DATABASE_VERSION);
+
+    std::string strType;
+    uint32_t nValue = 0;
+    ssData >> strType >> nValue;
+
+    return nValue;
+}
+
+
+TEST_CASE("LLD snapshot commit interleaving tests", "[LLD]")
+{
+    filesystem::remove_directories(config::GetDataDir() + "_VERSION_TEST/");
+
+    VersionDB* db = new VersionDB(LLD::FLAGS::CREATE | LLD::FLAGS::FORCE);
+    REQUIRE(db->Write(std::string("one"), uint32_t(1)));
+
+    DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+    ssKey << std::string("one");
+
+    const std::vector<uint8_t> vKey = ssKey.Bytes();
+
+    //a commit that applies between checking the versions and reading the disk is caught
+    {
+        LLD::Snapshot snapshot;
+        const uint64_t nEpoch = LLD::Snapshot::Pinned();
+        REQUIRE(nEpoch != 0);
+
+        /* The first step of a read: the list as it was before the commit. */
+        const auto pList = db->Versions();
+        const auto vNewer = db->NewerVersions(pList, nEpoch);
+        REQUIRE(vNewer.empty());
+
+        /* A commit publishes, stores its priors and applies to disk in between. */
+        db->TxnBegin();
+        REQUIRE(db->Write(std::string("one"), uint32_t(2)));
+        REQUIRE(db->TxnCommit());
+        db->TxnRelease();
+
+        /* The second step of the read goes to disk and sees the newer value. */
+        std::vector<uint8_t> vData;
+        REQUIRE(db->ReadVersion(pList, vKey, vData, nEpoch));
+        REQUIRE(VersionValue(vData) == 2);
+
+        /* Which the newer versions give away, so the read is retried with the new list. */
+        const auto vCurrent = db->NewerVersions(db->Versions(), nEpoch);
+        REQUIRE(vCurrent.size() == 1);
+        REQUIRE(vCurrent[0].second != nullptr);
+        REQUIRE_FALSE(vCurrent == vNewer);
+
+        REQUIRE(db->GetVersion(vKey, vData, nEpoch));
+        REQUIRE(VersionValue(vData) == 1);
+
+        uint32_t nValue = 0;
+        REQUIRE(db->Read(std::string("one"), nValue));
+        REQUIRE(nValue == 1);
+    }
+
+    uint32_t nValue = 0;
+    REQUIRE(db->Read(std::string("one"), nValue));
+    REQUIRE(nValue == 2);
+
+    delete db;
+    filesystem::remove_directories(config::GetDataDir() + "_VERSION_TEST/");
+}
@@ -0,0 +1,139 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/wal.h>
+#include <LLD/include/enum.h>
+#include <LLD/include/version.h>
+
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/runtime.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <fstream>
+
+TEST_CASE("LLD write ahead log tests", "[LLD]")
+{
+    std::string strDir  = config::GetDataDir() + "_WAL_TEST/";
+    std::string strFile = strDir + "journal.wal";
+
+    filesystem::remove_directories(strDir);
+    REQUIRE(filesystem::create_directories(strDir));
+
+    std::vector<uint8_t> vKey  = {1, 2, 3, 4};
+    std::vector<uint8_t> vData = {5, 6, 7, 8, 9};
+
+    //write a full transaction
+    {
+        LLD::WriteAheadLog log(strFile);
+        REQUIRE(log.Size() == 0);
+
+        DataStream ssJournal(SER_LLD, LLD::DATABASE_VERSION);
+        LLD::WriteAheadLog::Encode(ssJournal, LLD::JOURNAL::WRITE, vKey, vData);
+        LLD::WriteAheadLog::Encode(ssJournal, LLD::JOURNAL::ERASE, vData, std::vector<uint8_t>());
+        LLD::WriteAheadLog::Encode(ssJournal, LLD::JOURNAL::COMMIT, std::vector<uint8_t>(), std::vector<uint8_t>());
+
+        REQUIRE(log.Append(ssJournal.Bytes()));
+        REQUIRE(log.Size() == ssJournal.size());
+    }
+
+    //replay the records after reopening
+    {
+        LLD::WriteAheadLog log(strFile);
+
+        std::vector<uint8_t> vOpcodes;
+        REQUIRE(log.Replay([&](const uint8_t nOpcode, const std::vector<uint8_t>& vKeyIn, const std::vector<uint8_t>& vDataIn)
+        {
+            if(nOpcode == LLD::JOURNAL::WRITE)
+            {
+                REQUIRE(vKeyIn == vKey);
+                REQUIRE(vDataIn == vData);
+            }
+
+            vOpcodes.push_back(nOpcode);
+            return true;
+        }));
+
+        REQUIRE(vOpcodes.size() == 3);
+        REQUIRE(vOpcodes[0] == LLD::JOURNAL::WRITE);
+        REQUIRE(vOpcodes[1] == LLD::JOURNAL::ERASE);
+        REQUIRE(vOpcodes[2] == LLD::JOURNAL::COMMIT);
+    }
+
+    //corrupt the last byte of the commit record checksum
+    {
+        std::fstream stream(strFile, std::ios::in | std::ios::out | std::ios::binary);
+        stream.seekg(-1, std::ios::end);
+        char nByte = stream.get();
+
+        stream.seekp(-1, std::ios::end);
+        stream.put(nByte ^ char(0xff));
+    }
+
+    //replay stops before the corrupted record
+    {
+        LLD::WriteAheadLog log(strFile);
+
+        uint32_t nRecords = 0;
+        REQUIRE_FALSE(log.Replay([&](const uint8_t nOpcode, const std::vector<uint8_t>& vKeyIn, const std::vector<uint8_t>& vDataIn)
+        {
+            REQUIRE(nOpcode != LLD::JOURNAL::COMMIT);
+
+            ++nRecords;
+            return true;
+        }));
+
+        REQUIRE(nRecords == 2);
+
+        //truncate clears the log
+        REQUIRE(log.Truncate());
+        REQUIRE(log.Size() == 0);
+    }
+
+    //appends inside a long sync interval are left to the flusher, which stops with the log
+    config::mapArgs["-lldsync"]         = "interval";
+    config::mapArgs["-lldsyncinterval"] = "60000";
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        {
+            LLD::WriteAheadLog log(strFile);
+
+            DataStream ssJournal(SER_LLD, LLD::DATABASE_VERSION);
+            LLD::WriteAheadLog::Encode(ssJournal, LLD::JOURNAL::WRITE, vKey, vData);
+            for(uint32_t n = 0; n < 100; ++n)
+            {
+                REQUIRE(log.Append(ssJournal.Bytes()));
+            }
+        }
+
+        REQUIRE(timer.ElapsedMilliseconds() < 60000);
+
+        LLD::WriteAheadLog log(strFile);
+
+        uint32_t nRecords = 0;
+        REQUIRE(log.Replay([&](const uint8_t nOpcode, const std::vector<uint8_t>& vKeyIn, const std::vector<uint8_t>& vDataIn)
+        {
+            ++nRecords;
+            return true;
+        }));
+
+        REQUIRE(nRecords == 100);
+    }
+    config::mapArgs.erase("-lldsync");
+    config::mapArgs.erase("-lldsyncinterval");
+
+    filesystem::remove_directories(strDir);
+}
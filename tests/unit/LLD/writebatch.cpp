@@ -0,0 +1,94 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_lru.h>
+
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+
+#include <unit/catch2/catch.hpp>
+
+/* Get a serialized key and record as the cache writer batches them. */
+std::pair<std::vector<uint8_t>, std::vector<uint8_t>> BatchRecord(const uint32_t nKey, const std::string& strValue)
+{
+    DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+    ssKey << nKey;
+
+    DataStream ssData(SER_LLD, LLD::DATABASE_VERSION);
+    ssData << std::string("NONE") << strValue;
+
+    return std::make_pair(ssKey.Bytes(), ssData.Bytes());
+}
+
+
+TEST_CASE("LLD batched write tests", "[LLD]")
+{
+    filesystem::remove_directories(config::GetDataDir() + "_WRITEBATCH_TEST/");
+
+    typedef LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU> BatchDB;
+    BatchDB* db = new BatchDB("_WRITEBATCH_TEST", LLD::FLAGS::CREATE | LLD::FLAGS::WRITE | LLD::FLAGS::FORCE, 7777, 1024 * 1024);
+
+    REQUIRE(db->Write(uint32_t(1), std::string(10, 'a')));
+    REQUIRE(db->Write(uint32_t(2), std::string(10, 'a')));
+
+    //a key resized and then written back at its old size, so the first write is appended and the second updated in place
+    std::vector< std::pair<std::vector<uint8_t>, std::vector<uint8_t>> > vBatch;
+    vBatch.push_back(BatchRecord(1, std::string(20, 'b')));
+    vBatch.push_back(BatchRecord(1, std::string(10, 'c')));
+
+    //the reverse, updated in place and then resized
+    vBatch.push_back(BatchRecord(2, std::string(10, 'b')));
+    vBatch.push_back(BatchRecord(2, std::string(20, 'c')));
+
+    //a new key written twice, both appended
+    vBatch.push_back(BatchRecord(3, std::string(5, 'b')));
+    vBatch.push_back(BatchRecord(4, std::string(5, 'b')));
+    vBatch.push_back(BatchRecord(3, std::string(7, 'c')));
+
+    REQUIRE(db->WriteBatch(vBatch));
+
+    //the cache holds the last write of each key
+    std::string strValue;
+    REQUIRE(db->Read(uint32_t(1), strValue));
+    REQUIRE(strValue == std::string(10, 'c'));
+
+    REQUIRE(db->Read(uint32_t(2), strValue));
+    REQUIRE(strValue == std::string(20, 'c'));
+
+    REQUIRE(db->Read(uint32_t(3), strValue));
+    REQUIRE(strValue == std::string(7, 'c'));
+
+    REQUIRE(db->Read(uint32_t(4), strValue));
+    REQUIRE(strValue == std::string(5, 'b'));
+
+    //and so do the keychain and sector files
+    delete db;
+    db = new BatchDB("_WRITEBATCH_TEST", LLD::FLAGS::APPEND, 7777, 1024 * 1024);
+
+    REQUIRE(db->Read(uint32_t(1), strValue));
+    REQUIRE(strValue == std::string(10, 'c'));
+
+    REQUIRE(db->Read(uint32_t(2), strValue));
+    REQUIRE(strValue == std::string(20, 'c'));
+
+    REQUIRE(db->Read(uint32_t(3), strValue));
+    REQUIRE(strValue == std::string(7, 'c'));
+
+    REQUIRE(db->Read(uint32_t(4), strValue));
+    REQUIRE(strValue == std::string(5, 'b'));
+
+    delete db;
+    filesystem::remove_directories(config::GetDataDir() + "_WRITEBATCH_TEST/");
+}
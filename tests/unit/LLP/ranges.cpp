@@ -0,0 +1,173 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <unit/catch2/catch.hpp>
+
+#include <LLP/include/ranges.h>
+
+#include <vector>
+
+/* Build a list of headers with hashes that follow a starting value. */
+std::vector<uint1024_t> RangeHeaders(const uint32_t nStart, const uint32_t nCount)
+{
+    std::vector<uint1024_t> vHeaders;
+    for(uint32_t n = 0; n < nCount; ++n)
+        vHeaders.push_back(uint1024_t(nStart + n));
+
+    return vHeaders;
+}
+
+
+TEST_CASE( "LLP::SyncRanges splitting", "[ranges]")
+{
+    LLP::SyncRanges ranges;
+    ranges.Reset(uint1024_t(1000), 100, true);
+
+    /* Headers that weren't requested are not cut into ranges. */
+    REQUIRE(ranges.Add(RangeHeaders(1001, 10), 4) == 0);
+    REQUIRE(ranges.Size() == 0);
+
+    /* The first request is by locator from the anchor. */
+    uint1024_t hashStart = 0;
+    bool fLocator = false;
+    REQUIRE(ranges.Request(hashStart, fLocator));
+    REQUIRE(hashStart == uint1024_t(1000));
+    REQUIRE(fLocator);
+
+    /* Only one request is out at a time. */
+    REQUIRE_FALSE(ranges.Request(hashStart, fLocator));
+
+    /* Ten headers in ranges of four are cut into 4, 4 and 2. */
+    REQUIRE(ranges.Add(RangeHeaders(1001, 10), 4) == 3);
+    REQUIRE(ranges.Size() == 3);
+    REQUIRE(ranges.Pending() == 3);
+    REQUIRE(ranges.TailHeight() == 110);
+
+    /* Each range follows the last block of the one before it, with heights from the anchor. */
+    LLP::SyncRange range;
+    REQUIRE(ranges.Assign(1, 200, range));
+    REQUIRE(range.hashStart == uint1024_t(1000));
+    REQUIRE(range.hashStop  == uint1024_t(1004));
+    REQUIRE(range.nBlocks   == 4);
+    REQUIRE(range.nHeight   == 104);
+    REQUIRE(range.fLocator);
+
+    REQUIRE(ranges.Assign(1, 200, range));
+    REQUIRE(range.hashStart == uint1024_t(1004));
+    REQUIRE(range.hashStop  == uint1024_t(1008));
+    REQUIRE(range.nHeight   == 108);
+    REQUIRE_FALSE(range.fLocator);
+
+    REQUIRE(ranges.Assign(1, 200, range));
+    REQUIRE(range.hashStart == uint1024_t(1008));
+    REQUIRE(range.hashStop  == uint1024_t(1010));
+    REQUIRE(range.nBlocks   == 2);
+    REQUIRE(range.nHeight   == 110);
+
+    /* Every range is assigned once. */
+    REQUIRE_FALSE(ranges.Assign(2, 200, range));
+    REQUIRE(ranges.Pending() == 0);
+    REQUIRE(ranges.Assigned(1) == 3);
+
+    /* The next headers follow the tail, not the anchor. */
+    REQUIRE(ranges.Request(hashStart, fLocator));
+    REQUIRE(hashStart == uint1024_t(1010));
+    REQUIRE_FALSE(fLocator);
+
+    REQUIRE(ranges.Add(RangeHeaders(1011, 4), 4) == 1);
+    REQUIRE(ranges.TailHeight() == 114);
+
+    REQUIRE(ranges.Assign(2, 200, range));
+    REQUIRE(range.hashStart == uint1024_t(1010));
+    REQUIRE(range.hashStop  == uint1024_t(1014));
+    REQUIRE(range.nHeight   == 114);
+
+    /* An empty answer leaves the tail where it is, and allows the next request. */
+    REQUIRE(ranges.Request(hashStart, fLocator));
+    REQUIRE(ranges.Add(std::vector<uint1024_t>(), 4) == 0);
+    REQUIRE(ranges.TailHeight() == 114);
+    REQUIRE(ranges.Request(hashStart, fLocator));
+    REQUIRE(hashStart == uint1024_t(1014));
+
+    /* Reset drops the ranges. */
+    ranges.Reset();
+    REQUIRE(ranges.Size() == 0);
+    REQUIRE(ranges.TailHeight() == 0);
+}
+
+
+TEST_CASE( "LLP::SyncRanges assignment", "[ranges]")
+{
+    LLP::SyncRanges ranges;
+    ranges.Reset(uint1024_t(5000), 0, false);
+
+    uint1024_t hashStart = 0;
+    bool fLocator = false;
+    REQUIRE(ranges.Request(hashStart, fLocator));
+    REQUIRE(ranges.Add(RangeHeaders(5001, 30), 10) == 3);
+
+    /* A node is only given ranges it has all of. */
+    LLP::SyncRange range;
+    REQUIRE_FALSE(ranges.Assign(7, 9, range));
+    REQUIRE(ranges.Assign(7, 15, range));
+    REQUIRE(range.hashStop == uint1024_t(5010));
+    REQUIRE_FALSE(ranges.Assign(7, 15, range));
+
+    /* Higher nodes get the lowest range left. */
+    REQUIRE(ranges.Assign(8, 100, range));
+    REQUIRE(range.hashStop == uint1024_t(5020));
+    REQUIRE(ranges.Assign(9, 100, range));
+    REQUIRE(range.hashStop == uint1024_t(5030));
+
+    REQUIRE(ranges.Find(8, range));
+    REQUIRE(range.hashStop == uint1024_t(5020));
+    REQUIRE_FALSE(ranges.Find(10, range));
+
+    /* Blocks inside of a range don't finish it. */
+    REQUIRE_FALSE(ranges.Received(uint1024_t(5005)));
+    REQUIRE(ranges.Size() == 3);
+
+    /* The last block of a range finishes it, once. */
+    REQUIRE(ranges.Received(uint1024_t(5010)));
+    REQUIRE_FALSE(ranges.Received(uint1024_t(5010)));
+    REQUIRE(ranges.Size() == 2);
+    REQUIRE(ranges.Assigned(7) == 0);
+
+    /* The ranges of a node that goes away are given out again. */
+    REQUIRE(ranges.Release(8) == 1);
+    REQUIRE(ranges.Release(0) == 0);
+    REQUIRE(ranges.Pending() == 1);
+
+    REQUIRE(ranges.Assign(7, 100, range));
+    REQUIRE(range.hashStart == uint1024_t(5010));
+    REQUIRE(range.hashStop  == uint1024_t(5020));
+    REQUIRE(ranges.Pending() == 0);
+
+    /* A stalled range is taken over from the lowest up, by a node that has it. */
+    REQUIRE_FALSE(ranges.Reassign(10, 15, range));
+    REQUIRE(ranges.Reassign(10, 100, range));
+    REQUIRE(range.hashStop == uint1024_t(5020));
+    REQUIRE(ranges.Assigned(7) == 0);
+    REQUIRE(ranges.Assigned(10) == 1);
+
+    REQUIRE(ranges.Reassign(10, 100, range));
+    REQUIRE(range.hashStop == uint1024_t(5030));
+    REQUIRE(ranges.Assigned(9) == 0);
+
+    /* A node doesn't take over its own range. */
+    REQUIRE_FALSE(ranges.Reassign(10, 100, range));
+
+    REQUIRE(ranges.Received(uint1024_t(5020)));
+    REQUIRE(ranges.Received(uint1024_t(5030)));
+    REQUIRE(ranges.Size() == 0);
+}
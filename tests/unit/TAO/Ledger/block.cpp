@@ -11,12 +11,19 @@
 
 ____________________________________________________________________________________________*/
 
+#include <LLC/hash/SK.h>
+#include <LLC/hash/macro.h>
+#include <LLC/include/random.h>
+
 #include <TAO/Ledger/types/block.h>
 #include <TAO/Ledger/types/tritium.h>
 #include <TAO/Ledger/types/state.h>
 
 #include <unit/catch2/catch.hpp>
 
+#include <atomic>
+#include <thread>
+
 TEST_CASE( "Block primitive values", "[ledger]")
 {
     TAO::Ledger::Block block;
@@ -117,3 +124,107 @@ TEST_CASE( "Block primitive values", "[ledger]")
 
 
 }
+
+
+TEST_CASE( "Block::GetHash cached", "[ledger]")
+{
+    TAO::Ledger::TritiumBlock block;
+    block.nVersion       = 7;
+    block.hashPrevBlock  = 111;
+    block.hashMerkleRoot = 555;
+    block.nChannel       = 2;
+    block.nHeight        = 5;
+    block.nBits          = 333;
+    block.nNonce         = 222;
+    block.nTime          = 999;
+
+    const uint1024_t hash = block.GetHash();
+    REQUIRE(block.GetHash() == hash);
+
+    //header writes change the hash
+    block.nNonce = 223;
+    REQUIRE(block.GetHash() != hash);
+
+    block.nNonce = 222;
+    REQUIRE(block.GetHash() == hash);
+
+    //derived header fields change the hash
+    block.nTime = 1000;
+    REQUIRE(block.GetHash() != hash);
+
+    //copies keep the hash of their own data
+    TAO::Ledger::TritiumBlock block2 = block;
+    block2.nTime = 999;
+    REQUIRE(block2.GetHash() == hash);
+    REQUIRE(block.GetHash() != hash);
+
+    //proof and signature hashes are cached apart
+    const uint1024_t hashProof = block2.ProofHash();
+    REQUIRE(hashProof != hash);
+
+    for(uint32_t n = 0; n < 4; ++n)
+    {
+        REQUIRE(block2.SignatureHash() == hash);
+        REQUIRE(block2.ProofHash() == hashProof);
+    }
+
+    //threads hashing the same block all see the same hash
+    std::atomic<uint32_t> nFailed(0);
+    std::vector<std::thread> vThreads;
+    for(uint32_t n = 0; n < 8; ++n)
+    {
+        vThreads.push_back(std::thread([&]()
+        {
+            for(uint32_t i = 0; i < 1000; ++i)
+            {
+                if(block2.GetHash() != hash || block2.ProofHash() != hashProof)
+                    ++nFailed;
+            }
+        }));
+    }
+
+    for(auto& thread : vThreads)
+        thread.join();
+
+    REQUIRE(nFailed.load() == 0);
+}
+
+
+TEST_CASE( "Block::BuildMerkleTree batched", "[ledger]")
+{
+    TAO::Ledger::TritiumBlock block;
+
+    //odd and even leaf counts pair the last leaf with itself
+    for(uint32_t nLeaves : { 1, 2, 3, 7, 8, 33 })
+    {
+        std::vector<uint512_t> vLeaves;
+        for(uint32_t n = 0; n < nLeaves; ++n)
+            vLeaves.push_back(LLC::GetRand512());
+
+        //reference root with one SK512 per pair
+        std::vector<uint512_t> vLevel = vLeaves;
+        while(vLevel.size() > 1)
+        {
+            std::vector<uint512_t> vNext;
+            for(uint32_t i = 0; i < vLevel.size(); i += 2)
+            {
+                const uint512_t& hashLeft  = vLevel[i];
+                const uint512_t& hashRight = vLevel[std::min(i + 1, uint32_t(vLevel.size() - 1))];
+
+                vNext.push_back(LLC::SK512(BEGIN(hashLeft), END(hashLeft), BEGIN(hashRight), END(hashRight)));
+            }
+
+            vLevel = vNext;
+        }
+
+        const uint512_t hashRoot = block.BuildMerkleTree(vLeaves);
+        REQUIRE(hashRoot == vLevel[0]);
+
+        //typed leaves build the same tree
+        std::vector< std::pair<uint8_t, uint512_t> > vtx;
+        for(const auto& hash : vLeaves)
+            vtx.push_back(std::make_pair(uint8_t(0), hash));
+
+        REQUIRE(block.BuildMerkleTree(vtx) == hashRoot);
+    }
+}
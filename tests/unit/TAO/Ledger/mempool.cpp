@@ -32,6 +32,9 @@ ________________________________________________________________________________
 #include <unit/catch2/catch.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 TEST_CASE( "Mempool and memory sequencing tests", "[mempool]")
 {
@@ -1676,3 +1679,68 @@ TEST_CASE( "Mempool and memory sequencing tests", "[mempool]")
         TAO::Ledger::mempool.Check();
     }
 }
+
+
+TEST_CASE( "Mempool concurrent accept tests", "[mempool]")
+{
+    using namespace TAO::Register;
+    using namespace TAO::Operation;
+
+    //create a signed transaction
+    uint256_t hashGenesis   = TAO::Ledger::SignatureChain::Genesis("concurrentuser");
+    uint512_t hashPrivKey1  = LLC::GetRand512();
+    uint512_t hashPrivKey2  = LLC::GetRand512();
+
+    TAO::Register::Address hashToken = TAO::Register::Address(TAO::Register::Address::TOKEN);
+
+    TAO::Ledger::Transaction tx;
+    tx.hashGenesis = hashGenesis;
+    tx.nSequence   = 0;
+    tx.nTimestamp  = runtime::timestamp();
+    tx.nKeyType    = TAO::Ledger::SIGNATURE::BRAINPOOL;
+    tx.nNextType   = TAO::Ledger::SIGNATURE::BRAINPOOL;
+    tx.NextHash(hashPrivKey2, TAO::Ledger::SIGNATURE::BRAINPOOL);
+
+    //payload
+    Object token = CreateToken(hashToken, 1000, 100);
+    tx[0] << uint8_t(OP::CREATE) << hashToken << uint8_t(REGISTER::OBJECT) << token.GetState();
+
+    REQUIRE(tx.Build());
+    tx.Sign(hashPrivKey1);
+
+    //a copy with a broken signature fails its checks before taking the pool lock
+    {
+        TAO::Ledger::Transaction txBad = tx;
+        REQUIRE_FALSE(txBad.vchSig.empty());
+        txBad.vchSig[txBad.vchSig.size() / 2] ^= 0x01;
+
+        REQUIRE_FALSE(TAO::Ledger::mempool.Accept(txBad));
+        REQUIRE_FALSE(TAO::Ledger::mempool.Has(txBad.GetHash()));
+    }
+
+    //accept the same transaction from several threads, each with its own copy as if it came from a different peer
+    std::vector<TAO::Ledger::Transaction> vCopies(8, tx);
+
+    std::atomic<uint32_t> nAccepted(0);
+    std::vector<std::thread> vThreads;
+    for(auto& txCopy : vCopies)
+    {
+        vThreads.emplace_back([&txCopy, &nAccepted]
+        {
+            if(TAO::Ledger::mempool.Accept(txCopy))
+                ++nAccepted;
+        });
+    }
+
+    for(auto& thread : vThreads)
+        thread.join();
+
+    REQUIRE(nAccepted.load() == 1);
+    REQUIRE(TAO::Ledger::mempool.Has(tx.GetHash()));
+
+    //a later accept is a duplicate
+    REQUIRE_FALSE(TAO::Ledger::mempool.Accept(tx));
+
+    //cleanup
+    REQUIRE(TAO::Ledger::mempool.Remove(tx.GetHash()));
+}
@@ -0,0 +1,435 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/random.h>
+
+#include <LLD/include/global.h>
+
+#include <TAO/Operation/include/enum.h>
+
+#include <TAO/Register/include/create.h>
+#include <TAO/Register/types/address.h>
+#include <TAO/Register/types/object.h>
+
+#include <TAO/Ledger/include/chainstate.h>
+#include <TAO/Ledger/include/enum.h>
+#include <TAO/Ledger/include/schedule.h>
+#include <TAO/Ledger/types/sigchain.h>
+#include <TAO/Ledger/types/state.h>
+#include <TAO/Ledger/types/transaction.h>
+
+#include <Util/include/thread_pool.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <map>
+#include <string>
+
+
+TEST_CASE( "Connect Schedule Tests", "[ledger]")
+{
+    //transactions sharing no keys each get a group
+    {
+        std::vector< std::set<uint512_t> > vKeys =
+        {
+            { 10, 11 },
+            { 20 },
+            { 30, 31 }
+        };
+
+        std::vector< std::vector<uint32_t> > vGroups = TAO::Ledger::ConflictGroups(vKeys);
+        REQUIRE(vGroups.size() == 3);
+        REQUIRE(vGroups[0] == std::vector<uint32_t>({ 0 }));
+        REQUIRE(vGroups[1] == std::vector<uint32_t>({ 1 }));
+        REQUIRE(vGroups[2] == std::vector<uint32_t>({ 2 }));
+    }
+
+    //keys join transactions directly and through others, keeping block order
+    {
+        std::vector< std::set<uint512_t> > vKeys =
+        {
+            { 10 },
+            { 20 },
+            { 30, 20 },
+            { 40 },
+            { 10, 30 },
+            { 50 }
+        };
+
+        std::vector< std::vector<uint32_t> > vGroups = TAO::Ledger::ConflictGroups(vKeys);
+        REQUIRE(vGroups.size() == 3);
+        REQUIRE(vGroups[0] == std::vector<uint32_t>({ 0, 1, 2, 4 }));
+        REQUIRE(vGroups[1] == std::vector<uint32_t>({ 3 }));
+        REQUIRE(vGroups[2] == std::vector<uint32_t>({ 5 }));
+    }
+
+    //an empty run has no groups
+    {
+        std::vector< std::set<uint512_t> > vKeys;
+        REQUIRE(TAO::Ledger::ConflictGroups(vKeys).empty());
+    }
+}
+
+
+/* Get a new genesis for the schedule tests. */
+uint256_t ScheduleGenesis()
+{
+    const std::string strUser = "schedule" + std::to_string(LLC::GetRand());
+    return TAO::Ledger::SignatureChain::Genesis(SecureString(strUser.c_str()));
+}
+
+
+/* Get the groups of a list of transactions, failing if any can't be keyed. */
+std::vector< std::vector<uint32_t> > ScheduleGroups(const std::vector<TAO::Ledger::Transaction>& vtx)
+{
+    std::set<uint256_t> setMoved;
+
+    std::vector< std::set<uint512_t> > vKeys;
+    for(const auto& tx : vtx)
+    {
+        std::set<uint512_t> setKeys;
+        REQUIRE(TAO::Ledger::ConflictKeys(tx, tx.GetHash(), setMoved, setKeys));
+
+        vKeys.push_back(setKeys);
+    }
+
+    return TAO::Ledger::ConflictGroups(vKeys);
+}
+
+
+TEST_CASE( "Connect Schedule Conflict Key Tests", "[ledger]")
+{
+    using namespace TAO::Operation;
+
+    const uint256_t hashGenesis1 = ScheduleGenesis();
+    const uint256_t hashGenesis2 = ScheduleGenesis();
+
+    //transactions of the same sigchain are in one group
+    {
+        TAO::Ledger::Transaction tx1;
+        tx1.hashGenesis = hashGenesis1;
+        tx1.nSequence   = 1;
+        tx1[0] << uint8_t(OP::WRITE) << uint256_t(TAO::Register::Address(TAO::Register::Address::APPEND)) << std::vector<uint8_t>(1, 1);
+
+        TAO::Ledger::Transaction tx2;
+        tx2.hashGenesis = hashGenesis1;
+        tx2.nSequence   = 2;
+        tx2[0] << uint8_t(OP::WRITE) << uint256_t(TAO::Register::Address(TAO::Register::Address::APPEND)) << std::vector<uint8_t>(1, 2);
+
+        TAO::Ledger::Transaction tx3;
+        tx3.hashGenesis = hashGenesis2;
+        tx3.nSequence   = 1;
+        tx3[0] << uint8_t(OP::WRITE) << uint256_t(TAO::Register::Address(TAO::Register::Address::APPEND)) << std::vector<uint8_t>(1, 3);
+
+        std::vector< std::vector<uint32_t> > vGroups = ScheduleGroups({ tx1, tx3, tx2 });
+        REQUIRE(vGroups.size() == 2);
+        REQUIRE(vGroups[0] == std::vector<uint32_t>({ 0, 2 }));
+        REQUIRE(vGroups[1] == std::vector<uint32_t>({ 1 }));
+    }
+
+    //creates from different sigchains share a key, since creates check other registers exist
+    {
+        TAO::Register::Address hashToken1 = TAO::Register::Address(TAO::Register::Address::TOKEN);
+        TAO::Register::Address hashToken2 = TAO::Register::Address(TAO::Register::Address::TOKEN);
+
+        TAO::Ledger::Transaction tx1;
+        tx1.hashGenesis = hashGenesis1;
+        tx1[0] << uint8_t(OP::CREATE) << hashToken1 << uint8_t(TAO::Register::REGISTER::OBJECT)
+               << TAO::Register::CreateToken(hashToken1, 1000, 0).GetState();
+
+        TAO::Ledger::Transaction tx2;
+        tx2.hashGenesis = hashGenesis2;
+        tx2[0] << uint8_t(OP::CREATE) << hashToken2 << uint8_t(TAO::Register::REGISTER::OBJECT)
+               << TAO::Register::CreateToken(hashToken2, 1000, 0).GetState();
+
+        std::vector< std::vector<uint32_t> > vGroups = ScheduleGroups({ tx1, tx2 });
+        REQUIRE(vGroups.size() == 1);
+        REQUIRE(vGroups[0] == std::vector<uint32_t>({ 0, 1 }));
+    }
+
+    //a debit joins the owner of the recipient, who receives the event
+    {
+        TAO::Register::Address hashFrom = TAO::Register::Address(TAO::Register::Address::ACCOUNT);
+        TAO::Register::Address hashTo   = TAO::Register::Address(TAO::Register::Address::ACCOUNT);
+
+        TAO::Register::Object account = TAO::Register::CreateAccount(TAO::Register::Address(TAO::Register::Address::TOKEN));
+        account.hashOwner = hashGenesis2;
+        REQUIRE(LLD::Register->WriteState(hashTo, account, TAO::Ledger::FLAGS::BLOCK));
+
+        TAO::Ledger::Transaction tx1;
+        tx1.hashGenesis = hashGenesis1;
+        tx1[0] << uint8_t(OP::DEBIT) << hashFrom << hashTo << uint64_t(100) << uint64_t(0);
+
+        TAO::Ledger::Transaction tx2;
+        tx2.hashGenesis = hashGenesis2;
+        tx2[0] << uint8_t(OP::WRITE) << uint256_t(TAO::Register::Address(TAO::Register::Address::APPEND)) << std::vector<uint8_t>(1, 4);
+
+        std::set<uint512_t> setKeys;
+        REQUIRE(TAO::Ledger::ConflictKeys(tx1, tx1.GetHash(), std::set<uint256_t>(), setKeys));
+        REQUIRE(setKeys.count(hashGenesis2));
+
+        std::vector< std::vector<uint32_t> > vGroups = ScheduleGroups({ tx1, tx2 });
+        REQUIRE(vGroups.size() == 1);
+        REQUIRE(vGroups[0] == std::vector<uint32_t>({ 0, 1 }));
+
+        //the owner isn't known when the recipient changes owner in the same run
+        setKeys.clear();
+        REQUIRE_FALSE(TAO::Ledger::ConflictKeys(tx1, tx1.GetHash(), std::set<uint256_t>({ hashTo }), setKeys));
+    }
+
+    //a transfer joins the recipient
+    {
+        TAO::Register::Address hashAsset = TAO::Register::Address(TAO::Register::Address::OBJECT);
+
+        TAO::Ledger::Transaction tx1;
+        tx1.hashGenesis = hashGenesis1;
+        tx1[0] << uint8_t(OP::TRANSFER) << hashAsset << hashGenesis2 << uint8_t(TAO::Operation::TRANSFER::CLAIM);
+
+        TAO::Ledger::Transaction tx2;
+        tx2.hashGenesis = hashGenesis2;
+        tx2[0] << uint8_t(OP::WRITE) << uint256_t(TAO::Register::Address(TAO::Register::Address::APPEND)) << std::vector<uint8_t>(1, 5);
+
+        std::vector< std::vector<uint32_t> > vGroups = ScheduleGroups({ tx1, tx2 });
+        REQUIRE(vGroups.size() == 1);
+    }
+
+    //coinstakes and trust are connected on their own
+    {
+        std::set<uint512_t> setKeys;
+
+        TAO::Ledger::Transaction txTrust;
+        txTrust.hashGenesis = hashGenesis1;
+        txTrust[0] << uint8_t(OP::TRUST) << uint512_t(0) << uint64_t(0) << int64_t(0) << uint64_t(0);
+        REQUIRE(txTrust.IsCoinStake());
+        REQUIRE_FALSE(TAO::Ledger::ConflictKeys(txTrust, txTrust.GetHash(), std::set<uint256_t>(), setKeys));
+
+        TAO::Ledger::Transaction txGenesis;
+        txGenesis.hashGenesis = hashGenesis1;
+        txGenesis[0] << uint8_t(OP::GENESIS) << uint64_t(0) << uint64_t(0);
+        REQUIRE(txGenesis.IsCoinStake());
+        REQUIRE_FALSE(TAO::Ledger::ConflictKeys(txGenesis, txGenesis.GetHash(), std::set<uint256_t>(), setKeys));
+
+        TAO::Ledger::Transaction txMigrate;
+        txMigrate.hashGenesis = hashGenesis1;
+        txMigrate[0] << uint8_t(OP::MIGRATE) << uint512_t(0) << uint256_t(0);
+        REQUIRE_FALSE(TAO::Ledger::ConflictKeys(txMigrate, txMigrate.GetHash(), std::set<uint256_t>(), setKeys));
+    }
+}
+
+
+/* A signature chain that builds and connects transactions in sequence. */
+class ScheduleChain
+{
+    uint512_t hashPrivKey1;
+    uint512_t hashPrivKey2;
+    uint512_t hashPrevTx;
+    uint32_t  nSequence;
+
+public:
+
+    uint256_t hashGenesis;
+
+    ScheduleChain()
+    : hashPrivKey1(LLC::GetRand512())
+    , hashPrivKey2(LLC::GetRand512())
+    , hashPrevTx(0)
+    , nSequence(0)
+    , hashGenesis(ScheduleGenesis())
+    {
+    }
+
+    /* Build the next transaction with a contract, and connect it in memory, and on disk if fBlock. */
+    TAO::Ledger::Transaction Next(const TAO::Operation::Contract& contract, const bool fBlock)
+    {
+        TAO::Ledger::Transaction tx;
+        tx.hashGenesis = hashGenesis;
+        tx.nSequence   = nSequence;
+        tx.hashPrevTx  = hashPrevTx;
+        tx.nTimestamp  = runtime::timestamp();
+        tx.nKeyType    = TAO::Ledger::SIGNATURE::BRAINPOOL;
+        tx.nNextType   = TAO::Ledger::SIGNATURE::BRAINPOOL;
+        tx.NextHash(hashPrivKey2, TAO::Ledger::SIGNATURE::BRAINPOOL);
+        tx[0] = contract;
+
+        REQUIRE(tx.Build());
+        REQUIRE(tx.Sign(hashPrivKey1));
+
+        const uint512_t hash = tx.GetHash();
+        REQUIRE(tx.Verify(TAO::Ledger::FLAGS::MEMPOOL));
+        REQUIRE(tx.Connect(TAO::Ledger::FLAGS::MEMPOOL));
+        REQUIRE(LLD::Ledger->WriteTx(hash, tx));
+
+        if(fBlock)
+        {
+            REQUIRE(tx.Verify(TAO::Ledger::FLAGS::BLOCK));
+            REQUIRE(tx.Connect(TAO::Ledger::FLAGS::BLOCK));
+            REQUIRE(LLD::Ledger->IndexBlock(hash, TAO::Ledger::ChainState::Genesis()));
+        }
+
+        hashPrivKey1 = hashPrivKey2;
+        hashPrivKey2 = LLC::GetRand512();
+        hashPrevTx   = hash;
+        ++nSequence;
+
+        return tx;
+    }
+};
+
+
+/* Read the ledger state the schedule tests compare. */
+std::map<uint256_t, std::vector<uint8_t>> ScheduleState(const std::vector<uint256_t>& vRegisters, const std::vector<uint256_t>& vGenesis)
+{
+    std::map<uint256_t, std::vector<uint8_t>> mapState;
+    for(const auto& hashRegister : vRegisters)
+    {
+        TAO::Register::State state;
+        REQUIRE(LLD::Register->ReadState(hashRegister, state, TAO::Ledger::FLAGS::BLOCK));
+
+        mapState[hashRegister] = state.GetState();
+    }
+
+    for(const auto& hashGenesis : vGenesis)
+    {
+        /* The last transaction of the sigchain. */
+        uint512_t hashLast = 0;
+        REQUIRE(LLD::Ledger->ReadLast(hashGenesis, hashLast));
+
+        std::vector<uint8_t>& vState = mapState[hashGenesis];
+        vState = hashLast.GetBytes();
+
+        /* The events received, in order. */
+        uint32_t nSequence = 0;
+        LLD::Ledger->ReadSequence(hashGenesis, nSequence);
+        for(uint32_t n = 0; n < nSequence; ++n)
+        {
+            TAO::Ledger::Transaction tx;
+            REQUIRE(LLD::Ledger->ReadEvent(hashGenesis, n, tx));
+
+            const std::vector<uint8_t> vHash = tx.GetHash().GetBytes();
+            vState.insert(vState.end(), vHash.begin(), vHash.end());
+        }
+    }
+
+    return mapState;
+}
+
+
+TEST_CASE( "Connect Schedule Parallel Tests", "[ledger]")
+{
+    using namespace TAO::Operation;
+
+    //four sigchains, each with a token and an account for it
+    ScheduleChain chains[4];
+    TAO::Register::Address hashToken[4];
+    TAO::Register::Address hashAccount[4];
+    for(uint32_t n = 0; n < 4; ++n)
+    {
+        hashToken[n]   = TAO::Register::Address(TAO::Register::Address::TOKEN);
+        hashAccount[n] = TAO::Register::Address(TAO::Register::Address::ACCOUNT);
+
+        Contract token;
+        token << uint8_t(OP::CREATE) << hashToken[n] << uint8_t(TAO::Register::REGISTER::OBJECT)
+              << TAO::Register::CreateToken(hashToken[n], 10000, 0).GetState();
+        chains[n].Next(token, true);
+
+        Contract account;
+        account << uint8_t(OP::CREATE) << hashAccount[n] << uint8_t(TAO::Register::REGISTER::OBJECT)
+                << TAO::Register::CreateAccount(hashToken[n]).GetState();
+        chains[n].Next(account, true);
+    }
+
+    //the last sigchain also has an account for the token of the third
+    TAO::Register::Address hashShared = TAO::Register::Address(TAO::Register::Address::ACCOUNT);
+    {
+        Contract account;
+        account << uint8_t(OP::CREATE) << hashShared << uint8_t(TAO::Register::REGISTER::OBJECT)
+                << TAO::Register::CreateAccount(hashToken[2]).GetState();
+        chains[3].Next(account, true);
+    }
+
+    //build a run of debits in memory only: two in order on each of the first two sigchains,
+    //and debits from the third and fourth that both write events for the fourth
+    std::vector<TAO::Ledger::Transaction> vtx;
+    for(uint32_t n = 0; n < 2; ++n)
+    {
+        for(uint32_t i = 0; i < 2; ++i)
+        {
+            Contract debit;
+            debit << uint8_t(OP::DEBIT) << hashToken[n] << hashAccount[n] << uint64_t(100 * (i + 1)) << uint64_t(0);
+            vtx.push_back(chains[n].Next(debit, false));
+        }
+    }
+    {
+        Contract debit;
+        debit << uint8_t(OP::DEBIT) << hashToken[2] << hashShared << uint64_t(300) << uint64_t(0);
+        vtx.push_back(chains[2].Next(debit, false));
+    }
+    {
+        Contract debit;
+        debit << uint8_t(OP::DEBIT) << hashToken[3] << hashAccount[3] << uint64_t(400) << uint64_t(0);
+        vtx.push_back(chains[3].Next(debit, false));
+    }
+
+    //the sigchains and the shared recipient make three groups
+    std::vector< std::vector<uint32_t> > vGroups = ScheduleGroups(vtx);
+    REQUIRE(vGroups.size() == 3);
+    REQUIRE(vGroups[0] == std::vector<uint32_t>({ 0, 1 }));
+    REQUIRE(vGroups[1] == std::vector<uint32_t>({ 2, 3 }));
+    REQUIRE(vGroups[2] == std::vector<uint32_t>({ 4, 5 }));
+
+    std::vector<uint256_t> vRegisters;
+    std::vector<uint256_t> vGenesis;
+    for(uint32_t n = 0; n < 4; ++n)
+    {
+        vRegisters.push_back(hashToken[n]);
+        vRegisters.push_back(hashAccount[n]);
+        vGenesis.push_back(chains[n].hashGenesis);
+    }
+    vRegisters.push_back(hashShared);
+
+    const std::map<uint256_t, std::vector<uint8_t>> mapBefore = ScheduleState(vRegisters, vGenesis);
+
+    //connect the run serially in block order
+    for(const auto& tx : vtx)
+    {
+        REQUIRE(tx.Verify(TAO::Ledger::FLAGS::BLOCK));
+        REQUIRE(tx.Connect(TAO::Ledger::FLAGS::BLOCK));
+        REQUIRE(LLD::Ledger->IndexBlock(tx.GetHash(), TAO::Ledger::ChainState::Genesis()));
+    }
+
+    const std::map<uint256_t, std::vector<uint8_t>> mapSerial = ScheduleState(vRegisters, vGenesis);
+    REQUIRE((mapSerial != mapBefore));
+
+    //disconnect it again
+    for(auto tx = vtx.rbegin(); tx != vtx.rend(); ++tx)
+    {
+        REQUIRE(tx->Disconnect(TAO::Ledger::FLAGS::BLOCK));
+        REQUIRE(LLD::Ledger->EraseIndex(tx->GetHash()));
+    }
+
+    REQUIRE((ScheduleState(vRegisters, vGenesis) == mapBefore));
+
+    //connect the run with its groups in parallel
+    TAO::Ledger::BlockState state;
+    for(const auto& tx : vtx)
+        state.vtx.push_back(std::make_pair(TAO::Ledger::TRANSACTION::TRITIUM, tx.GetHash()));
+
+    thread_pool pool(4);
+
+    std::vector<TAO::Ledger::Transaction> vRun;
+    REQUIRE(state.ConnectRun(0, vRun, &pool));
+    REQUIRE(vRun.size() == vtx.size());
+
+    //the ledger is the same as after the serial connect
+    REQUIRE((ScheduleState(vRegisters, vGenesis) == mapSerial));
+}
@@ -0,0 +1,57 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/random.h>
+
+#include <TAO/Ledger/types/sigcache.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+TEST_CASE( "Signature Cache Tests", "[ledger]")
+{
+    TAO::Ledger::SignatureCache cache;
+
+    const uint512_t hashTx  = LLC::GetRand512();
+    const uint256_t hashKey = LLC::GetRand256();
+
+    //unverified signatures miss
+    REQUIRE_FALSE(cache.Has(hashTx, hashKey));
+    REQUIRE(cache.Misses() == 1);
+
+    //verified signatures hit only with the same key
+    cache.Add(hashTx, hashKey);
+    REQUIRE(cache.Has(hashTx, hashKey));
+    REQUIRE_FALSE(cache.Has(hashTx, hashKey + 1));
+    REQUIRE(cache.Hits() == 1);
+    REQUIRE(cache.Misses() == 2);
+
+    //eviction drops every key of the transaction and keeps others
+    const uint512_t hashOther = LLC::GetRand512();
+    cache.Add(hashTx, hashKey + 1);
+    cache.Add(hashOther, hashKey);
+
+    REQUIRE(cache.Size() == 3);
+
+    cache.Evict(hashTx);
+    REQUIRE_FALSE(cache.Has(hashTx, hashKey));
+    REQUIRE_FALSE(cache.Has(hashTx, hashKey + 1));
+    REQUIRE(cache.Has(hashOther, hashKey));
+
+    //evicted signatures leave nothing behind
+    REQUIRE(cache.Size() == 1);
+
+    cache.Add(hashTx, hashKey);
+    REQUIRE(cache.Has(hashTx, hashKey));
+    REQUIRE(cache.Size() == 2);
+}
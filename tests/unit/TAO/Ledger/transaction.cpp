@@ -11,10 +11,19 @@
 
 ____________________________________________________________________________________________*/
 
+#include <LLD/include/version.h>
+
+#include <TAO/Operation/include/enum.h>
+
 #include <TAO/Ledger/types/transaction.h>
 
+#include <Util/templates/datastream.h>
+
 #include <unit/catch2/catch.hpp>
 
+#include <atomic>
+#include <thread>
+
 //test greater than operator
 TEST_CASE( "Transaction::operator>", "[ledger]" )
 {
@@ -39,3 +48,60 @@ TEST_CASE( "Transaction::operator<", "[ledger]" )
     REQUIRE(tx1 < tx2);
     REQUIRE_FALSE(tx2 < tx1);
 }
+
+
+//test the cached transaction hash
+TEST_CASE( "Transaction::GetHash cached", "[ledger]" )
+{
+    TAO::Ledger::Transaction tx;
+    tx.nSequence = 1;
+    tx[0] << uint8_t(TAO::Operation::OP::WRITE) << uint256_t(555) << std::vector<uint8_t>(10, 0xff);
+
+    const uint512_t hash = tx.GetHash();
+    REQUIRE(tx.GetHash() == hash);
+
+    //header writes change the hash
+    tx.nTimestamp += 1;
+    REQUIRE(tx.GetHash() != hash);
+
+    tx.nTimestamp -= 1;
+    REQUIRE(tx.GetHash() == hash);
+
+    //contract writes change the hash
+    TAO::Ledger::Transaction txWrite = tx;
+    txWrite[0] << uint8_t(1);
+
+    const uint512_t hashWrite = txWrite.GetHash();
+    REQUIRE(hashWrite != hash);
+    REQUIRE(tx.GetHash() == hash);
+
+    //reading into a transaction with a cached hash
+    DataStream ssData(SER_LLD, LLD::DATABASE_VERSION);
+    ssData << txWrite;
+
+    TAO::Ledger::Transaction txRead = tx;
+    REQUIRE(txRead.GetHash() == hash);
+
+    ssData >> txRead;
+    REQUIRE(txRead.GetHash() == hashWrite);
+
+    //threads hashing the same transaction all see the same hash
+    std::atomic<uint32_t> nFailed(0);
+    std::vector<std::thread> vThreads;
+    for(uint32_t n = 0; n < 8; ++n)
+    {
+        vThreads.push_back(std::thread([&]()
+        {
+            for(uint32_t i = 0; i < 1000; ++i)
+            {
+                if(txRead.GetHash() != hashWrite)
+                    ++nFailed;
+            }
+        }));
+    }
+
+    for(auto& thread : vThreads)
+        thread.join();
+
+    REQUIRE(nFailed.load() == 0);
+}
@@ -0,0 +1,97 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <Util/templates/sharded_cache.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+/* Picks the shard of a test key by its tens, so keys of the same tens are erased together. */
+struct TensHash
+{
+    uint64_t operator()(const uint32_t nKey) const
+    {
+        return nKey / 10;
+    }
+};
+
+
+TEST_CASE("Util sharded cache tests", "[cache]")
+{
+    //the oldest entries are dropped over the bound
+    {
+        sharded_cache<uint32_t, uint32_t, TensHash, 1> cache;
+        for(uint32_t n = 1; n <= 5; ++n)
+        {
+            REQUIRE(cache.put(n, n * 100, 4));
+        }
+
+        REQUIRE(cache.size() == 4);
+        REQUIRE_FALSE(cache.has(1));
+
+        uint32_t nValue = 0;
+        REQUIRE(cache.get(5, nValue));
+        REQUIRE(nValue == 500);
+
+        //a cached key keeps its value and its place
+        REQUIRE_FALSE(cache.put(2, 0, 4));
+        REQUIRE(cache.get(2, nValue));
+        REQUIRE(nValue == 200);
+    }
+
+    //erased entries leave the eviction order too, so a key added again is not dropped early
+    {
+        sharded_cache<uint32_t, uint32_t, TensHash, 1> cache;
+        for(uint32_t n = 1; n <= 4; ++n)
+        {
+            REQUIRE(cache.put(n, n, 4));
+        }
+
+        cache.erase(1);
+        REQUIRE(cache.size() == 3);
+
+        REQUIRE(cache.put(1, 1, 4));
+        REQUIRE(cache.put(5, 5, 4));
+
+        REQUIRE(cache.size() == 4);
+        REQUIRE(cache.has(1));
+        REQUIRE_FALSE(cache.has(2));
+
+        //adding and erasing many times never grows past the bound
+        for(uint32_t n = 100; n < 10000; ++n)
+        {
+            REQUIRE(cache.put(n, n, 4));
+            cache.erase(n);
+        }
+
+        REQUIRE(cache.size() == 3);
+        REQUIRE(cache.has(1));
+    }
+
+    //ranges are erased from their first key while they match
+    {
+        sharded_cache<uint32_t, uint32_t, TensHash> cache;
+        for(uint32_t n = 10; n < 30; ++n)
+        {
+            REQUIRE(cache.put(n, n, 1000));
+        }
+
+        cache.erase_range(10, [](const uint32_t nKey) { return nKey / 10 == 1; });
+        REQUIRE(cache.size() == 10);
+
+        for(uint32_t n = 10; n < 30; ++n)
+        {
+            REQUIRE(cache.has(n) == (n >= 20));
+        }
+    }
+}